@@ -22,6 +22,7 @@
 #include "clang-c/CXErrorCode.h"
 #include "clang-c/CXString.h"
 #include "clang-c/BuildSystem.h"
+#include "clang-c/CXCompilationDatabase.h"
 
 /**
  * \brief The version constants for the libclang API.
@@ -32,7 +33,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 43
+#define CINDEX_VERSION_MINOR 46
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -1480,11 +1481,42 @@ CINDEX_LINKAGE int clang_saveTranslationUnit(CXTranslationUnit TU,
  * \brief Suspend a translation unit in order to free memory associated with it.
  *
  * A suspended translation unit uses significantly less memory but on the other
- * side does not support any other calls than \c clang_reparseTranslationUnit
- * to resume it or \c clang_disposeTranslationUnit to dispose it completely.
+ * side does not support any other calls than \c clang_resumeTranslationUnit or
+ * \c clang_reparseTranslationUnit to resume it or
+ * \c clang_disposeTranslationUnit to dispose it completely.
+ *
+ * If the translation unit was parsed without a precompiled preamble or
+ * header, or with \c CXTranslationUnit_ForSerialization, its AST is kept in a
+ * compact serialized form (along with the preamble, if any) from which
+ * \c clang_resumeTranslationUnit restores it without reparsing.
  */
 CINDEX_LINKAGE unsigned clang_suspendTranslationUnit(CXTranslationUnit);
 
+/**
+ * \brief Resume a translation unit suspended by
+ * \c clang_suspendTranslationUnit.
+ *
+ * The translation unit is restored from the serialized form kept when it was
+ * suspended, as it was at that time. If there is no such form, or if any of
+ * the files the translation unit depends on changed on disk since, the
+ * translation unit is reparsed as by \c clang_reparseTranslationUnit with the
+ * given unsaved files and options, which are otherwise unused. Clients whose
+ * unsaved files changed since the translation unit was suspended should call
+ * \c clang_reparseTranslationUnit instead.
+ *
+ * Calling this function on a translation unit that is not suspended has no
+ * effect.
+ *
+ * \returns 0 if the translation unit was resumed successfully, otherwise
+ * a nonzero error code of the same kind as \c clang_reparseTranslationUnit
+ * returns. If an error occurs, the translation unit can only be reparsed or
+ * disposed.
+ */
+CINDEX_LINKAGE int
+clang_resumeTranslationUnit(CXTranslationUnit TU, unsigned num_unsaved_files,
+                            struct CXUnsavedFile *unsaved_files,
+                            unsigned options);
+
 /**
  * \brief Destroy the specified CXTranslationUnit object.
  */
@@ -5097,7 +5129,16 @@ enum CXCodeComplete_Flags {
    * \brief Whether to include brief documentation within the set of code
    * completions returned.
    */
-  CXCodeComplete_IncludeBriefComments = 0x04
+  CXCodeComplete_IncludeBriefComments = 0x04,
+
+  /**
+   * \brief Whether to drop results that do not fuzzy-match the identifier
+   * being typed, ranking the remaining results by match quality.
+   *
+   * The identifier is the one that ends at the code-completion location,
+   * unless a prefix is given to \c clang_codeCompleteAtWithLimit().
+   */
+  CXCodeComplete_FuzzyFilter = 0x08
 };
 
 /**
@@ -5314,6 +5355,35 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             unsigned num_unsaved_files,
                                             unsigned options);
 
+/**
+ * \brief Perform code completion at a given location in a translation unit,
+ * reporting only the best-ranked results.
+ *
+ * This function behaves like \c clang_codeCompleteAt(), but results are
+ * filtered against \p typed_prefix and ranked while they are produced, so
+ * that only \p max_results of them have completion strings built and
+ * returned. The latency is therefore largely independent of the number of
+ * declarations visible at the completion location.
+ *
+ * \param typed_prefix The text typed so far for the name being completed.
+ * If NULL or empty, the identifier that ends at the code-completion location
+ * is used instead. Filtering only happens when \p options includes
+ * \c CXCodeComplete_FuzzyFilter.
+ *
+ * \param max_results The maximum number of results to return, keeping the
+ * ones with the best (lowest) priority. Zero means no limit.
+ *
+ * The other parameters and the result are as for \c clang_codeCompleteAt().
+ */
+CINDEX_LINKAGE
+CXCodeCompleteResults *
+clang_codeCompleteAtWithLimit(CXTranslationUnit TU,
+                              const char *complete_filename,
+                              unsigned complete_line, unsigned complete_column,
+                              struct CXUnsavedFile *unsaved_files,
+                              unsigned num_unsaved_files, unsigned options,
+                              const char *typed_prefix, unsigned max_results);
+
 /**
  * \brief Sort the code-completion results in case-insensitive alphabetical 
  * order.
@@ -6143,7 +6213,18 @@ typedef enum {
    * indexing session associated with a \c CXIndexAction object.
    * Bodies in system headers are always skipped.
    */
-  CXIndexOpt_SkipParsedBodiesInSession = 0x10
+  CXIndexOpt_SkipParsedBodiesInSession = 0x10,
+
+  /**
+   * \brief Report the declarations and references in a header only for the
+   * first translation unit of an indexing session, associated with a
+   * \c CXIndexAction object, that includes it.
+   *
+   * This applies to headers with include guards or '#pragma once' that are
+   * included with the same predefined macros, i.e. the same -D/-U options and
+   * language mode.
+   */
+  CXIndexOpt_SkipIndexedHeadersInSession = 0x20
 
 } CXIndexOptFlags;
 
@@ -6220,6 +6301,36 @@ CINDEX_LINKAGE int clang_indexTranslationUnit(CXIndexAction,
                                               unsigned index_options,
                                               CXTranslationUnit);
 
+/**
+ * \brief Index the translation units of the given compile commands, e.g., a
+ * whole project as returned by
+ * \c clang_CompilationDatabase_getAllCompileCommands, on a pool of threads.
+ *
+ * Each command is indexed as if by #clang_indexSourceFileFullArgv, in the
+ * directory of the command. Combine with
+ * \c CXIndexOpt_SkipIndexedHeadersInSession to have the symbols of each
+ * header reported once for the whole run.
+ *
+ * The callbacks of different translation units may be invoked concurrently
+ * from different threads, with the same \p client_data; the callbacks for a
+ * single translation unit are invoked from a single thread.
+ *
+ * \param num_threads the number of threads to use, or 0 to use one thread
+ * per hardware thread.
+ *
+ * \returns 0 if every translation unit was indexed, otherwise the
+ * \c CXErrorCode of the first command that failed.
+ *
+ * The other parameters are the same as #clang_indexSourceFile.
+ */
+CINDEX_LINKAGE int clang_indexCompileCommands(CXIndexAction,
+                                              CXClientData client_data,
+                                              IndexerCallbacks *index_callbacks,
+                                              unsigned index_callbacks_size,
+                                              unsigned index_options,
+                                              CXCompileCommands commands,
+                                              unsigned num_threads);
+
 /**
  * \brief Retrieve the CXIdxFile, file, line, column, and offset represented by
  * the given CXIdxLoc.
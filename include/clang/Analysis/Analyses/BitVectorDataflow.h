@@ -0,0 +1,130 @@
+//===- BitVectorDataflow.h - Dense bit-vector dataflow ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a worklist that visits the blocks of a CFG in reverse
+// postorder, or in postorder for backward analyses, and a solver for dataflow
+// problems whose values are dense bit vectors and whose block transfer
+// functions are given as gen and kill sets.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_ANALYSIS_ANALYSES_BITVECTORDATAFLOW_H
+#define LLVM_CLANG_ANALYSIS_ANALYSES_BITVECTORDATAFLOW_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/SmallVector.h"
+#include <functional>
+#include <vector>
+
+namespace clang {
+
+class CFG;
+class CFGBlock;
+class PostOrderCFGView;
+
+/// \brief A worklist of CFG blocks.
+///
+/// Blocks are handed out in reverse postorder for forward analyses, and in
+/// postorder for backward analyses, so that a block is usually visited after
+/// the blocks its value depends on. Blocks that are not reachable from the
+/// entry come after all the others. A block is in the worklist at most once.
+class DataflowWorklist {
+public:
+  enum Direction { Forward, Backward };
+
+private:
+  /// \brief The position of each block in the visiting order, by block ID.
+  SmallVector<unsigned, 32> Positions;
+  /// \brief The blocks, by position.
+  SmallVector<const CFGBlock *, 32> Blocks;
+  /// \brief The positions of the blocks in the worklist.
+  llvm::BitVector Enqueued;
+  llvm::PriorityQueue<unsigned, SmallVector<unsigned, 32>,
+                      std::greater<unsigned>> Queue;
+
+public:
+  DataflowWorklist(const CFG &cfg, const PostOrderCFGView &POV,
+                   Direction Dir);
+
+  void enqueueBlock(const CFGBlock *B);
+  void enqueueSuccessors(const CFGBlock *B);
+  void enqueuePredecessors(const CFGBlock *B);
+
+  /// \brief Enqueue all blocks of the CFG.
+  void enqueueAllBlocks();
+
+  /// \brief Remove and return the first block in the visiting order, or null
+  /// if the worklist is empty.
+  const CFGBlock *dequeue();
+};
+
+/// \brief Solves a dataflow problem over a CFG whose values are sets of bits,
+/// such as sets of variables, and where each block clears the bits in its
+/// kill set and then sets the bits in its gen set.
+///
+/// The values are dense bit vectors, so that merging and comparing them is
+/// cheap; clients should number only the facts that can actually flow
+/// between blocks.
+class BitVectorDataflow {
+public:
+  enum MeetOperator { Union, Intersection };
+
+private:
+  struct BlockValues {
+    llvm::BitVector Gen;
+    llvm::BitVector Kill;
+    llvm::BitVector In;
+    llvm::BitVector Out;
+  };
+
+  const CFG &cfg;
+  const PostOrderCFGView &POV;
+  DataflowWorklist::Direction Dir;
+  MeetOperator Meet;
+  unsigned NumBits = 0;
+  /// \brief The values of each block, by block ID.
+  std::vector<BlockValues> Values;
+  unsigned NumBlockVisits = 0;
+
+public:
+  BitVectorDataflow(const CFG &cfg, const PostOrderCFGView &POV,
+                    DataflowWorklist::Direction Dir, MeetOperator Meet);
+
+  /// \brief Set the number of bits in the values, which also resizes the gen
+  /// and kill sets of all blocks.
+  void setNumBits(unsigned N);
+  unsigned getNumBits() const { return NumBits; }
+
+  llvm::BitVector &getGen(const CFGBlock *B);
+  llvm::BitVector &getKill(const CFGBlock *B);
+
+  /// \brief Compute the fixed point.
+  ///
+  /// \param Boundary The value flowing into the entry block for forward
+  /// analyses, or into the exit block for backward analyses.
+  void solve(const llvm::BitVector &Boundary);
+
+  /// \brief The value flowing into the given block: at its start for forward
+  /// analyses, or at its end for backward analyses.
+  const llvm::BitVector &getIn(const CFGBlock *B) const;
+
+  /// \brief The value flowing out of the given block: at its end for forward
+  /// analyses, or at its start for backward analyses.
+  const llvm::BitVector &getOut(const CFGBlock *B) const;
+
+  /// \brief The number of times the solver applied a block's transfer
+  /// function.
+  unsigned getNumBlockVisits() const { return NumBlockVisits; }
+};
+
+} // end namespace clang
+
+#endif
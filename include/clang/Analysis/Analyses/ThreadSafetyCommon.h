@@ -27,6 +27,7 @@
 #include "clang/Analysis/Analyses/ThreadSafetyTraverse.h"
 #include "clang/Analysis/AnalysisContext.h"
 #include "clang/Basic/OperatorKinds.h"
+#include "llvm/ADT/DenseSet.h"
 #include <memory>
 #include <ostream>
 #include <sstream>
@@ -258,23 +259,41 @@ class CapabilityExpr {
 private:
   const til::SExpr* CapExpr;   ///< The capability expression.
   bool Negated;                ///< True if this is a negative capability
+  bool Interned;               ///< True if CapExpr is the only expression
+                               ///< with its value; see SExprBuilder.
 
 public:
-  CapabilityExpr(const til::SExpr *E, bool Neg) : CapExpr(E), Negated(Neg) {}
+  CapabilityExpr(const til::SExpr *E, bool Neg, bool Intern = false)
+      : CapExpr(E), Negated(Neg), Interned(Intern) {}
 
   const til::SExpr* sexpr()    const { return CapExpr; }
   bool              negative() const { return Negated; }
+  bool              interned() const { return Interned; }
 
   CapabilityExpr operator!() const {
-    return CapabilityExpr(CapExpr, !Negated);
+    return CapabilityExpr(CapExpr, !Negated, Interned);
   }
 
   bool equals(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::equals(CapExpr, other.CapExpr);
+    if (Negated != other.Negated)
+      return false;
+    // Two interned expressions are equal only if they are the same.
+    if (CapExpr == other.CapExpr)
+      return true;
+    if (Interned && other.Interned)
+      return false;
+    return sx::equals(CapExpr, other.CapExpr);
   }
 
   bool matches(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::matches(CapExpr, other.CapExpr);
+    if (Negated != other.Negated)
+      return false;
+    // Interned expressions have no wildcards, so they match only if equal.
+    if (CapExpr == other.CapExpr)
+      return true;
+    if (Interned && other.Interned)
+      return false;
+    return sx::matches(CapExpr, other.CapExpr);
   }
 
   bool matchesUniv(const CapabilityExpr &CapE) const {
@@ -311,6 +330,29 @@ public:
 
 
 
+// Hashes and compares til::SExprs by value, for interning them.
+struct InternedSExprInfo {
+  static const til::SExpr *getEmptyKey() {
+    return llvm::DenseMapInfo<const til::SExpr *>::getEmptyKey();
+  }
+  static const til::SExpr *getTombstoneKey() {
+    return llvm::DenseMapInfo<const til::SExpr *>::getTombstoneKey();
+  }
+  static unsigned getHashValue(const til::SExpr *E) {
+    return til::StructuralHasher::hashExpr(E);
+  }
+  static bool isEqual(const til::SExpr *LHS, const til::SExpr *RHS) {
+    if (LHS == RHS)
+      return true;
+    if (LHS == getEmptyKey() || LHS == getTombstoneKey() ||
+        RHS == getEmptyKey() || RHS == getTombstoneKey())
+      return false;
+    return sx::equals(LHS, RHS);
+  }
+};
+
+
+
 // Translate clang::Expr to til::SExpr.
 class SExprBuilder {
 public:
@@ -360,6 +402,10 @@ public:
 
   til::SExpr *lookupStmt(const Stmt *S);
 
+  // Return the capability for E, which is interned if possible, so that
+  // equal capabilities can be compared by their addresses.
+  CapabilityExpr internCapability(const til::SExpr *E, bool Neg);
+
   til::BasicBlock *lookupBlock(const CFGBlock *B) {
     return BlockMap[B->getBlockID()];
   }
@@ -463,6 +509,8 @@ private:
 
   til::SCFG *Scfg;
   StatementMap SMap;                       // Map from Stmt to TIL Variables
+  llvm::DenseSet<const til::SExpr *, InternedSExprInfo>
+      InternedCapabilities;                // Interned capability expressions.
   LVarIndexMap LVarIdxMap;                 // Indices of clang local vars.
   std::vector<til::BasicBlock *> BlockMap; // Map from clang to til BBs.
   std::vector<BlockInfo> BBInfo;           // Extra information per BB.
@@ -18,6 +18,7 @@
 #define LLVM_CLANG_ANALYSIS_ANALYSES_THREADSAFETYTRAVERSE_H
 
 #include "ThreadSafetyTIL.h"
+#include "llvm/ADT/Hashing.h"
 #include <ostream>
 
 namespace clang {
@@ -374,6 +375,73 @@ public:
 };
 
 
+// Computes a hash of an expression that is consistent with EqualsComparator:
+// expressions that compare equal have the same hash.  This is done by
+// comparing the expression with itself, and folding everything that is
+// compared into the hash.
+class StructuralHasher : public Comparator<StructuralHasher> {
+public:
+  typedef bool CType;
+
+  CType trueResult() { return true; }
+  bool notTrue(CType ct) { return !ct; }
+
+  bool compareIntegers(unsigned i, unsigned j) {
+    Hash = llvm::hash_combine(Hash, i);
+    return true;
+  }
+  bool compareStrings(StringRef s, StringRef r) {
+    Hash = llvm::hash_combine(Hash, s);
+    return true;
+  }
+  bool comparePointers(const void* P, const void* Q) {
+    Hash = llvm::hash_combine(Hash, P);
+    return true;
+  }
+
+  bool compare(const SExpr *E1, const SExpr* E2) {
+    if (!E1) {
+      Hash = llvm::hash_combine(Hash, 0);
+      return true;
+    }
+    switch (E1->opcode()) {
+    case COP_Wildcard:
+    case COP_Literal:
+    case COP_Undefined:
+      Inexact = true;
+      break;
+    default:
+      break;
+    }
+    Hash = llvm::hash_combine(Hash, static_cast<unsigned>(E1->opcode()));
+    return compareByCase(E1, E1);
+  }
+
+  void enterScope(const Variable* V1, const Variable* V2) { }
+  void leaveScope() { }
+
+  bool compareVariableRefs(const Variable* V1, const Variable* V2) {
+    Hash = llvm::hash_combine(Hash, V1);
+    return true;
+  }
+
+  // Returns true if E contains wildcards, which match more than the
+  // expressions they are equal to, or literals or undefined values, whose
+  // values are not compared.
+  bool isInexact() const { return Inexact; }
+
+  static unsigned hashExpr(const SExpr *E) {
+    StructuralHasher Hasher;
+    Hasher.compare(E, E);
+    return Hasher.Hash;
+  }
+
+private:
+  llvm::hash_code Hash = 0;
+  bool Inexact = false;
+};
+
+
 
 // inline std::ostream& operator<<(std::ostream& SS, StringRef R) {
 //   return SS.write(R.data(), R.size());
@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Specifiers.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/iterator_range.h"
@@ -236,6 +237,19 @@ private:
 
     DiagnosticMapping &getOrAddMapping(diag::kind Diag);
 
+    /// \brief Get the mapping for \p Diag, or its default mapping if it has
+    /// not been set or queried in this state yet, without adding it.
+    DiagnosticMapping getMappingOrDefault(diag::kind Diag) const;
+
+    /// \brief Compute the severity of \p Diag from its mapping and the
+    /// flags of this state.
+    ///
+    /// This leaves out the adjustments that depend on where the diagnostic is
+    /// reported (__extension__ blocks and system headers), all of which can
+    /// only make the diagnostic ignored.
+    diag::Severity getSeverity(diag::kind Diag,
+                               const DiagnosticMapping &Mapping) const;
+
     const_iterator begin() const { return DiagMap.begin(); }
     const_iterator end() const { return DiagMap.end(); }
   };
@@ -260,6 +274,7 @@ private:
       Files.clear();
       FirstDiagState = CurDiagState = nullptr;
       CurDiagStateLoc = SourceLocation();
+      invalidateLookupCache();
     }
 
     /// Grab the most-recently-added state point.
@@ -296,7 +311,12 @@ private:
       /// be at least one of these (the state on entry to the file).
       llvm::SmallVector<DiagStatePoint, 4> StateTransitions;
 
-      DiagState *lookup(unsigned Offset) const;
+      DiagState *lookup(unsigned Offset) const {
+        return findTransition(Offset)->State;
+      }
+
+      /// Find the last state transition at or before \p Offset.
+      const DiagStatePoint *findTransition(unsigned Offset) const;
     };
 
     /// The diagnostic states for each file.
@@ -309,6 +329,20 @@ private:
     /// The location at which the current diagnostic state was established.
     SourceLocation CurDiagStateLoc;
 
+    /// \brief The range of source locations, as raw encodings, over which
+    /// the state found by the last lookup() holds, and that state.
+    ///
+    /// Diagnostics tend to be queried many times at nearby locations, so this
+    /// spares most lookups from decomposing the location and searching the
+    /// file's state transitions. The range is empty if nothing is cached.
+    mutable unsigned LastLookupBegin = 0;
+    mutable unsigned LastLookupSize = 0;
+    mutable DiagState *LastLookupState = nullptr;
+
+    /// Forget the range cached by lookup(), after the state transitions
+    /// changed.
+    void invalidateLookupCache() { LastLookupSize = 0; }
+
     /// Get the diagnostic state information for a file.
     File *getFile(SourceManager &SrcMgr, FileID ID) const;
 
@@ -335,6 +369,30 @@ private:
                      : DiagStatesByLoc.getCurDiagState();
   }
 
+  /// \brief Whether each built-in diagnostic is known to be ignored in every
+  /// DiagState, and so at every source location.
+  ///
+  /// Most diagnostics are off by default and stay off everywhere, so this
+  /// turns most isIgnored() queries into a bit test. A bit of
+  /// IgnoredEverywhere is only meaningful once the same bit of
+  /// IgnoredEverywhereKnown is set; both are cleared whenever a mapping or a
+  /// flag that can make a diagnostic ignored changes.
+  mutable llvm::BitVector IgnoredEverywhereKnown;
+  mutable llvm::BitVector IgnoredEverywhere;
+
+  /// \brief Determine whether the built-in diagnostic \p DiagID is ignored
+  /// in every DiagState.
+  bool isIgnoredEverywhere(unsigned DiagID) const {
+    if (!IgnoredEverywhereKnown.test(DiagID))
+      computeIgnoredEverywhere(DiagID);
+    return IgnoredEverywhere.test(DiagID);
+  }
+  void computeIgnoredEverywhere(unsigned DiagID) const;
+
+  /// \brief Forget which diagnostics are ignored everywhere, after the
+  /// diagnostic states changed.
+  void invalidateIgnoredEverywhere() { IgnoredEverywhereKnown.reset(); }
+
   /// \brief Sticky flag set to \c true when an error is emitted.
   bool ErrorOccurred;
 
@@ -502,6 +560,7 @@ public:
   /// If this and WarningsAsErrors are both set, then this one wins.
   void setIgnoreAllWarnings(bool Val) {
     GetCurDiagState()->IgnoreAllWarnings = Val;
+    invalidateIgnoredEverywhere();
   }
   bool getIgnoreAllWarnings() const {
     return GetCurDiagState()->IgnoreAllWarnings;
@@ -513,6 +572,7 @@ public:
   /// If this and IgnoreAllWarnings are both set, then that one wins.
   void setEnableAllWarnings(bool Val) {
     GetCurDiagState()->EnableAllWarnings = Val;
+    invalidateIgnoredEverywhere();
   }
   bool getEnableAllWarnings() const {
     return GetCurDiagState()->EnableAllWarnings;
@@ -597,6 +657,7 @@ public:
   /// This corresponds to the GCC -pedantic and -pedantic-errors option.
   void setExtensionHandlingBehavior(diag::Severity H) {
     GetCurDiagState()->ExtBehavior = H;
+    invalidateIgnoredEverywhere();
   }
   diag::Severity getExtensionHandlingBehavior() const {
     return GetCurDiagState()->ExtBehavior;
@@ -730,6 +791,8 @@ public:
   /// \param Loc The source location we are interested in finding out the
   /// diagnostic state. Can be null in order to query the latest state.
   bool isIgnored(unsigned DiagID, SourceLocation Loc) const {
+    if (DiagID < diag::DIAG_UPPER_LIMIT && isIgnoredEverywhere(DiagID))
+      return true;
     return Diags->getDiagnosticSeverity(DiagID, Loc, *this) ==
            diag::Severity::Ignored;
   }
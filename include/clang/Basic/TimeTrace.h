@@ -0,0 +1,94 @@
+//===- TimeTrace.h - Timeline of the compilation ----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Records a timeline of nested events, such as frontend phases,
+/// header inclusions and template instantiations, and writes it in the
+/// Chrome trace-event format for -ftime-trace.
+///
+/// Recording is off unless timeTraceProfilerInitialize() was called on the
+/// current thread, in which case each event costs a clock read at its start
+/// and end. Otherwise a TimeTraceScope only tests a pointer.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include <string>
+
+namespace clang {
+
+class TimeTraceProfiler;
+
+/// \brief The profiler of the current thread, or null if recording is off.
+extern LLVM_THREAD_LOCAL TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// \brief Start recording events on the current thread.
+///
+/// \param GranularityInMicroseconds Events that take less time than this are
+/// dropped, which keeps the trace of a large translation unit readable.
+void timeTraceProfilerInitialize(unsigned GranularityInMicroseconds);
+
+/// \brief Stop recording events on the current thread and discard them.
+void timeTraceProfilerCleanup();
+
+/// \brief Determine whether events are recorded on the current thread.
+inline bool timeTraceProfilerEnabled() {
+  return TimeTraceProfilerInstance != nullptr;
+}
+
+/// \brief Write the events recorded on the current thread as a Chrome
+/// trace-event JSON document, which chrome://tracing and Speedscope load.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// \brief Start an event, which lasts until the matching
+/// timeTraceProfilerEnd(). \p Detail further describes the event, for
+/// instance with the name of the header or of the template.
+void timeTraceProfilerBegin(StringRef Name, StringRef Detail);
+
+/// \brief Start an event whose detail is only computed if events are
+/// recorded, since it is usually a name that has to be printed.
+void timeTraceProfilerBegin(StringRef Name,
+                            llvm::function_ref<std::string()> Detail);
+
+/// \brief End the most recently started event.
+void timeTraceProfilerEnd();
+
+/// \brief Records an event over the lifetime of this object, if events are
+/// recorded when it is created.
+class TimeTraceScope {
+  bool Active;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail)
+      : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  TimeTraceScope &operator=(const TimeTraceScope &) = delete;
+  ~TimeTraceScope() {
+    if (Active)
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace clang
+
+#endif
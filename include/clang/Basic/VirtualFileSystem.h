@@ -25,10 +25,12 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include <string>
 #include <system_error>
@@ -343,6 +345,73 @@ public:
   std::error_code setCurrentWorkingDirectory(const Twine &Path) override;
 };
 
+/// \brief A file system that caches the status and the contents of the files
+/// looked up through another file system.
+///
+/// The cache can be used from several threads at once, so that one
+/// \p CachingFileSystem can be the base of a \p FileManager per thread and
+/// each file is stat'ed and read once for all of them. Failed lookups are
+/// cached as well. Paths are made absolute before they are looked up.
+///
+/// Cached entries never expire: the file system assumes that the files it has
+/// seen do not change while it is alive. Volatile reads bypass the cache.
+class CachingFileSystem : public FileSystem {
+public:
+  /// \brief The number of cache hits and misses so far.
+  struct Statistics {
+    /// \brief Lookups by \p status and \p openFileForRead.
+    uint64_t StatusHits = 0;
+    uint64_t StatusMisses = 0;
+    /// \brief Reads of file contents.
+    uint64_t ContentsHits = 0;
+    uint64_t ContentsMisses = 0;
+  };
+
+private:
+  struct Entry;
+  struct Shard;
+  class CachedFile;
+
+  /// \brief The number of independently locked parts of the cache.
+  enum { NumShards = 32 };
+
+  IntrusiveRefCntPtr<FileSystem> Base;
+  std::unique_ptr<Shard[]> Shards;
+
+  mutable std::mutex WorkingDirectoryMutex;
+  llvm::ErrorOr<std::string> WorkingDirectory;
+
+  std::atomic<uint64_t> StatusHits{0};
+  std::atomic<uint64_t> StatusMisses{0};
+  std::atomic<uint64_t> ContentsHits{0};
+  std::atomic<uint64_t> ContentsMisses{0};
+
+  /// \brief Compute the key that \p Path is cached under.
+  ///
+  /// \returns false if \p Path could not be made absolute.
+  bool getCacheKey(const Twine &Path, SmallVectorImpl<char> &Key) const;
+  Shard &getShard(StringRef Key) const;
+  void recordStatus(StringRef Key, const llvm::ErrorOr<Status> &Result,
+                    StringRef RealName = StringRef());
+  std::shared_ptr<llvm::MemoryBuffer> lookupContents(StringRef Key);
+  std::shared_ptr<llvm::MemoryBuffer>
+  recordContents(StringRef Key, std::unique_ptr<llvm::MemoryBuffer> Contents);
+
+public:
+  explicit CachingFileSystem(IntrusiveRefCntPtr<FileSystem> Base);
+  ~CachingFileSystem() override;
+
+  /// \brief Retrieve the number of cache hits and misses so far.
+  Statistics getStatistics() const;
+
+  llvm::ErrorOr<Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<File>>
+  openFileForRead(const Twine &Path) override;
+  directory_iterator dir_begin(const Twine &Dir, std::error_code &EC) override;
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override;
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override;
+};
+
 /// \brief Get a globally unique ID for a virtual file or directory.
 llvm::sys::fs::UniqueID getNextVirtualUniqueID();
 
@@ -355,6 +424,32 @@ getVFSFromYAML(std::unique_ptr<llvm::MemoryBuffer> Buffer,
                void *DiagContext = nullptr,
                IntrusiveRefCntPtr<FileSystem> ExternalFS = getRealFileSystem());
 
+/// \brief Gets a \p FileSystem for a virtual file system described in the
+/// binary overlay format written by \c writeBinaryVFSOverlay.
+///
+/// The overlay is read in place, one path component at a time, so a large
+/// overlay costs nothing up front; \p Buffer is best memory-mapped. The file
+/// system never changes once created, and can be shared between threads.
+///
+/// \returns null if \p Buffer does not hold a valid binary overlay.
+IntrusiveRefCntPtr<FileSystem>
+getVFSFromBinaryOverlay(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                        StringRef OverlayFilePath,
+                        IntrusiveRefCntPtr<FileSystem> ExternalFS =
+                            getRealFileSystem());
+
+/// \brief Whether \p Buffer holds a binary overlay rather than YAML.
+bool isBinaryVFSOverlay(const llvm::MemoryBuffer &Buffer);
+
+/// \brief Compile a virtual file system described in YAML format to the
+/// binary overlay format, written to \p OS.
+///
+/// \returns false if the YAML could not be parsed.
+bool writeBinaryVFSOverlay(std::unique_ptr<llvm::MemoryBuffer> YAMLBuffer,
+                           llvm::SourceMgr::DiagHandlerTy DiagHandler,
+                           StringRef YAMLFilePath, llvm::raw_ostream &OS,
+                           void *DiagContext = nullptr);
+
 struct YAMLVFSEntry {
   template <typename T1, typename T2> YAMLVFSEntry(T1 &&VPath, T2 &&RPath)
       : VPath(std::forward<T1>(VPath)), RPath(std::forward<T2>(RPath)) {}
@@ -363,8 +458,9 @@ struct YAMLVFSEntry {
 };
 
 /// \brief Collect all pairs of <virtual path, real path> entries from the
-/// \p YAMLFilePath. This is used by the module dependency collector to forward
-/// the entries into the reproducer output VFS YAML file.
+/// \p YAMLFilePath, which may also be a binary overlay. This is used by the
+/// module dependency collector to forward the entries into the reproducer
+/// output VFS YAML file.
 void collectVFSFromYAML(
     std::unique_ptr<llvm::MemoryBuffer> Buffer,
     llvm::SourceMgr::DiagHandlerTy DiagHandler, StringRef YAMLFilePath,
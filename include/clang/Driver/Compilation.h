@@ -108,6 +108,9 @@ class Compilation {
   /// Whether an error during the parsing of the input args.
   bool ContainsError;
 
+  /// The maximum number of jobs to execute at the same time.
+  unsigned NumParallelJobs;
+
 public:
   Compilation(const Driver &D, const ToolChain &DefaultToolChain,
               llvm::opt::InputArgList *Args,
@@ -264,8 +267,12 @@ public:
 
   /// ExecuteJob - Execute a single job.
   ///
+  /// Up to getNumParallelJobs() jobs are run at the same time; a job is only
+  /// started once the jobs producing its inputs have completed. No new job
+  /// is started after one failed.
+  ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
-  /// failing commands and their associated result code.
+  /// failing commands and their associated result code, in job order.
   void ExecuteJobs(
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
@@ -281,6 +288,14 @@ public:
   /// Return whether an error during the parsing of the input args.
   bool containsError() const { return ContainsError; }
 
+  /// Return the maximum number of jobs to execute at the same time.
+  unsigned getNumParallelJobs() const { return NumParallelJobs; }
+
+  void setNumParallelJobs(unsigned N) {
+    assert(N && "must allow at least one job");
+    NumParallelJobs = N;
+  }
+
   /// Redirect - Redirect output of this compilation. Can only be done once.
   ///
   /// \param Redirects - array of pointers to paths. The array
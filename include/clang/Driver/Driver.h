@@ -201,6 +201,14 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// Function that runs the -cc1 tool given its full command line, including
+  /// the executable and "-cc1".
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+
+  /// The -cc1 tool linked into the driver, used to run -cc1 jobs in the
+  /// driver's process with -fintegrated-cc1. Null if it is not available.
+  CC1ToolFunc CC1Main;
+
 private:
   /// Default target triple.
   std::string DefaultTargetTriple;
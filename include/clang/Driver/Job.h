@@ -121,6 +121,9 @@ public:
   ///         from the parent process will be used.
   void setEnvironment(llvm::ArrayRef<const char *> NewEnvironment);
 
+  /// Whether the command was given an environment of its own.
+  bool hasEnvironment() const { return !Environment.empty(); }
+
   const char *getExecutable() const { return Executable; }
 
   const llvm::opt::ArgStringList &getArguments() const { return Arguments; }
@@ -162,6 +165,20 @@ public:
               bool *ExecutionFailed) const override;
 };
 
+/// Like Command, but runs the -cc1 tool in the driver's process when the
+/// driver provides it (see Driver::CC1Main), saving a fork and exec per job.
+/// Falls back to a new process if the job needs redirections or its own
+/// environment.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_, const ArgStringList &Arguments_,
+             ArrayRef<InputInfo> Inputs);
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// JobList - A sequence of jobs to perform.
 class JobList {
 public:
@@ -134,6 +134,10 @@ private:
   /// \brief Track whether the main file was loaded from an AST or not.
   bool MainFileIsAST;
 
+  /// \brief Whether the current AST was restored from the serialized form
+  /// kept while the translation unit was suspended, rather than parsed.
+  bool ResumedFromSuspension;
+
   /// \brief What kind of translation unit this AST represents.
   TranslationUnitKind TUKind;
 
@@ -209,6 +213,18 @@ private:
   /// preamble.
   std::unique_ptr<llvm::MemoryBuffer> SavedMainFileBuffer;
 
+  /// \brief The serialized form of the translation unit, written when it was
+  /// suspended and kept until it is reparsed.
+  std::unique_ptr<llvm::MemoryBuffer> SuspendedAST;
+
+  /// \brief The diagnostics of the translation unit at the time it was
+  /// suspended, which are restored along with its AST.
+  SmallVector<StandaloneDiagnostic, 4> SuspendedDiagnostics;
+
+  /// \brief The buffer cache used by the AST reader of a resumed translation
+  /// unit.
+  IntrusiveRefCntPtr<MemoryBufferCache> ResumedPCMCache;
+
   /// \brief The number of warnings that occurred while parsing the preamble.
   ///
   /// This value will be used to restore the state of the \c DiagnosticsEngine
@@ -399,7 +415,7 @@ public:
 
   ~ASTUnit();
 
-  bool isMainFileAST() const { return MainFileIsAST; }
+  bool isMainFileAST() const { return MainFileIsAST || ResumedFromSuspension; }
 
   bool isUnsafeToFree() const { return UnsafeToFree; }
   void setUnsafeToFree(bool Value) { UnsafeToFree = Value; }
@@ -623,10 +639,14 @@ public:
   typedef std::pair<std::string, llvm::MemoryBuffer *> RemappedFile;
 
   /// \brief Create a ASTUnit. Gets ownership of the passed CompilerInvocation.
+  ///
+  /// \param BaseFS the file system the unit's files are read from, before
+  /// any overlays requested by \p CI; the real file system if null.
   static std::unique_ptr<ASTUnit>
   create(std::shared_ptr<CompilerInvocation> CI,
          IntrusiveRefCntPtr<DiagnosticsEngine> Diags, bool CaptureDiagnostics,
-         bool UserFilesAreVolatile);
+         bool UserFilesAreVolatile,
+         IntrusiveRefCntPtr<vfs::FileSystem> BaseFS = nullptr);
 
   enum WhatToLoad {
     /// Load options and the preprocessor state.
@@ -809,6 +829,32 @@ public:
   /// Preamble-related data is not affected.
   void ResetForParse();
 
+  /// \brief Free the AST, the preprocessor and the cached code-completion
+  /// results, keeping the AST in a compact serialized form from which
+  /// \c resume() can restore it without reparsing.
+  ///
+  /// A serialized form can only be kept if the translation unit was parsed
+  /// without a precompiled header or preamble, or for serialization.
+  /// Otherwise, the translation unit has to be reparsed to be used again.
+  ///
+  /// \returns True if no serialized form could be kept, false otherwise.
+  bool suspend();
+
+  /// \brief Determine whether the translation unit is suspended and can be
+  /// restored by \c resume().
+  bool isSuspended() const { return SuspendedAST && !Ctx; }
+
+  /// \brief Restore the AST of a suspended translation unit from its
+  /// serialized form.
+  ///
+  /// The translation unit is restored as it was when it was suspended,
+  /// including the contents of remapped files. Restoring fails if any of the
+  /// files it depends on changed on disk in the meantime.
+  ///
+  /// \returns True if the AST could not be restored, in which case the
+  /// translation unit has to be reparsed, false otherwise.
+  bool resume(std::shared_ptr<PCHContainerOperations> PCHContainerOps);
+
   /// \brief Perform code completion at the given file, line, and
   /// column within this translation unit.
   ///
@@ -827,6 +873,15 @@ public:
   /// \param IncludeBriefComments Whether to include brief documentation within
   /// the set of code completions returned.
   ///
+  /// \param FuzzyFilterResults Whether to drop results that do not
+  /// fuzzy-match the typed prefix, ranking the remaining ones by match quality.
+  ///
+  /// \param TypedPrefix The prefix to match results against. If empty, the
+  /// identifier that ends at the code-completion location is used.
+  ///
+  /// \param ResultLimit The maximum number of results to report, keeping the
+  /// best-ranked ones, or zero to report all results.
+  ///
   /// FIXME: The Diag, LangOpts, SourceMgr, FileMgr, StoredDiagnostics, and
   /// OwnedBuffers parameters are all disgusting hacks. They will go away.
   void CodeComplete(StringRef File, unsigned Line, unsigned Column,
@@ -837,7 +892,10 @@ public:
                     DiagnosticsEngine &Diag, LangOptions &LangOpts,
                     SourceManager &SourceMgr, FileManager &FileMgr,
                     SmallVectorImpl<StoredDiagnostic> &StoredDiagnostics,
-                    SmallVectorImpl<const llvm::MemoryBuffer *> &OwnedBuffers);
+                    SmallVectorImpl<const llvm::MemoryBuffer *> &OwnedBuffers,
+                    bool FuzzyFilterResults = false,
+                    StringRef TypedPrefix = StringRef(),
+                    unsigned ResultLimit = 0);
 
   /// \brief Save this translation unit to a file with the given name.
   ///
@@ -174,6 +174,8 @@ public:
                                            /// metrics and statistics.
   unsigned ShowTimers : 1;                 ///< Show timers for individual
                                            /// actions.
+  unsigned TimeTrace : 1;                  ///< Write a timeline of the
+                                           /// compilation.
   unsigned ShowVersion : 1;                ///< Show the -version text.
   unsigned FixWhatYouCan : 1;              ///< Apply fixes even if there are
                                            /// unfixable errors.
@@ -266,6 +268,10 @@ public:
   /// The output file, if any.
   std::string OutputFile;
 
+  /// If given, the file to write the header cost report to. cc1 inserts the
+  /// platform of each compiler instance before the extension.
+  std::string HeaderCostReportFile;
+
   /// If given, the new suffix for fix-it rewritten files.
   std::string FixItSuffix;
 
@@ -324,17 +330,22 @@ public:
   /// Filename to write statistics to.
   std::string StatsFile;
 
+  /// Minimum duration, in microseconds, of the events that -ftime-trace
+  /// records.
+  unsigned TimeTraceGranularity;
+
 public:
   FrontendOptions() :
     DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-    ShowStats(false), ShowTimers(false), ShowVersion(false),
+    ShowStats(false), ShowTimers(false), TimeTrace(false), ShowVersion(false),
     FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
     SkipFunctionBodies(false), UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
     BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
     IncludeTimestamps(true), ARCMTAction(ARCMT_None),
-    ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly)
+    ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly),
+    TimeTraceGranularity(500)
   {}
 
   /// getInputKindForExtension - Return the appropriate input kind for a file
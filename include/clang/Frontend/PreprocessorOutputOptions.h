@@ -25,6 +25,7 @@ public:
   unsigned ShowIncludeDirectives : 1;  ///< Print includes, imports etc. within preprocessed output.
   unsigned RewriteIncludes : 1;    ///< Preprocess include directives only.
   unsigned RewriteImports  : 1;    ///< Include contents of transitively-imported modules.
+  unsigned CompressOutput : 1;     ///< Compress the output with zlib.
 
 public:
   PreprocessorOutputOptions() {
@@ -37,6 +38,7 @@ public:
     ShowIncludeDirectives = 0;
     RewriteIncludes = 0;
     RewriteImports = 0;
+    CompressOutput = 0;
   }
 };
 
@@ -0,0 +1,100 @@
+//===--- SerializedDiagnosticAggregator.h - Merges diagnostics --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_FRONTEND_SERIALIZED_DIAGNOSTIC_AGGREGATOR_H_
+#define LLVM_CLANG_FRONTEND_SERIALIZED_DIAGNOSTIC_AGGREGATOR_H_
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace clang {
+namespace serialized_diags {
+
+/// \brief The statistics of the diagnostics of a flag (warning group) across
+/// the aggregated files.
+struct DiagnosticFlagSummary {
+  /// \brief The name of the flag, without the leading "-W", or an empty
+  /// string for the diagnostics that have no flag. It is owned by the
+  /// DiagnosticAggregator.
+  StringRef Flag;
+
+  /// \brief The number of times the diagnostics of the flag were reported
+  /// in all the files.
+  unsigned Occurrences = 0;
+
+  /// \brief The number of distinct diagnostics of the flag.
+  unsigned Unique = 0;
+
+  /// \brief The number of distinct diagnostics of the flag that are errors,
+  /// for instance because of -Werror.
+  unsigned Errors = 0;
+
+  /// \brief The number of files that report the flag.
+  unsigned TranslationUnits = 0;
+
+  /// \brief The number of source files in which the flag is reported.
+  unsigned SourceFiles = 0;
+};
+
+/// \brief Merges the diagnostics of many serialized diagnostics files, such as
+/// those of all the translation units of a project, and summarizes them.
+///
+/// Two diagnostics are the same if they have the same severity, location,
+/// flag and message; a header diagnostic that every translation unit reports
+/// is therefore counted once, with one occurrence per translation unit.
+/// Notes are not counted. File names, flags and messages are interned, so
+/// that the memory used is proportional to the number of distinct
+/// diagnostics rather than to the number of files.
+class DiagnosticAggregator {
+public:
+  DiagnosticAggregator();
+  ~DiagnosticAggregator();
+
+  /// \brief Read the serialized diagnostics file \p File and merge its
+  /// diagnostics. If the file cannot be read, its diagnostics are not
+  /// merged.
+  std::error_code addFile(StringRef File);
+
+  /// \brief Merge the diagnostics of \p Other, which read other files.
+  void merge(const DiagnosticAggregator &Other);
+
+  /// \brief Read the serialized diagnostics files \p Files on \p NumThreads
+  /// threads and merge their diagnostics. \p OnError is called, on this
+  /// thread and in the order of \p Files, for each file that cannot be read.
+  void addFiles(ArrayRef<std::string> Files, unsigned NumThreads,
+                llvm::function_ref<void(StringRef, std::error_code)> OnError);
+
+  /// \brief The number of files whose diagnostics were merged.
+  unsigned getNumFiles() const;
+
+  /// \brief The number of diagnostics read, without notes.
+  unsigned getNumDiagnostics() const;
+
+  /// \brief The number of distinct diagnostics read.
+  unsigned getNumUniqueDiagnostics() const;
+
+  /// \brief Summarize the diagnostics per flag, the most reported flags
+  /// first.
+  std::vector<DiagnosticFlagSummary> summarize() const;
+
+private:
+  class Impl;
+  class Reader;
+
+  std::unique_ptr<Impl> TheImpl;
+};
+
+} // end serialized_diags namespace
+} // end clang namespace
+
+#endif
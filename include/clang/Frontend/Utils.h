@@ -20,9 +20,11 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Option/OptSpecifier.h"
+#include "llvm/Support/Error.h"
 #include <utility>
 
 namespace llvm {
+class MemoryBuffer;
 class raw_fd_ostream;
 class Triple;
 
@@ -71,6 +73,16 @@ void InitializePreprocessor(Preprocessor &PP, const PreprocessorOptions &PPOpts,
 void DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream* OS,
                               const PreprocessorOutputOptions &Opts);
 
+/// writeCompressedPreprocessedOutput - Write \p Text, the output of -E, to
+/// \p OS compressed with zlib, behind a header that identifies it as such.
+llvm::Error writeCompressedPreprocessedOutput(StringRef Text, raw_ostream &OS);
+
+/// decompressPreprocessedInput - If \p Buffer was written by
+/// writeCompressedPreprocessedOutput, return its decompressed contents.
+/// Returns null if it was not, or an error if it cannot be decompressed.
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+decompressPreprocessedInput(const llvm::MemoryBuffer &Buffer);
+
 /// An interface for collecting the dependencies of a compilation. Users should
 /// use \c attachToPreprocessor and \c attachToASTReader to get all of the
 /// dependencies.
@@ -170,6 +182,14 @@ void AttachHeaderIncludeGen(Preprocessor &PP,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// CreateHeaderCostReporter - Create a consumer that attributes the tokens,
+/// time, declarations, template instantiations and AST memory of the
+/// translation unit to the files it includes, and writes them as JSON to
+/// \p OutputPath at the end of the translation unit. It attaches itself to
+/// \p PP, so it must be created before the main file is entered.
+std::unique_ptr<ASTConsumer> CreateHeaderCostReporter(Preprocessor &PP,
+                                                      StringRef OutputPath);
+
 /// Cache tokens for use with PCH. Note that this requires a seekable stream.
 void CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS);
 
@@ -0,0 +1,216 @@
+//===--- SymbolIndex.h - Persistent, sharded symbol index -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines an on-disk symbol index that maps USRs to the locations
+// where the symbols are declared, defined and referenced. The index is a
+// directory with one shard per translation unit; re-indexing a translation
+// unit replaces its shard. Shards are memory-mapped and queried in place, so
+// tools can find references and overrides without reparsing anything.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_INDEX_SYMBOLINDEX_H
+#define LLVM_CLANG_INDEX_SYMBOLINDEX_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/IndexSymbol.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang {
+  class SourceManager;
+
+namespace index {
+
+/// \brief A relation from a stored symbol occurrence to another symbol.
+struct StoredSymbolRelation {
+  SymbolRoleSet Roles;
+  StringRef USR;
+
+  StoredSymbolRelation(SymbolRoleSet Roles, StringRef USR)
+    : Roles(Roles), USR(USR) {}
+};
+
+/// \brief A symbol occurrence, as recorded in a symbol index.
+///
+/// The strings refer to the storage of the index they were read from.
+struct StoredSymbolOccurrence {
+  StringRef USR;
+  SymbolKind Kind;
+  SymbolRoleSet Roles;
+  StringRef FilePath;
+  unsigned Line;
+  unsigned Column;
+  SmallVector<StoredSymbolRelation, 2> Relations;
+};
+
+/// \brief Collects the symbol occurrences of a single translation unit and
+/// writes them out as one shard of a symbol index.
+class SymbolIndexShardBuilder {
+  struct Occurrence {
+    unsigned File;
+    unsigned Line;
+    unsigned Column;
+    SymbolRoleSet Roles;
+    SmallVector<std::pair<SymbolRoleSet, std::string>, 1> Relations;
+  };
+
+  struct SymbolData {
+    SymbolKind Kind = SymbolKind::Unknown;
+    std::vector<Occurrence> Occurrences;
+    /// \brief Relations other symbols have to this one, e.g., the methods
+    /// that override it.
+    std::vector<std::pair<SymbolRoleSet, std::string>> IncomingRelations;
+  };
+
+  std::string MainFilePath;
+  llvm::StringMap<unsigned> FileIDs;
+  std::vector<StringRef> Files;
+  llvm::StringMap<SymbolData> Symbols;
+
+  unsigned getFileID(StringRef Path);
+
+public:
+  explicit SymbolIndexShardBuilder(StringRef MainFilePath);
+
+  StringRef getMainFilePath() const { return MainFilePath; }
+
+  /// \brief Record an occurrence of the symbol with the given USR.
+  void addOccurrence(StringRef USR, SymbolKind Kind, SymbolRoleSet Roles,
+                     StringRef FilePath, unsigned Line, unsigned Column,
+                     ArrayRef<StoredSymbolRelation> Relations);
+
+  /// \brief Emit the shard in its binary form.
+  void emit(SmallVectorImpl<char> &Buffer) const;
+
+  /// \brief Write the shard into the given index directory, atomically
+  /// replacing any shard previously written for the same main file.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool writeToDirectory(StringRef IndexDir, std::string &Error) const;
+};
+
+/// \brief An index data consumer that records the occurrences reported while
+/// indexing a translation unit, and writes them as a shard of the symbol index
+/// in the given directory when indexing finishes.
+class SymbolIndexRecorder : public IndexDataConsumer {
+  std::string IndexDir;
+  std::unique_ptr<SymbolIndexShardBuilder> Builder;
+  const SourceManager *SM;
+  USRCache USRs;
+  std::string Error;
+
+  StringRef getUSR(const Decl *D);
+  StringRef getFilePath(FileID FID);
+
+public:
+  explicit SymbolIndexRecorder(StringRef IndexDir);
+  ~SymbolIndexRecorder() override;
+
+  void initialize(ASTContext &Ctx) override;
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           FileID FID, unsigned Offset,
+                           ASTNodeInfo ASTNode) override;
+
+  bool handleMacroOccurence(const IdentifierInfo *Name,
+                            const MacroInfo *MI, SymbolRoleSet Roles,
+                            FileID FID, unsigned Offset) override;
+
+  void finish() override;
+
+  /// \brief Retrieve the error that occurred while writing the shard, if any.
+  StringRef getError() const { return Error; }
+};
+
+/// \brief A read-only view of an on-disk symbol index.
+///
+/// Queries look at every shard; occurrences in headers that were indexed as
+/// part of several translation units are reported once.
+class SymbolIndex {
+public:
+  class Shard;
+
+private:
+  std::string IndexDir;
+  /// \brief The loaded shards, keyed by file path.
+  std::map<std::string, std::unique_ptr<Shard>> Shards;
+
+  explicit SymbolIndex(StringRef IndexDir);
+
+public:
+  ~SymbolIndex();
+
+  /// \brief Open the symbol index in the given directory.
+  ///
+  /// \returns the index, or null with \p Error set if it could not be read.
+  static std::unique_ptr<SymbolIndex> open(StringRef IndexDir,
+                                           std::string &Error);
+
+  /// \brief Pick up shards that were added, rewritten or removed since the
+  /// index was opened or last updated.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  bool update(std::string &Error);
+
+  /// \brief Retrieve the number of translation units in the index.
+  unsigned getNumShards() const { return Shards.size(); }
+
+  /// \brief Visit the occurrences of the symbol with the given USR that have
+  /// any of the given roles, or all of its occurrences if \p Roles is zero.
+  ///
+  /// \param Receiver returns false to stop the traversal.
+  void forEachOccurrence(
+      StringRef USR, SymbolRoleSet Roles,
+      llvm::function_ref<bool(const StoredSymbolOccurrence &)> Receiver) const;
+
+  /// \brief Visit the references to the symbol with the given USR.
+  void forEachReference(
+      StringRef USR,
+      llvm::function_ref<bool(const StoredSymbolOccurrence &)> Receiver) const {
+    forEachOccurrence(USR, (SymbolRoleSet)SymbolRole::Reference, Receiver);
+  }
+
+  /// \brief Visit the USRs of the symbols that have any of the given
+  /// relations to the symbol with the given USR.
+  void forEachRelatedSymbol(StringRef USR, SymbolRoleSet Roles,
+                            llvm::function_ref<bool(StringRef)> Receiver) const;
+
+  /// \brief Visit the USRs of the methods that directly override the method
+  /// with the given USR.
+  void forEachOverride(StringRef USR,
+                       llvm::function_ref<bool(StringRef)> Receiver) const {
+    forEachRelatedSymbol(USR, (SymbolRoleSet)SymbolRole::RelationOverrideOf,
+                         Receiver);
+  }
+
+  /// \brief Retrieve the name of the shard file used for the translation unit
+  /// with the given main file.
+  static std::string getShardFileName(StringRef MainFilePath);
+
+  /// \brief Remove the shard for the translation unit with the given main
+  /// file, e.g., because the file was deleted.
+  ///
+  /// \returns true if an error occurred, false otherwise.
+  static bool removeShard(StringRef IndexDir, StringRef MainFilePath);
+};
+
+} // namespace index
+} // namespace clang
+
+#endif
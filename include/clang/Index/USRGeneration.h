@@ -11,7 +11,9 @@
 #define LLVM_CLANG_INDEX_USRGENERATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class Decl;
@@ -25,9 +27,43 @@ static inline StringRef getUSRSpacePrefix() {
   return "c:";
 }
 
+/// \brief A cache of the USRs generated for the declarations of a single
+/// ASTContext.
+///
+/// Besides answering repeated queries for the same declaration, the cache
+/// speeds up generating the USRs of new declarations: the USR of a
+/// declaration starts with the USR of its enclosing context, so the cached
+/// USR of the context is appended instead of visiting the context again.
+///
+/// The cache must be cleared when the ASTContext is destroyed.
+class USRCache {
+  llvm::BumpPtrAllocator Alloc;
+  llvm::DenseMap<const Decl *, StringRef> USRs;
+
+public:
+  /// \brief Retrieve the cached USR of the given declaration, or an empty
+  /// string if it is not cached.
+  StringRef lookup(const Decl *D) const { return USRs.lookup(D); }
+
+  /// \brief Cache the USR of the given declaration.
+  StringRef insert(const Decl *D, StringRef USR);
+
+  unsigned size() const { return USRs.size(); }
+
+  void clear() {
+    USRs.clear();
+    Alloc.Reset();
+  }
+};
+
 /// \brief Generate a USR for a Decl, including the USR prefix.
+///
+/// \param Cache if non-null, the USRs of \p D and of its enclosing contexts
+/// are looked up in and added to this cache.
+///
 /// \returns true if the results should be ignored, false otherwise.
-bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
+bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf,
+                        USRCache *Cache = nullptr);
 
 /// \brief Generate a USR fragment for an Objective-C class.
 void generateUSRForObjCClass(StringRef Cls, raw_ostream &OS,
@@ -0,0 +1,72 @@
+//===--- CompactTokenBuffer.h - Compact storage of tokens -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the CompactTokenBuffer class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_COMPACTTOKENBUFFER_H
+#define LLVM_CLANG_LEX_COMPACTTOKENBUFFER_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Lex/Token.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace clang {
+  class IdentifierInfo;
+  class SourceManager;
+
+  /// CompactTokenBuffer - A sequence of tokens stored in a compact form,
+  /// for tokens that are kept for a long time before they are replayed, such
+  /// as those of the inline member function bodies of a class, which are only
+  /// parsed once the class is complete.
+  ///
+  /// A Token takes 24 bytes. Most tokens are encoded as a few bytes instead:
+  /// their kind, flags and length, the offset of their location from that of
+  /// the previous token, and the index of their IdentifierInfo in a table of
+  /// the distinct identifiers of the buffer. The literal data of a literal is
+  /// recomputed from its location when the tokens are decoded. The tokens
+  /// which carry other data, such as annotation tokens, are stored as is.
+  class CompactTokenBuffer {
+    /// Bytes - The encoded tokens.
+    SmallVector<char, 0> Bytes;
+
+    /// Identifiers - The distinct identifiers of the tokens.
+    SmallVector<IdentifierInfo *, 0> Identifiers;
+
+    /// VerbatimTokens - The tokens which could not be encoded, in order.
+    SmallVector<Token, 0> VerbatimTokens;
+
+    /// NumTokens - The number of tokens in the buffer.
+    unsigned NumTokens = 0;
+
+  public:
+    /// encode - Replace the contents of the buffer with the tokens \p Toks.
+    void encode(ArrayRef<Token> Toks, const SourceManager &SM);
+
+    /// decode - Append the tokens of the buffer to \p Toks.
+    void decode(SmallVectorImpl<Token> &Toks, const SourceManager &SM) const;
+
+    unsigned size() const { return NumTokens; }
+    bool empty() const { return NumTokens == 0; }
+
+    /// clear - Remove all the tokens and release the memory of the buffer.
+    void clear();
+
+    /// getMemorySize - The number of bytes of heap memory used by the buffer.
+    size_t getMemorySize() const {
+      return Bytes.capacity() +
+             Identifiers.capacity() * sizeof(IdentifierInfo *) +
+             VerbatimTokens.capacity() * sizeof(Token);
+    }
+  };
+}  // end clang namespace
+
+#endif
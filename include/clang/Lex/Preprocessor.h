@@ -33,6 +33,7 @@
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Registry.h"
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -397,6 +398,11 @@ class Preprocessor {
   /// encountered (e.g. a file is \#included, etc).
   std::unique_ptr<PPCallbacks> Callbacks;
 
+  /// \brief If set, called with each token that Lex() returns, but not again
+  /// when the parser backtracks over it, and not for the tokens of
+  /// directives or of pre-expanded macro arguments.
+  std::function<void(const Token &)> OnToken;
+
   struct MacroExpandsInfo {
     Token Tok;
     MacroDefinition MD;
@@ -827,6 +833,14 @@ public:
   }
   /// \}
 
+  /// \brief Register a function that sees each token the preprocessor
+  /// returns, once, or clear it with nullptr.
+  ///
+  /// This is called for every token, so it must be cheap.
+  void setTokenWatcher(std::function<void(const Token &)> F) {
+    OnToken = std::move(F);
+  }
+
   bool isMacroDefined(StringRef Id) {
     return isMacroDefined(&Identifiers.get(Id));
   }
@@ -1760,6 +1774,9 @@ public:
   Module *LeaveSubmodule(bool ForPragma);
 
 private:
+  /// \brief Call OnToken with a token that a lexer returned, if it counts.
+  void reportLexedToken(const Token &Result);
+
   void PushIncludeMacroStack() {
     assert(CurLexerKind != CLK_CachingLexer && "cannot push a caching lexer");
     IncludeMacroStack.emplace_back(CurLexerKind, CurLexerSubmodule,
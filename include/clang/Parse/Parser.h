@@ -19,10 +19,12 @@
 #include "clang/Basic/OperatorPrecedence.h"
 #include "clang/Basic/Specifiers.h"
 #include "clang/Lex/CodeCompletionHandler.h"
+#include "clang/Lex/CompactTokenBuffer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/LoopHint.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -1034,6 +1036,10 @@ private:
     Decl *D;
     CachedTokens Toks;
 
+    /// CompactToks - The tokens of the definition, once the whole definition
+    /// was lexed, if they are stored compactly (see CompactLateParsedTokens).
+    CompactTokenBuffer CompactToks;
+
     /// \brief Whether this member function had an associated template
     /// scope. When true, D is a template declaration.
     /// otherwise, it is a member function declaration.
@@ -1114,6 +1120,9 @@ private:
     /// CachedTokens - The sequence of tokens that comprises the initializer,
     /// including any leading '='.
     CachedTokens Toks;
+
+    /// CompactToks - Toks, if they are stored compactly.
+    CompactTokenBuffer CompactToks;
   };
 
   /// LateParsedDeclarationsContainer - During parsing of a top (non-nested)
@@ -1271,10 +1280,13 @@ private:
   void ParseLexedMethodDeclaration(LateParsedMethodDeclaration &LM);
   void ParseLexedMethodDefs(ParsingClass &Class);
   void ParseLexedMethodDef(LexedMethod &LM);
+  bool DelayLexedMethodDef(LexedMethod &LM);
   void ParseLexedMemberInitializers(ParsingClass &Class);
   void ParseLexedMemberInitializer(LateParsedMemberInitializer &MI);
   void ParseLexedObjCMethodDefs(LexedMethod &LM, bool parseMethod);
   bool ConsumeAndStoreFunctionPrologue(CachedTokens &Toks);
+  void CompactLateParsedTokens(CachedTokens &Toks, CompactTokenBuffer &Compact);
+  void ExpandLateParsedTokens(CompactTokenBuffer &Compact, CachedTokens &Toks);
   bool ConsumeAndStoreInitializer(CachedTokens &Toks, CachedInitKind CIK);
   bool ConsumeAndStoreConditional(CachedTokens &Toks);
   bool ConsumeAndStoreUntil(tok::TokenKind T1,
@@ -2094,6 +2106,17 @@ private:
     True, False, Ambiguous, Error
   };
 
+  /// \brief The outcomes of isCXXFunctionDeclarator() found while
+  /// disambiguating the current statement, keyed by the location of the '('
+  /// and the number of tentatively declared identifiers at that point.
+  ///
+  /// Disambiguating a statement tentatively parses its first declarator, and
+  /// parsing the declaration for real checks the same '(' again; this lets
+  /// the second check reuse the first instead of scanning the parameter list
+  /// again.
+  llvm::DenseMap<std::pair<unsigned, unsigned>, TPResult>
+      FunctionDeclaratorResults;
+
   /// \brief Based only on the given token kind, determine whether we know that
   /// we're at the start of an expression or a type-specifier-seq (which may
   /// be an expression, in C++).
@@ -2145,6 +2168,7 @@ private:
   TryParseParameterDeclarationClause(bool *InvalidAsDeclaration = nullptr,
                                      bool VersusTemplateArg = false);
   TPResult TryParseFunctionDeclarator();
+  TPResult TryParseFunctionDeclaratorOrDirectInit();
   TPResult TryParseBracketDeclarator();
   TPResult TryConsumeDeclarationSpecifier();
 
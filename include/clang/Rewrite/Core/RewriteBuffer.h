@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -31,6 +32,23 @@ class RewriteBuffer {
   DeltaTree Deltas;
   RewriteRope Buffer;
 public:
+  /// \brief An edit to apply as part of a batch; see \c ApplyEdits.
+  struct Edit {
+    /// \brief The range of the original buffer that is replaced. Edits that
+    /// replace nothing are insertions.
+    unsigned OrigOffset;
+    unsigned OrigLength;
+    StringRef Text;
+    /// \brief For insertions, whether the text goes after any text inserted
+    /// at the same point before, rather than in front of it.
+    bool InsertAfter;
+
+    Edit(unsigned OrigOffset, unsigned OrigLength, StringRef Text,
+         bool InsertAfter = true)
+      : OrigOffset(OrigOffset), OrigLength(OrigLength), Text(Text),
+        InsertAfter(InsertAfter) {}
+  };
+
   typedef RewriteRope::const_iterator iterator;
   iterator begin() const { return Buffer.begin(); }
   iterator end() const { return Buffer.end(); }
@@ -87,6 +105,25 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+  /// ApplyEdits - Apply a batch of edits in a single pass over the buffer.
+  ///
+  /// The result is the same as making the edits one at a time with
+  /// InsertText and ReplaceText, but the new contents are built at once
+  /// instead of updating the rope for every edit, which matters for files
+  /// with many thousands of edits. The edits need not be sorted. Insertions
+  /// at the same point keep their relative order.
+  ///
+  /// \returns true, leaving the buffer alone, if the edits conflict (see
+  /// findConflict) or reach past the end of the buffer.
+  bool ApplyEdits(ArrayRef<Edit> Edits);
+
+  /// \brief Find two edits in \p Edits that cannot be applied together:
+  /// edits conflict if one of them starts within the text the other replaces.
+  ///
+  /// \returns true and sets \p Index to the position of one of the
+  /// conflicting edits if there is a conflict.
+  static bool findConflict(ArrayRef<Edit> Edits, unsigned &Index);
+
 private:  // Methods only usable by Rewriter.
 
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
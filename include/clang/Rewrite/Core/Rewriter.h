@@ -17,9 +17,12 @@
 
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Rewrite/Core/RewriteBuffer.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/StringSaver.h"
 #include <cstring>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace clang {
   class LangOptions;
@@ -187,9 +190,70 @@ public:
   bool overwriteChangedFiles();
 
 private:
+  friend class RewriteBatch;
+
   unsigned getLocationOffsetAndFileID(SourceLocation Loc, FileID &FID) const;
 };
 
+/// RewriteBatch - Collects edits to the buffers of a Rewriter and applies them
+/// all at once, with a single pass over each file.
+///
+/// This is much faster than editing through the Rewriter directly when a
+/// file gets many edits, as in large automated refactorings. Locations refer
+/// to the original files, as with the Rewriter. The edits of a batch must not
+/// overlap, and conflicting edits are detected before any file is changed.
+class RewriteBatch {
+  Rewriter &Rewrite;
+  std::map<FileID, std::vector<RewriteBuffer::Edit>> Edits;
+  llvm::BumpPtrAllocator Alloc;
+  llvm::StringSaver Strings;
+
+  bool addEdit(SourceLocation Loc, unsigned OrigLength, StringRef Str,
+               bool InsertAfter);
+
+public:
+  explicit RewriteBatch(Rewriter &Rewrite)
+    : Rewrite(Rewrite), Strings(Alloc) {}
+
+  /// InsertText - Insert the specified string at the specified location in
+  /// the original buffer.  This method returns true (and does nothing) if the
+  /// input location was not rewritable, false otherwise.
+  bool InsertText(SourceLocation Loc, StringRef Str,
+                  bool InsertAfter = true) {
+    return addEdit(Loc, 0, Str, InsertAfter);
+  }
+
+  /// InsertTextBefore - Insert the specified string in front of any other
+  /// text inserted at the same location.
+  bool InsertTextBefore(SourceLocation Loc, StringRef Str) {
+    return addEdit(Loc, 0, Str, /*InsertAfter=*/false);
+  }
+
+  /// RemoveText - Remove the specified text region.
+  bool RemoveText(SourceLocation Start, unsigned Length) {
+    return addEdit(Start, Length, StringRef(), /*InsertAfter=*/true);
+  }
+
+  /// ReplaceText - This method replaces a range of characters in the input
+  /// buffer with a new string.
+  bool ReplaceText(SourceLocation Start, unsigned OrigLength,
+                   StringRef NewStr) {
+    return addEdit(Start, OrigLength, NewStr, /*InsertAfter=*/true);
+  }
+
+  /// \brief Whether the batch has no edits.
+  bool empty() const { return Edits.empty(); }
+
+  /// \brief Apply the collected edits to the buffers of the Rewriter, and
+  /// empty the batch.
+  ///
+  /// \returns true if the edits could not be applied. If two edits conflict,
+  /// no file is changed and \p ConflictLoc, if non-null, is set to the
+  /// location of one of them. An edit may also be rejected because it
+  /// overlaps text that was changed through the Rewriter directly.
+  bool commit(SourceLocation *ConflictLoc = nullptr);
+};
+
 } // end namespace clang
 
 #endif
@@ -61,6 +61,10 @@ private:
   /// built.
   unsigned NumFunctionsWithBadCFGs;
 
+  /// \brief Number of functions checked without building a CFG, because no
+  /// enabled CFG-based warning could apply to them.
+  unsigned NumFunctionsWithoutCFG;
+
   /// \brief Total number of blocks across all CFGs.
   unsigned NumCFGBlocks;
 
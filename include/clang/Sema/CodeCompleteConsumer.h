@@ -802,6 +802,48 @@ inline bool operator>=(const CodeCompletionResult &X,
 raw_ostream &operator<<(raw_ostream &OS,
                               const CodeCompletionString &CCS);
 
+/// \brief Scores code-completion results against the text the user has
+/// typed so far.
+///
+/// A result matches when the typed text is a case-insensitive subsequence of
+/// its name. Better matches (exact prefixes, then matches that start at word
+/// boundaries such as "gfl" for "getFooList") receive a smaller priority
+/// penalty than scattered subsequence matches.
+class CodeCompletionFuzzyMatcher {
+  /// \brief The typed text.
+  std::string Pattern;
+
+  /// \brief The typed text, lowercased.
+  std::string LowerPattern;
+
+public:
+  explicit CodeCompletionFuzzyMatcher(StringRef Pattern);
+
+  /// \brief Retrieve the text that results are matched against.
+  StringRef getPattern() const { return Pattern; }
+
+  /// \brief Match \p Word against the typed text.
+  ///
+  /// \param Penalty Set to the amount by which the priority of a matching
+  /// result should be increased; zero for an exact prefix match.
+  ///
+  /// \returns true if \p Word matches.
+  bool match(StringRef Word, unsigned &Penalty) const;
+
+  /// \brief Match the name of the given result against the typed text.
+  bool matchResult(const CodeCompletionResult &R, unsigned &Penalty) const;
+};
+
+/// \brief Move the \p Limit best-ranked results (by priority, then by name)
+/// to the front of the given array, in order.
+///
+/// This costs O(N log Limit) rather than the O(N log N) of a full sort, which
+/// matters when tens of thousands of global declarations are visible.
+///
+/// \returns the number of results that should be reported.
+unsigned selectBestCodeCompletionResults(CodeCompletionResult *Results,
+                                         unsigned NumResults, unsigned Limit);
+
 /// \brief Abstract interface for a consumer of code-completion
 /// information.
 class CodeCompleteConsumer {
@@ -906,6 +948,22 @@ public:
     return CodeCompleteOpts.IncludeBriefComments;
   }
 
+  /// \brief Whether results should be filtered and ranked by fuzzy matching
+  /// them against the typed prefix.
+  bool fuzzyFilterResults() const {
+    return CodeCompleteOpts.FuzzyFilterResults;
+  }
+
+  /// \brief The maximum number of results to report, or zero for no limit.
+  unsigned getResultLimit() const {
+    return CodeCompleteOpts.ResultLimit;
+  }
+
+  /// \brief Retrieve the prefix that results are fuzzy-matched against: the
+  /// explicitly provided one, or else the identifier that ends at the
+  /// code-completion point.
+  StringRef getTypedPrefix(Sema &S) const;
+
   /// \brief Determine whether the output of this consumer is binary.
   bool isOutputBinary() const { return OutputIsBinary; }
 
@@ -10,6 +10,8 @@
 #ifndef LLVM_CLANG_SEMA_CODECOMPLETEOPTIONS_H
 #define LLVM_CLANG_SEMA_CODECOMPLETEOPTIONS_H
 
+#include <string>
+
 namespace clang {
 
 /// Options controlling the behavior of code completion.
@@ -27,11 +29,25 @@ public:
   /// Show brief documentation comments in code completion results.
   unsigned IncludeBriefComments : 1;
 
+  /// Drop results that do not fuzzy-match the typed prefix as they are
+  /// produced, and rank the remaining ones by match quality.
+  unsigned FuzzyFilterResults : 1;
+
+  /// The maximum number of results to report, keeping the best-ranked ones.
+  /// Zero means that all results are reported.
+  unsigned ResultLimit;
+
+  /// The text the user has typed for the name being completed. When empty,
+  /// the identifier that ends at the code-completion point is used instead.
+  std::string TypedPrefix;
+
   CodeCompleteOptions() :
       IncludeMacros(0),
       IncludeCodePatterns(0),
       IncludeGlobals(1),
-      IncludeBriefComments(0)
+      IncludeBriefComments(0),
+      FuzzyFilterResults(0),
+      ResultLimit(0)
   { }
 };
 
@@ -603,6 +603,20 @@ public:
       LateParsedTemplateMapT;
   LateParsedTemplateMapT LateParsedTemplateMap;
 
+  /// \brief The inline member functions whose bodies are parsed lazily, with
+  /// -flazy-inline-function-bodies, and that are not used yet. Their tokens
+  /// are in LateParsedTemplateMap.
+  llvm::SmallPtrSet<FunctionDecl *, 16> UnusedLazyFunctionBodies;
+
+  /// \brief The lazily parsed inline member functions that are used, whose
+  /// bodies are parsed at the end of the translation unit.
+  SmallVector<FunctionDecl *, 16> PendingLazyFunctionBodies;
+
+  /// \brief With -flazy-inline-function-bodies-check, the lazily parsed
+  /// function whose body is being parsed, in which names that refer to
+  /// declarations following its class are diagnosed.
+  FunctionDecl *CheckedLazyFunctionBody = nullptr;
+
   /// \brief Callback to the parser to parse templated functions when needed.
   typedef void LateTemplateParserCB(void *P, LateParsedTemplate &LPT);
   typedef void LateTemplateParserCleanupCB(void *P);
@@ -5745,6 +5759,8 @@ public:
   void MarkAsLateParsedTemplate(FunctionDecl *FD, Decl *FnD,
                                 CachedTokens &Toks);
   void UnmarkAsLateParsedTemplate(FunctionDecl *FD);
+  void MarkAsLazyFunctionBody(FunctionDecl *FD, CachedTokens &Toks);
+  bool ParsePendingLazyFunctionBodies();
   bool IsInsideALocalClassWithinATemplateFunction();
 
   Decl *ActOnStaticAssertDeclaration(SourceLocation StaticAssertLoc,
@@ -22,6 +22,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
@@ -253,6 +254,15 @@ class Replacements {
   /// category of replacements.
   llvm::Error add(const Replacement &R);
 
+  /// \brief Adds all of \p Rs to the current set of replacements.
+  ///
+  /// This has the same effect as calling \c add for each replacement in
+  /// turn, but takes O(N log N) time for N replacements: they are sorted and
+  /// swept once against the existing ones, and only those that overlap
+  /// another replacement go through \c add. If an error is returned, the
+  /// current replacements are left unchanged.
+  llvm::Error addAll(ArrayRef<Replacement> Rs);
+
   /// \brief Merges \p Replaces into the current replacements. \p Replaces
   /// refers to code after applying the current replacements.
   Replacements merge(const Replacements &Replaces) const;
@@ -288,6 +298,9 @@ private:
   Replacements(const_iterator Begin, const_iterator End)
       : Replaces(Begin, End) {}
 
+  explicit Replacements(ReplacementsImpl Replaces)
+      : Replaces(std::move(Replaces)) {}
+
   // Returns `R` with new range that refers to code after `Replaces` being
   // applied.
   Replacement getReplacementInChangedCode(const Replacement &R) const;
@@ -0,0 +1,181 @@
+//===- BitVectorDataflow.cpp - Dense bit-vector dataflow --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the dataflow worklist and the bit-vector dataflow
+// solver shared by the analyses on source-level CFGs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/Analyses/BitVectorDataflow.h"
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "clang/Analysis/CFG.h"
+#include <algorithm>
+
+using namespace clang;
+
+//===----------------------------------------------------------------------===//
+// DataflowWorklist
+//===----------------------------------------------------------------------===//
+
+DataflowWorklist::DataflowWorklist(const CFG &cfg, const PostOrderCFGView &POV,
+                                   Direction Dir)
+    : Positions(cfg.getNumBlockIDs(), ~0U), Enqueued(cfg.getNumBlockIDs()) {
+  Blocks.reserve(cfg.getNumBlockIDs());
+  Blocks.append(POV.begin(), POV.end());
+  if (Dir == Backward)
+    std::reverse(Blocks.begin(), Blocks.end());
+  for (unsigned I = 0, E = Blocks.size(); I != E; ++I)
+    Positions[Blocks[I]->getBlockID()] = I;
+
+  // The blocks that are not reachable from the entry come last.
+  for (const CFGBlock *B : cfg) {
+    if (Positions[B->getBlockID()] != ~0U)
+      continue;
+    Positions[B->getBlockID()] = Blocks.size();
+    Blocks.push_back(B);
+  }
+}
+
+void DataflowWorklist::enqueueBlock(const CFGBlock *B) {
+  if (!B)
+    return;
+  unsigned Position = Positions[B->getBlockID()];
+  if (Enqueued[Position])
+    return;
+  Enqueued[Position] = true;
+  Queue.push(Position);
+}
+
+void DataflowWorklist::enqueueSuccessors(const CFGBlock *B) {
+  for (const CFGBlock *Succ : B->succs())
+    enqueueBlock(Succ);
+}
+
+void DataflowWorklist::enqueuePredecessors(const CFGBlock *B) {
+  for (const CFGBlock *Pred : B->preds())
+    enqueueBlock(Pred);
+}
+
+void DataflowWorklist::enqueueAllBlocks() {
+  for (unsigned I = 0, E = Blocks.size(); I != E; ++I) {
+    if (Enqueued[I])
+      continue;
+    Enqueued[I] = true;
+    Queue.push(I);
+  }
+}
+
+const CFGBlock *DataflowWorklist::dequeue() {
+  if (Queue.empty())
+    return nullptr;
+  unsigned Position = Queue.top();
+  Queue.pop();
+  Enqueued[Position] = false;
+  return Blocks[Position];
+}
+
+//===----------------------------------------------------------------------===//
+// BitVectorDataflow
+//===----------------------------------------------------------------------===//
+
+BitVectorDataflow::BitVectorDataflow(const CFG &cfg,
+                                     const PostOrderCFGView &POV,
+                                     DataflowWorklist::Direction Dir,
+                                     MeetOperator Meet)
+    : cfg(cfg), POV(POV), Dir(Dir), Meet(Meet),
+      Values(cfg.getNumBlockIDs()) {}
+
+void BitVectorDataflow::setNumBits(unsigned N) {
+  NumBits = N;
+  for (BlockValues &V : Values) {
+    V.Gen.resize(N);
+    V.Kill.resize(N);
+  }
+}
+
+llvm::BitVector &BitVectorDataflow::getGen(const CFGBlock *B) {
+  return Values[B->getBlockID()].Gen;
+}
+
+llvm::BitVector &BitVectorDataflow::getKill(const CFGBlock *B) {
+  return Values[B->getBlockID()].Kill;
+}
+
+const llvm::BitVector &BitVectorDataflow::getIn(const CFGBlock *B) const {
+  return Values[B->getBlockID()].In;
+}
+
+const llvm::BitVector &BitVectorDataflow::getOut(const CFGBlock *B) const {
+  return Values[B->getBlockID()].Out;
+}
+
+void BitVectorDataflow::solve(const llvm::BitVector &Boundary) {
+  assert(Boundary.size() == NumBits && "boundary value has the wrong size");
+  const CFGBlock *BoundaryBlock =
+      Dir == DataflowWorklist::Forward ? &cfg.getEntry() : &cfg.getExit();
+
+  // Start from the top of the lattice: the empty set for a union, and the
+  // full set for an intersection.
+  for (BlockValues &V : Values) {
+    V.In = llvm::BitVector(NumBits);
+    V.Out = llvm::BitVector(NumBits, Meet == Intersection);
+  }
+
+  DataflowWorklist Worklist(cfg, POV, Dir);
+  Worklist.enqueueAllBlocks();
+  llvm::BitVector Visited(cfg.getNumBlockIDs());
+  llvm::BitVector NewOut(NumBits);
+
+  while (const CFGBlock *B = Worklist.dequeue()) {
+    ++NumBlockVisits;
+    BlockValues &V = Values[B->getBlockID()];
+
+    // Merge the values of the blocks flowing into this one.
+    if (B == BoundaryBlock) {
+      V.In = Boundary;
+    } else {
+      bool IsFirst = true;
+      auto MeetWith = [&](const CFGBlock *Other) {
+        if (!Other)
+          return;
+        const llvm::BitVector &OtherOut = Values[Other->getBlockID()].Out;
+        if (IsFirst)
+          V.In = OtherOut;
+        else if (Meet == Union)
+          V.In |= OtherOut;
+        else
+          V.In &= OtherOut;
+        IsFirst = false;
+      };
+      if (Dir == DataflowWorklist::Forward)
+        for (const CFGBlock *Pred : B->preds())
+          MeetWith(Pred);
+      else
+        for (const CFGBlock *Succ : B->succs())
+          MeetWith(Succ);
+      if (IsFirst)
+        V.In.reset();
+    }
+
+    // Apply the transfer function.
+    NewOut = V.In;
+    NewOut.reset(V.Kill);
+    NewOut |= V.Gen;
+
+    if (Visited[B->getBlockID()] && NewOut == V.Out)
+      continue;
+    Visited[B->getBlockID()] = true;
+    std::swap(V.Out, NewOut);
+
+    if (Dir == DataflowWorklist::Forward)
+      Worklist.enqueueSuccessors(B);
+    else
+      Worklist.enqueuePredecessors(B);
+  }
+}
@@ -14,12 +14,13 @@
 #include "clang/Analysis/Analyses/LiveVariables.h"
 #include "clang/AST/Stmt.h"
 #include "clang/AST/StmtVisitor.h"
+#include "clang/Analysis/Analyses/BitVectorDataflow.h"
 #include "clang/Analysis/Analyses/PostOrderCFGView.h"
 #include "clang/Analysis/AnalysisContext.h"
 #include "clang/Analysis/CFG.h"
 #include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PostOrderIterator.h"
-#include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/PointerUnion.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <vector>
@@ -27,51 +28,15 @@
 using namespace clang;
 
 namespace {
+class TransferFunctions;
 
-class DataflowWorklist {
-  llvm::BitVector enqueuedBlocks;
-  PostOrderCFGView *POV;
-  llvm::PriorityQueue<const CFGBlock *, SmallVector<const CFGBlock *, 20>,
-                      PostOrderCFGView::BlockOrderCompare> worklist;
+/// A statement or variable whose liveness is tracked.
+typedef llvm::PointerUnion<const Stmt *, const VarDecl *> LiveItem;
 
-public:
-  DataflowWorklist(const CFG &cfg, AnalysisDeclContext &Ctx)
-    : enqueuedBlocks(cfg.getNumBlockIDs()),
-      POV(Ctx.getAnalysis<PostOrderCFGView>()),
-      worklist(POV->getComparator()) {}
-  
-  void enqueueBlock(const CFGBlock *block);
-  void enqueuePredecessors(const CFGBlock *block);
-
-  const CFGBlock *dequeue();
-};
-
-}
-
-void DataflowWorklist::enqueueBlock(const clang::CFGBlock *block) {
-  if (block && !enqueuedBlocks[block->getBlockID()]) {
-    enqueuedBlocks[block->getBlockID()] = true;
-    worklist.push(block);
-  }
-}
-
-void DataflowWorklist::enqueuePredecessors(const clang::CFGBlock *block) {
-  for (CFGBlock::const_pred_iterator I = block->pred_begin(),
-       E = block->pred_end(); I != E; ++I) {
-    enqueueBlock(*I);
-  }
-}
-
-const CFGBlock *DataflowWorklist::dequeue() {
-  if (worklist.empty())
-    return nullptr;
-  const CFGBlock *b = worklist.top();
-  worklist.pop();
-  enqueuedBlocks[b->getBlockID()] = false;
-  return b;
-}
+/// The effect of a block on liveness: the items it makes live (true) or dead
+/// (false) at its start.
+typedef llvm::MapVector<LiveItem, bool> BlockEffect;
 
-namespace {
 class LiveVariablesImpl {
 public:  
   AnalysisDeclContext &analysisContext;
@@ -82,15 +47,24 @@ public:
   llvm::DenseMap<const Stmt *, LiveVariables::LivenessValues> stmtsToLiveness;
   llvm::DenseMap<const DeclRefExpr *, unsigned> inAssignment;
   const bool killAtAssign;
-  
-  LiveVariables::LivenessValues
-  merge(LiveVariables::LivenessValues valsA,
-        LiveVariables::LivenessValues valsB);
+
+  /// The items that are live at the start of some block, and thus may be
+  /// live across blocks, numbered for the bit vectors of the dataflow
+  /// computation.
+  std::vector<LiveItem> items;
+  llvm::DenseMap<LiveItem, unsigned> itemIndices;
+
+  void walkBlock(const CFGBlock *block, TransferFunctions &TF,
+                 LiveVariables::LivenessValues *val);
 
   LiveVariables::LivenessValues
   runOnBlock(const CFGBlock *block, LiveVariables::LivenessValues val,
              LiveVariables::Observer *obs = nullptr);
 
+  void computeBlockEffect(const CFGBlock *block, BlockEffect &effect);
+
+  LiveVariables::LivenessValues getLivenessValues(const llvm::BitVector &bits);
+
   void dumpBlockLiveness(const SourceManager& M);
 
   LiveVariablesImpl(AnalysisDeclContext &ac, bool KillAtAssign)
@@ -117,44 +91,8 @@ bool LiveVariables::LivenessValues::isLive(const VarDecl *D) const {
   return liveDecls.contains(D);
 }
 
-namespace {
-  template <typename SET>
-  SET mergeSets(SET A, SET B) {
-    if (A.isEmpty())
-      return B;
-    
-    for (typename SET::iterator it = B.begin(), ei = B.end(); it != ei; ++it) {
-      A = A.add(*it);
-    }
-    return A;
-  }
-}
-
 void LiveVariables::Observer::anchor() { }
 
-LiveVariables::LivenessValues
-LiveVariablesImpl::merge(LiveVariables::LivenessValues valsA,
-                         LiveVariables::LivenessValues valsB) {  
-  
-  llvm::ImmutableSetRef<const Stmt *>
-    SSetRefA(valsA.liveStmts.getRootWithoutRetain(), SSetFact.getTreeFactory()),
-    SSetRefB(valsB.liveStmts.getRootWithoutRetain(), SSetFact.getTreeFactory());
-                                                
-  
-  llvm::ImmutableSetRef<const VarDecl *>
-    DSetRefA(valsA.liveDecls.getRootWithoutRetain(), DSetFact.getTreeFactory()),
-    DSetRefB(valsB.liveDecls.getRootWithoutRetain(), DSetFact.getTreeFactory());
-  
-
-  SSetRefA = mergeSets(SSetRefA, SSetRefB);
-  DSetRefA = mergeSets(DSetRefA, DSetRefB);
-  
-  // asImmutableSet() canonicalizes the tree, allowing us to do an easy
-  // comparison afterwards.
-  return LiveVariables::LivenessValues(SSetRefA.asImmutableSet(),
-                                       DSetRefA.asImmutableSet());  
-}
-
 bool LiveVariables::LivenessValues::equals(const LivenessValues &V) const {
   return liveStmts == V.liveStmts && liveDecls == V.liveDecls;
 }
@@ -184,9 +122,12 @@ bool LiveVariables::isLive(const Stmt *Loc, const Stmt *S) {
 //===----------------------------------------------------------------------===//
 
 namespace {
+/// Applies the liveness effects of statements, walked backwards, either to a
+/// set of live items, or to a summary of the effects of a block.
 class TransferFunctions : public StmtVisitor<TransferFunctions> {
   LiveVariablesImpl &LV;
-  LiveVariables::LivenessValues &val;
+  LiveVariables::LivenessValues *val;
+  BlockEffect *effect;
   LiveVariables::Observer *observer;
   const CFGBlock *currentBlock;
 public:
@@ -194,7 +135,43 @@ public:
                     LiveVariables::LivenessValues &Val,
                     LiveVariables::Observer *Observer,
                     const CFGBlock *CurrentBlock)
-  : LV(im), val(Val), observer(Observer), currentBlock(CurrentBlock) {}
+  : LV(im), val(&Val), effect(nullptr), observer(Observer),
+    currentBlock(CurrentBlock) {}
+
+  TransferFunctions(LiveVariablesImpl &im, BlockEffect &Effect,
+                    const CFGBlock *CurrentBlock)
+  : LV(im), val(nullptr), effect(&Effect), observer(nullptr),
+    currentBlock(CurrentBlock) {}
+
+  void addStmt(const Stmt *S) {
+    if (effect)
+      (*effect)[S] = true;
+    else
+      val->liveStmts = LV.SSetFact.add(val->liveStmts, S);
+  }
+
+  void removeStmt(const Stmt *S) {
+    if (effect)
+      (*effect)[S] = false;
+    else
+      val->liveStmts = LV.SSetFact.remove(val->liveStmts, S);
+  }
+
+  void addDecl(const VarDecl *D) {
+    if (effect)
+      (*effect)[D] = true;
+    else
+      val->liveDecls = LV.DSetFact.add(val->liveDecls, D);
+  }
+
+  void removeDecl(const VarDecl *D) {
+    if (effect)
+      (*effect)[D] = false;
+    else
+      val->liveDecls = LV.DSetFact.remove(val->liveDecls, D);
+  }
+
+  void addLiveStmt(const Stmt *S);
 
   void VisitBinaryOperator(BinaryOperator *BO);
   void VisitBlockExpr(BlockExpr *BE);
@@ -237,20 +214,18 @@ static const Stmt *LookThroughStmt(const Stmt *S) {
   return S;
 }
 
-static void AddLiveStmt(llvm::ImmutableSet<const Stmt *> &Set,
-                        llvm::ImmutableSet<const Stmt *>::Factory &F,
-                        const Stmt *S) {
-  Set = F.add(Set, LookThroughStmt(S));
+void TransferFunctions::addLiveStmt(const Stmt *S) {
+  addStmt(LookThroughStmt(S));
 }
 
 void TransferFunctions::Visit(Stmt *S) {
   if (observer)
-    observer->observeStmt(S, currentBlock, val);
+    observer->observeStmt(S, currentBlock, *val);
   
   StmtVisitor<TransferFunctions>::Visit(S);
   
   if (isa<Expr>(S)) {
-    val.liveStmts = LV.SSetFact.remove(val.liveStmts, S);
+    removeStmt(S);
   }
 
   // Mark all children expressions live.
@@ -267,7 +242,7 @@ void TransferFunctions::Visit(Stmt *S) {
       // Include the implicit "this" pointer as being live.
       CXXMemberCallExpr *CE = cast<CXXMemberCallExpr>(S);
       if (Expr *ImplicitObj = CE->getImplicitObjectArgument()) {
-        AddLiveStmt(val.liveStmts, LV.SSetFact, ImplicitObj);
+        addLiveStmt(ImplicitObj);
       }
       break;
     }
@@ -275,8 +250,7 @@ void TransferFunctions::Visit(Stmt *S) {
       // In calls to super, include the implicit "self" pointer as being live.
       ObjCMessageExpr *CE = cast<ObjCMessageExpr>(S);
       if (CE->getReceiverKind() == ObjCMessageExpr::SuperInstance)
-        val.liveDecls = LV.DSetFact.add(val.liveDecls,
-                                        LV.analysisContext.getSelfDecl());
+        addDecl(LV.analysisContext.getSelfDecl());
       break;
     }
     case Stmt::DeclStmtClass: {
@@ -284,7 +258,7 @@ void TransferFunctions::Visit(Stmt *S) {
       if (const VarDecl *VD = dyn_cast<VarDecl>(DS->getSingleDecl())) {
         for (const VariableArrayType* VA = FindVA(VD->getType());
              VA != nullptr; VA = FindVA(VA->getElementType())) {
-          AddLiveStmt(val.liveStmts, LV.SSetFact, VA->getSizeExpr());
+          addLiveStmt(VA->getSizeExpr());
         }
       }
       break;
@@ -297,7 +271,7 @@ void TransferFunctions::Visit(Stmt *S) {
       if (OpaqueValueExpr *OV = dyn_cast<OpaqueValueExpr>(child))
         child = OV->getSourceExpr();
       child = child->IgnoreParens();
-      val.liveStmts = LV.SSetFact.add(val.liveStmts, child);
+      addStmt(child);
       return;
     }
 
@@ -318,7 +292,7 @@ void TransferFunctions::Visit(Stmt *S) {
 
   for (Stmt *Child : S->children()) {
     if (Child)
-      AddLiveStmt(val.liveStmts, LV.SSetFact, Child);
+      addLiveStmt(Child);
   }
 }
 
@@ -338,7 +312,7 @@ void TransferFunctions::VisitBinaryOperator(BinaryOperator *B) {
 
         if (!isAlwaysAlive(VD)) {
           // The variable is now dead.
-          val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+          removeDecl(VD);
         }
 
         if (observer)
@@ -352,21 +326,21 @@ void TransferFunctions::VisitBlockExpr(BlockExpr *BE) {
        LV.analysisContext.getReferencedBlockVars(BE->getBlockDecl())) {
     if (isAlwaysAlive(VD))
       continue;
-    val.liveDecls = LV.DSetFact.add(val.liveDecls, VD);
+    addDecl(VD);
   }
 }
 
 void TransferFunctions::VisitDeclRefExpr(DeclRefExpr *DR) {
   if (const VarDecl *D = dyn_cast<VarDecl>(DR->getDecl()))
     if (!isAlwaysAlive(D) && LV.inAssignment.find(DR) == LV.inAssignment.end())
-      val.liveDecls = LV.DSetFact.add(val.liveDecls, D);
+      addDecl(D);
 }
 
 void TransferFunctions::VisitDeclStmt(DeclStmt *DS) {
   for (const auto *DI : DS->decls())
     if (const auto *VD = dyn_cast<VarDecl>(DI)) {
       if (!isAlwaysAlive(VD))
-        val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+        removeDecl(VD);
     }
 }
 
@@ -384,7 +358,7 @@ void TransferFunctions::VisitObjCForCollectionStmt(ObjCForCollectionStmt *OS) {
   }
   
   if (VD) {
-    val.liveDecls = LV.DSetFact.remove(val.liveDecls, VD);
+    removeDecl(VD);
     if (observer && DR)
       observer->observerKill(DR);
   }
@@ -402,7 +376,7 @@ VisitUnaryExprOrTypeTraitExpr(UnaryExprOrTypeTraitExpr *UE)
   const Expr *subEx = UE->getArgumentExpr();
   if (subEx->getType()->isVariableArrayType()) {
     assert(subEx->isLValue());
-    val.liveStmts = LV.SSetFact.add(val.liveStmts, subEx->IgnoreParens());
+    addStmt(subEx->IgnoreParens());
   }
 }
 
@@ -430,13 +404,8 @@ void TransferFunctions::VisitUnaryOperator(UnaryOperator *UO) {
     }
 }
 
-LiveVariables::LivenessValues
-LiveVariablesImpl::runOnBlock(const CFGBlock *block,
-                              LiveVariables::LivenessValues val,
-                              LiveVariables::Observer *obs) {
-
-  TransferFunctions TF(*this, val, obs, block);
-  
+void LiveVariablesImpl::walkBlock(const CFGBlock *block, TransferFunctions &TF,
+                                  LiveVariables::LivenessValues *val) {
   // Visit the terminator (if any).
   if (const Stmt *term = block->getTerminator())
     TF.Visit(const_cast<Stmt*>(term));
@@ -448,7 +417,7 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
 
     if (Optional<CFGAutomaticObjDtor> Dtor =
             elem.getAs<CFGAutomaticObjDtor>()) {
-      val.liveDecls = DSetFact.add(val.liveDecls, Dtor->getVarDecl());
+      TF.addDecl(Dtor->getVarDecl());
       continue;
     }
 
@@ -457,7 +426,36 @@ LiveVariablesImpl::runOnBlock(const CFGBlock *block,
     
     const Stmt *S = elem.castAs<CFGStmt>().getStmt();
     TF.Visit(const_cast<Stmt*>(S));
-    stmtsToLiveness[S] = val;
+    if (val)
+      stmtsToLiveness[S] = *val;
+  }
+}
+
+LiveVariables::LivenessValues
+LiveVariablesImpl::runOnBlock(const CFGBlock *block,
+                              LiveVariables::LivenessValues val,
+                              LiveVariables::Observer *obs) {
+  TransferFunctions TF(*this, val, obs, block);
+  walkBlock(block, TF, &val);
+  return val;
+}
+
+void LiveVariablesImpl::computeBlockEffect(const CFGBlock *block,
+                                           BlockEffect &effect) {
+  effect.clear();
+  TransferFunctions TF(*this, effect, block);
+  walkBlock(block, TF, nullptr);
+}
+
+LiveVariables::LivenessValues
+LiveVariablesImpl::getLivenessValues(const llvm::BitVector &bits) {
+  LiveVariables::LivenessValues val;
+  for (int i = bits.find_first(); i != -1; i = bits.find_next(i)) {
+    LiveItem item = items[i];
+    if (const Stmt *S = item.dyn_cast<const Stmt *>())
+      val.liveStmts = SSetFact.add(val.liveStmts, S);
+    else
+      val.liveDecls = DSetFact.add(val.liveDecls, item.get<const VarDecl *>());
   }
   return val;
 }
@@ -490,15 +488,8 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
 
   LiveVariablesImpl *LV = new LiveVariablesImpl(AC, killAtAssign);
 
-  // Construct the dataflow worklist.  Enqueue the exit block as the
-  // start of the analysis.
-  DataflowWorklist worklist(*cfg, AC);
-  llvm::BitVector everAnalyzedBlock(cfg->getNumBlockIDs());
-
-  // FIXME: we should enqueue using post order.
   for (CFG::const_iterator it = cfg->begin(), ei = cfg->end(); it != ei; ++it) {
     const CFGBlock *block = *it;
-    worklist.enqueueBlock(block);
     
     // FIXME: Scan for DeclRefExprs using in the LHS of an assignment.
     // We need to do this because we lack context in the reverse analysis
@@ -520,33 +511,46 @@ LiveVariables::computeLiveness(AnalysisDeclContext &AC,
         }
       }
   }
-  
-  while (const CFGBlock *block = worklist.dequeue()) {
-    // Determine if the block's end value has changed.  If not, we
-    // have nothing left to do for this block.
-    LivenessValues &prevVal = LV->blocksEndToLiveness[block];
-    
-    // Merge the values of all successor blocks.
-    LivenessValues val;
-    for (CFGBlock::const_succ_iterator it = block->succ_begin(),
-                                       ei = block->succ_end(); it != ei; ++it) {
-      if (const CFGBlock *succ = *it) {     
-        val = LV->merge(val, LV->blocksBeginToLiveness[succ]);
-      }
+
+  // Summarize the effect of each block. Only the items that some block makes
+  // live at its start can be live across blocks, so only those get a bit in
+  // the dataflow values; all others are handled within their blocks below.
+  std::vector<SmallVector<std::pair<LiveItem, bool>, 8>> effects(
+      cfg->getNumBlockIDs());
+  BlockEffect effect;
+  for (const CFGBlock *block : *cfg) {
+    LV->computeBlockEffect(block, effect);
+    for (const auto &E : effect) {
+      if (E.second && LV->itemIndices.insert(std::make_pair(
+                          E.first, LV->items.size())).second)
+        LV->items.push_back(E.first);
     }
-    
-    if (!everAnalyzedBlock[block->getBlockID()])
-      everAnalyzedBlock[block->getBlockID()] = true;
-    else if (prevVal.equals(val))
-      continue;
+    effects[block->getBlockID()].append(effect.begin(), effect.end());
+  }
 
-    prevVal = val;
-    
-    // Update the dataflow value for the start of this block.
+  BitVectorDataflow dataflow(*cfg, *AC.getAnalysis<PostOrderCFGView>(),
+                             DataflowWorklist::Backward,
+                             BitVectorDataflow::Union);
+  dataflow.setNumBits(LV->items.size());
+  for (const CFGBlock *block : *cfg) {
+    llvm::BitVector &gen = dataflow.getGen(block);
+    llvm::BitVector &kill = dataflow.getKill(block);
+    for (const auto &E : effects[block->getBlockID()]) {
+      auto I = LV->itemIndices.find(E.first);
+      if (I == LV->itemIndices.end())
+        continue;
+      (E.second ? gen : kill).set(I->second);
+    }
+  }
+  effects.clear();
+  dataflow.solve(llvm::BitVector(LV->items.size()));
+
+  // Compute the liveness at each statement from the liveness at the end of
+  // its block.
+  for (const CFGBlock *block : *cfg) {
+    LivenessValues val = LV->getLivenessValues(dataflow.getIn(block));
+    LV->blocksEndToLiveness[block] = val;
     LV->blocksBeginToLiveness[block] = LV->runOnBlock(block, val);
-    
-    // Enqueue the value to the predecessors.
-    worklist.enqueuePredecessors(block);
   }
   
   return new LiveVariables(LV);
@@ -133,19 +133,25 @@ public:
 typedef unsigned short FactID;
 
 /// \brief FactManager manages the memory for all facts that are created during
-/// the analysis of a single routine.
+/// the analysis of a single routine.  It also keeps a copy of the capability
+/// of each fact in a flat table indexed by FactID, so that FactSet lookups do
+/// not need to load the facts themselves.
 class FactManager {
 private:
   std::vector<std::unique_ptr<FactEntry>> Facts;
+  std::vector<CapabilityExpr> Capabilities;
 
 public:
   FactID newFact(std::unique_ptr<FactEntry> Entry) {
+    Capabilities.push_back(*Entry);
     Facts.push_back(std::move(Entry));
     return static_cast<unsigned short>(Facts.size() - 1);
   }
 
   const FactEntry &operator[](FactID F) const { return *Facts[F]; }
   FactEntry &operator[](FactID F) { return *Facts[F]; }
+
+  const CapabilityExpr &capability(FactID F) const { return Capabilities[F]; }
 };
 
 
@@ -155,7 +161,9 @@ public:
 /// table maintained by a FactManager.  A typical FactSet only holds 1 or 2
 /// locks, so we can get away with doing a linear search for lookup.  Note
 /// that a hashtable or map is inappropriate in this case, because lookups
-/// may involve partial pattern matches, rather than exact matches.
+/// may involve partial pattern matches, rather than exact matches.  Most
+/// capabilities are interned, however, so that comparing them is usually
+/// just a pointer comparison.
 class FactSet {
 private:
   typedef SmallVector<FactID, 4> FactVec;
@@ -177,7 +185,7 @@ public:
   // Return true if the set contains only negative facts
   bool isEmpty(FactManager &FactMan) const {
     for (FactID FID : *this) {
-      if (!FactMan[FID].negative())
+      if (!FactMan.capability(FID).negative())
         return false;
     }
     return true;
@@ -197,13 +205,13 @@ public:
       return false;
 
     for (unsigned i = 0; i < n-1; ++i) {
-      if (FM[FactIDs[i]].matches(CapE)) {
+      if (FM.capability(FactIDs[i]).matches(CapE)) {
         FactIDs[i] = FactIDs[n-1];
         FactIDs.pop_back();
         return true;
       }
     }
-    if (FM[FactIDs[n-1]].matches(CapE)) {
+    if (FM.capability(FactIDs[n-1]).matches(CapE)) {
       FactIDs.pop_back();
       return true;
     }
@@ -212,20 +220,20 @@ public:
 
   iterator findLockIter(FactManager &FM, const CapabilityExpr &CapE) {
     return std::find_if(begin(), end(), [&](FactID ID) {
-      return FM[ID].matches(CapE);
+      return FM.capability(ID).matches(CapE);
     });
   }
 
   FactEntry *findLock(FactManager &FM, const CapabilityExpr &CapE) const {
     auto I = std::find_if(begin(), end(), [&](FactID ID) {
-      return FM[ID].matches(CapE);
+      return FM.capability(ID).matches(CapE);
     });
     return I != end() ? &FM[*I] : nullptr;
   }
 
   FactEntry *findLockUniv(FactManager &FM, const CapabilityExpr &CapE) const {
     auto I = std::find_if(begin(), end(), [&](FactID ID) -> bool {
-      return FM[ID].matchesUniv(CapE);
+      return FM.capability(ID).matchesUniv(CapE);
     });
     return I != end() ? &FM[*I] : nullptr;
   }
@@ -233,14 +241,14 @@ public:
   FactEntry *findPartialMatch(FactManager &FM,
                               const CapabilityExpr &CapE) const {
     auto I = std::find_if(begin(), end(), [&](FactID ID) -> bool {
-      return FM[ID].partiallyMatches(CapE);
+      return FM.capability(ID).partiallyMatches(CapE);
     });
     return I != end() ? &FM[*I] : nullptr;
   }
 
   bool containsMutexDecl(FactManager &FM, const ValueDecl* Vd) const {
     auto I = std::find_if(begin(), end(), [&](FactID ID) -> bool {
-      return FM[ID].valueDecl() == Vd;
+      return FM.capability(ID).valueDecl() == Vd;
     });
     return I != end();
   }
@@ -841,28 +849,28 @@ public:
 
 class ScopedLockableFactEntry : public FactEntry {
 private:
-  SmallVector<const til::SExpr *, 4> UnderlyingMutexes;
+  SmallVector<CapabilityExpr, 4> UnderlyingMutexes;
 
 public:
   ScopedLockableFactEntry(const CapabilityExpr &CE, SourceLocation Loc,
                           const CapExprSet &Excl, const CapExprSet &Shrd)
       : FactEntry(CE, LK_Exclusive, Loc, false) {
     for (const auto &M : Excl)
-      UnderlyingMutexes.push_back(M.sexpr());
+      UnderlyingMutexes.emplace_back(M.sexpr(), false, M.interned());
     for (const auto &M : Shrd)
-      UnderlyingMutexes.push_back(M.sexpr());
+      UnderlyingMutexes.emplace_back(M.sexpr(), false, M.interned());
   }
 
   void
   handleRemovalFromIntersection(const FactSet &FSet, FactManager &FactMan,
                                 SourceLocation JoinLoc, LockErrorKind LEK,
                                 ThreadSafetyHandler &Handler) const override {
-    for (const til::SExpr *UnderlyingMutex : UnderlyingMutexes) {
-      if (FSet.findLock(FactMan, CapabilityExpr(UnderlyingMutex, false))) {
+    for (const CapabilityExpr &UnderlyingMutex : UnderlyingMutexes) {
+      if (FSet.findLock(FactMan, UnderlyingMutex)) {
         // If this scoped lock manages another mutex, and if the underlying
         // mutex is still held, then warn about the underlying mutex.
         Handler.handleMutexHeldEndOfScope(
-            "mutex", sx::toString(UnderlyingMutex), loc(), JoinLoc, LEK);
+            "mutex", UnderlyingMutex.toString(), loc(), JoinLoc, LEK);
       }
     }
   }
@@ -872,8 +880,7 @@ public:
                     bool FullyRemove, ThreadSafetyHandler &Handler,
                     StringRef DiagKind) const override {
     assert(!Cp.negative() && "Managing object cannot be negative.");
-    for (const til::SExpr *UnderlyingMutex : UnderlyingMutexes) {
-      CapabilityExpr UnderCp(UnderlyingMutex, false);
+    for (const CapabilityExpr &UnderCp : UnderlyingMutexes) {
       auto UnderEntry = llvm::make_unique<LockableFactEntry>(
           !UnderCp, LK_Exclusive, UnlockLoc);
 
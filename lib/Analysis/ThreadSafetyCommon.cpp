@@ -181,9 +181,21 @@ CapabilityExpr SExprBuilder::translateAttrExpr(const Expr *AttrExp,
   // Hack to deal with smart pointers -- strip off top-level pointer casts.
   if (auto *CE = dyn_cast_or_null<til::Cast>(E)) {
     if (CE->castOpcode() == til::CAST_objToPtr)
-      return CapabilityExpr(CE->expr(), Neg);
+      return internCapability(CE->expr(), Neg);
   }
-  return CapabilityExpr(E, Neg);
+  return internCapability(E, Neg);
+}
+
+/// \brief Return the capability for E, replacing E by a previously translated
+/// capability expression with the same value, if there is one.  Expressions
+/// with wildcards, literals or undefined values are not interned, because they
+/// may compare equal to expressions that are written differently.
+CapabilityExpr SExprBuilder::internCapability(const til::SExpr *E, bool Neg) {
+  til::StructuralHasher Hasher;
+  Hasher.compare(E, E);
+  if (Hasher.isInexact())
+    return CapabilityExpr(E, Neg);
+  return CapabilityExpr(*InternedCapabilities.insert(E).first, Neg, true);
 }
 
 // Translate a clang statement or expression to a TIL expression.
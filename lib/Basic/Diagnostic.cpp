@@ -78,6 +78,9 @@ DiagnosticsEngine::DiagnosticsEngine(IntrusiveRefCntPtr<DiagnosticIDs> diags,
   TemplateBacktraceLimit = 0;
   ConstexprBacktraceLimit = 0;
 
+  IgnoredEverywhereKnown.resize(diag::DIAG_UPPER_LIMIT);
+  IgnoredEverywhere.resize(diag::DIAG_UPPER_LIMIT);
+
   Reset();
 }
 
@@ -128,6 +131,7 @@ void DiagnosticsEngine::Reset() {
   DiagStates.clear();
   DiagStatesByLoc.clear();
   DiagStateOnPushStack.clear();
+  invalidateIgnoredEverywhere();
 
   // Create a DiagState and DiagStatePoint representing diagnostic changes
   // through command-line.
@@ -163,6 +167,7 @@ void DiagnosticsEngine::DiagStateMap::append(SourceManager &SrcMgr,
                                              DiagState *State) {
   CurDiagState = State;
   CurDiagStateLoc = Loc;
+  invalidateLookupCache();
 
   std::pair<FileID, unsigned> Decomp = SrcMgr.getDecomposedLoc(Loc);
   unsigned Offset = Decomp.second;
@@ -190,20 +195,38 @@ DiagnosticsEngine::DiagStateMap::lookup(SourceManager &SrcMgr,
   if (Files.empty())
     return FirstDiagState;
 
+  // Next most common case: the location is in the range over which the state
+  // found by the last lookup holds.
+  unsigned Raw = Loc.getRawEncoding();
+  if (Raw - LastLookupBegin < LastLookupSize)
+    return LastLookupState;
+
   std::pair<FileID, unsigned> Decomp = SrcMgr.getDecomposedLoc(Loc);
   const File *F = getFile(SrcMgr, Decomp.first);
-  return F->lookup(Decomp.second);
+  const DiagStatePoint *P = F->findTransition(Decomp.second);
+  if (Loc.isInvalid())
+    return P->State;
+
+  // Cache the range of locations in this FileID that have the same state:
+  // up to the next transition, or up to the start of the next FileID.
+  unsigned End = P + 1 != F->StateTransitions.end()
+                     ? P[1].Offset
+                     : SrcMgr.getFileIDSize(Decomp.first) + 1;
+  LastLookupBegin = Raw - (Decomp.second - P->Offset);
+  LastLookupSize = End - P->Offset;
+  LastLookupState = P->State;
+  return P->State;
 }
 
-DiagnosticsEngine::DiagState *
-DiagnosticsEngine::DiagStateMap::File::lookup(unsigned Offset) const {
+const DiagnosticsEngine::DiagStateMap::DiagStatePoint *
+DiagnosticsEngine::DiagStateMap::File::findTransition(unsigned Offset) const {
   auto OnePastIt = std::upper_bound(
       StateTransitions.begin(), StateTransitions.end(), Offset,
       [](unsigned Offset, const DiagStatePoint &P) {
         return Offset < P.Offset;
       });
   assert(OnePastIt != StateTransitions.begin() && "missing initial state");
-  return OnePastIt[-1].State;
+  return &OnePastIt[-1];
 }
 
 DiagnosticsEngine::DiagStateMap::File *
@@ -262,6 +285,7 @@ void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
   }
   DiagnosticMapping Mapping = makeUserMapping(Map, L);
   Mapping.setUpgradedFromWarning(WasUpgradedFromWarning);
+  invalidateIgnoredEverywhere();
 
   // Common case; setting all the diagnostics of a group in one place.
   if ((L.isInvalid() || L == DiagStatesByLoc.getCurDiagStateLoc()) &&
@@ -371,6 +395,19 @@ void DiagnosticsEngine::setSeverityForAll(diag::Flavor Flavor,
       setSeverity(Diag, Map, Loc);
 }
 
+void DiagnosticsEngine::computeIgnoredEverywhere(unsigned DiagID) const {
+  IgnoredEverywhereKnown.set(DiagID);
+  IgnoredEverywhere.set(DiagID);
+  for (const DiagState &State : DiagStates) {
+    diag::kind Diag = (diag::kind)DiagID;
+    if (State.getSeverity(Diag, State.getMappingOrDefault(Diag)) !=
+        diag::Severity::Ignored) {
+      IgnoredEverywhere.reset(DiagID);
+      return;
+    }
+  }
+}
+
 void DiagnosticsEngine::Report(const StoredDiagnostic &storedDiag) {
   assert(CurDiagID == ~0U && "Multiple diagnostics in flight at once!");
 
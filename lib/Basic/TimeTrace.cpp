@@ -0,0 +1,137 @@
+//===- TimeTrace.cpp - Timeline of the compilation ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+using namespace clang;
+
+namespace clang {
+class TimeTraceProfiler {
+  typedef std::chrono::steady_clock Clock;
+
+  struct TimeTraceEvent {
+    Clock::time_point Start;
+    Clock::duration Duration;
+    std::string Name;
+    std::string Detail;
+  };
+
+public:
+  explicit TimeTraceProfiler(unsigned GranularityInMicroseconds)
+      : StartTime(Clock::now()),
+        Granularity(std::chrono::microseconds(GranularityInMicroseconds)) {}
+
+  void begin(StringRef Name, std::string Detail) {
+    Stack.push_back(
+        {Clock::now(), Clock::duration(), Name.str(), std::move(Detail)});
+  }
+
+  void end() {
+    assert(!Stack.empty() && "time trace event ended without a begin");
+    TimeTraceEvent &E = Stack.back();
+    E.Duration = Clock::now() - E.Start;
+    if (E.Duration >= Granularity)
+      Events.push_back(std::move(E));
+    Stack.pop_back();
+  }
+
+  void write(raw_ostream &OS) const;
+
+private:
+  /// The events that have started and not ended yet, innermost last.
+  SmallVector<TimeTraceEvent, 16> Stack;
+  /// The events that have ended, in the order in which they ended.
+  std::vector<TimeTraceEvent> Events;
+  Clock::time_point StartTime;
+  Clock::duration Granularity;
+};
+} // end namespace clang
+
+LLVM_THREAD_LOCAL TimeTraceProfiler *clang::TimeTraceProfilerInstance =
+    nullptr;
+
+/// Writes \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << "\\u" << llvm::format_hex_no_prefix(C, 4);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) const {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+
+  // Complete events ("ph":"X") with their start and duration in
+  // microseconds; the viewer nests them by time.
+  OS << "{\"traceEvents\":[";
+  for (const TimeTraceEvent &E : Events) {
+    OS << "\n{\"pid\":1,\"tid\":0,\"ph\":\"X\",\"ts\":"
+       << duration_cast<microseconds>(E.Start - StartTime).count()
+       << ",\"dur\":" << duration_cast<microseconds>(E.Duration).count()
+       << ",\"name\":";
+    writeJSONString(OS, E.Name);
+    if (!E.Detail.empty()) {
+      OS << ",\"args\":{\"detail\":";
+      writeJSONString(OS, E.Detail);
+      OS << '}';
+    }
+    OS << "},";
+  }
+  OS << "\n{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"name\":\"process_name\","
+        "\"args\":{\"name\":\"clang\"}}\n]}\n";
+}
+
+void clang::timeTraceProfilerInitialize(unsigned GranularityInMicroseconds) {
+  assert(!TimeTraceProfilerInstance && "time trace profiler already running");
+  TimeTraceProfilerInstance = new TimeTraceProfiler(GranularityInMicroseconds);
+}
+
+void clang::timeTraceProfilerCleanup() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+void clang::timeTraceProfilerWrite(raw_ostream &OS) {
+  assert(TimeTraceProfilerInstance && "time trace profiler not running");
+  TimeTraceProfilerInstance->write(OS);
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->begin(Name, Detail.str());
+}
+
+void clang::timeTraceProfilerBegin(StringRef Name,
+                                   llvm::function_ref<std::string()> Detail) {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->begin(Name, Detail());
+}
+
+void clang::timeTraceProfilerEnd() {
+  if (TimeTraceProfilerInstance)
+    TimeTraceProfilerInstance->end();
+}
@@ -10,16 +10,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/YAMLParser.h"
@@ -681,6 +685,285 @@ std::error_code InMemoryFileSystem::setCurrentWorkingDirectory(const Twine &P) {
 }
 }
 
+//===-----------------------------------------------------------------------===/
+// CachingFileSystem implementation
+//===-----------------------------------------------------------------------===/
+
+struct CachingFileSystem::Entry {
+  /// \brief Whether the result of \c status is known.
+  bool HasStatus = false;
+  std::error_code StatusError;
+  Status S;
+  /// \brief The name reported by the opened file, e.g. its real path.
+  std::string RealName;
+  /// \brief The contents of the file, once read.
+  std::shared_ptr<MemoryBuffer> Contents;
+};
+
+struct CachingFileSystem::Shard {
+  std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+};
+
+namespace {
+/// \brief A view of the cached contents of a file that keeps them alive.
+class SharedMemoryBuffer : public MemoryBuffer {
+  std::shared_ptr<MemoryBuffer> Contents;
+  std::string Name;
+
+public:
+  SharedMemoryBuffer(std::shared_ptr<MemoryBuffer> Contents, std::string Name)
+      : Contents(std::move(Contents)), Name(std::move(Name)) {
+    init(this->Contents->getBufferStart(), this->Contents->getBufferEnd(),
+         /*RequiresNullTerminator=*/true);
+  }
+
+  StringRef getBufferIdentifier() const override { return Name; }
+  BufferKind getBufferKind() const override {
+    return Contents->getBufferKind();
+  }
+};
+} // end anonymous namespace
+
+/// \brief A file opened through a \c CachingFileSystem.
+class CachingFileSystem::CachedFile : public File {
+  CachingFileSystem &FS;
+  std::string Key;
+  Status S;
+  std::string RealName;
+  /// \brief The file opened in the underlying file system, or null if its
+  /// contents were already cached when it was opened.
+  std::unique_ptr<File> Underlying;
+
+public:
+  CachedFile(CachingFileSystem &FS, StringRef Key, Status S,
+             StringRef RealName, std::unique_ptr<File> Underlying)
+      : FS(FS), Key(Key), S(std::move(S)), RealName(RealName),
+        Underlying(std::move(Underlying)) {}
+  ~CachedFile() override { close(); }
+
+  ErrorOr<Status> status() override { return S; }
+  ErrorOr<std::string> getName() override {
+    return RealName.empty() ? S.getName().str() : RealName;
+  }
+  ErrorOr<std::unique_ptr<MemoryBuffer>> getBuffer(const Twine &Name,
+                                                   int64_t FileSize,
+                                                   bool RequiresNullTerminator,
+                                                   bool IsVolatile) override;
+  std::error_code close() override {
+    if (!Underlying)
+      return std::error_code();
+    std::error_code EC = Underlying->close();
+    Underlying.reset();
+    return EC;
+  }
+};
+
+ErrorOr<std::unique_ptr<MemoryBuffer>>
+CachingFileSystem::CachedFile::getBuffer(const Twine &Name, int64_t FileSize,
+                                         bool RequiresNullTerminator,
+                                         bool IsVolatile) {
+  if (IsVolatile) {
+    // The contents may change while we are looking; read them afresh.
+    if (!Underlying) {
+      auto F = FS.Base->openFileForRead(Key);
+      if (!F)
+        return F.getError();
+      Underlying = std::move(*F);
+    }
+    return Underlying->getBuffer(Name, FileSize, RequiresNullTerminator,
+                                 IsVolatile);
+  }
+
+  std::shared_ptr<MemoryBuffer> Contents = FS.lookupContents(Key);
+  if (Contents) {
+    ++FS.ContentsHits;
+  } else {
+    ++FS.ContentsMisses;
+    assert(Underlying && "cached contents were dropped");
+    // Always ask for a null terminator, so that the cached contents can
+    // serve any later request.
+    auto Buffer = Underlying->getBuffer(Name, FileSize,
+                                        /*RequiresNullTerminator=*/true,
+                                        /*IsVolatile=*/false);
+    if (!Buffer)
+      return Buffer.getError();
+    Contents = FS.recordContents(Key, std::move(*Buffer));
+  }
+  return std::unique_ptr<MemoryBuffer>(
+      new SharedMemoryBuffer(std::move(Contents), Name.str()));
+}
+
+CachingFileSystem::CachingFileSystem(IntrusiveRefCntPtr<FileSystem> BaseFS)
+    : Base(std::move(BaseFS)), Shards(new Shard[NumShards]),
+      WorkingDirectory(Base->getCurrentWorkingDirectory()) {}
+
+CachingFileSystem::~CachingFileSystem() {}
+
+CachingFileSystem::Statistics CachingFileSystem::getStatistics() const {
+  Statistics Stats;
+  Stats.StatusHits = StatusHits;
+  Stats.StatusMisses = StatusMisses;
+  Stats.ContentsHits = ContentsHits;
+  Stats.ContentsMisses = ContentsMisses;
+  return Stats;
+}
+
+bool CachingFileSystem::getCacheKey(const Twine &Path,
+                                    SmallVectorImpl<char> &Key) const {
+  Path.toVector(Key);
+  if (makeAbsolute(Key))
+    return false;
+  // '..' is left alone; it means something else after a symlink.
+  llvm::sys::path::remove_dots(Key);
+  return true;
+}
+
+CachingFileSystem::Shard &CachingFileSystem::getShard(StringRef Key) const {
+  return Shards[llvm::hash_value(Key) % NumShards];
+}
+
+void CachingFileSystem::recordStatus(StringRef Key,
+                                     const ErrorOr<Status> &Result,
+                                     StringRef RealName) {
+  Shard &S = getShard(Key);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  Entry &E = S.Entries[Key];
+  if (!RealName.empty() && E.RealName.empty())
+    E.RealName = RealName;
+  if (E.HasStatus)
+    return;
+  E.HasStatus = true;
+  if (Result)
+    E.S = *Result;
+  else
+    E.StatusError = Result.getError();
+}
+
+std::shared_ptr<MemoryBuffer>
+CachingFileSystem::lookupContents(StringRef Key) {
+  Shard &S = getShard(Key);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  auto I = S.Entries.find(Key);
+  if (I == S.Entries.end())
+    return nullptr;
+  return I->second.Contents;
+}
+
+std::shared_ptr<MemoryBuffer>
+CachingFileSystem::recordContents(StringRef Key,
+                                  std::unique_ptr<MemoryBuffer> Contents) {
+  Shard &S = getShard(Key);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  Entry &E = S.Entries[Key];
+  // Another thread may have read the file in the meantime; keep its copy.
+  if (!E.Contents)
+    E.Contents = std::move(Contents);
+  return E.Contents;
+}
+
+/// \brief Give a cached status the name it was looked up by, unless the
+/// underlying file system chose another name for it.
+static Status getStatusForPath(const Status &S, StringRef Key,
+                               const Twine &Path) {
+  std::string Name = Path.str();
+  if (S.getName() != Key || Name == Key)
+    return S;
+  Status Renamed = Status::copyWithNewName(S, Name);
+  Renamed.IsVFSMapped = S.IsVFSMapped;
+  return Renamed;
+}
+
+ErrorOr<Status> CachingFileSystem::status(const Twine &Path) {
+  SmallString<256> Key;
+  if (!getCacheKey(Path, Key))
+    return Base->status(Path);
+
+  {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto I = S.Entries.find(Key);
+    if (I != S.Entries.end() && I->second.HasStatus) {
+      ++StatusHits;
+      if (I->second.StatusError)
+        return I->second.StatusError;
+      return getStatusForPath(I->second.S, Key, Path);
+    }
+  }
+
+  // Don't hold the lock while we stat, so that a slow file system doesn't
+  // hold up lookups of other paths.
+  ++StatusMisses;
+  ErrorOr<Status> Result = Base->status(Key);
+  recordStatus(Key, Result);
+  if (!Result)
+    return Result.getError();
+  return getStatusForPath(*Result, Key, Path);
+}
+
+ErrorOr<std::unique_ptr<File>>
+CachingFileSystem::openFileForRead(const Twine &Path) {
+  SmallString<256> Key;
+  if (!getCacheKey(Path, Key))
+    return Base->openFileForRead(Path);
+
+  {
+    Shard &S = getShard(Key);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto I = S.Entries.find(Key);
+    if (I != S.Entries.end() && I->second.HasStatus) {
+      Entry &E = I->second;
+      if (E.StatusError == llvm::errc::no_such_file_or_directory) {
+        ++StatusHits;
+        return E.StatusError;
+      }
+      // Once the contents are cached, the file need not be opened at all.
+      if (!E.StatusError && E.Contents) {
+        ++StatusHits;
+        return std::unique_ptr<File>(
+            new CachedFile(*this, Key, getStatusForPath(E.S, Key, Path),
+                           E.RealName, nullptr));
+      }
+    }
+  }
+
+  ++StatusMisses;
+  auto F = Base->openFileForRead(Key);
+  if (!F) {
+    if (F.getError() == llvm::errc::no_such_file_or_directory)
+      recordStatus(Key, F.getError());
+    return F.getError();
+  }
+  ErrorOr<Status> Result = (*F)->status();
+  if (!Result)
+    return std::move(*F);
+  ErrorOr<std::string> Name = (*F)->getName();
+  StringRef RealName = Name ? StringRef(*Name) : StringRef();
+  recordStatus(Key, Result, RealName);
+  return std::unique_ptr<File>(
+      new CachedFile(*this, Key, getStatusForPath(*Result, Key, Path),
+                     RealName, std::move(*F)));
+}
+
+directory_iterator CachingFileSystem::dir_begin(const Twine &Dir,
+                                                std::error_code &EC) {
+  return Base->dir_begin(Dir, EC);
+}
+
+ErrorOr<std::string> CachingFileSystem::getCurrentWorkingDirectory() const {
+  std::lock_guard<std::mutex> Lock(WorkingDirectoryMutex);
+  return WorkingDirectory;
+}
+
+std::error_code
+CachingFileSystem::setCurrentWorkingDirectory(const Twine &Path) {
+  if (std::error_code EC = Base->setCurrentWorkingDirectory(Path))
+    return EC;
+  std::lock_guard<std::mutex> Lock(WorkingDirectoryMutex);
+  WorkingDirectory = Base->getCurrentWorkingDirectory();
+  return std::error_code();
+}
+
 //===-----------------------------------------------------------------------===/
 // RedirectingFileSystem implementation
 //===-----------------------------------------------------------------------===/
@@ -936,6 +1219,10 @@ public:
     return IgnoreNonExistentContents;
   }
 
+  /// \brief Write the overlay in the binary format read by
+  /// \c getVFSFromBinaryOverlay.
+  void writeBinaryOverlay(raw_ostream &OS) const;
+
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
 LLVM_DUMP_METHOD void dump() const {
     for (const std::unique_ptr<Entry> &Root : Roots)
@@ -1616,12 +1903,24 @@ static void getVFSEntries(Entry *SrcE, SmallVectorImpl<StringRef> &Path,
   Entries.push_back(YAMLVFSEntry(VPath.c_str(), FE->getExternalContentsPath()));
 }
 
+static void collectVFSFromBinaryOverlay(
+    std::unique_ptr<MemoryBuffer> Buffer, StringRef OverlayFilePath,
+    SmallVectorImpl<YAMLVFSEntry> &CollectedEntries,
+    IntrusiveRefCntPtr<FileSystem> ExternalFS);
+
 void vfs::collectVFSFromYAML(std::unique_ptr<MemoryBuffer> Buffer,
                              SourceMgr::DiagHandlerTy DiagHandler,
                              StringRef YAMLFilePath,
                              SmallVectorImpl<YAMLVFSEntry> &CollectedEntries,
                              void *DiagContext,
                              IntrusiveRefCntPtr<FileSystem> ExternalFS) {
+  // Overlays compiled to the binary format are accepted, too.
+  if (isBinaryVFSOverlay(*Buffer)) {
+    collectVFSFromBinaryOverlay(std::move(Buffer), YAMLFilePath,
+                                CollectedEntries, std::move(ExternalFS));
+    return;
+  }
+
   RedirectingFileSystem *VFS = RedirectingFileSystem::create(
       std::move(Buffer), DiagHandler, YAMLFilePath, DiagContext,
       std::move(ExternalFS));
@@ -1633,12 +1932,668 @@ void vfs::collectVFSFromYAML(std::unique_ptr<MemoryBuffer> Buffer,
   getVFSEntries(*RootE, Components, CollectedEntries);
 }
 
-UniqueID vfs::getNextVirtualUniqueID() {
-  static std::atomic<unsigned> UID;
-  unsigned ID = ++UID;
+/// The last file ID of the virtual unique IDs handed out.
+static std::atomic<unsigned> LastVirtualFileID;
+
+/// Reserve \p Count consecutive virtual unique IDs, returning the file ID
+/// of the first one.
+static unsigned reserveVirtualFileIDs(unsigned Count) {
+  return LastVirtualFileID.fetch_add(Count) + 1;
+}
+
+/// Get the virtual unique ID with the given file ID.
+static UniqueID getVirtualUniqueID(uint64_t FileID) {
   // The following assumes that uint64_t max will never collide with a real
   // dev_t value from the OS.
-  return UniqueID(std::numeric_limits<uint64_t>::max(), ID);
+  return UniqueID(std::numeric_limits<uint64_t>::max(), FileID);
+}
+
+UniqueID vfs::getNextVirtualUniqueID() {
+  return getVirtualUniqueID(reserveVirtualFileIDs(1));
+}
+
+//===-----------------------------------------------------------------------===/
+// Binary overlay implementation
+//===-----------------------------------------------------------------------===/
+
+/// \brief The binary overlay format.
+///
+/// All integers are 32-bit little-endian, and all offsets are relative to the
+/// start of the overlay.
+///
+/// \verbatim
+/// Header:     magic, version, flags, node count, node table offset,
+///             hash table size, hash table offset, string table offset,
+///             string table size
+/// Node:       name offset, name size, parent node, kind, external contents
+///             offset, external contents size, first child, child count
+/// Hash table: one node index + 1 per slot, 0 for an empty slot
+/// Strings:    the names and external contents of the nodes
+/// \endverbatim
+///
+/// Node 0 is an unnamed directory holding the roots, and the children of a
+/// directory are consecutive nodes, in the order of the YAML file. The hash
+/// table, with linear probing, maps a parent node and a path component to
+/// the parent's children with that name, so that looking up a path takes one
+/// probe sequence per component. Nothing has to be read up front.
+namespace binary_overlay {
+static const char Magic[4] = {'V', 'F', 'S', 'B'};
+enum : uint32_t { Version = 1 };
+
+enum HeaderField {
+  HF_Magic,
+  HF_Version,
+  HF_Flags,
+  HF_NumNodes,
+  HF_NodesOffset,
+  HF_HashTableSize,
+  HF_HashTableOffset,
+  HF_StringsOffset,
+  HF_StringsSize,
+  HF_NumFields
+};
+
+enum NodeField {
+  NF_NameOffset,
+  NF_NameSize,
+  NF_Parent,
+  NF_Kind,
+  NF_ExternalOffset,
+  NF_ExternalSize,
+  NF_FirstChild,
+  NF_NumChildren,
+  NF_NumFields
+};
+
+enum Flags : uint32_t {
+  F_CaseSensitive = 1 << 0,
+  F_UseExternalNames = 1 << 1,
+  F_IgnoreNonExistentContents = 1 << 2,
+  F_OverlayRelative = 1 << 3
+};
+
+/// The kind field holds the \c EntryKind in its low byte and, for files, the
+/// \c RedirectingFileEntry::NameKind in the next one.
+static uint32_t getKind(EntryKind K, RedirectingFileEntry::NameKind UseName) {
+  return K | UseName << 8;
+}
+
+/// Hash a path component of the given parent node. This is part of the
+/// format, so it must not change without bumping the version.
+static uint32_t hashComponent(uint32_t Parent, StringRef Name,
+                              bool CaseSensitive) {
+  // 32-bit FNV-1a.
+  uint32_t Hash = 2166136261u;
+  auto Mix = [&Hash](unsigned char C) { Hash = (Hash ^ C) * 16777619u; };
+  for (unsigned I = 0; I != 4; ++I)
+    Mix(Parent >> (I * 8));
+  for (char C : Name)
+    Mix(CaseSensitive ? C : toLowercase(C));
+  return Hash;
+}
+} // end namespace binary_overlay
+
+void RedirectingFileSystem::writeBinaryOverlay(raw_ostream &OS) const {
+  using namespace binary_overlay;
+
+  // Lay the nodes out breadth-first, so that the children of a directory are
+  // consecutive.
+  std::vector<std::pair<Entry *, uint32_t>> Nodes; // Entry and parent.
+  std::vector<std::pair<uint32_t, uint32_t>> Children; // First and count.
+  Nodes.emplace_back(nullptr, 0);
+  for (uint32_t I = 0; I != Nodes.size(); ++I) {
+    uint32_t First = Nodes.size();
+    if (I == 0) {
+      for (const std::unique_ptr<Entry> &Root : Roots)
+        Nodes.emplace_back(Root.get(), I);
+    } else if (auto *DE = dyn_cast<RedirectingDirectoryEntry>(Nodes[I].first)) {
+      for (std::unique_ptr<Entry> &SubEntry :
+           llvm::make_range(DE->contents_begin(), DE->contents_end()))
+        Nodes.emplace_back(SubEntry.get(), I);
+    }
+    Children.emplace_back(First, Nodes.size() - First);
+  }
+
+  std::string Strings;
+  llvm::StringMap<uint32_t> StringOffsets;
+  auto AddString = [&](StringRef Str) {
+    auto Result = StringOffsets.insert(std::make_pair(Str, Strings.size()));
+    if (Result.second)
+      Strings += Str;
+    return Result.first->second;
+  };
+
+  uint32_t HashTableSize = llvm::NextPowerOf2(Nodes.size() * 2);
+  std::vector<uint32_t> HashTable(HashTableSize);
+  std::vector<uint32_t> NodeTable;
+  NodeTable.reserve(Nodes.size() * NF_NumFields);
+  for (uint32_t I = 0; I != Nodes.size(); ++I) {
+    Entry *E = Nodes[I].first;
+    uint32_t Parent = Nodes[I].second;
+    StringRef Name, ExternalContents;
+    uint32_t Kind = getKind(EK_Directory, RedirectingFileEntry::NK_NotSet);
+    if (E) {
+      Name = E->getName();
+      if (auto *F = dyn_cast<RedirectingFileEntry>(E)) {
+        Kind = getKind(EK_File, F->getUseName());
+        ExternalContents = F->getExternalContentsPath();
+        // Keep relative overlays relative to wherever the binary overlay
+        // ends up.
+        if (IsRelativeOverlay &&
+            ExternalContents.startswith(ExternalContentsPrefixDir)) {
+          ExternalContents =
+              ExternalContents.drop_front(ExternalContentsPrefixDir.size());
+          while (!ExternalContents.empty() &&
+                 sys::path::is_separator(ExternalContents.front()))
+            ExternalContents = ExternalContents.drop_front();
+        }
+      }
+
+      uint32_t Mask = HashTableSize - 1;
+      uint32_t Slot = hashComponent(Parent, Name, CaseSensitive) & Mask;
+      while (HashTable[Slot])
+        Slot = (Slot + 1) & Mask;
+      HashTable[Slot] = I + 1;
+    }
+
+    NodeTable.push_back(AddString(Name));
+    NodeTable.push_back(Name.size());
+    NodeTable.push_back(Parent);
+    NodeTable.push_back(Kind);
+    NodeTable.push_back(AddString(ExternalContents));
+    NodeTable.push_back(ExternalContents.size());
+    NodeTable.push_back(Children[I].first);
+    NodeTable.push_back(Children[I].second);
+  }
+
+  uint32_t Flags = 0;
+  if (CaseSensitive)
+    Flags |= F_CaseSensitive;
+  if (UseExternalNames)
+    Flags |= F_UseExternalNames;
+  if (IgnoreNonExistentContents)
+    Flags |= F_IgnoreNonExistentContents;
+  if (IsRelativeOverlay)
+    Flags |= F_OverlayRelative;
+
+  uint32_t NodesOffset = HF_NumFields * 4;
+  uint32_t HashTableOffset = NodesOffset + NodeTable.size() * 4;
+  uint32_t StringsOffset = HashTableOffset + HashTableSize * 4;
+
+  using namespace llvm::support;
+  endian::Writer<little> LE(OS);
+  OS.write(Magic, sizeof(Magic));
+  LE.write<uint32_t>(Version);
+  LE.write<uint32_t>(Flags);
+  LE.write<uint32_t>(Nodes.size());
+  LE.write<uint32_t>(NodesOffset);
+  LE.write<uint32_t>(HashTableSize);
+  LE.write<uint32_t>(HashTableOffset);
+  LE.write<uint32_t>(StringsOffset);
+  LE.write<uint32_t>(Strings.size());
+  for (uint32_t Value : NodeTable)
+    LE.write<uint32_t>(Value);
+  for (uint32_t Value : HashTable)
+    LE.write<uint32_t>(Value);
+  OS << Strings;
+}
+
+namespace {
+
+/// \brief A virtual file system read in place from a binary overlay.
+///
+/// This behaves like the \c RedirectingFileSystem for the YAML file the
+/// overlay was compiled from. It only reads the nodes on the paths that are
+/// looked up and never changes after it is created, so it can be shared
+/// between threads.
+class BinaryOverlayFileSystem : public vfs::FileSystem {
+  struct Node {
+    StringRef Name;
+    uint32_t Parent;
+    EntryKind Kind;
+    RedirectingFileEntry::NameKind UseName;
+    StringRef ExternalContents;
+    uint32_t FirstChild;
+    uint32_t NumChildren;
+  };
+
+  std::unique_ptr<MemoryBuffer> Buffer;
+  IntrusiveRefCntPtr<FileSystem> ExternalFS;
+  /// For relative overlays, the directory holding the overlay, which the
+  /// external contents are relative to.
+  std::string ExternalContentsPrefixDir;
+
+  uint32_t Flags;
+  uint32_t NumNodes;
+  const char *Nodes;
+  uint32_t HashTableSize;
+  const char *HashTable;
+  const char *Strings;
+  uint32_t StringsSize;
+
+  /// The file ID of the unique ID of node 0; the directories use consecutive
+  /// IDs after it.
+  unsigned FirstFileID;
+  /// The modification time reported for directories.
+  sys::TimePoint<> DirectoryMTime;
+
+  BinaryOverlayFileSystem(std::unique_ptr<MemoryBuffer> Buffer,
+                          IntrusiveRefCntPtr<FileSystem> ExternalFS)
+      : Buffer(std::move(Buffer)), ExternalFS(std::move(ExternalFS)) {}
+
+  bool isCaseSensitive() const {
+    return Flags & binary_overlay::F_CaseSensitive;
+  }
+
+  /// \brief Decode the node with the given index.
+  ///
+  /// \returns false if the node is out of range or malformed.
+  bool getNode(uint32_t Index, Node &N) const;
+
+  /// \brief Looks up the path <tt>[Start, End)</tt> among the children of
+  /// the directory \p Dir.
+  ErrorOr<uint32_t> lookupPath(sys::path::const_iterator Start,
+                               sys::path::const_iterator End,
+                               uint32_t Dir) const;
+
+  /// \brief Get the status of the node with the given index.
+  ErrorOr<Status> status(const Twine &Path, uint32_t Index,
+                         const Node &N) const;
+
+  /// \brief Get the path of the external contents of the given file.
+  std::string getExternalContentsPath(const Node &N) const;
+
+public:
+  /// \brief Checks the header of the overlay in \p Buffer, and returns a
+  /// virtual file system reading it, or null if it is malformed.
+  static BinaryOverlayFileSystem *
+  create(std::unique_ptr<MemoryBuffer> Buffer, StringRef OverlayFilePath,
+         IntrusiveRefCntPtr<FileSystem> ExternalFS);
+
+  /// \brief Looks up \p Path, returning the index of its node.
+  ErrorOr<uint32_t> lookupPath(const Twine &Path) const;
+
+  /// \brief Collect the mappings of the files in the overlay.
+  void collectEntries(uint32_t Index, SmallVectorImpl<StringRef> &Path,
+                      SmallVectorImpl<YAMLVFSEntry> &Entries) const;
+
+  bool ignoreNonExistentContents() const {
+    return Flags & binary_overlay::F_IgnoreNonExistentContents;
+  }
+
+  ErrorOr<Status> status(const Twine &Path) override;
+  ErrorOr<std::unique_ptr<File>> openFileForRead(const Twine &Path) override;
+  directory_iterator dir_begin(const Twine &Dir, std::error_code &EC) override;
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return ExternalFS->getCurrentWorkingDirectory();
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    return ExternalFS->setCurrentWorkingDirectory(Path);
+  }
+};
+
+class BinaryOverlayDirIterImpl : public clang::vfs::detail::DirIterImpl {
+  std::string Dir;
+  BinaryOverlayFileSystem &FS;
+  uint32_t Current, End;
+  std::vector<StringRef> Names;
+
+  /// \brief Move to the first entry from \c Current on that maps to existing
+  /// contents.
+  std::error_code settle();
+
+public:
+  BinaryOverlayDirIterImpl(const Twine &Path, BinaryOverlayFileSystem &FS,
+                           std::vector<StringRef> Names, std::error_code &EC)
+      : Dir(Path.str()), FS(FS), Current(0), End(Names.size()),
+        Names(std::move(Names)) {
+    EC = settle();
+  }
+
+  std::error_code increment() override {
+    assert(Current != End && "cannot iterate past end");
+    ++Current;
+    return settle();
+  }
+};
+
+} // end anonymous namespace
+
+BinaryOverlayFileSystem *
+BinaryOverlayFileSystem::create(std::unique_ptr<MemoryBuffer> Buffer,
+                                StringRef OverlayFilePath,
+                                IntrusiveRefCntPtr<FileSystem> ExternalFS) {
+  using namespace binary_overlay;
+  using namespace llvm::support;
+
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < HF_NumFields * 4 || !isBinaryVFSOverlay(*Buffer))
+    return nullptr;
+  auto Field = [&](HeaderField F) {
+    return endian::read32le(Data.data() + F * 4);
+  };
+  if (Field(HF_Version) != Version)
+    return nullptr;
+
+  // Check that the tables are within the buffer.
+  uint32_t NumNodes = Field(HF_NumNodes);
+  uint32_t HashTableSize = Field(HF_HashTableSize);
+  auto InBuffer = [&](uint32_t Offset, uint64_t Size) {
+    return Offset <= Data.size() && Size <= Data.size() - Offset;
+  };
+  if (NumNodes == 0 || !isPowerOf2_32(HashTableSize) ||
+      !InBuffer(Field(HF_NodesOffset), uint64_t(NumNodes) * NF_NumFields * 4) ||
+      !InBuffer(Field(HF_HashTableOffset), uint64_t(HashTableSize) * 4) ||
+      !InBuffer(Field(HF_StringsOffset), Field(HF_StringsSize)))
+    return nullptr;
+
+  std::unique_ptr<BinaryOverlayFileSystem> FS(
+      new BinaryOverlayFileSystem(std::move(Buffer), std::move(ExternalFS)));
+  FS->Flags = Field(HF_Flags);
+  FS->NumNodes = NumNodes;
+  FS->Nodes = Data.data() + Field(HF_NodesOffset);
+  FS->HashTableSize = HashTableSize;
+  FS->HashTable = Data.data() + Field(HF_HashTableOffset);
+  FS->Strings = Data.data() + Field(HF_StringsOffset);
+  FS->StringsSize = Field(HF_StringsSize);
+  FS->FirstFileID = reserveVirtualFileIDs(NumNodes);
+  FS->DirectoryMTime = std::chrono::system_clock::now();
+
+  Node Root;
+  if (!FS->getNode(0, Root) || Root.Kind != EK_Directory)
+    return nullptr;
+
+  if (FS->Flags & F_OverlayRelative) {
+    SmallString<256> OverlayAbsDir = sys::path::parent_path(OverlayFilePath);
+    std::error_code EC = llvm::sys::fs::make_absolute(OverlayAbsDir);
+    assert(!EC && "Overlay dir final path must be absolute");
+    (void)EC;
+    FS->ExternalContentsPrefixDir = OverlayAbsDir.str();
+  }
+
+  return FS.release();
+}
+
+bool BinaryOverlayFileSystem::getNode(uint32_t Index, Node &N) const {
+  using namespace binary_overlay;
+  if (Index >= NumNodes)
+    return false;
+  const char *Data = Nodes + uint64_t(Index) * NF_NumFields * 4;
+  auto Field = [Data](NodeField F) {
+    return llvm::support::endian::read32le(Data + F * 4);
+  };
+  auto GetString = [&](NodeField OffsetField, NodeField SizeField,
+                       StringRef &Str) {
+    uint32_t Offset = Field(OffsetField), Size = Field(SizeField);
+    if (Offset > StringsSize || Size > StringsSize - Offset)
+      return false;
+    Str = StringRef(Strings + Offset, Size);
+    return true;
+  };
+
+  uint32_t Kind = Field(NF_Kind);
+  uint32_t FirstChild = Field(NF_FirstChild);
+  uint32_t NumChildren = Field(NF_NumChildren);
+  if ((Kind & 0xff) > EK_File ||
+      (Kind >> 8) > RedirectingFileEntry::NK_Virtual ||
+      FirstChild > NumNodes || NumChildren > NumNodes - FirstChild)
+    return false;
+
+  N.Kind = static_cast<EntryKind>(Kind & 0xff);
+  N.UseName = static_cast<RedirectingFileEntry::NameKind>(Kind >> 8);
+  N.Parent = Field(NF_Parent);
+  N.FirstChild = FirstChild;
+  N.NumChildren = NumChildren;
+  return GetString(NF_NameOffset, NF_NameSize, N.Name) &&
+         GetString(NF_ExternalOffset, NF_ExternalSize, N.ExternalContents);
+}
+
+ErrorOr<uint32_t>
+BinaryOverlayFileSystem::lookupPath(const Twine &Path_) const {
+  SmallString<256> Path;
+  Path_.toVector(Path);
+
+  // Handle relative paths
+  if (std::error_code EC = makeAbsolute(Path))
+    return EC;
+
+  // Canonicalize the path the same way RedirectingFileSystem does.
+#ifndef LLVM_ON_WIN32
+  Path = sys::path::remove_leading_dotslash(Path);
+  sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+#endif
+
+  if (Path.empty())
+    return make_error_code(llvm::errc::invalid_argument);
+
+  return lookupPath(sys::path::begin(Path), sys::path::end(Path), 0);
+}
+
+ErrorOr<uint32_t>
+BinaryOverlayFileSystem::lookupPath(sys::path::const_iterator Start,
+                                    sys::path::const_iterator End,
+                                    uint32_t Dir) const {
+  StringRef Component = *Start;
+  sys::path::const_iterator Next = Start;
+  ++Next;
+
+  // Visit the children of Dir named Component in the order of the overlay;
+  // like in RedirectingFileSystem, a directory that does not contain the
+  // rest of the path lets the search continue with the next one.
+  bool CaseSensitive = isCaseSensitive();
+  uint32_t Mask = HashTableSize - 1;
+  uint32_t Slot =
+      binary_overlay::hashComponent(Dir, Component, CaseSensitive) & Mask;
+  for (uint32_t Probes = 0; Probes != HashTableSize;
+       ++Probes, Slot = (Slot + 1) & Mask) {
+    uint32_t Value = llvm::support::endian::read32le(HashTable + Slot * 4);
+    if (Value == 0)
+      break;
+
+    Node N;
+    if (!getNode(Value - 1, N))
+      return make_error_code(llvm::errc::invalid_argument);
+    if (N.Parent != Dir || !(CaseSensitive ? Component.equals(N.Name)
+                                           : Component.equals_lower(N.Name)))
+      continue;
+
+    if (Next == End)
+      return Value - 1;
+    if (N.Kind != EK_Directory)
+      return make_error_code(llvm::errc::not_a_directory);
+
+    ErrorOr<uint32_t> Result = lookupPath(Next, End, Value - 1);
+    if (Result || Result.getError() != llvm::errc::no_such_file_or_directory)
+      return Result;
+  }
+  return make_error_code(llvm::errc::no_such_file_or_directory);
+}
+
+std::string
+BinaryOverlayFileSystem::getExternalContentsPath(const Node &N) const {
+  if (ExternalContentsPrefixDir.empty())
+    return N.ExternalContents;
+  SmallString<256> Path(ExternalContentsPrefixDir);
+  sys::path::append(Path, N.ExternalContents);
+  return Path.str();
+}
+
+ErrorOr<Status> BinaryOverlayFileSystem::status(const Twine &Path,
+                                                uint32_t Index,
+                                                const Node &N) const {
+  if (N.Kind == EK_Directory)
+    return Status(Path.str(), getVirtualUniqueID(FirstFileID + Index),
+                  DirectoryMTime, 0, 0, 0, file_type::directory_file,
+                  sys::fs::all_all);
+
+  std::string ExternalPath = getExternalContentsPath(N);
+  ErrorOr<Status> S = ExternalFS->status(ExternalPath);
+  if (!S)
+    return S;
+  bool UseExternalName =
+      N.UseName == RedirectingFileEntry::NK_NotSet
+          ? (Flags & binary_overlay::F_UseExternalNames)
+          : N.UseName == RedirectingFileEntry::NK_External;
+  return getRedirectedFileStatus(Path, UseExternalName, *S);
+}
+
+ErrorOr<Status> BinaryOverlayFileSystem::status(const Twine &Path) {
+  ErrorOr<uint32_t> Index = lookupPath(Path);
+  if (!Index)
+    return Index.getError();
+  Node N;
+  if (!getNode(*Index, N))
+    return make_error_code(llvm::errc::invalid_argument);
+  return status(Path, *Index, N);
+}
+
+ErrorOr<std::unique_ptr<File>>
+BinaryOverlayFileSystem::openFileForRead(const Twine &Path) {
+  ErrorOr<uint32_t> Index = lookupPath(Path);
+  if (!Index)
+    return Index.getError();
+  Node N;
+  if (!getNode(*Index, N))
+    return make_error_code(llvm::errc::invalid_argument);
+  if (N.Kind != EK_File) // FIXME: errc::not_a_file?
+    return make_error_code(llvm::errc::invalid_argument);
+
+  auto Result = ExternalFS->openFileForRead(getExternalContentsPath(N));
+  if (!Result)
+    return Result;
+
+  auto ExternalStatus = (*Result)->status();
+  if (!ExternalStatus)
+    return ExternalStatus.getError();
+
+  bool UseExternalName =
+      N.UseName == RedirectingFileEntry::NK_NotSet
+          ? (Flags & binary_overlay::F_UseExternalNames)
+          : N.UseName == RedirectingFileEntry::NK_External;
+  Status S = getRedirectedFileStatus(Path, UseExternalName, *ExternalStatus);
+  return std::unique_ptr<File>(
+      llvm::make_unique<FileWithFixedStatus>(std::move(*Result), S));
+}
+
+directory_iterator BinaryOverlayFileSystem::dir_begin(const Twine &Dir,
+                                                      std::error_code &EC) {
+  ErrorOr<uint32_t> Index = lookupPath(Dir);
+  if (!Index) {
+    EC = Index.getError();
+    return directory_iterator();
+  }
+  Node N;
+  if (!getNode(*Index, N)) {
+    EC = make_error_code(llvm::errc::invalid_argument);
+    return directory_iterator();
+  }
+  if (N.Kind != EK_Directory) {
+    EC = std::error_code(static_cast<int>(errc::not_a_directory),
+                         std::system_category());
+    return directory_iterator();
+  }
+
+  std::vector<StringRef> Names;
+  for (uint32_t I = N.FirstChild, E = N.FirstChild + N.NumChildren; I != E;
+       ++I) {
+    Node Child;
+    if (!getNode(I, Child)) {
+      EC = make_error_code(llvm::errc::invalid_argument);
+      return directory_iterator();
+    }
+    Names.push_back(Child.Name);
+  }
+  return directory_iterator(std::make_shared<BinaryOverlayDirIterImpl>(
+      Dir, *this, std::move(Names), EC));
+}
+
+void BinaryOverlayFileSystem::collectEntries(
+    uint32_t Index, SmallVectorImpl<StringRef> &Path,
+    SmallVectorImpl<YAMLVFSEntry> &Entries) const {
+  Node N;
+  if (!getNode(Index, N))
+    return;
+
+  if (N.Kind == EK_File) {
+    SmallString<128> VPath;
+    for (StringRef Comp : Path)
+      llvm::sys::path::append(VPath, Comp);
+    Entries.push_back(YAMLVFSEntry(VPath.c_str(), getExternalContentsPath(N)));
+    return;
+  }
+
+  for (uint32_t I = N.FirstChild, E = N.FirstChild + N.NumChildren; I != E;
+       ++I) {
+    Node Child;
+    if (!getNode(I, Child))
+      return;
+    Path.push_back(Child.Name);
+    collectEntries(I, Path, Entries);
+    Path.pop_back();
+  }
+}
+
+std::error_code BinaryOverlayDirIterImpl::settle() {
+  for (; Current != End; ++Current) {
+    SmallString<128> PathStr(Dir);
+    llvm::sys::path::append(PathStr, Names[Current]);
+    llvm::ErrorOr<vfs::Status> S = FS.status(PathStr);
+    if (S) {
+      CurrentEntry = *S;
+      return std::error_code();
+    }
+    // Skip entries which do not map to a reliable external content.
+    if (!FS.ignoreNonExistentContents() ||
+        S.getError() != llvm::errc::no_such_file_or_directory)
+      return S.getError();
+  }
+  CurrentEntry = Status();
+  return std::error_code();
+}
+
+bool vfs::isBinaryVFSOverlay(const MemoryBuffer &Buffer) {
+  return Buffer.getBuffer().startswith(
+      StringRef(binary_overlay::Magic, sizeof(binary_overlay::Magic)));
+}
+
+IntrusiveRefCntPtr<FileSystem>
+vfs::getVFSFromBinaryOverlay(std::unique_ptr<MemoryBuffer> Buffer,
+                             StringRef OverlayFilePath,
+                             IntrusiveRefCntPtr<FileSystem> ExternalFS) {
+  return BinaryOverlayFileSystem::create(std::move(Buffer), OverlayFilePath,
+                                         std::move(ExternalFS));
+}
+
+bool vfs::writeBinaryVFSOverlay(std::unique_ptr<MemoryBuffer> YAMLBuffer,
+                                SourceMgr::DiagHandlerTy DiagHandler,
+                                StringRef YAMLFilePath, raw_ostream &OS,
+                                void *DiagContext) {
+  IntrusiveRefCntPtr<RedirectingFileSystem> FS =
+      RedirectingFileSystem::create(std::move(YAMLBuffer), DiagHandler,
+                                    YAMLFilePath, DiagContext,
+                                    getRealFileSystem());
+  if (!FS)
+    return false;
+  FS->writeBinaryOverlay(OS);
+  return true;
+}
+
+static void collectVFSFromBinaryOverlay(
+    std::unique_ptr<MemoryBuffer> Buffer, StringRef OverlayFilePath,
+    SmallVectorImpl<YAMLVFSEntry> &CollectedEntries,
+    IntrusiveRefCntPtr<FileSystem> ExternalFS) {
+  IntrusiveRefCntPtr<BinaryOverlayFileSystem> FS =
+      BinaryOverlayFileSystem::create(std::move(Buffer), OverlayFilePath,
+                                      std::move(ExternalFS));
+  if (!FS)
+    return;
+  ErrorOr<uint32_t> RootIndex = FS->lookupPath("/");
+  if (!RootIndex)
+    return;
+  SmallVector<StringRef, 8> Components;
+  Components.push_back("/");
+  FS->collectEntries(*RootIndex, Components, CollectedEntries);
 }
 
 void YAMLVFSWriter::addFileMapping(StringRef VirtualPath, StringRef RealPath) {
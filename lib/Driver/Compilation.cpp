@@ -14,9 +14,14 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <condition_variable>
+#include <mutex>
 
 using namespace clang::driver;
 using namespace clang;
@@ -27,7 +32,7 @@ Compilation::Compilation(const Driver &D, const ToolChain &_DefaultToolChain,
                          bool ContainsError)
     : TheDriver(D), DefaultToolChain(_DefaultToolChain), ActiveOffloadMask(0u),
       Args(_Args), TranslatedArgs(_TranslatedArgs), Redirects(nullptr),
-      ForDiagnostics(false), ContainsError(ContainsError) {
+      ForDiagnostics(false), ContainsError(ContainsError), NumParallelJobs(1) {
   // The offloading host toolchain is the default tool chain.
   OrderedOffloadingToolchains.insert(
       std::make_pair(Action::OFK_Host, &DefaultToolChain));
@@ -122,43 +127,50 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
-  if ((getDriver().CCPrintOptions ||
-       getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
-    raw_ostream *OS = &llvm::errs();
-
-    // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
-    // output stream.
-    if (getDriver().CCPrintOptions && getDriver().CCPrintOptionsFilename) {
-      std::error_code EC;
-      OS = new llvm::raw_fd_ostream(getDriver().CCPrintOptionsFilename, EC,
-                                    llvm::sys::fs::F_Append |
-                                        llvm::sys::fs::F_Text);
-      if (EC) {
-        getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
-            << EC.message();
-        FailingCommand = &C;
-        delete OS;
-        return 1;
-      }
+/// Print the command if requested by -v or CC_PRINT_OPTIONS.
+///
+/// \returns true if the command could not be logged.
+static bool PrintCommand(const Compilation &Comp, const Command &C) {
+  const Driver &D = Comp.getDriver();
+  if ((!D.CCPrintOptions && !Comp.getArgs().hasArg(options::OPT_v)) ||
+      D.CCGenDiagnostics)
+    return false;
+
+  raw_ostream *OS = &llvm::errs();
+
+  // Follow gcc implementation of CC_PRINT_OPTIONS; we could also cache the
+  // output stream.
+  if (D.CCPrintOptions && D.CCPrintOptionsFilename) {
+    std::error_code EC;
+    OS = new llvm::raw_fd_ostream(D.CCPrintOptionsFilename, EC,
+                                  llvm::sys::fs::F_Append |
+                                      llvm::sys::fs::F_Text);
+    if (EC) {
+      D.Diag(clang::diag::err_drv_cc_print_options_failure) << EC.message();
+      delete OS;
+      return true;
     }
+  }
 
-    if (getDriver().CCPrintOptions)
-      *OS << "[Logging clang options]";
+  if (D.CCPrintOptions)
+    *OS << "[Logging clang options]";
 
-    C.Print(*OS, "\n", /*Quote=*/getDriver().CCPrintOptions);
+  C.Print(*OS, "\n", /*Quote=*/D.CCPrintOptions);
 
-    if (OS != &llvm::errs())
-      delete OS;
-  }
+  if (OS != &llvm::errs())
+    delete OS;
+  return false;
+}
 
-  std::string Error;
-  bool ExecutionFailed;
-  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+/// Report the outcome of executing a command.
+///
+/// \returns the result code of the command.
+static int FinishCommand(const Compilation &Comp, const Command &C, int Res,
+                         StringRef Error, bool ExecutionFailed,
+                         const Command *&FailingCommand) {
   if (!Error.empty()) {
     assert(Res && "Error string set with 0 result code!");
-    getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
+    Comp.getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
   }
 
   if (Res)
@@ -167,18 +179,164 @@ int Compilation::ExecuteCommand(const Command &C,
   return ExecutionFailed ? 1 : Res;
 }
 
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (PrintCommand(*this, C)) {
+    FailingCommand = &C;
+    return 1;
+  }
+
+  std::string Error;
+  bool ExecutionFailed;
+  int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  return FinishCommand(*this, C, Res, Error, ExecutionFailed, FailingCommand);
+}
+
+/// Compute, for each job, the earlier jobs it has to wait for: the ones whose
+/// outputs it consumes, and the ones writing the same result file.
+static void
+ComputeJobDependencies(const Compilation &Comp,
+                       ArrayRef<const Command *> Commands,
+                       std::vector<SmallVector<unsigned, 4>> &Dependencies) {
+  Dependencies.resize(Commands.size());
+  for (unsigned I = 0, E = Commands.size(); I != E; ++I) {
+    // A job consumes the outputs of the jobs whose actions its own action
+    // (transitively) takes as inputs.
+    llvm::SmallPtrSet<const Action *, 16> Inputs;
+    SmallVector<const Action *, 16> Worklist(
+        Commands[I]->getSource().input_begin(),
+        Commands[I]->getSource().input_end());
+    while (!Worklist.empty()) {
+      const Action *A = Worklist.pop_back_val();
+      if (Inputs.insert(A).second)
+        Worklist.append(A->input_begin(), A->input_end());
+    }
+
+    const JobAction *JA = dyn_cast<JobAction>(&Commands[I]->getSource());
+    const char *ResultFile = JA ? Comp.getResultFiles().lookup(JA) : nullptr;
+    for (unsigned J = 0; J != I; ++J) {
+      const Action *Source = &Commands[J]->getSource();
+      bool SameResultFile = false;
+      if (ResultFile) {
+        if (const auto *JJA = dyn_cast<JobAction>(Source)) {
+          const char *Other = Comp.getResultFiles().lookup(JJA);
+          SameResultFile = Other && StringRef(Other) == ResultFile;
+        }
+      }
+      if (Source == &Commands[I]->getSource() || Inputs.count(Source) ||
+          SameResultFile)
+        Dependencies[I].push_back(J);
+    }
+  }
+}
+
 void Compilation::ExecuteJobs(
     const JobList &Jobs,
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
-  for (const auto &Job : Jobs) {
-    const Command *FailingCommand = nullptr;
-    if (int Res = ExecuteCommand(Job, FailingCommand)) {
-      FailingCommands.push_back(std::make_pair(Res, FailingCommand));
-      // Bail as soon as one command fails, so we don't output duplicate error
-      // messages if we die on e.g. the same file.
-      return;
+  if (NumParallelJobs == 1 || Jobs.size() < 2 ||
+      !llvm::llvm_is_multithreaded()) {
+    for (const auto &Job : Jobs) {
+      const Command *FailingCommand = nullptr;
+      if (int Res = ExecuteCommand(Job, FailingCommand)) {
+        FailingCommands.push_back(std::make_pair(Res, FailingCommand));
+        // Bail as soon as one command fails, so we don't output duplicate
+        // error messages if we die on e.g. the same file.
+        return;
+      }
     }
+    return;
   }
+
+  SmallVector<const Command *, 8> Commands;
+  for (const auto &Job : Jobs)
+    Commands.push_back(&Job);
+
+  std::vector<SmallVector<unsigned, 4>> Dependencies;
+  ComputeJobDependencies(*this, Commands, Dependencies);
+
+  enum JobState { Pending, Running, Succeeded, Failed };
+  struct JobResult {
+    int Res = 0;
+    std::string Error;
+    bool ExecutionFailed = false;
+  };
+  std::vector<JobState> States(Commands.size(), Pending);
+  std::vector<JobResult> Results(Commands.size());
+
+  // Jobs only execute the command on the pool; printing, diagnostics and
+  // scheduling happen on this thread.
+  std::mutex Mutex;
+  std::condition_variable CompletionCV;
+  std::vector<unsigned> Completed;
+  llvm::ThreadPool Pool(std::min<unsigned>(NumParallelJobs, Commands.size()));
+
+  typedef std::pair<unsigned, std::pair<int, const Command *>> JobFailure;
+  SmallVector<JobFailure, 4> Failures;
+  unsigned NumRunning = 0;
+  while (true) {
+    // Start every job whose dependencies succeeded. As in sequential mode, no
+    // new job is started once one failed.
+    for (unsigned I = 0, E = Commands.size(); I != E && Failures.empty();
+         ++I) {
+      if (States[I] != Pending ||
+          llvm::any_of(Dependencies[I], [&](unsigned Dep) {
+            return States[Dep] != Succeeded;
+          }))
+        continue;
+
+      if (PrintCommand(*this, *Commands[I])) {
+        States[I] = Failed;
+        Failures.push_back(std::make_pair(I, std::make_pair(1, Commands[I])));
+        break;
+      }
+
+      States[I] = Running;
+      ++NumRunning;
+      const Command *C = Commands[I];
+      Pool.async([&, I, C] {
+        JobResult Result;
+        Result.Res =
+            C->Execute(Redirects, &Result.Error, &Result.ExecutionFailed);
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Results[I] = std::move(Result);
+        Completed.push_back(I);
+        CompletionCV.notify_one();
+      });
+    }
+
+    if (!NumRunning)
+      break;
+
+    std::vector<unsigned> Finished;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      CompletionCV.wait(Lock, [&] { return !Completed.empty(); });
+      Finished.swap(Completed);
+    }
+
+    for (unsigned I : Finished) {
+      --NumRunning;
+      const JobResult &Result = Results[I];
+      const Command *FailingCommand = nullptr;
+      if (int Res = FinishCommand(*this, *Commands[I], Result.Res,
+                                  Result.Error, Result.ExecutionFailed,
+                                  FailingCommand)) {
+        States[I] = Failed;
+        Failures.push_back(
+            std::make_pair(I, std::make_pair(Res, FailingCommand)));
+      } else {
+        States[I] = Succeeded;
+      }
+    }
+  }
+
+  // Report failures in job order, independently of which finished first.
+  std::sort(Failures.begin(), Failures.end(),
+            [](const JobFailure &LHS, const JobFailure &RHS) {
+              return LHS.first < RHS.first;
+            });
+  for (const auto &Failure : Failures)
+    FailingCommands.push_back(Failure.second);
 }
 
 void Compilation::initCompilationForDiagnostics() {
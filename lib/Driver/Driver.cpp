@@ -91,7 +91,8 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
       DriverTitle("clang LLVM compiler"), CCPrintOptionsFilename(nullptr),
       CCPrintHeadersFilename(nullptr), CCLogDiagnosticsFilename(nullptr),
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-      CCGenDiagnostics(false), DefaultTargetTriple(DefaultTargetTriple),
+      CCGenDiagnostics(false), CC1Main(nullptr),
+      DefaultTargetTriple(DefaultTargetTriple),
       CCCGenericGCCName(""), CheckInputsExist(true), CCCUsePCH(true),
       GenReproducer(false), SuppressMissingInputWarning(false) {
 
@@ -723,6 +724,16 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   Compilation *C = new Compilation(*this, TC, UArgs.release(), TranslatedArgs,
                                    ContainsError);
 
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_parallel_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    unsigned NumJobs;
+    if (Value.getAsInteger(10, NumJobs) || NumJobs == 0)
+      Diag(diag::err_drv_invalid_int_value)
+          << A->getAsString(C->getArgs()) << Value;
+    else
+      C->setNumParallelJobs(NumJobs);
+  }
+
   if (!HandleImmediateArgs(*C))
     return C;
 
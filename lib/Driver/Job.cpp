@@ -15,10 +15,13 @@
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
@@ -420,6 +423,54 @@ int ForceSuccessCommand::Execute(const StringRef **Redirects,
   return 0;
 }
 
+CC1Command::CC1Command(const Action &Source_, const Tool &Creator_,
+                       const char *Executable_,
+                       const ArgStringList &Arguments_,
+                       ArrayRef<InputInfo> Inputs)
+    : Command(Source_, Creator_, Executable_, Arguments_, Inputs) {}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  const Driver &D = getCreator().getToolChain().getDriver();
+  if (!D.CC1Main || Redirects || hasEnvironment())
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+
+  // The arguments are passed directly, so there is no need for the response
+  // file even if one was set up.
+  SmallVector<const char *, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  // The job writes to the same streams as the driver; keep the output of
+  // each in order.
+  llvm::outs().flush();
+  llvm::errs().flush();
+  auto FlushJobOutput = llvm::make_scope_exit([] {
+    llvm::outs().flush();
+    llvm::errs().flush();
+  });
+
+  // Catch crashes of the job so that they are reported like those of a job
+  // run in a process of its own, instead of taking down the driver. Only
+  // for the job: a crash of the driver itself should still be fatal.
+  llvm::CrashRecoveryContext::Enable();
+  auto DisableCrashRecovery =
+      llvm::make_scope_exit([] { llvm::CrashRecoveryContext::Disable(); });
+  llvm::CrashRecoveryContext CRC;
+  int Res = 1;
+  if (!CRC.RunSafely([&] { Res = D.CC1Main(Argv); })) {
+    // The job did not get to uninstall its fatal error handler, which refers
+    // to its (now gone) diagnostics engine.
+    llvm::remove_fatal_error_handler();
+    // Pretend the job was killed by a signal.
+    return -2;
+  }
+  return Res;
+}
+
 void JobList::Print(raw_ostream &OS, const char *Terminator, bool Quote,
                     CrashReportInfo *CrashInfo) const {
   for (const auto &Job : *this)
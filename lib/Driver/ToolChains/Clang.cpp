@@ -2098,10 +2098,17 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   if (C.getDriver().embedBitcodeMarkerOnly() && !C.getDriver().isUsingLTO())
     CmdArgs.push_back("-fembed-bitcode=marker");
 
+  // Run the job in the driver's process if asked to. The tool's globals are
+  // not safe to share between jobs running at the same time.
+  bool InProcess = Args.hasFlag(options::OPT_fintegrated_cc1,
+                                options::OPT_fno_integrated_cc1, false) &&
+                   D.CC1Main && C.getNumParallelJobs() == 1;
+
   // We normally speed up the clang process a bit by skipping destructors at
   // exit, but when we're generating diagnostics we can rely on some of the
-  // cleanup.
-  if (!C.isForDiagnostics())
+  // cleanup. A job run in the driver's process has to free its memory, or it
+  // piles up over the jobs of the compilation.
+  if (!C.isForDiagnostics() && !InProcess)
     CmdArgs.push_back("-disable-free");
 
 // Disable the verification pass in -asserts builds.
@@ -3274,6 +3281,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -3712,6 +3721,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_use_line_directives, false))
     CmdArgs.push_back("-fuse-line-directives");
 
+  if (Args.hasFlag(options::OPT_fcompress_preprocessed_output,
+                   options::OPT_fno_compress_preprocessed_output, false))
+    CmdArgs.push_back("-fcompress-preprocessed-output");
+
   // -fms-compatibility=0 is default.
   if (Args.hasFlag(options::OPT_fms_compatibility,
                    options::OPT_fno_ms_compatibility,
@@ -4451,6 +4464,18 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back("-fwhole-program-vtables");
   }
 
+  // -mllvm options, whether given by the user or added by the toolchain, set
+  // the values of the global LLVM options, which cannot be restored once the
+  // job is done; they would leak into the next jobs. Such a job gets a
+  // process of its own.
+  if (InProcess && llvm::any_of(CmdArgs, [](const char *Arg) {
+        return StringRef(Arg) == "-mllvm";
+      })) {
+    InProcess = false;
+    if (!C.isForDiagnostics())
+      CmdArgs.push_back("-disable-free");
+  }
+
   // Finally add the compile command to the compilation.
   if (Args.hasArg(options::OPT__SLASH_fallback) &&
       Output.getType() == types::TY_Object &&
@@ -4465,6 +4490,9 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     // fails, so that the main compilation's fallback to cl.exe runs.
     C.addCommand(llvm::make_unique<ForceSuccessCommand>(JA, *this, Exec,
                                                         CmdArgs, Inputs));
+  } else if (InProcess) {
+    C.addCommand(
+        llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs, Inputs));
   } else {
     C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
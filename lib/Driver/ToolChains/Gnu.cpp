@@ -14,6 +14,7 @@
 #include "Arch/Sparc.h"
 #include "Arch/SystemZ.h"
 #include "CommonArgs.h"
+#include "clang/Basic/Version.h"
 #include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Config/config.h" // for GCC_INSTALL_PREFIX
 #include "clang/Driver/Compilation.h"
@@ -23,8 +24,12 @@
 #include "clang/Driver/Tool.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetParser.h"
+#include <chrono>
 #include <system_error>
 
 using namespace clang::driver;
@@ -1667,11 +1672,76 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args) {
   return GCC_INSTALL_PREFIX;
 }
 
+/// The first line of a cached GCC installation, identifying the format.
+static const char GCCInstallCacheMagic[] = "clang-gcc-installation-cache-v1";
+
+/// \brief Compute the file caching the GCC installation detected with the
+/// given inputs, if --toolchain-cache is given, along with the inputs the
+/// cached result is valid for.
+static bool getGCCInstallCacheFile(const Driver &D,
+                                   const llvm::Triple &TargetTriple,
+                                   const ArgList &Args,
+                                   ArrayRef<std::string> ExtraTripleAliases,
+                                   SmallVectorImpl<char> &CacheFile,
+                                   std::vector<std::string> &Key) {
+  const Arg *A = Args.getLastArg(options::OPT_toolchain_cache_EQ);
+  if (!A)
+    return false;
+
+  // Solaris installations are laid out differently; they are not cached.
+  if (TargetTriple.getOS() == llvm::Triple::Solaris)
+    return false;
+
+  Key.push_back(getClangFullVersion());
+  Key.push_back("triple=" + TargetTriple.str());
+  for (const std::string &Alias : ExtraTripleAliases)
+    Key.push_back("alias=" + Alias);
+  Key.push_back("sysroot=" + D.SysRoot);
+  Key.push_back("installed-dir=" + D.InstalledDir);
+  for (const std::string &Prefix : D.PrefixDirs)
+    Key.push_back("prefix=" + Prefix);
+  Key.push_back(("gcc-toolchain=" + getGCCToolchainDir(Args)).str());
+  // The multilibs an installation must provide, and so the installation that
+  // is picked, depend on the target flags.
+  for (const Arg *MArg : Args.filtered(options::OPT_m_Group))
+    Key.push_back(MArg->getAsString(Args));
+
+  llvm::MD5 Hash;
+  for (const std::string &Component : Key) {
+    if (StringRef(Component).count('\n'))
+      return false;
+    Hash.update(Component);
+    Hash.update(StringRef("\0", 1));
+  }
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> HashStr;
+  llvm::MD5::stringifyResult(Result, HashStr);
+
+  CacheFile.assign(A->getValue(), A->getValue() + strlen(A->getValue()));
+  llvm::sys::path::append(CacheFile, "gcc-installation-" + HashStr);
+  return true;
+}
+
+/// \brief Describe the state of a path the detection looked at: whether it
+/// exists and, if it does, when it was last modified.
+static std::string getProbeStamp(vfs::FileSystem &FS, StringRef Path) {
+  llvm::ErrorOr<vfs::Status> Status = FS.status(Path);
+  if (!Status)
+    return "none";
+  auto MTime = Status->getLastModificationTime().time_since_epoch();
+  return std::to_string(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(MTime).count());
+}
+
 /// \brief Initialize a GCCInstallationDetector from the driver.
 ///
 /// This performs all of the autodetection and sets up the various paths.
 /// Once constructed, a GCCInstallationDetector is essentially immutable.
 ///
+/// With --toolchain-cache, the result is reused from an earlier run with the
+/// same inputs as long as none of the paths that were looked at changed.
+///
 /// FIXME: We shouldn't need an explicit TargetTriple parameter here, and
 /// should instead pull the target out of the driver. This is currently
 /// necessary because the driver doesn't store the final version of the target
@@ -1679,6 +1749,160 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args) {
 void Generic_GCC::GCCInstallationDetector::init(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     ArrayRef<std::string> ExtraTripleAliases) {
+  SmallString<128> CacheFile;
+  std::vector<std::string> CacheKey;
+  if (getGCCInstallCacheFile(D, TargetTriple, Args, ExtraTripleAliases,
+                             CacheFile, CacheKey) &&
+      loadFromCache(CacheFile, CacheKey, TargetTriple, Args))
+    return;
+
+  RecordProbes = !CacheFile.empty();
+  detect(TargetTriple, Args, ExtraTripleAliases);
+  if (RecordProbes) {
+    storeToCache(CacheFile, CacheKey);
+    RecordProbes = false;
+    ProbedPaths.clear();
+  }
+}
+
+bool Generic_GCC::GCCInstallationDetector::loadFromCache(
+    StringRef CacheFile, ArrayRef<std::string> Key,
+    const llvm::Triple &TargetTriple, const ArgList &Args) {
+  // The cache lives outside of the files the compilation sees, so read it
+  // from the real file system.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+      llvm::MemoryBuffer::getFile(CacheFile);
+  if (!File)
+    return false;
+
+  SmallVector<StringRef, 64> Lines;
+  File.get()->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines[0] != GCCInstallCacheMagic)
+    return false;
+
+  size_t NumKeyComponents = 0;
+  std::set<std::string> Candidates;
+  StringRef InstallPath, ParentLibPath, Triple, VersionText;
+  bool NeedsBiarch = false;
+  for (StringRef Line : makeArrayRef(Lines).slice(1)) {
+    StringRef Kind, Value;
+    std::tie(Kind, Value) = Line.split('\t');
+    if (Kind == "key") {
+      if (NumKeyComponents == Key.size() || Value != Key[NumKeyComponents])
+        return false;
+      ++NumKeyComponents;
+    } else if (Kind == "probe") {
+      StringRef Stamp, Path;
+      std::tie(Stamp, Path) = Value.split('\t');
+      if (Stamp != getProbeStamp(D.getVFS(), Path))
+        return false;
+    } else if (Kind == "candidate") {
+      Candidates.insert(Value);
+    } else if (Kind == "install") {
+      InstallPath = Value;
+    } else if (Kind == "parent-lib") {
+      ParentLibPath = Value;
+    } else if (Kind == "triple") {
+      Triple = Value;
+    } else if (Kind == "version") {
+      VersionText = Value;
+    } else if (Kind == "biarch") {
+      NeedsBiarch = Value == "1";
+    } else {
+      return false;
+    }
+  }
+  if (NumKeyComponents != Key.size())
+    return false;
+
+  // No installation was found, and nothing has changed since.
+  if (InstallPath.empty()) {
+    CandidateGCCInstallPaths = std::move(Candidates);
+    return true;
+  }
+
+  // The multilibs also depend on flags that are not part of the key, and only
+  // take a few probes of the selected installation; select them again.
+  if (!ScanGCCForMultilibs(TargetTriple, Args, InstallPath, NeedsBiarch))
+    return false;
+
+  CandidateGCCInstallPaths = std::move(Candidates);
+  GCCInstallPath = InstallPath;
+  GCCParentLibPath = ParentLibPath;
+  GCCTriple.setTriple(Triple);
+  Version = GCCVersion::Parse(VersionText);
+  SelectedNeedsBiarchSuffix = NeedsBiarch;
+  IsValid = true;
+  return true;
+}
+
+void Generic_GCC::GCCInstallationDetector::storeToCache(
+    StringRef CacheFile, ArrayRef<std::string> Key) const {
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  bool CanCache = true;
+  auto Emit = [&](StringRef Kind, StringRef Value) {
+    if (Value.count('\n'))
+      CanCache = false;
+    OS << Kind << '\t' << Value << '\n';
+  };
+
+  OS << GCCInstallCacheMagic << '\n';
+  for (const std::string &Component : Key)
+    Emit("key", Component);
+
+  // Creating or removing a path changes the modification time of its parent
+  // directory, so checking the parents of the probed paths as well catches
+  // installations that appear later, too.
+  std::set<std::string> Paths;
+  for (const std::string &Path : ProbedPaths) {
+    Paths.insert(Path);
+    StringRef Parent = llvm::sys::path::parent_path(Path);
+    if (!Parent.empty())
+      Paths.insert(Parent);
+  }
+  for (const std::string &Path : Paths)
+    Emit("probe", getProbeStamp(D.getVFS(), Path) + "\t" + Path);
+
+  for (const std::string &Candidate : CandidateGCCInstallPaths)
+    Emit("candidate", Candidate);
+  if (IsValid) {
+    Emit("install", GCCInstallPath);
+    Emit("parent-lib", GCCParentLibPath);
+    Emit("triple", GCCTriple.str());
+    Emit("version", Version.Text);
+    Emit("biarch", SelectedNeedsBiarchSuffix ? "1" : "0");
+  }
+  OS.flush();
+  if (!CanCache)
+    return;
+
+  // The cache is only an optimization, so failing to write it is not an
+  // error. Write a temporary file and rename it, so that concurrent runs
+  // never see a partial entry.
+  llvm::sys::fs::create_directories(llvm::sys::path::parent_path(CacheFile));
+  SmallString<128> TmpPath;
+  int TmpFD;
+  if (llvm::sys::fs::createUniqueFile(CacheFile + "-%%%%%%%%", TmpFD,
+                                      TmpPath))
+    return;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpPath, CacheFile))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+void Generic_GCC::GCCInstallationDetector::detect(
+    const llvm::Triple &TargetTriple, const ArgList &Args,
+    ArrayRef<std::string> ExtraTripleAliases) {
   llvm::Triple BiarchVariantTriple = TargetTriple.isArch32Bit()
                                          ? TargetTriple.get64BitArchVariant()
                                          : TargetTriple.get32BitArchVariant();
@@ -1746,10 +1970,12 @@ void Generic_GCC::GCCInstallationDetector::init(
   // installation available. GCC installs are ranked by version number.
   Version = GCCVersion::Parse("0.0.0");
   for (const std::string &Prefix : Prefixes) {
+    noteProbedPath(Prefix);
     if (!D.getVFS().exists(Prefix))
       continue;
     for (StringRef Suffix : CandidateLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      noteProbedPath(LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : ExtraTripleAliases) // Try these first.
@@ -1759,6 +1985,7 @@ void Generic_GCC::GCCInstallationDetector::init(
     }
     for (StringRef Suffix : CandidateBiarchLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
+      noteProbedPath(LibDir);
       if (!D.getVFS().exists(LibDir))
         continue;
       for (StringRef Candidate : CandidateBiarchTripleAliases)
@@ -2182,6 +2409,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       continue;
 
     StringRef LibSuffix = Suffix.LibSuffix;
+    noteProbedPath(LibDir + "/" + LibSuffix.str());
     std::error_code EC;
     for (vfs::directory_iterator
              LI = D.getVFS().dir_begin(LibDir + "/" + LibSuffix, EC),
@@ -2197,6 +2425,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       if (CandidateVersion <= Version)
         continue;
 
+      noteProbedPath(LI->getName());
       if (!ScanGCCForMultilibs(TargetTriple, Args, LI->getName(),
                                NeedsBiarchSuffix))
         continue;
@@ -2208,6 +2437,7 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       // Linux.
       GCCInstallPath = (LibDir + "/" + LibSuffix + "/" + VersionText).str();
       GCCParentLibPath = (GCCInstallPath + "/../" + Suffix.ReversePath).str();
+      SelectedNeedsBiarchSuffix = NeedsBiarchSuffix;
       IsValid = true;
     }
   }
@@ -2216,9 +2446,11 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
 bool Generic_GCC::GCCInstallationDetector::ScanGentooGccConfig(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     StringRef CandidateTriple, bool NeedsBiarchSuffix) {
+  const std::string ConfigPath =
+      D.SysRoot + "/etc/env.d/gcc/config-" + CandidateTriple.str();
+  noteProbedPath(ConfigPath);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
-      D.getVFS().getBufferForFile(D.SysRoot + "/etc/env.d/gcc/config-" +
-                                  CandidateTriple.str());
+      D.getVFS().getBufferForFile(ConfigPath);
   if (File) {
     SmallVector<StringRef, 2> Lines;
     File.get()->getBuffer().split(Lines, "\n");
@@ -2234,6 +2466,7 @@ bool Generic_GCC::GCCInstallationDetector::ScanGentooGccConfig(
         const std::string GentooPath = D.SysRoot + "/usr/lib/gcc/" +
                                        ActiveVersion.first.str() + "/" +
                                        ActiveVersion.second.str();
+        noteProbedPath(GentooPath + "/crtbegin.o");
         if (D.getVFS().exists(GentooPath + "/crtbegin.o")) {
           if (!ScanGCCForMultilibs(TargetTriple, Args, GentooPath,
                                    NeedsBiarchSuffix))
@@ -2243,6 +2476,7 @@ bool Generic_GCC::GCCInstallationDetector::ScanGentooGccConfig(
           GCCInstallPath = GentooPath;
           GCCParentLibPath = GentooPath + "/../../..";
           GCCTriple.setTriple(ActiveVersion.first);
+          SelectedNeedsBiarchSuffix = NeedsBiarchSuffix;
           IsValid = true;
           return true;
         }
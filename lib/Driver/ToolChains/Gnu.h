@@ -208,6 +208,17 @@ public:
     /// The set of multilibs that the detected installation supports.
     MultilibSet Multilibs;
 
+    /// Whether the detected installation was scanned for multilibs with a
+    /// biarch suffix.
+    bool SelectedNeedsBiarchSuffix = false;
+
+    /// Whether to record the paths probed during detection, so that the
+    /// result can be cached along with what it depends on.
+    bool RecordProbes = false;
+
+    /// The paths probed during detection, if recording them.
+    std::set<std::string> ProbedPaths;
+
   public:
     explicit GCCInstallationDetector(const Driver &D) : IsValid(false), D(D) {}
     void init(const llvm::Triple &TargetTriple, const llvm::opt::ArgList &Args,
@@ -242,6 +253,20 @@ public:
     void print(raw_ostream &OS) const;
 
   private:
+    void detect(const llvm::Triple &TargetTriple,
+                const llvm::opt::ArgList &Args,
+                ArrayRef<std::string> ExtraTripleAliases);
+
+    void noteProbedPath(StringRef Path) {
+      if (RecordProbes)
+        ProbedPaths.insert(Path);
+    }
+
+    bool loadFromCache(StringRef CacheFile, ArrayRef<std::string> Key,
+                       const llvm::Triple &TargetTriple,
+                       const llvm::opt::ArgList &Args);
+    void storeToCache(StringRef CacheFile, ArrayRef<std::string> Key) const;
+
     static void
     CollectLibDirsAndTriples(const llvm::Triple &TargetTriple,
                              const llvm::Triple &BiarchTriple,
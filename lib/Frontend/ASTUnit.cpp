@@ -185,7 +185,7 @@ static std::atomic<unsigned> ActiveASTUnitObjects;
 ASTUnit::ASTUnit(bool _MainFileIsAST)
   : Reader(nullptr), HadModuleLoaderFatalFailure(false),
     OnlyLocalDecls(false), CaptureDiagnostics(false),
-    MainFileIsAST(_MainFileIsAST), 
+    MainFileIsAST(_MainFileIsAST), ResumedFromSuspension(false),
     TUKind(TU_Complete), WantTiming(getenv("LIBCLANG_TIMING")),
     OwnsRemappedFileBuffers(true),
     NumStoredDiagnosticsFromDriver(0),
@@ -203,7 +203,7 @@ ASTUnit::ASTUnit(bool _MainFileIsAST)
 
 ASTUnit::~ASTUnit() {
   // If we loaded from an AST file, balance out the BeginSourceFile call.
-  if (MainFileIsAST && getDiagnostics().getClient()) {
+  if (isMainFileAST() && getDiagnostics().getClient()) {
     getDiagnostics().getClient()->EndSourceFile();
   }
 
@@ -1068,6 +1068,11 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
 
   ResetForParse();
 
+  // The AST writer keeps state about the AST it is attached to, so start
+  // over with a fresh one.
+  if (WriterData)
+    WriterData.reset(new ASTWriterData(*PCMCache));
+
   SourceMgr = new SourceManager(getDiagnostics(), *FileMgr,
                                 UserFilesAreVolatile);
   if (!OverrideMainBuffer) {
@@ -1386,11 +1391,14 @@ StringRef ASTUnit::getASTFileName() const {
 std::unique_ptr<ASTUnit>
 ASTUnit::create(std::shared_ptr<CompilerInvocation> CI,
                 IntrusiveRefCntPtr<DiagnosticsEngine> Diags,
-                bool CaptureDiagnostics, bool UserFilesAreVolatile) {
+                bool CaptureDiagnostics, bool UserFilesAreVolatile,
+                IntrusiveRefCntPtr<vfs::FileSystem> BaseFS) {
   std::unique_ptr<ASTUnit> AST(new ASTUnit(false));
   ConfigureDiags(Diags, *AST, CaptureDiagnostics);
+  if (!BaseFS)
+    BaseFS = vfs::getRealFileSystem();
   IntrusiveRefCntPtr<vfs::FileSystem> VFS =
-      createVFSFromCompilerInvocation(*CI, *Diags);
+      createVFSFromCompilerInvocation(*CI, *Diags, BaseFS);
   if (!VFS)
     return nullptr;
   AST->Diagnostics = Diags;
@@ -1729,6 +1737,10 @@ bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   }
 
   clearFileLevelDecls();
+
+  // Reparsing supersedes whatever the translation unit was suspended with.
+  SuspendedAST.reset();
+  SuspendedDiagnostics.clear();
   
   SimpleTimer ParsingTimer(WantTiming);
   ParsingTimer.setOutput("Reparsing " + getMainFileName());
@@ -1777,6 +1789,13 @@ bool ASTUnit::Reparse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
 }
 
 void ASTUnit::ResetForParse() {
+  // Balance out the BeginSourceFile call made when the AST was resumed.
+  if (ResumedFromSuspension) {
+    if (getDiagnostics().getClient())
+      getDiagnostics().getClient()->EndSourceFile();
+    ResumedFromSuspension = false;
+  }
+
   SavedMainFileBuffer.reset();
 
   SourceMgr.reset();
@@ -1784,16 +1803,146 @@ void ASTUnit::ResetForParse() {
   Ctx.reset();
   PP.reset();
   Reader.reset();
+  ResumedPCMCache.reset();
 
   TopLevelDecls.clear();
   clearFileLevelDecls();
 }
 
+bool ASTUnit::suspend() {
+  if (!Ctx)
+    return !SuspendedAST;
+
+  // An AST that was resumed has not changed since it was suspended, so its
+  // serialized form can be reused as is. Otherwise, write the AST out. That
+  // only works if it was not loaded from a PCH, or if the AST writer was
+  // tracking the declarations loaded from it all along.
+  if (!SuspendedAST && Invocation && !MainFileIsAST && TheSema &&
+      (WriterData || !Reader) && !HadModuleLoaderFatalFailure) {
+    SmallString<128> Buffer;
+    llvm::raw_svector_ostream OS(Buffer);
+    if (!serialize(OS))
+      SuspendedAST = llvm::MemoryBuffer::getMemBufferCopy(
+          Buffer, getMainFileName() + ".suspended.ast");
+  }
+
+  // The stored diagnostics refer to the source manager we are about to free,
+  // so keep the ones that have a location in a form that survives it.
+  if (SuspendedAST) {
+    if (!ResumedFromSuspension) {
+      SuspendedDiagnostics.clear();
+      for (const StoredDiagnostic &SD : StoredDiagnostics)
+        if (SD.getLocation().isValid())
+          SuspendedDiagnostics.push_back(
+              makeStandaloneDiagnostic(*LangOpts, SD));
+    }
+    StoredDiagnostics.erase(
+        std::remove_if(StoredDiagnostics.begin(), StoredDiagnostics.end(),
+                       [](const StoredDiagnostic &SD) {
+                         return SD.getLocation().isValid();
+                       }),
+        StoredDiagnostics.end());
+  }
+
+  // The cached code-completion results are rebuilt by the next reparse.
+  ClearCachedCompletionResults();
+  CompletionCacheTopLevelHashValue = 0;
+  CCTUInfo.reset();
+
+  Consumer.reset();
+  ResetForParse();
+  return !SuspendedAST;
+}
+
+bool ASTUnit::resume(std::shared_ptr<PCHContainerOperations> PCHContainerOps) {
+  if (!isSuspended())
+    return !Ctx;
+
+  const PCHContainerReader &PCHContainerRdr = PCHContainerOps->getRawReader();
+
+  LangOpts = std::make_shared<LangOptions>();
+  HSOpts = std::make_shared<HeaderSearchOptions>();
+  HSOpts->ModuleFormat = PCHContainerRdr.getFormat();
+  PPOpts = std::make_shared<PreprocessorOptions>();
+  Target = nullptr;
+  ResumedPCMCache = new MemoryBufferCache;
+  SourceMgr = new SourceManager(getDiagnostics(), getFileManager(),
+                                UserFilesAreVolatile);
+  HeaderInfo.reset(new HeaderSearch(HSOpts, getSourceManager(),
+                                    getDiagnostics(), getLangOpts(),
+                                    /*Target=*/nullptr));
+  PP = std::make_shared<Preprocessor>(
+      PPOpts, getDiagnostics(), *LangOpts, getSourceManager(),
+      *ResumedPCMCache, *HeaderInfo, ModuleLoader,
+      /*IILookup=*/nullptr,
+      /*OwnsHeaderSearch=*/false);
+  Ctx = new ASTContext(*LangOpts, getSourceManager(), PP->getIdentifierTable(),
+                       PP->getSelectorTable(), PP->getBuiltinInfo());
+
+  unsigned Counter = 0;
+  Reader = new ASTReader(*PP, Ctx.get(), PCHContainerRdr, { },
+                         /*isysroot=*/"",
+                         /*DisableValidation=*/false,
+                         /*AllowASTWithCompilerErrors=*/true);
+  Reader->setListener(llvm::make_unique<ASTInfoCollector>(
+      *PP, Ctx.get(), *HSOpts, *PPOpts, *LangOpts, TargetOpts, Target,
+      Counter));
+  Ctx->setExternalSource(Reader);
+
+  // The reader does not take ownership of the serialized form, so that it
+  // can be resumed from again after the next suspension.
+  StringRef FileName = SuspendedAST->getBufferIdentifier();
+  Reader->addInMemoryBuffer(
+      FileName,
+      llvm::MemoryBuffer::getMemBuffer(SuspendedAST->getMemBufferRef(),
+                                       /*RequiresNullTerminator=*/false));
+
+  // Files that changed on disk make the serialized form out of date; that is
+  // not an error, the translation unit just has to be reparsed.
+  if (Reader->ReadAST(FileName, serialization::MK_MainFile, SourceLocation(),
+                      ASTReader::ARR_Missing | ASTReader::ARR_OutOfDate) !=
+      ASTReader::Success) {
+    ResetForParse();
+    return true;
+  }
+
+  OriginalSourceFile = Reader->getOriginalSourceFile();
+  PP->setCounterValue(Counter);
+
+  Consumer.reset(new ASTConsumer);
+  TheSema.reset(new Sema(*PP, *Ctx, *Consumer, TUKind));
+  TheSema->Initialize();
+  Reader->InitializeSema(*TheSema);
+
+  ResumedFromSuspension = true;
+  if (getDiagnostics().getClient())
+    getDiagnostics().getClient()->BeginSourceFile(PP->getLangOpts(), PP.get());
+
+  // Map the diagnostics back into the new source manager. The preamble's
+  // location cache must not pick up locations from it.
+  llvm::StringMap<SourceLocation> SavedPreambleSrcLocCache;
+  SavedPreambleSrcLocCache.swap(PreambleSrcLocCache);
+  SmallVector<StoredDiagnostic, 4> Diags;
+  TranslateStoredDiagnostics(getFileManager(), getSourceManager(),
+                             SuspendedDiagnostics, Diags);
+  SavedPreambleSrcLocCache.swap(PreambleSrcLocCache);
+  StoredDiagnostics.append(Diags.begin(), Diags.end());
+  return false;
+}
+
 //----------------------------------------------------------------------------//
 // Code completion
 //----------------------------------------------------------------------------//
 
 namespace {
+  /// \brief The options of the consumer that merges the cached results,
+  /// which gets all the results from Sema.
+  static CodeCompleteOptions
+  withoutResultLimit(CodeCompleteOptions CodeCompleteOpts) {
+    CodeCompleteOpts.ResultLimit = 0;
+    return CodeCompleteOpts;
+  }
+
   /// \brief Code completion consumer that combines the cached code-completion
   /// results from an ASTUnit with the code-completion results provided to it,
   /// then passes the result on to 
@@ -1801,12 +1950,19 @@ namespace {
     uint64_t NormalContexts;
     ASTUnit &AST;
     CodeCompleteConsumer &Next;
+
+    /// \brief The maximum number of results to report, or zero for no
+    /// limit. The limit is only applied once the cached results are merged:
+    /// the results that Sema reports hide cached results, even if they do
+    /// not make the cut themselves.
+    unsigned ResultLimit;
     
   public:
     AugmentedCodeCompleteConsumer(ASTUnit &AST, CodeCompleteConsumer &Next,
                                   const CodeCompleteOptions &CodeCompleteOpts)
-      : CodeCompleteConsumer(CodeCompleteOpts, Next.isOutputBinary()),
-        AST(AST), Next(Next)
+      : CodeCompleteConsumer(withoutResultLimit(CodeCompleteOpts),
+                             Next.isOutputBinary()),
+        AST(AST), Next(Next), ResultLimit(CodeCompleteOpts.ResultLimit)
     { 
       // Compute the set of contexts in which we will look when we don't have
       // any information about the specific context.
@@ -1948,6 +2104,12 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
   llvm::StringSet<llvm::BumpPtrAllocator> HiddenNames;
   typedef CodeCompletionResult Result;
   SmallVector<Result, 8> AllResults;
+  Optional<CodeCompletionFuzzyMatcher> Matcher;
+  if (fuzzyFilterResults()) {
+    StringRef Prefix = getTypedPrefix(S);
+    if (!Prefix.empty())
+      Matcher = CodeCompletionFuzzyMatcher(Prefix);
+  }
   for (ASTUnit::cached_completion_iterator 
             C = AST.cached_completion_begin(),
          CEnd = AST.cached_completion_end();
@@ -1970,6 +2132,13 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     if (C->Kind != CXCursor_MacroDefinition &&
         HiddenNames.count(C->Completion->getTypedText()))
       continue;
+
+    // Drop global results that don't match the typed prefix before doing any
+    // further work on them.
+    unsigned MatchPenalty = 0;
+    if (Matcher &&
+        !Matcher->match(C->Completion->getTypedText(), MatchPenalty))
+      continue;
     
     // Adjust priority based on similar type classes.
     unsigned Priority = C->Priority;
@@ -2010,19 +2179,23 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
       Completion = Builder.TakeString();
     }
     
-    AllResults.push_back(Result(Completion, Priority, C->Kind,
+    AllResults.push_back(Result(Completion, Priority + MatchPenalty, C->Kind,
                                 C->Availability));
   }
   
   // If we did not add any cached completion results, just forward the
   // results we were given to the next consumer.
   if (!AddedResult) {
-    Next.ProcessCodeCompleteResults(S, Context, Results, NumResults);
+    Next.ProcessCodeCompleteResults(
+        S, Context, Results,
+        selectBestCodeCompletionResults(Results, NumResults, ResultLimit));
     return;
   }
   
-  Next.ProcessCodeCompleteResults(S, Context, AllResults.data(),
-                                  AllResults.size());
+  Next.ProcessCodeCompleteResults(
+      S, Context, AllResults.data(),
+      selectBestCodeCompletionResults(AllResults.data(), AllResults.size(),
+                                      ResultLimit));
 }
 
 void ASTUnit::CodeComplete(
@@ -2033,7 +2206,8 @@ void ASTUnit::CodeComplete(
     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     DiagnosticsEngine &Diag, LangOptions &LangOpts, SourceManager &SourceMgr,
     FileManager &FileMgr, SmallVectorImpl<StoredDiagnostic> &StoredDiagnostics,
-    SmallVectorImpl<const llvm::MemoryBuffer *> &OwnedBuffers) {
+    SmallVectorImpl<const llvm::MemoryBuffer *> &OwnedBuffers,
+    bool FuzzyFilterResults, StringRef TypedPrefix, unsigned ResultLimit) {
   if (!Invocation)
     return;
 
@@ -2052,6 +2226,9 @@ void ASTUnit::CodeComplete(
   CodeCompleteOpts.IncludeCodePatterns = IncludeCodePatterns;
   CodeCompleteOpts.IncludeGlobals = CachedCompletionResults.empty();
   CodeCompleteOpts.IncludeBriefComments = IncludeBriefComments;
+  CodeCompleteOpts.FuzzyFilterResults = FuzzyFilterResults;
+  CodeCompleteOpts.TypedPrefix = TypedPrefix.str();
+  CodeCompleteOpts.ResultLimit = ResultLimit;
 
   assert(IncludeBriefComments == this->IncludeBriefCommentsInCodeCompletion);
 
@@ -2219,6 +2396,12 @@ static bool serializeUnit(ASTWriter &Writer,
 }
 
 bool ASTUnit::serialize(raw_ostream &OS) {
+  // A resumed AST is exactly what it was serialized to when suspended.
+  if (ResumedFromSuspension) {
+    OS << SuspendedAST->getBuffer();
+    return false;
+  }
+
   // For serialization we are lenient if the errors were only warn-as-error kind.
   bool hasErrors = getDiagnostics().hasUncompilableErrorOccurred();
 
@@ -813,6 +813,22 @@ std::unique_ptr<llvm::raw_pwrite_stream> CompilerInstance::createOutputFile(
 
 // Initialization Utilities
 
+/// If \p Buffer was written by -fcompress-preprocessed-output, set \p Result
+/// to its decompressed contents. Returns false if it cannot be decompressed.
+static bool decompressInput(const llvm::MemoryBuffer &Buffer, StringRef Name,
+                            DiagnosticsEngine &Diags,
+                            std::unique_ptr<llvm::MemoryBuffer> &Result) {
+  llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> Decompressed =
+      decompressPreprocessedInput(Buffer);
+  if (!Decompressed) {
+    Diags.Report(diag::err_fe_error_decompressing)
+        << Name << llvm::toString(Decompressed.takeError());
+    return false;
+  }
+  Result = std::move(*Decompressed);
+  return true;
+}
+
 bool CompilerInstance::InitializeSourceManager(const FrontendInputFile &Input){
   return InitializeSourceManager(
       Input, getDiagnostics(), getFileManager(), getSourceManager(),
@@ -896,6 +912,21 @@ bool CompilerInstance::InitializeSourceManager(
       }
     }
 
+    // Preprocessed input may be compressed. The source manager must see the
+    // decompressed contents before the file ID is created, since that
+    // reserves the size of the file.
+    if (Input.getKind().isPreprocessed()) {
+      bool Invalid = false;
+      llvm::MemoryBuffer *Contents =
+          SourceMgr.getMemoryBufferForFile(File, &Invalid);
+      std::unique_ptr<llvm::MemoryBuffer> Decompressed;
+      if (!Invalid &&
+          !decompressInput(*Contents, InputFile, Diags, Decompressed))
+        return false;
+      if (Decompressed)
+        SourceMgr.overrideFileContents(File, std::move(Decompressed));
+    }
+
     SourceMgr.setMainFileID(
         SourceMgr.createFileID(File, SourceLocation(), Kind));
   } else {
@@ -907,6 +938,14 @@ bool CompilerInstance::InitializeSourceManager(
     }
     std::unique_ptr<llvm::MemoryBuffer> SB = std::move(SBOrErr.get());
 
+    if (Input.getKind().isPreprocessed()) {
+      std::unique_ptr<llvm::MemoryBuffer> Decompressed;
+      if (!decompressInput(*SB, "<stdin>", Diags, Decompressed))
+        return false;
+      if (Decompressed)
+        SB = std::move(Decompressed);
+    }
+
     const FileEntry *File = FileMgr.getVirtualFile(SB->getBufferIdentifier(),
                                                    SB->getBufferSize(), 0);
     SourceMgr.setMainFileID(
@@ -0,0 +1,82 @@
+//===--- CompressedPreprocessedOutput.cpp - Compressed -E output ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// -fcompress-preprocessed-output writes the output of -E compressed, so that
+// distributed builds can ship it without a separate compression step, and the
+// frontend decompresses preprocessed inputs in that format.
+//
+// The format is an 8-byte magic, the size of the decompressed text as a
+// 64-bit little-endian integer, and the text compressed with zlib. The magic
+// starts with a byte that cannot start a source file.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+
+static const char Magic[] = "\x7f" "CLZPP1\n";
+static const size_t MagicSize = sizeof(Magic) - 1;
+static const size_t HeaderSize = MagicSize + sizeof(uint64_t);
+
+static llvm::Error makeError(const Twine &Message) {
+  return llvm::make_error<llvm::StringError>(Message,
+                                             llvm::inconvertibleErrorCode());
+}
+
+llvm::Error clang::writeCompressedPreprocessedOutput(StringRef Text,
+                                                     raw_ostream &OS) {
+  if (!llvm::zlib::isAvailable())
+    return makeError("zlib is not available");
+
+  SmallString<0> Compressed;
+  if (llvm::Error E = llvm::zlib::compress(Text, Compressed))
+    return E;
+
+  char Size[sizeof(uint64_t)];
+  llvm::support::endian::write64le(Size, Text.size());
+  OS.write(Magic, MagicSize);
+  OS.write(Size, sizeof(Size));
+  OS << Compressed;
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+clang::decompressPreprocessedInput(const llvm::MemoryBuffer &Buffer) {
+  StringRef Data = Buffer.getBuffer();
+  if (!Data.startswith(StringRef(Magic, MagicSize)))
+    return nullptr;
+  if (Data.size() < HeaderSize)
+    return makeError("truncated compressed preprocessed input");
+  if (!llvm::zlib::isAvailable())
+    return makeError("zlib is not available");
+
+  size_t Size =
+      llvm::support::endian::read64le(Data.data() + MagicSize);
+  // Decompress in place into the buffer that the source manager will own,
+  // which is null-terminated.
+  std::unique_ptr<llvm::MemoryBuffer> Result =
+      llvm::MemoryBuffer::getNewUninitMemBuffer(Size,
+                                                Buffer.getBufferIdentifier());
+  if (!Result)
+    return makeError("compressed preprocessed input is too large");
+  size_t ActualSize = Size;
+  if (llvm::Error E = llvm::zlib::uncompress(
+          Data.drop_front(HeaderSize),
+          const_cast<char *>(Result->getBufferStart()), ActualSize))
+    return std::move(E);
+  if (ActualSize != Size)
+    return makeError("compressed preprocessed input has the wrong size");
+  return std::move(Result);
+}
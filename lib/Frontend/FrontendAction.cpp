@@ -11,6 +11,7 @@
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclGroup.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
@@ -20,6 +21,7 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/LiteralSupport.h"
+#include "clang/Lex/PPCallbacks.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Parse/ParseAST.h"
@@ -124,6 +126,43 @@ public:
   }
 };
 
+/// \brief Records an -ftime-trace event for each file that the main file
+/// includes, directly or not, from its entry to its end.
+class TimeTraceIncludeCallbacks : public PPCallbacks {
+  SourceManager &SM;
+  /// The number of included files that have been entered and not exited.
+  unsigned Depth = 0;
+  bool SeenMainFile = false;
+
+public:
+  explicit TimeTraceIncludeCallbacks(SourceManager &SM) : SM(SM) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile) {
+      // The main file is entered first and never exited.
+      if (!SeenMainFile) {
+        SeenMainFile = true;
+        return;
+      }
+      ++Depth;
+      timeTraceProfilerBegin("Source",
+                             [&] { return SM.getBufferName(Loc).str(); });
+    } else if (Reason == ExitFile && Depth) {
+      --Depth;
+      timeTraceProfilerEnd();
+    }
+  }
+
+  void EndOfMainFile() override {
+    // Close the events of the files that were not exited, if compilation
+    // stopped inside of them.
+    for (; Depth; --Depth)
+      timeTraceProfilerEnd();
+  }
+};
+
 } // end anonymous namespace
 
 FrontendAction::FrontendAction() : Instance(nullptr) {}
@@ -149,14 +188,24 @@ FrontendAction::CreateWrappedASTConsumer(CompilerInstance &CI,
   if (!Consumer)
     return nullptr;
 
+  // The header cost report watches the whole parse, so it goes first.
+  std::unique_ptr<ASTConsumer> HeaderCostReporter;
+  if (!CI.getFrontendOpts().HeaderCostReportFile.empty() &&
+      CI.hasPreprocessor())
+    HeaderCostReporter = CreateHeaderCostReporter(
+        CI.getPreprocessor(), CI.getFrontendOpts().HeaderCostReportFile);
+
   // If there are no registered plugins we don't need to wrap the consumer
-  if (FrontendPluginRegistry::begin() == FrontendPluginRegistry::end())
+  if (FrontendPluginRegistry::begin() == FrontendPluginRegistry::end() &&
+      !HeaderCostReporter)
     return Consumer;
 
   // Collect the list of plugins that go before the main action (in Consumers)
   // or after it (in AfterConsumers)
   std::vector<std::unique_ptr<ASTConsumer>> Consumers;
   std::vector<std::unique_ptr<ASTConsumer>> AfterConsumers;
+  if (HeaderCostReporter)
+    Consumers.push_back(std::move(HeaderCostReporter));
   for (FrontendPluginRegistry::iterator it = FrontendPluginRegistry::begin(),
                                         ie = FrontendPluginRegistry::end();
        it != ie; ++it) {
@@ -895,11 +944,19 @@ failure:
 bool FrontendAction::Execute() {
   CompilerInstance &CI = getCompilerInstance();
 
-  if (CI.hasFrontendTimer()) {
-    llvm::TimeRegion Timer(CI.getFrontendTimer());
-    ExecuteAction();
+  if (timeTraceProfilerEnabled() && CI.hasPreprocessor())
+    CI.getPreprocessor().addPPCallbacks(
+        llvm::make_unique<TimeTraceIncludeCallbacks>(CI.getSourceManager()));
+
+  {
+    TimeTraceScope TimeScope("Frontend",
+                             [&] { return getCurrentFile().str(); });
+    if (CI.hasFrontendTimer()) {
+      llvm::TimeRegion Timer(CI.getFrontendTimer());
+      ExecuteAction();
+    }
+    else ExecuteAction();
   }
-  else ExecuteAction();
 
   // If we are supposed to rebuild the global module index, do so now unless
   // there were any module-build failures.
@@ -542,9 +542,17 @@ void PrintPreprocessedAction::ExecuteAction() {
     }
   }
 
-  std::unique_ptr<raw_ostream> OS =
-      CI.createDefaultOutputFile(BinaryMode, getCurrentFile());
-  if (!OS) return;
+  // Compressed output is binary anyway.
+  bool Compress = CI.getPreprocessorOutputOpts().CompressOutput;
+  std::unique_ptr<raw_ostream> FileOS =
+      CI.createDefaultOutputFile(BinaryMode || Compress, getCurrentFile());
+  if (!FileOS) return;
+
+  // zlib compresses a whole buffer at a time, so print to memory first when
+  // compressing.
+  SmallString<0> Uncompressed;
+  llvm::raw_svector_ostream UncompressedOS(Uncompressed);
+  raw_ostream *OS = Compress ? &UncompressedOS : FileOS.get();
 
   // If we're preprocessing a module map, start by dumping the contents of the
   // module itself before switching to the input buffer.
@@ -561,8 +569,14 @@ void PrintPreprocessedAction::ExecuteAction() {
     (*OS) << "#pragma clang module contents\n";
   }
 
-  DoPrintPreprocessedInput(CI.getPreprocessor(), OS.get(),
+  DoPrintPreprocessedInput(CI.getPreprocessor(), OS,
                            CI.getPreprocessorOutputOpts());
+
+  if (Compress)
+    if (llvm::Error E =
+            writeCompressedPreprocessedOutput(Uncompressed, *FileOS))
+      CI.getDiagnostics().Report(diag::err_fe_error_compressing_output)
+          << llvm::toString(std::move(E));
 }
 
 void PrintPreambleAction::ExecuteAction() {
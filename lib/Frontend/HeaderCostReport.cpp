@@ -0,0 +1,348 @@
+//===--- HeaderCostReport.cpp - Attribute compile costs to headers --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements -header-cost-report, which attributes the tokens,
+// time, declarations, template instantiations and AST memory of a translation
+// unit to the files it includes, and writes them as JSON so that the reports
+// of a whole project can be merged by utils/merge-header-costs.py.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+using namespace clang;
+
+namespace {
+
+/// The costs attributed to a file.
+struct HeaderCosts {
+  uint64_t Tokens = 0;
+  uint64_t Microseconds = 0;
+  uint64_t Decls = 0;
+  uint64_t Instantiations = 0;
+  uint64_t Bytes = 0;
+
+  HeaderCosts &operator+=(const HeaderCosts &Other) {
+    Tokens += Other.Tokens;
+    Microseconds += Other.Microseconds;
+    Decls += Other.Decls;
+    Instantiations += Other.Instantiations;
+    Bytes += Other.Bytes;
+    return *this;
+  }
+};
+
+/// One entry into a file: the main file, the predefines buffer or an
+/// \#include. A header that is included several times without a guard has
+/// several inclusions.
+struct Inclusion {
+  std::string Name;
+  /// The index of the including inclusion, or ~0U for the main file.
+  unsigned Parent;
+  /// The costs incurred while this file was the one being lexed, or at
+  /// locations in this file.
+  HeaderCosts Exclusive;
+};
+
+/// The costs of all the inclusions of a file.
+struct FileCosts {
+  StringRef Name;
+  unsigned NumInclusions = 0;
+  HeaderCosts Exclusive;
+  /// The costs of the inclusions of this file and of everything they include.
+  /// Inclusions of the file within itself are only counted once.
+  HeaderCosts Inclusive;
+};
+
+/// Tracks which inclusion is being lexed, and charges it with the tokens, time
+/// and memory spent until the next file change. Shared by the preprocessor
+/// callbacks and the AST consumer, which are destroyed in no particular order.
+class HeaderCostCollector {
+  typedef std::chrono::steady_clock Clock;
+
+  SourceManager &SM;
+  const ASTContext *Context = nullptr;
+  std::vector<Inclusion> Inclusions;
+  llvm::DenseMap<FileID, unsigned> InclusionOfFile;
+  /// The inclusion being lexed, or ~0U outside of the main file.
+  unsigned Current = ~0U;
+  Clock::time_point LastChange;
+  size_t LastBytes = 0;
+
+  size_t getASTBytes() const {
+    return Context ? Context->getAllocator().getBytesAllocated() : 0;
+  }
+
+  /// Charge the time and memory spent since the last file change to the
+  /// current inclusion.
+  void charge() {
+    Clock::time_point Now = Clock::now();
+    size_t Bytes = getASTBytes();
+    if (Current != ~0U) {
+      HeaderCosts &Costs = Inclusions[Current].Exclusive;
+      Costs.Microseconds += std::chrono::duration_cast<
+          std::chrono::microseconds>(Now - LastChange).count();
+      Costs.Bytes += Bytes - LastBytes;
+    }
+    LastChange = Now;
+    LastBytes = Bytes;
+  }
+
+  /// Find the inclusion that contains \p Loc, or null if the location is not
+  /// in a file that was entered, for instance if it is in an AST file.
+  Inclusion *getInclusionAt(SourceLocation Loc) {
+    if (Loc.isInvalid())
+      return nullptr;
+    auto It = InclusionOfFile.find(SM.getFileID(SM.getExpansionLoc(Loc)));
+    return It == InclusionOfFile.end() ? nullptr : &Inclusions[It->second];
+  }
+
+  void countDecls(const DeclContext *DC, bool InInstantiation);
+  void countInstantiation(TemplateSpecializationKind TSK,
+                          SourceLocation PointOfInstantiation);
+
+public:
+  explicit HeaderCostCollector(SourceManager &SM) : SM(SM) {}
+
+  void setContext(const ASTContext &Ctx) {
+    charge();
+    Context = &Ctx;
+    LastBytes = getASTBytes();
+  }
+
+  void enterFile(FileID FID) {
+    charge();
+    InclusionOfFile[FID] = Inclusions.size();
+    Inclusions.push_back(
+        {SM.getBufferName(SM.getLocForStartOfFile(FID)), Current, {}});
+    Current = Inclusions.size() - 1;
+  }
+
+  void exitFile() {
+    charge();
+    if (Current != ~0U)
+      Current = Inclusions[Current].Parent;
+  }
+
+  void countToken() {
+    if (Current != ~0U)
+      ++Inclusions[Current].Exclusive.Tokens;
+  }
+
+  /// Stop the clock and attribute the declarations of \p Ctx.
+  void finish(const ASTContext &Ctx) {
+    charge();
+    Current = ~0U;
+    countDecls(Ctx.getTranslationUnitDecl(), /*InInstantiation=*/false);
+  }
+
+  void write(raw_ostream &OS) const;
+};
+
+class HeaderCostCallbacks : public PPCallbacks {
+  SourceManager &SM;
+  std::shared_ptr<HeaderCostCollector> Collector;
+
+public:
+  HeaderCostCallbacks(SourceManager &SM,
+                      std::shared_ptr<HeaderCostCollector> Collector)
+      : SM(SM), Collector(std::move(Collector)) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile)
+      Collector->enterFile(SM.getFileID(Loc));
+    else if (Reason == ExitFile)
+      Collector->exitFile();
+  }
+};
+
+class HeaderCostConsumer : public ASTConsumer {
+  Preprocessor &PP;
+  std::string OutputPath;
+  std::shared_ptr<HeaderCostCollector> Collector;
+
+public:
+  HeaderCostConsumer(Preprocessor &PP, StringRef OutputPath,
+                     std::shared_ptr<HeaderCostCollector> Collector)
+      : PP(PP), OutputPath(OutputPath), Collector(std::move(Collector)) {}
+
+  void Initialize(ASTContext &Ctx) override { Collector->setContext(Ctx); }
+
+  void HandleTranslationUnit(ASTContext &Ctx) override {
+    PP.setTokenWatcher(nullptr);
+    Collector->finish(Ctx);
+
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(OutputPath, EC, llvm::sys::fs::F_Text);
+    if (EC) {
+      PP.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << OutputPath << EC.message();
+      return;
+    }
+    Collector->write(OS);
+  }
+};
+
+} // end anonymous namespace
+
+void HeaderCostCollector::countInstantiation(
+    TemplateSpecializationKind TSK, SourceLocation PointOfInstantiation) {
+  if (TSK != TSK_ImplicitInstantiation &&
+      TSK != TSK_ExplicitInstantiationDefinition)
+    return;
+  if (Inclusion *I = getInclusionAt(PointOfInstantiation))
+    ++I->Exclusive.Instantiations;
+}
+
+/// Counts the declarations written in \p DC by the file they are written in,
+/// and the instantiations of the templates declared in it by the file that
+/// triggered them. Declarations within instantiations are not counted, since
+/// the instantiation is charged for them.
+void HeaderCostCollector::countDecls(const DeclContext *DC,
+                                     bool InInstantiation) {
+  // Don't deserialize declarations from AST files; they were not created by
+  // this translation unit.
+  for (const Decl *D : DC->noload_decls()) {
+    if (!InInstantiation && !D->isImplicit())
+      if (Inclusion *I = getInclusionAt(D->getLocation()))
+        ++I->Exclusive.Decls;
+
+    if (const auto *FD = dyn_cast<FunctionDecl>(D)) {
+      if (FD->isThisDeclarationADefinition())
+        countInstantiation(FD->getTemplateSpecializationKind(),
+                           FD->getPointOfInstantiation());
+    } else if (const auto *CTD = dyn_cast<ClassTemplateDecl>(D)) {
+      if (CTD->isThisDeclarationADefinition())
+        for (const ClassTemplateSpecializationDecl *Spec :
+             CTD->specializations()) {
+          if (!Spec->isCompleteDefinition())
+            continue;
+          countInstantiation(Spec->getSpecializationKind(),
+                             Spec->getPointOfInstantiation());
+          countDecls(Spec, /*InInstantiation=*/true);
+        }
+    } else if (const auto *FTD = dyn_cast<FunctionTemplateDecl>(D)) {
+      if (FTD->isThisDeclarationADefinition())
+        for (const FunctionDecl *Spec : FTD->specializations())
+          if (Spec->isThisDeclarationADefinition())
+            countInstantiation(Spec->getTemplateSpecializationKind(),
+                               Spec->getPointOfInstantiation());
+    }
+
+    // The members of a template are in its pattern.
+    if (const auto *TD = dyn_cast<TemplateDecl>(D))
+      D = TD->getTemplatedDecl();
+    if (const auto *Inner = dyn_cast_or_null<DeclContext>(D))
+      countDecls(Inner, InInstantiation);
+  }
+}
+
+/// Writes \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << "\\u" << llvm::format_hex_no_prefix(C, 4);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+static void writeCosts(raw_ostream &OS, const HeaderCosts &Costs) {
+  OS << "{\"tokens\": " << Costs.Tokens
+     << ", \"microseconds\": " << Costs.Microseconds
+     << ", \"decls\": " << Costs.Decls
+     << ", \"instantiations\": " << Costs.Instantiations
+     << ", \"bytes\": " << Costs.Bytes << '}';
+}
+
+void HeaderCostCollector::write(raw_ostream &OS) const {
+  // Inclusions are recorded in the order in which they are entered, so the
+  // children of an inclusion follow it: sum the inclusive costs backwards.
+  std::vector<HeaderCosts> Inclusive(Inclusions.size());
+  for (unsigned I = Inclusions.size(); I-- != 0;) {
+    Inclusive[I] += Inclusions[I].Exclusive;
+    if (Inclusions[I].Parent != ~0U)
+      Inclusive[Inclusions[I].Parent] += Inclusive[I];
+  }
+
+  llvm::StringMap<FileCosts> Files;
+  for (unsigned I = 0, E = Inclusions.size(); I != E; ++I) {
+    const Inclusion &Inc = Inclusions[I];
+    FileCosts &File = Files[Inc.Name];
+    ++File.NumInclusions;
+    File.Exclusive += Inc.Exclusive;
+
+    // Only the outermost inclusion of a file counts towards its inclusive
+    // costs, which already cover the nested ones.
+    bool Nested = false;
+    for (unsigned P = Inc.Parent; P != ~0U && !Nested;
+         P = Inclusions[P].Parent)
+      Nested = Inclusions[P].Name == Inc.Name;
+    if (!Nested)
+      File.Inclusive += Inclusive[I];
+  }
+
+  std::vector<FileCosts *> Sorted;
+  for (auto &Entry : Files) {
+    Entry.second.Name = Entry.first();
+    Sorted.push_back(&Entry.second);
+  }
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const FileCosts *LHS, const FileCosts *RHS) {
+              if (LHS->Inclusive.Microseconds != RHS->Inclusive.Microseconds)
+                return LHS->Inclusive.Microseconds >
+                       RHS->Inclusive.Microseconds;
+              return LHS->Name < RHS->Name;
+            });
+
+  OS << "{\n  \"version\": 1,\n  \"main-file\": ";
+  writeJSONString(OS, Inclusions.empty() ? "" : Inclusions[0].Name);
+  OS << ",\n  \"files\": [";
+  for (const FileCosts *File : Sorted) {
+    OS << (File == Sorted.front() ? "\n" : ",\n") << "    {\"name\": ";
+    writeJSONString(OS, File->Name);
+    OS << ", \"inclusions\": " << File->NumInclusions << ", \"exclusive\": ";
+    writeCosts(OS, File->Exclusive);
+    OS << ", \"inclusive\": ";
+    writeCosts(OS, File->Inclusive);
+    OS << '}';
+  }
+  OS << "\n  ]\n}\n";
+}
+
+std::unique_ptr<ASTConsumer>
+clang::CreateHeaderCostReporter(Preprocessor &PP, StringRef OutputPath) {
+  auto Collector =
+      std::make_shared<HeaderCostCollector>(PP.getSourceManager());
+  PP.addPPCallbacks(
+      llvm::make_unique<HeaderCostCallbacks>(PP.getSourceManager(), Collector));
+  PP.setTokenWatcher([Collector](const Token &) { Collector->countToken(); });
+  return llvm::make_unique<HeaderCostConsumer>(PP, OutputPath, Collector);
+}
@@ -28,6 +28,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <cstring>
 using namespace clang;
 
 /// PrintMacroDefinition - Print a macro definition in a form that will be
@@ -668,6 +669,18 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+/// If \p Tok is a punctuator that is spelled the usual way, return its
+/// spelling, which then does not need to be looked up in the source buffer.
+static const char *getFixedSpelling(const Token &Tok) {
+  if (Tok.needsCleaning())
+    return nullptr;
+  const char *Punc = tok::getPunctuatorSpelling(Tok.getKind());
+  // A digraph is longer than the punctuator it stands for.
+  if (!Punc || strlen(Punc) != Tok.getLength())
+    return nullptr;
+  return Punc;
+}
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
@@ -728,6 +741,8 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
     } else if (Tok.isLiteral() && !Tok.needsCleaning() &&
                Tok.getLiteralData()) {
       OS.write(Tok.getLiteralData(), Tok.getLength());
+    } else if (const char *Punc = getFixedSpelling(Tok)) {
+      OS.write(Punc, Tok.getLength());
     } else if (Tok.getLength() < 256) {
       const char *TokPtr = Buffer;
       unsigned Len = PP.getSpelling(Tok, TokPtr);
@@ -792,6 +807,9 @@ static void DoPrintMacros(Preprocessor &PP, raw_ostream *OS) {
   }
 }
 
+/// The size of the output buffer of -E.
+static const size_t PrintBufferSize = 256 * 1024;
+
 /// DoPrintPreprocessedInput - This implements -E mode.
 ///
 void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
@@ -803,6 +821,12 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
     return;
   }
 
+  // The output is written a few bytes at a time, so flushing it in blocks of
+  // the file system's preferred size means many small writes. Use a larger
+  // buffer, unless the stream is unbuffered because it is a terminal.
+  if (OS->GetBufferSize() != 0 && OS->GetBufferSize() < PrintBufferSize)
+    OS->SetBufferSize(PrintBufferSize);
+
   // Inform the preprocessor whether we want it to retain comments or not, due
   // to -C or -CC.
   PP.SetCommentRetentionState(Opts.ShowComments, Opts.ShowMacroComments);
@@ -0,0 +1,274 @@
+//===--- SerializedDiagnosticAggregator.cpp - Merges diagnostics ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/SerializedDiagnosticAggregator.h"
+#include "clang/Frontend/SerializedDiagnosticReader.h"
+#include "clang/Frontend/SerializedDiagnostics.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace clang;
+using namespace clang::serialized_diags;
+
+namespace {
+/// \brief A diagnostic, with interned file, flag and message.
+struct DiagnosticKey {
+  unsigned Severity;
+  unsigned File;
+  unsigned Line;
+  unsigned Column;
+  unsigned Flag;
+  unsigned Message;
+};
+} // end anonymous namespace
+
+namespace llvm {
+template <> struct DenseMapInfo<DiagnosticKey> {
+  static DiagnosticKey getEmptyKey() { return {~0U, 0, 0, 0, 0, 0}; }
+  static DiagnosticKey getTombstoneKey() { return {~0U - 1, 0, 0, 0, 0, 0}; }
+  static unsigned getHashValue(const DiagnosticKey &K) {
+    return hash_combine(K.Severity, K.File, K.Line, K.Column, K.Flag,
+                        K.Message);
+  }
+  static bool isEqual(const DiagnosticKey &LHS, const DiagnosticKey &RHS) {
+    return LHS.Severity == RHS.Severity && LHS.File == RHS.File &&
+           LHS.Line == RHS.Line && LHS.Column == RHS.Column &&
+           LHS.Flag == RHS.Flag && LHS.Message == RHS.Message;
+  }
+};
+} // end llvm namespace
+
+namespace {
+/// \brief A table of interned strings, which are identified by their index.
+class StringTable {
+  llvm::StringMap<unsigned> IDs;
+  std::vector<StringRef> Strings;
+
+public:
+  /// \brief The empty string has ID 0.
+  StringTable() { intern(""); }
+
+  unsigned intern(StringRef Str) {
+    auto Result = IDs.insert(std::make_pair(Str, Strings.size()));
+    if (Result.second)
+      Strings.push_back(Result.first->getKey());
+    return Result.first->second;
+  }
+
+  StringRef operator[](unsigned ID) const { return Strings[ID]; }
+  unsigned size() const { return Strings.size(); }
+};
+} // end anonymous namespace
+
+class DiagnosticAggregator::Impl {
+public:
+  StringTable Files, Flags, Messages;
+
+  /// \brief The number of occurrences of each distinct diagnostic.
+  llvm::DenseMap<DiagnosticKey, unsigned> Occurrences;
+
+  /// \brief The number of files that report each flag, by flag ID.
+  std::vector<unsigned> FlagTranslationUnits;
+
+  unsigned NumFiles = 0;
+  unsigned NumDiagnostics = 0;
+
+  void addTranslationUnit(ArrayRef<unsigned> FlagsSeen) {
+    ++NumFiles;
+    for (unsigned Flag : FlagsSeen) {
+      if (Flag >= FlagTranslationUnits.size())
+        FlagTranslationUnits.resize(Flags.size());
+      ++FlagTranslationUnits[Flag];
+    }
+  }
+};
+
+/// \brief Reads the diagnostics of one file into an aggregator. The file
+/// and flag IDs of a file are mapped to the interned IDs as their records are
+/// read.
+class DiagnosticAggregator::Reader : public SerializedDiagnosticReader {
+  Impl &Agg;
+  llvm::DenseMap<unsigned, unsigned> FileIDs, FlagIDs;
+  llvm::DenseSet<unsigned> FlagsSeen;
+  unsigned Depth = 0;
+
+public:
+  explicit Reader(Impl &Agg) : Agg(Agg) {}
+
+  /// \brief The flags that the file reports, in no particular order.
+  std::vector<unsigned> getFlagsSeen() const {
+    return std::vector<unsigned>(FlagsSeen.begin(), FlagsSeen.end());
+  }
+
+protected:
+  std::error_code visitStartOfDiagnostic() override {
+    ++Depth;
+    return std::error_code();
+  }
+
+  std::error_code visitEndOfDiagnostic() override {
+    --Depth;
+    return std::error_code();
+  }
+
+  std::error_code visitDiagFlagRecord(unsigned ID, StringRef Name) override {
+    FlagIDs[ID] = Agg.Flags.intern(Name);
+    return std::error_code();
+  }
+
+  std::error_code visitFilenameRecord(unsigned ID, unsigned Size,
+                                      unsigned Timestamp,
+                                      StringRef Name) override {
+    FileIDs[ID] = Agg.Files.intern(Name);
+    return std::error_code();
+  }
+
+  std::error_code visitDiagnosticRecord(unsigned Severity,
+                                        const Location &Location,
+                                        unsigned Category, unsigned Flag,
+                                        StringRef Message) override {
+    // Notes are nested in the diagnostic they belong to.
+    if (Depth > 1 || Severity == Note)
+      return std::error_code();
+
+    DiagnosticKey Key = {Severity, FileIDs.lookup(Location.FileID),
+                         Location.Line, Location.Col, FlagIDs.lookup(Flag),
+                         Agg.Messages.intern(Message)};
+    ++Agg.Occurrences[Key];
+    ++Agg.NumDiagnostics;
+    FlagsSeen.insert(Key.Flag);
+    return std::error_code();
+  }
+};
+
+DiagnosticAggregator::DiagnosticAggregator() : TheImpl(new Impl) {}
+
+DiagnosticAggregator::~DiagnosticAggregator() {}
+
+std::error_code DiagnosticAggregator::addFile(StringRef File) {
+  // Read into a separate aggregator, so that nothing is merged from a file
+  // that is only partially readable.
+  DiagnosticAggregator FileAgg;
+  Reader FileReader(*FileAgg.TheImpl);
+  if (std::error_code EC = FileReader.readDiagnostics(File))
+    return EC;
+  FileAgg.TheImpl->addTranslationUnit(FileReader.getFlagsSeen());
+  merge(FileAgg);
+  return std::error_code();
+}
+
+void DiagnosticAggregator::merge(const DiagnosticAggregator &Other) {
+  Impl &Agg = *TheImpl;
+  const Impl &OtherAgg = *Other.TheImpl;
+
+  // Map the IDs of Other to those of this aggregator.
+  auto MapTable = [](StringTable &To, const StringTable &From) {
+    std::vector<unsigned> IDs(From.size());
+    for (unsigned I = 0, E = From.size(); I != E; ++I)
+      IDs[I] = To.intern(From[I]);
+    return IDs;
+  };
+  std::vector<unsigned> FileIDs = MapTable(Agg.Files, OtherAgg.Files);
+  std::vector<unsigned> FlagIDs = MapTable(Agg.Flags, OtherAgg.Flags);
+  std::vector<unsigned> MessageIDs = MapTable(Agg.Messages, OtherAgg.Messages);
+
+  for (const auto &Entry : OtherAgg.Occurrences) {
+    DiagnosticKey Key = Entry.first;
+    Key.File = FileIDs[Key.File];
+    Key.Flag = FlagIDs[Key.Flag];
+    Key.Message = MessageIDs[Key.Message];
+    Agg.Occurrences[Key] += Entry.second;
+  }
+
+  Agg.FlagTranslationUnits.resize(Agg.Flags.size());
+  for (unsigned I = 0, E = OtherAgg.FlagTranslationUnits.size(); I != E; ++I)
+    Agg.FlagTranslationUnits[FlagIDs[I]] += OtherAgg.FlagTranslationUnits[I];
+
+  Agg.NumFiles += OtherAgg.NumFiles;
+  Agg.NumDiagnostics += OtherAgg.NumDiagnostics;
+}
+
+void DiagnosticAggregator::addFiles(
+    ArrayRef<std::string> Files, unsigned NumThreads,
+    llvm::function_ref<void(StringRef, std::error_code)> OnError) {
+  NumThreads = std::max(1U, std::min<unsigned>(NumThreads, Files.size()));
+
+  // Each thread takes the next file to read and merges it into its own
+  // aggregator, which are merged once all the files are read.
+  std::vector<DiagnosticAggregator> Shards(NumThreads);
+  std::vector<std::error_code> Errors(Files.size());
+  std::atomic<unsigned> NextFile(0);
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (unsigned Shard = 0; Shard != NumThreads; ++Shard) {
+      Pool.async([&, Shard] {
+        for (unsigned I = NextFile++; I < Files.size(); I = NextFile++)
+          Errors[I] = Shards[Shard].addFile(Files[I]);
+      });
+    }
+    Pool.wait();
+  }
+
+  for (const DiagnosticAggregator &Shard : Shards)
+    merge(Shard);
+  for (unsigned I = 0, E = Files.size(); I != E; ++I)
+    if (Errors[I])
+      OnError(Files[I], Errors[I]);
+}
+
+unsigned DiagnosticAggregator::getNumFiles() const {
+  return TheImpl->NumFiles;
+}
+
+unsigned DiagnosticAggregator::getNumDiagnostics() const {
+  return TheImpl->NumDiagnostics;
+}
+
+unsigned DiagnosticAggregator::getNumUniqueDiagnostics() const {
+  return TheImpl->Occurrences.size();
+}
+
+std::vector<DiagnosticFlagSummary> DiagnosticAggregator::summarize() const {
+  const Impl &Agg = *TheImpl;
+  std::vector<DiagnosticFlagSummary> Summaries(Agg.Flags.size());
+  llvm::DenseSet<std::pair<unsigned, unsigned>> FlagFiles;
+  for (const auto &Entry : Agg.Occurrences) {
+    const DiagnosticKey &Key = Entry.first;
+    DiagnosticFlagSummary &Summary = Summaries[Key.Flag];
+    Summary.Occurrences += Entry.second;
+    ++Summary.Unique;
+    if (Key.Severity == Error || Key.Severity == Fatal)
+      ++Summary.Errors;
+    if (FlagFiles.insert(std::make_pair(Key.Flag, Key.File)).second)
+      ++Summary.SourceFiles;
+  }
+  for (unsigned I = 0, E = Summaries.size(); I != E; ++I) {
+    Summaries[I].Flag = Agg.Flags[I];
+    if (I < Agg.FlagTranslationUnits.size())
+      Summaries[I].TranslationUnits = Agg.FlagTranslationUnits[I];
+  }
+
+  Summaries.erase(std::remove_if(Summaries.begin(), Summaries.end(),
+                                 [](const DiagnosticFlagSummary &Summary) {
+                                   return Summary.Unique == 0;
+                                 }),
+                  Summaries.end());
+  std::sort(Summaries.begin(), Summaries.end(),
+            [](const DiagnosticFlagSummary &LHS,
+               const DiagnosticFlagSummary &RHS) {
+              if (LHS.Occurrences != RHS.Occurrences)
+                return LHS.Occurrences > RHS.Occurrences;
+              return LHS.Flag < RHS.Flag;
+            });
+  return Summaries;
+}
@@ -0,0 +1,691 @@
+//===--- SymbolIndex.cpp - Persistent, sharded symbol index ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Every shard of the index is a single file, laid out as follows (all integers
+// are little-endian):
+//
+//   header:     "CIDX", version, main file, file table offset, symbol table
+//               offset, symbol table bucket offset (all 32-bit)
+//   symbols:    on-disk chained hash table from USR to symbol data
+//   file table: 32-bit file count, then 16-bit length + path for each file
+//
+// The symbol data is the symbol kind (8-bit), the occurrences of the symbol
+// and the relations other symbols have to it. Each occurrence is stored as
+// file, line, column, roles (32-bit each) and its relations; each relation is
+// stored as roles (32-bit) and a USR (16-bit length + bytes).
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/SymbolIndex.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Lex/MacroInfo.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <set>
+#include <tuple>
+
+using namespace clang;
+using namespace clang::index;
+
+/// \brief The symbol index shard format version.
+static const unsigned CurrentVersion = 1;
+
+/// \brief The extension used for symbol index shards.
+static const char ShardExtension[] = ".cidx";
+
+/// \brief The size of the shard header, in bytes.
+static const unsigned HeaderSize = 24;
+
+//----------------------------------------------------------------------------//
+// Shard writer.
+//----------------------------------------------------------------------------//
+
+namespace {
+
+/// \brief Trait used to write the symbol table of a shard. The data of each
+/// symbol is serialized up front.
+class SymbolTableWriterTrait {
+public:
+  typedef StringRef key_type;
+  typedef StringRef key_type_ref;
+  typedef StringRef data_type;
+  typedef StringRef data_type_ref;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static hash_value_type ComputeHash(key_type_ref Key) {
+    return llvm::HashString(Key);
+  }
+
+  std::pair<unsigned,unsigned>
+  EmitKeyDataLength(raw_ostream& Out, key_type_ref Key, data_type_ref Data) {
+    using namespace llvm::support;
+    endian::Writer<little> LE(Out);
+    unsigned KeyLen = Key.size();
+    unsigned DataLen = Data.size();
+    LE.write<uint16_t>(KeyLen);
+    LE.write<uint32_t>(DataLen);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  void EmitKey(raw_ostream& Out, key_type_ref Key, unsigned KeyLen) {
+    Out.write(Key.data(), KeyLen);
+  }
+
+  void EmitData(raw_ostream& Out, key_type_ref Key, data_type_ref Data,
+                unsigned DataLen) {
+    Out.write(Data.data(), DataLen);
+  }
+};
+
+} // end anonymous namespace
+
+static void emitUSR(llvm::support::endian::Writer<llvm::support::little> &LE,
+                    raw_ostream &Out, StringRef USR) {
+  LE.write<uint16_t>(USR.size());
+  Out << USR;
+}
+
+SymbolIndexShardBuilder::SymbolIndexShardBuilder(StringRef MainFilePath)
+  : MainFilePath(MainFilePath) {
+  getFileID(MainFilePath);
+}
+
+unsigned SymbolIndexShardBuilder::getFileID(StringRef Path) {
+  auto Known = FileIDs.insert(std::make_pair(Path, Files.size()));
+  if (Known.second)
+    Files.push_back(Known.first->first());
+  return Known.first->second;
+}
+
+void SymbolIndexShardBuilder::addOccurrence(
+    StringRef USR, SymbolKind Kind, SymbolRoleSet Roles, StringRef FilePath,
+    unsigned Line, unsigned Column, ArrayRef<StoredSymbolRelation> Relations) {
+  // USRs are stored with a 16-bit length.
+  if (USR.empty() || USR.size() > UINT16_MAX)
+    return;
+
+  SymbolData &Symbol = Symbols[USR];
+  Symbol.Kind = Kind;
+
+  Occurrence Occur;
+  Occur.File = getFileID(FilePath);
+  Occur.Line = Line;
+  Occur.Column = Column;
+  Occur.Roles = Roles;
+  for (const StoredSymbolRelation &Rel : Relations) {
+    if (Rel.USR.empty() || Rel.USR.size() > UINT16_MAX)
+      continue;
+    Occur.Relations.push_back(std::make_pair(Rel.Roles, Rel.USR.str()));
+
+    // Record the inverse relation, so that queries such as "who overrides
+    // this method" only need to look at the related symbol.
+    Symbols[Rel.USR].IncomingRelations.push_back(
+        std::make_pair(Rel.Roles, USR.str()));
+  }
+  Symbol.Occurrences.push_back(std::move(Occur));
+}
+
+void SymbolIndexShardBuilder::emit(SmallVectorImpl<char> &Buffer) const {
+  using namespace llvm::support;
+
+  // Serialize the data of each symbol, dropping the duplicate occurrences
+  // reported e.g. for implicit references.
+  std::vector<std::pair<StringRef, std::string>> SymbolBlobs;
+  SymbolBlobs.reserve(Symbols.size());
+  for (const auto &Entry : Symbols) {
+    const SymbolData &Symbol = Entry.second;
+
+    std::vector<const Occurrence *> Occurrences;
+    std::set<std::tuple<unsigned, unsigned, unsigned, SymbolRoleSet>> Seen;
+    for (const Occurrence &Occur : Symbol.Occurrences)
+      if (Seen.insert(std::make_tuple(Occur.File, Occur.Line, Occur.Column,
+                                      Occur.Roles)).second)
+        Occurrences.push_back(&Occur);
+
+    std::vector<std::pair<SymbolRoleSet, StringRef>> Incoming;
+    std::set<std::pair<SymbolRoleSet, StringRef>> SeenIncoming;
+    for (const auto &Rel : Symbol.IncomingRelations)
+      if (SeenIncoming.insert(std::make_pair(Rel.first,
+                                             StringRef(Rel.second))).second)
+        Incoming.push_back(std::make_pair(Rel.first, Rel.second));
+
+    std::string Blob;
+    llvm::raw_string_ostream Out(Blob);
+    endian::Writer<little> LE(Out);
+    LE.write<uint8_t>((uint8_t)Symbol.Kind);
+    LE.write<uint32_t>(Occurrences.size());
+    for (const Occurrence *Occur : Occurrences) {
+      LE.write<uint32_t>(Occur->File);
+      LE.write<uint32_t>(Occur->Line);
+      LE.write<uint32_t>(Occur->Column);
+      LE.write<uint32_t>(Occur->Roles);
+      LE.write<uint16_t>(Occur->Relations.size());
+      for (const auto &Rel : Occur->Relations) {
+        LE.write<uint32_t>(Rel.first);
+        emitUSR(LE, Out, Rel.second);
+      }
+    }
+    LE.write<uint32_t>(Incoming.size());
+    for (const auto &Rel : Incoming) {
+      LE.write<uint32_t>(Rel.first);
+      emitUSR(LE, Out, Rel.second);
+    }
+    Out.flush();
+
+    SymbolBlobs.push_back(std::make_pair(Entry.first(), std::move(Blob)));
+  }
+
+  // Build the symbol table.
+  llvm::OnDiskChainedHashTableGenerator<SymbolTableWriterTrait> Generator;
+  SymbolTableWriterTrait Trait;
+  for (const auto &Blob : SymbolBlobs)
+    Generator.insert(Blob.first, Blob.second, Trait);
+
+  SmallString<4096> SymbolTable;
+  uint32_t BucketOffset;
+  {
+    llvm::raw_svector_ostream Out(SymbolTable);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(Out).write<uint32_t>(0);
+    BucketOffset = Generator.Emit(Out, Trait);
+  }
+
+  // Write the shard.
+  llvm::raw_svector_ostream Out(Buffer);
+  endian::Writer<little> LE(Out);
+  Out << "CIDX";
+  LE.write<uint32_t>(CurrentVersion);
+  LE.write<uint32_t>(0); // The main file is always the first file.
+  LE.write<uint32_t>(HeaderSize + SymbolTable.size());
+  LE.write<uint32_t>(HeaderSize);
+  LE.write<uint32_t>(BucketOffset);
+  Out << SymbolTable;
+
+  LE.write<uint32_t>(Files.size());
+  for (StringRef File : Files) {
+    LE.write<uint16_t>(File.size());
+    Out << File;
+  }
+}
+
+bool SymbolIndexShardBuilder::writeToDirectory(StringRef IndexDir,
+                                               std::string &Error) const {
+  if (std::error_code EC = llvm::sys::fs::create_directories(IndexDir)) {
+    Error = "unable to create index directory '" + IndexDir.str() +
+            "': " + EC.message();
+    return true;
+  }
+
+  SmallString<128> ShardPath(IndexDir);
+  llvm::sys::path::append(ShardPath,
+                          SymbolIndex::getShardFileName(MainFilePath));
+
+  SmallVector<char, 16> OutputBuffer;
+  emit(OutputBuffer);
+
+  // Write the shard to a temporary file, then move it into place so that
+  // concurrent readers never see a partially-written shard.
+  SmallString<128> ShardTmpPath;
+  int TmpFD;
+  if (std::error_code EC = llvm::sys::fs::createUniqueFile(
+          ShardPath + "-%%%%%%%%", TmpFD, ShardTmpPath)) {
+    Error = "unable to create temporary file in '" + IndexDir.str() +
+            "': " + EC.message();
+    return true;
+  }
+
+  llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+  Out.write(OutputBuffer.data(), OutputBuffer.size());
+  Out.close();
+  if (Out.has_error()) {
+    Out.clear_error();
+    llvm::sys::fs::remove(ShardTmpPath);
+    Error = "unable to write '" + ShardTmpPath.str().str() + "'";
+    return true;
+  }
+
+  if (std::error_code EC = llvm::sys::fs::rename(ShardTmpPath, ShardPath)) {
+    llvm::sys::fs::remove(ShardTmpPath);
+    Error = "unable to rename '" + ShardTmpPath.str().str() + "' to '" +
+            ShardPath.str().str() + "': " + EC.message();
+    return true;
+  }
+
+  return false;
+}
+
+//----------------------------------------------------------------------------//
+// Index data consumer.
+//----------------------------------------------------------------------------//
+
+SymbolIndexRecorder::SymbolIndexRecorder(StringRef IndexDir)
+  : IndexDir(IndexDir), SM(nullptr) {}
+
+SymbolIndexRecorder::~SymbolIndexRecorder() {}
+
+void SymbolIndexRecorder::initialize(ASTContext &Ctx) {
+  SM = &Ctx.getSourceManager();
+  StringRef MainFilePath;
+  if (const FileEntry *MainFile = SM->getFileEntryForID(SM->getMainFileID()))
+    MainFilePath = MainFile->getName();
+  Builder.reset(new SymbolIndexShardBuilder(MainFilePath));
+}
+
+StringRef SymbolIndexRecorder::getUSR(const Decl *D) {
+  D = D->getCanonicalDecl();
+  StringRef USR = USRs.lookup(D);
+  if (!USR.empty())
+    return USR;
+
+  SmallString<128> Buf;
+  if (generateUSRForDecl(D, Buf, &USRs))
+    return StringRef();
+  return USRs.lookup(D);
+}
+
+StringRef SymbolIndexRecorder::getFilePath(FileID FID) {
+  if (const FileEntry *File = SM->getFileEntryForID(FID))
+    return File->getName();
+  return StringRef();
+}
+
+bool SymbolIndexRecorder::handleDeclOccurence(
+    const Decl *D, SymbolRoleSet Roles, ArrayRef<SymbolRelation> Relations,
+    FileID FID, unsigned Offset, ASTNodeInfo ASTNode) {
+  StringRef FilePath = getFilePath(FID);
+  if (FilePath.empty())
+    return true;
+
+  StringRef USR = getUSR(D);
+  if (USR.empty())
+    return true;
+
+  SmallVector<StoredSymbolRelation, 4> StoredRelations;
+  for (const SymbolRelation &Rel : Relations) {
+    StringRef RelUSR = getUSR(Rel.RelatedSymbol);
+    if (!RelUSR.empty())
+      StoredRelations.push_back(StoredSymbolRelation(Rel.Roles, RelUSR));
+  }
+
+  Builder->addOccurrence(USR, getSymbolInfo(D).Kind, Roles, FilePath,
+                         SM->getLineNumber(FID, Offset),
+                         SM->getColumnNumber(FID, Offset), StoredRelations);
+  return true;
+}
+
+bool SymbolIndexRecorder::handleMacroOccurence(const IdentifierInfo *Name,
+                                               const MacroInfo *MI,
+                                               SymbolRoleSet Roles,
+                                               FileID FID, unsigned Offset) {
+  StringRef FilePath = getFilePath(FID);
+  if (FilePath.empty() || !MI)
+    return true;
+
+  SmallString<128> USR;
+  if (generateUSRForMacro(Name->getName(), MI->getDefinitionLoc(), *SM, USR))
+    return true;
+
+  Builder->addOccurrence(USR, SymbolKind::Macro, Roles, FilePath,
+                         SM->getLineNumber(FID, Offset),
+                         SM->getColumnNumber(FID, Offset), None);
+  return true;
+}
+
+void SymbolIndexRecorder::finish() {
+  if (!Builder || Builder->getMainFilePath().empty())
+    return;
+  Builder->writeToDirectory(IndexDir, Error);
+  Builder.reset();
+  USRs.clear();
+}
+
+//----------------------------------------------------------------------------//
+// Index reader.
+//----------------------------------------------------------------------------//
+
+namespace {
+
+/// \brief Trait used to read the symbol table of a shard. The symbol data is
+/// decoded lazily by the queries.
+class SymbolTableReaderTrait {
+public:
+  typedef StringRef external_key_type;
+  typedef StringRef internal_key_type;
+  typedef StringRef data_type;
+  typedef unsigned hash_value_type;
+  typedef unsigned offset_type;
+
+  static bool EqualKey(const internal_key_type& a, const internal_key_type& b) {
+    return a == b;
+  }
+
+  static hash_value_type ComputeHash(const internal_key_type& a) {
+    return llvm::HashString(a);
+  }
+
+  static std::pair<unsigned, unsigned>
+  ReadKeyDataLength(const unsigned char*& d) {
+    using namespace llvm::support;
+    unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(d);
+    unsigned DataLen = endian::readNext<uint32_t, little, unaligned>(d);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static const internal_key_type&
+  GetInternalKey(const external_key_type& x) { return x; }
+
+  static const external_key_type&
+  GetExternalKey(const internal_key_type& x) { return x; }
+
+  static internal_key_type ReadKey(const unsigned char* d, unsigned n) {
+    return StringRef((const char *)d, n);
+  }
+
+  static data_type ReadData(const internal_key_type& k,
+                            const unsigned char* d,
+                            unsigned DataLen) {
+    return StringRef((const char *)d, DataLen);
+  }
+};
+
+typedef llvm::OnDiskChainedHashTable<SymbolTableReaderTrait> SymbolTable;
+
+/// \brief Reads the serialized symbol data, checking that every read stays
+/// within the data.
+class SymbolDataReader {
+  const unsigned char *Ptr;
+  const unsigned char *End;
+  bool Invalid;
+
+public:
+  explicit SymbolDataReader(StringRef Data)
+    : Ptr((const unsigned char *)Data.begin()),
+      End((const unsigned char *)Data.end()), Invalid(false) {}
+
+  bool isInvalid() const { return Invalid; }
+
+  template <typename T> T read() {
+    using namespace llvm::support;
+    if (Invalid || End - Ptr < (ptrdiff_t)sizeof(T)) {
+      Invalid = true;
+      return T();
+    }
+    return endian::readNext<T, little, unaligned>(Ptr);
+  }
+
+  StringRef readString() {
+    unsigned Len = read<uint16_t>();
+    if (Invalid || End - Ptr < (ptrdiff_t)Len) {
+      Invalid = true;
+      return StringRef();
+    }
+    StringRef Str((const char *)Ptr, Len);
+    Ptr += Len;
+    return Str;
+  }
+};
+
+} // end anonymous namespace
+
+class SymbolIndex::Shard {
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<SymbolTable> Table;
+  std::vector<StringRef> Files;
+
+  Shard(std::unique_ptr<llvm::MemoryBuffer> Buffer)
+    : Buffer(std::move(Buffer)) {}
+
+public:
+  /// \brief The modification time and size of the shard file, used to detect
+  /// that it was rewritten.
+  llvm::sys::TimePoint<> ModTime;
+  uint64_t Size;
+
+  /// \brief Load the shard from the given buffer.
+  ///
+  /// \returns the shard, or null if the buffer is not a valid shard.
+  static std::unique_ptr<Shard>
+  load(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+    using namespace llvm::support;
+
+    StringRef Data = Buffer->getBuffer();
+    if (Data.size() < HeaderSize || !Data.startswith("CIDX"))
+      return nullptr;
+
+    const unsigned char *Start = (const unsigned char *)Data.data();
+    const unsigned char *Ptr = Start + 4;
+    unsigned Version = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    unsigned MainFile = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    unsigned FileTableOffset =
+        endian::readNext<uint32_t, little, unaligned>(Ptr);
+    unsigned TableOffset = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    unsigned BucketOffset = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    if (Version != CurrentVersion || MainFile != 0 ||
+        FileTableOffset > Data.size() || TableOffset > FileTableOffset ||
+        BucketOffset == 0 || BucketOffset >= FileTableOffset - TableOffset)
+      return nullptr;
+
+    std::unique_ptr<Shard> S(new Shard(std::move(Buffer)));
+
+    SymbolDataReader FileTable(Data.substr(FileTableOffset));
+    unsigned NumFiles = FileTable.read<uint32_t>();
+    for (unsigned I = 0; I != NumFiles && !FileTable.isInvalid(); ++I)
+      S->Files.push_back(FileTable.readString());
+    if (FileTable.isInvalid() || S->Files.empty())
+      return nullptr;
+
+    S->Table.reset(SymbolTable::Create(Start + TableOffset + BucketOffset,
+                                       Start + TableOffset));
+    return S;
+  }
+
+  StringRef getMainFilePath() const { return Files.front(); }
+
+  /// \brief Find the serialized data of the symbol with the given USR.
+  StringRef lookup(StringRef USR) const {
+    auto Known = Table->find(USR);
+    if (Known == Table->end())
+      return StringRef();
+    return *Known;
+  }
+
+  StringRef getFile(unsigned ID) const {
+    return ID < Files.size() ? Files[ID] : StringRef();
+  }
+};
+
+SymbolIndex::SymbolIndex(StringRef IndexDir) : IndexDir(IndexDir) {}
+
+SymbolIndex::~SymbolIndex() {}
+
+std::unique_ptr<SymbolIndex> SymbolIndex::open(StringRef IndexDir,
+                                               std::string &Error) {
+  if (!llvm::sys::fs::is_directory(IndexDir)) {
+    Error = "symbol index directory '" + IndexDir.str() + "' does not exist";
+    return nullptr;
+  }
+
+  std::unique_ptr<SymbolIndex> Index(new SymbolIndex(IndexDir));
+  if (Index->update(Error))
+    return nullptr;
+  return Index;
+}
+
+bool SymbolIndex::update(std::string &Error) {
+  llvm::StringSet<> Present;
+
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator Dir(IndexDir, EC), DirEnd;
+       Dir != DirEnd && !EC; Dir.increment(EC)) {
+    StringRef Path = Dir->path();
+    if (llvm::sys::path::extension(Path) != ShardExtension)
+      continue;
+
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status))
+      continue;
+    Present.insert(Path);
+
+    // Skip shards that have not changed since we loaded them.
+    auto Known = Shards.find(Path.str());
+    if (Known != Shards.end() &&
+        Known->second->ModTime == Status.getLastModificationTime() &&
+        Known->second->Size == Status.getSize())
+      continue;
+
+    // Shards that cannot be read are ignored; they will be rewritten the next
+    // time their translation unit is indexed.
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    std::unique_ptr<Shard> S;
+    if (Buffer)
+      S = Shard::load(std::move(*Buffer));
+    if (!S) {
+      if (Known != Shards.end())
+        Shards.erase(Known);
+      continue;
+    }
+
+    S->ModTime = Status.getLastModificationTime();
+    S->Size = Status.getSize();
+    Shards[Path.str()] = std::move(S);
+  }
+
+  if (EC) {
+    Error = "unable to read symbol index directory '" + IndexDir + "': " +
+            EC.message();
+    return true;
+  }
+
+  // Drop the shards that were removed.
+  for (auto I = Shards.begin(), E = Shards.end(); I != E;) {
+    if (Present.count(I->first))
+      ++I;
+    else
+      I = Shards.erase(I);
+  }
+
+  return false;
+}
+
+void SymbolIndex::forEachOccurrence(
+    StringRef USR, SymbolRoleSet Roles,
+    llvm::function_ref<bool(const StoredSymbolOccurrence &)> Receiver) const {
+  // Headers are indexed as part of every translation unit that includes them,
+  // so the same occurrence may be found in several shards.
+  std::set<std::tuple<StringRef, unsigned, unsigned, SymbolRoleSet>> Seen;
+
+  for (const auto &Entry : Shards) {
+    const Shard &S = *Entry.second;
+    StringRef Data = S.lookup(USR);
+    if (Data.empty())
+      continue;
+
+    SymbolDataReader Reader(Data);
+    StoredSymbolOccurrence Occur;
+    Occur.USR = USR;
+    Occur.Kind = (SymbolKind)Reader.read<uint8_t>();
+    unsigned NumOccurrences = Reader.read<uint32_t>();
+    for (unsigned I = 0; I != NumOccurrences; ++I) {
+      Occur.FilePath = S.getFile(Reader.read<uint32_t>());
+      Occur.Line = Reader.read<uint32_t>();
+      Occur.Column = Reader.read<uint32_t>();
+      Occur.Roles = Reader.read<uint32_t>();
+      Occur.Relations.clear();
+      unsigned NumRelations = Reader.read<uint16_t>();
+      for (unsigned R = 0; R != NumRelations; ++R) {
+        SymbolRoleSet RelRoles = Reader.read<uint32_t>();
+        Occur.Relations.push_back(
+            StoredSymbolRelation(RelRoles, Reader.readString()));
+      }
+      if (Reader.isInvalid())
+        break;
+
+      if (Roles && !(Occur.Roles & Roles))
+        continue;
+      if (!Seen.insert(std::make_tuple(Occur.FilePath, Occur.Line,
+                                       Occur.Column, Occur.Roles)).second)
+        continue;
+      if (!Receiver(Occur))
+        return;
+    }
+  }
+}
+
+void SymbolIndex::forEachRelatedSymbol(
+    StringRef USR, SymbolRoleSet Roles,
+    llvm::function_ref<bool(StringRef)> Receiver) const {
+  llvm::StringSet<> Seen;
+
+  for (const auto &Entry : Shards) {
+    StringRef Data = Entry.second->lookup(USR);
+    if (Data.empty())
+      continue;
+
+    // Skip over the occurrences to get to the incoming relations.
+    SymbolDataReader Reader(Data);
+    Reader.read<uint8_t>();
+    unsigned NumOccurrences = Reader.read<uint32_t>();
+    for (unsigned I = 0; I != NumOccurrences && !Reader.isInvalid(); ++I) {
+      Reader.read<uint32_t>();
+      Reader.read<uint32_t>();
+      Reader.read<uint32_t>();
+      Reader.read<uint32_t>();
+      unsigned NumRelations = Reader.read<uint16_t>();
+      for (unsigned R = 0; R != NumRelations; ++R) {
+        Reader.read<uint32_t>();
+        Reader.readString();
+      }
+    }
+
+    unsigned NumIncoming = Reader.read<uint32_t>();
+    for (unsigned I = 0; I != NumIncoming; ++I) {
+      SymbolRoleSet RelRoles = Reader.read<uint32_t>();
+      StringRef RelUSR = Reader.readString();
+      if (Reader.isInvalid())
+        break;
+      if (!(RelRoles & Roles) || !Seen.insert(RelUSR).second)
+        continue;
+      if (!Receiver(RelUSR))
+        return;
+    }
+  }
+}
+
+std::string SymbolIndex::getShardFileName(StringRef MainFilePath) {
+  // Name the shard after the main file so the index directory is easy to
+  // inspect, and disambiguate files with the same name by hashing the path.
+  llvm::MD5 Hash;
+  Hash.update(MainFilePath);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> HashStr;
+  llvm::MD5::stringifyResult(Result, HashStr);
+
+  return (llvm::sys::path::filename(MainFilePath) + "-" + HashStr +
+          ShardExtension).str();
+}
+
+bool SymbolIndex::removeShard(StringRef IndexDir, StringRef MainFilePath) {
+  SmallString<128> ShardPath(IndexDir);
+  llvm::sys::path::append(ShardPath, getShardFileName(MainFilePath));
+  return bool(llvm::sys::fs::remove(ShardPath));
+}
@@ -12,6 +12,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Lex/PreprocessingRecord.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -62,16 +63,19 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  USRCache *Cache;
   
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
   
 public:
-  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf)
+  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf,
+                        USRCache *Cache = nullptr)
   : Buf(Buf),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << getUSRSpacePrefix();
@@ -79,6 +83,12 @@ public:
 
   bool ignoreResults() const { return IgnoreResults; }
 
+  /// Whether the generator is in its initial state, in which the USR
+  /// fragment generated for a declaration is the same as its own USR.
+  bool isPristine() const {
+    return !IgnoreResults && !generatedLoc && TypeSubstitutions.empty();
+  }
+
   // Visitation methods from generating USRs from AST elements.
   void VisitDeclContext(const DeclContext *D);
   void VisitFieldDecl(const FieldDecl *D);
@@ -196,8 +206,31 @@ bool USRGenerator::ShouldGenerateLocation(const NamedDecl *D) {
 }
 
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
-  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
+  const NamedDecl *D = dyn_cast<NamedDecl>(DC);
+  if (!D)
+    return;
+
+  // Once a location or a type substitution was generated, visiting the
+  // context may produce something other than its USR.
+  if (!Cache || !isPristine()) {
     Visit(D);
+    return;
+  }
+
+  StringRef CachedUSR = Cache->lookup(D);
+  if (!CachedUSR.empty()) {
+    Out << CachedUSR.substr(getUSRSpacePrefix().size());
+    return;
+  }
+
+  const unsigned StartSize = Buf.size();
+  Visit(D);
+  if (!isPristine())
+    return;
+
+  SmallString<128> USR(getUSRSpacePrefix());
+  USR.append(Buf.begin() + StartSize, Buf.end());
+  Cache->insert(D, USR);
 }
 
 void USRGenerator::VisitFieldDecl(const FieldDecl *D) {
@@ -981,17 +1014,39 @@ void clang::index::generateUSRForEnumConstant(StringRef EnumConstantName,
   OS << '@' << EnumConstantName;
 }
 
+StringRef USRCache::insert(const Decl *D, StringRef USR) {
+  StringRef &Entry = USRs[D];
+  if (Entry.empty())
+    Entry = USR.copy(Alloc);
+  return Entry;
+}
+
 bool clang::index::generateUSRForDecl(const Decl *D,
-                                      SmallVectorImpl<char> &Buf) {
+                                      SmallVectorImpl<char> &Buf,
+                                      USRCache *Cache) {
   if (!D)
     return true;
   // We don't ignore decls with invalid source locations. Implicit decls, like
   // C++'s operator new function, can have invalid locations but it is fine to
   // create USRs that can identify them.
 
-  USRGenerator UG(&D->getASTContext(), Buf);
+  if (Cache) {
+    StringRef CachedUSR = Cache->lookup(D);
+    if (!CachedUSR.empty()) {
+      Buf.append(CachedUSR.begin(), CachedUSR.end());
+      return false;
+    }
+  }
+
+  const unsigned StartSize = Buf.size();
+  USRGenerator UG(&D->getASTContext(), Buf, Cache);
   UG.Visit(D);
-  return UG.ignoreResults();
+  if (UG.ignoreResults())
+    return true;
+
+  if (Cache)
+    Cache->insert(D, StringRef(Buf.data() + StartSize, Buf.size() - StartSize));
+  return false;
 }
 
 bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
@@ -0,0 +1,152 @@
+//===--- CompactTokenBuffer.cpp - Compact storage of tokens ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the CompactTokenBuffer class.
+//
+// Each token starts with its kind shifted left by one, as a ULEB128. If the
+// low bit is set, the token is the next verbatim token. Otherwise the kind is
+// followed by the flags (ULEB128), the difference between the raw encoding
+// of its location and that of the previous encoded token (SLEB128) and its
+// length (ULEB128). Tokens which are not literals then have one plus the
+// index of their IdentifierInfo, or zero if they have none (ULEB128).
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/CompactTokenBuffer.h"
+#include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace clang;
+
+/// getSpellingData - Return the characters of the token at \p Loc, which is
+/// where the literal data of a literal token at \p Loc points to, or null.
+static const char *getSpellingData(const SourceManager &SM,
+                                   SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return nullptr;
+  bool Invalid = false;
+  const char *Data = SM.getCharacterData(SM.getSpellingLoc(Loc), &Invalid);
+  return Invalid ? nullptr : Data;
+}
+
+/// canEncode - Return true if all the data of \p Tok can be recomputed from
+/// its kind, flags, location, length and identifier.
+static bool canEncode(const Token &Tok, const SourceManager &SM) {
+  if (Tok.isAnnotation() || Tok.is(tok::raw_identifier))
+    return false;
+  if (Tok.is(tok::eof))
+    return !Tok.getEofData();
+  if (Tok.isLiteral())
+    return Tok.getLiteralData() &&
+           Tok.getLiteralData() == getSpellingData(SM, Tok.getLocation());
+  return true;
+}
+
+void CompactTokenBuffer::encode(ArrayRef<Token> Toks,
+                                const SourceManager &SM) {
+  clear();
+
+  // Encode into a temporary buffer, so that the buffer is allocated to the
+  // exact size.
+  SmallVector<char, 256> Encoded;
+  llvm::raw_svector_ostream OS(Encoded);
+  SmallVector<IdentifierInfo *, 32> Idents;
+  SmallVector<Token, 4> Verbatim;
+  llvm::DenseMap<IdentifierInfo *, unsigned> IdentIDs;
+
+  unsigned PrevLoc = 0;
+  for (const Token &Tok : Toks) {
+    if (!canEncode(Tok, SM)) {
+      llvm::encodeULEB128((uint64_t(Tok.getKind()) << 1) | 1, OS);
+      Verbatim.push_back(Tok);
+      continue;
+    }
+
+    unsigned Loc = Tok.getLocation().getRawEncoding();
+    llvm::encodeULEB128(uint64_t(Tok.getKind()) << 1, OS);
+    llvm::encodeULEB128(Tok.getFlags(), OS);
+    llvm::encodeSLEB128(int64_t(Loc) - int64_t(PrevLoc), OS);
+    llvm::encodeULEB128(Tok.getLength(), OS);
+    PrevLoc = Loc;
+
+    if (Tok.isLiteral())
+      continue;
+    unsigned ID = 0;
+    if (IdentifierInfo *II = Tok.getIdentifierInfo()) {
+      unsigned &Entry = IdentIDs[II];
+      if (!Entry) {
+        Idents.push_back(II);
+        Entry = Idents.size();
+      }
+      ID = Entry;
+    }
+    llvm::encodeULEB128(ID, OS);
+  }
+
+  Bytes.append(Encoded.begin(), Encoded.end());
+  Identifiers.append(Idents.begin(), Idents.end());
+  VerbatimTokens.append(Verbatim.begin(), Verbatim.end());
+  NumTokens = Toks.size();
+}
+
+void CompactTokenBuffer::decode(SmallVectorImpl<Token> &Toks,
+                                const SourceManager &SM) const {
+  Toks.reserve(Toks.size() + NumTokens);
+
+  const uint8_t *Ptr = reinterpret_cast<const uint8_t *>(Bytes.data());
+  auto ReadULEB = [&Ptr]() {
+    unsigned N;
+    uint64_t Value = llvm::decodeULEB128(Ptr, &N);
+    Ptr += N;
+    return Value;
+  };
+  auto ReadSLEB = [&Ptr]() {
+    unsigned N;
+    int64_t Value = llvm::decodeSLEB128(Ptr, &N);
+    Ptr += N;
+    return Value;
+  };
+
+  unsigned PrevLoc = 0;
+  const Token *NextVerbatim = VerbatimTokens.begin();
+  for (unsigned I = 0; I != NumTokens; ++I) {
+    uint64_t Header = ReadULEB();
+    if (Header & 1) {
+      assert(NextVerbatim != VerbatimTokens.end() && "missing verbatim token");
+      Toks.push_back(*NextVerbatim++);
+      continue;
+    }
+
+    Token Tok;
+    Tok.startToken();
+    Tok.setKind(tok::TokenKind(Header >> 1));
+    Tok.setFlag(Token::TokenFlags(ReadULEB()));
+    PrevLoc = unsigned(int64_t(PrevLoc) + ReadSLEB());
+    Tok.setLocation(SourceLocation::getFromRawEncoding(PrevLoc));
+    Tok.setLength(ReadULEB());
+
+    if (Tok.isLiteral()) {
+      Tok.setLiteralData(getSpellingData(SM, Tok.getLocation()));
+    } else if (unsigned ID = ReadULEB()) {
+      assert(ID <= Identifiers.size() && "invalid identifier index");
+      Tok.setIdentifierInfo(Identifiers[ID - 1]);
+    }
+    Toks.push_back(Tok);
+  }
+  assert(Ptr == reinterpret_cast<const uint8_t *>(Bytes.end()) &&
+         NextVerbatim == VerbatimTokens.end() && "trailing encoded tokens");
+}
+
+void CompactTokenBuffer::clear() {
+  SmallVector<char, 0>().swap(Bytes);
+  SmallVector<IdentifierInfo *, 0>().swap(Identifiers);
+  SmallVector<Token, 0>().swap(VerbatimTokens);
+  NumTokens = 0;
+}
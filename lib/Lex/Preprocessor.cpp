@@ -745,24 +745,32 @@ bool Preprocessor::HandleIdentifier(Token &Identifier) {
 void Preprocessor::Lex(Token &Result) {
   // We loop here until a lex function returns a token; this avoids recursion.
   bool ReturnedToken;
+  // Whether the token comes from a lexer rather than from the cache of
+  // backtracked tokens or from a nested call to Lex(), which reported it.
+  bool LexedToken = false;
   do {
     switch (CurLexerKind) {
     case CLK_Lexer:
       ReturnedToken = CurLexer->Lex(Result);
+      LexedToken = true;
       break;
     case CLK_PTHLexer:
       ReturnedToken = CurPTHLexer->Lex(Result);
+      LexedToken = true;
       break;
     case CLK_TokenLexer:
       ReturnedToken = CurTokenLexer->Lex(Result);
+      LexedToken = true;
       break;
     case CLK_CachingLexer:
       CachingLex(Result);
       ReturnedToken = true;
+      LexedToken = false;
       break;
     case CLK_LexAfterModuleImport:
       LexAfterModuleImport(Result);
       ReturnedToken = true;
+      LexedToken = false;
       break;
     }
   } while (!ReturnedToken);
@@ -771,6 +779,24 @@ void Preprocessor::Lex(Token &Result) {
     setCodeCompletionIdentifierInfo(Result.getIdentifierInfo());
 
   LastTokenWasAt = Result.is(tok::at);
+
+  if (OnToken && LexedToken)
+    reportLexedToken(Result);
+}
+
+/// \brief Hand a token of the source to the token watcher, unless it is
+/// part of a directive or of the pre-expansion of a macro argument, whose
+/// tokens are returned again when the macro is expanded.
+void Preprocessor::reportLexedToken(const Token &Result) {
+  if (InMacroArgPreExpansion || Result.is(tok::eod))
+    return;
+  // Within a macro expansion, CurPPLexer is null; the directive, if any, is
+  // being parsed by the lexer of the file.
+  const PreprocessorLexer *FileLexer =
+      CurPPLexer ? CurPPLexer : getCurrentFileLexer();
+  if (FileLexer && FileLexer->ParsingPreprocessorDirective)
+    return;
+  OnToken(Result);
 }
 
 /// \brief Lex a token following the 'import' contextual keyword.
@@ -171,6 +171,7 @@ NamedDecl *Parser::ParseCXXInlineMethodDef(AccessSpecifier AS,
     // to know this.
     Actions.CheckForFunctionRedefinition(FD);
     FD->setWillHaveBody(true);
+    CompactLateParsedTokens(Toks, LM->CompactToks);
   } else {
     // If semantic analysis could not build a function declaration,
     // just throw away the late-parsed declaration.
@@ -220,6 +221,32 @@ void Parser::ParseCXXNonStaticMemberInitializer(Decl *VarD) {
   Eof.setLocation(Tok.getLocation());
   Eof.setEofData(VarD);
   Toks.push_back(Eof);
+  CompactLateParsedTokens(Toks, MI->CompactToks);
+}
+
+/// CompactLateParsedTokens - Move the tokens of a late parsed definition to
+/// \p Compact, which takes a few bytes per token instead of a Token. The
+/// tokens of all the inline functions of a class are kept until the class is
+/// complete, which takes a lot of memory for large classes. Short sequences
+/// are left alone, since they take little memory anyway.
+void Parser::CompactLateParsedTokens(CachedTokens &Toks,
+                                     CompactTokenBuffer &Compact) {
+  const unsigned MinTokensToCompact = 32;
+  if (Toks.size() < MinTokensToCompact)
+    return;
+  Compact.encode(Toks, PP.getSourceManager());
+  CachedTokens().swap(Toks);
+}
+
+/// ExpandLateParsedTokens - Move the tokens stored compactly by
+/// CompactLateParsedTokens back to \p Toks, to replay them.
+void Parser::ExpandLateParsedTokens(CompactTokenBuffer &Compact,
+                                    CachedTokens &Toks) {
+  if (Compact.empty())
+    return;
+  assert(Toks.empty() && "tokens stored both compactly and as is");
+  Compact.decode(Toks, PP.getSourceManager());
+  Compact.clear();
 }
 
 Parser::LateParsedDeclaration::~LateParsedDeclaration() {}
@@ -480,7 +507,42 @@ void Parser::ParseLexedMethodDefs(ParsingClass &Class) {
   }
 }
 
+/// DelayLexedMethodDef - With -flazy-inline-function-bodies, hand the tokens
+/// of the body of an inline member function from a header to Sema, which
+/// parses them at the end of the translation unit if the function is used.
+/// Returns true if the body was delayed.
+bool Parser::DelayLexedMethodDef(LexedMethod &LM) {
+  if (!getLangOpts().LazyInlineFunctionBodies ||
+      Actions.TUKind != TU_Complete || PP.isCodeCompletionEnabled() ||
+      LM.TemplateScope)
+    return false;
+
+  // The body of a member of a template is needed to instantiate it, and that
+  // of a member of a local class refers to the enclosing function. Constexpr
+  // functions and functions with a deduced return type need their body as
+  // soon as they are used, and the body of a function marked used or
+  // dllexport is always emitted.
+  auto *MD = dyn_cast_or_null<CXXMethodDecl>(LM.D);
+  if (!MD || MD->isInvalidDecl() || MD->isDependentContext() ||
+      MD->getParent()->isLocalClass() || MD->isConstexpr() ||
+      MD->getReturnType()->getContainedAutoType() ||
+      MD->hasAttr<UsedAttr>() || MD->hasAttr<DLLExportAttr>())
+    return false;
+
+  // Functions of the main file are the ones being compiled.
+  if (PP.getSourceManager().isInMainFile(MD->getLocation()))
+    return false;
+
+  MD->setWillHaveBody(false);
+  Actions.MarkAsLazyFunctionBody(MD, LM.Toks);
+  return true;
+}
+
 void Parser::ParseLexedMethodDef(LexedMethod &LM) {
+  ExpandLateParsedTokens(LM.CompactToks, LM.Toks);
+  if (DelayLexedMethodDef(LM))
+    return;
+
   // If this is a member template, introduce the template parameter scope.
   ParseScope TemplateScope(this, Scope::TemplateParamScope, LM.TemplateScope);
   TemplateParameterDepthRAII CurTemplateDepthTracker(TemplateParameterDepth);
@@ -608,6 +670,8 @@ void Parser::ParseLexedMemberInitializer(LateParsedMemberInitializer &MI) {
   if (!MI.Field || MI.Field->isInvalidDecl())
     return;
 
+  ExpandLateParsedTokens(MI.CompactToks, MI.Toks);
+
   // Append the current token at the end of the new token stream so that it
   // doesn't get lost.
   MI.Toks.push_back(Tok);
@@ -5372,6 +5372,26 @@ static SourceLocation getMissingDeclaratorIdLoc(Declarator &D,
   return Loc;
 }
 
+/// Whether the declarator so far consists only of a name, parentheses and
+/// pointer operators, none of which can declare anything when parsed.
+static bool hasOnlyPointerOrParenChunks(const Declarator &D) {
+  for (unsigned I = 0, E = D.getNumTypeObjects(); I != E; ++I) {
+    switch (D.getTypeObject(I).Kind) {
+    case DeclaratorChunk::Pointer:
+    case DeclaratorChunk::BlockPointer:
+    case DeclaratorChunk::Reference:
+    case DeclaratorChunk::MemberPointer:
+    case DeclaratorChunk::Paren:
+      break;
+    case DeclaratorChunk::Array:
+    case DeclaratorChunk::Function:
+    case DeclaratorChunk::Pipe:
+      return false;
+    }
+  }
+  return true;
+}
+
 /// ParseDirectDeclarator
 ///       direct-declarator: [C99 6.7.5]
 /// [C99]   identifier
@@ -5686,7 +5706,13 @@ void Parser::ParseDirectDeclarator(Declarator &D) {
         // The name of the declarator, if any, is tentatively declared within
         // a possible direct initializer.
         TentativelyDeclaredIdentifiers.push_back(D.getIdentifier());
+        // If the declaration statement was disambiguated, we may already know
+        // the answer for the first declarator, unless parsing it so far could
+        // have declared a name that changes it.
+        if (!D.isFirstDeclarator() || !hasOnlyPointerOrParenChunks(D))
+          FunctionDeclaratorResults.clear();
         bool IsFunctionDecl = isCXXFunctionDeclarator(&IsAmbiguous);
+        FunctionDeclaratorResults.clear();
         TentativelyDeclaredIdentifiers.pop_back();
         if (!IsFunctionDecl)
           break;
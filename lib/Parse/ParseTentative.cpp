@@ -132,6 +132,11 @@ bool Parser::isCXXSimpleDeclaration(bool AllowForRangeDecl) {
   // Ok, we have a simple-type-specifier/typename-specifier followed by a '(',
   // or an identifier which doesn't resolve as anything. We need tentative
   // parsing...
+  //
+  // What we find out about function declarators is kept until the declaration
+  // is parsed for real, see ParseDirectDeclarator; forget what we found for
+  // the previous statement.
+  FunctionDeclaratorResults.clear();
  
   {
     RevertingTentativeParsingAction PA(*this);
@@ -426,6 +431,7 @@ Parser::isCXXConditionDeclarationOrInitStatement(bool CanBeInitStatement) {
     return State.result();
 
   // It might be a declaration; we need tentative parsing.
+  FunctionDeclaratorResults.clear();
   RevertingTentativeParsingAction PA(*this);
 
   // FIXME: A tag definition unambiguously tells us this is an init-statement.
@@ -1680,28 +1686,19 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
 
-  RevertingTentativeParsingAction PA(*this);
-
-  ConsumeParen();
-  bool InvalidAsDeclaration = false;
-  TPResult TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
-  if (TPR == TPResult::Ambiguous) {
-    if (Tok.isNot(tok::r_paren))
-      TPR = TPResult::False;
-    else {
-      const Token &Next = NextToken();
-      if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const, tok::kw_volatile,
-                       tok::kw_throw, tok::kw_noexcept, tok::l_square,
-                       tok::l_brace, tok::kw_try, tok::equal, tok::arrow) ||
-          isCXX11VirtSpecifier(Next))
-        // The next token cannot appear after a constructor-style initializer,
-        // and can appear next in a function definition. This must be a function
-        // declarator.
-        TPR = TPResult::True;
-      else if (InvalidAsDeclaration)
-        // Use the absence of 'typename' as a tie-breaker.
-        TPR = TPResult::False;
-    }
+  auto Key = std::make_pair(Tok.getLocation().getRawEncoding(),
+                            unsigned(TentativelyDeclaredIdentifiers.size()));
+  auto Known = FunctionDeclaratorResults.find(Key);
+  TPResult TPR;
+  if (Known != FunctionDeclaratorResults.end()) {
+    TPR = Known->second;
+  } else {
+    // Only remember what we found while disambiguating a statement; see
+    // isCXXSimpleDeclaration.
+    bool IsTentative = PP.isBacktrackEnabled();
+    TPR = TryParseFunctionDeclaratorOrDirectInit();
+    if (IsTentative)
+      FunctionDeclaratorResults[Key] = TPR;
   }
 
   if (IsAmbiguous && TPR == TPResult::Ambiguous)
@@ -1711,6 +1708,38 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   return TPR != TPResult::False;
 }
 
+/// Tentatively parse the '(' at the current position as the start of a
+/// function declarator, as opposed to a constructor-style initializer, and
+/// revert.
+Parser::TPResult Parser::TryParseFunctionDeclaratorOrDirectInit() {
+  RevertingTentativeParsingAction PA(*this);
+
+  ConsumeParen();
+  bool InvalidAsDeclaration = false;
+  TPResult TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
+  if (TPR != TPResult::Ambiguous)
+    return TPR;
+
+  if (Tok.isNot(tok::r_paren))
+    return TPResult::False;
+
+  const Token &Next = NextToken();
+  if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const, tok::kw_volatile,
+                   tok::kw_throw, tok::kw_noexcept, tok::l_square,
+                   tok::l_brace, tok::kw_try, tok::equal, tok::arrow) ||
+      isCXX11VirtSpecifier(Next))
+    // The next token cannot appear after a constructor-style initializer,
+    // and can appear next in a function definition. This must be a function
+    // declarator.
+    return TPResult::True;
+
+  if (InvalidAsDeclaration)
+    // Use the absence of 'typename' as a tie-breaker.
+    return TPResult::False;
+
+  return TPResult::Ambiguous;
+}
+
 /// parameter-declaration-clause:
 ///   parameter-declaration-list[opt] '...'[opt]
 ///   parameter-declaration-list ',' '...'
@@ -592,8 +592,9 @@ bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
     return false;
 
   case tok::eof:
-    // Late template parsing can begin.
-    if (getLangOpts().DelayedTemplateParsing)
+    // Late template parsing, and parsing of lazy function bodies, can begin.
+    if (getLangOpts().DelayedTemplateParsing ||
+        getLangOpts().LazyInlineFunctionBodies)
       Actions.SetLateTemplateParser(LateTemplateParserCallback,
                                     PP.isIncrementalProcessingEnabled() ?
                                     LateTemplateParserCleanupCallback : nullptr,
@@ -22,6 +22,42 @@
 #include "llvm/Support/raw_ostream.h"
 using namespace clang;
 
+namespace {
+/// \brief Walks a RewriteBuffer from front to back a piece at a time, rather
+/// than a byte at a time.
+class RewriteBufferCursor {
+  RewriteBuffer::iterator I, E;
+  /// The rest of the current piece.
+  StringRef Piece;
+  /// The offset of the start of \c Piece in the buffer.
+  unsigned Offset;
+
+public:
+  explicit RewriteBufferCursor(const RewriteBuffer &RB)
+    : I(RB.begin()), E(RB.end()), Offset(0) {
+    if (I != E)
+      Piece = I.piece();
+  }
+
+  /// \brief Move forward to offset \p Target, appending the bytes passed
+  /// over to \p Out if it is non-null.
+  void advance(unsigned Target, std::string *Out) {
+    while (Offset < Target) {
+      if (Piece.empty()) {
+        I.MoveToNextPiece();
+        assert(I != E && "advancing past the end of the buffer");
+        Piece = I.piece();
+      }
+      size_t N = std::min<size_t>(Piece.size(), Target - Offset);
+      if (Out)
+        Out->append(Piece.data(), N);
+      Piece = Piece.drop_front(N);
+      Offset += N;
+    }
+  }
+};
+} // end anonymous namespace
+
 raw_ostream &RewriteBuffer::write(raw_ostream &os) const {
   // Walk RewriteRope chunks efficiently using MoveToNextPiece() instead of the
   // character iterator.
@@ -114,6 +150,112 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
 }
 
+namespace {
+/// The order of edits at the same point in a batch.
+enum EditRank { InsertBeforeRank, InsertAfterRank, ReplaceRank };
+}
+
+static EditRank getEditRank(const RewriteBuffer::Edit &E) {
+  if (E.OrigLength)
+    return ReplaceRank;
+  return E.InsertAfter ? InsertAfterRank : InsertBeforeRank;
+}
+
+/// \brief Sort the indices of \p Edits into the order in which the edits
+/// appear in the rewritten buffer.
+static void sortEdits(ArrayRef<RewriteBuffer::Edit> Edits,
+                      SmallVectorImpl<unsigned> &Order) {
+  Order.resize(Edits.size());
+  for (unsigned I = 0, N = Edits.size(); I != N; ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned L, unsigned R) {
+    if (Edits[L].OrigOffset != Edits[R].OrigOffset)
+      return Edits[L].OrigOffset < Edits[R].OrigOffset;
+    return getEditRank(Edits[L]) < getEditRank(Edits[R]);
+  });
+
+  // Each insertion before the others at a point goes in front of those made
+  // earlier, so they end up in reverse.
+  for (unsigned I = 0, N = Order.size(); I != N;) {
+    unsigned J = I + 1;
+    if (getEditRank(Edits[Order[I]]) == InsertBeforeRank)
+      while (J != N && getEditRank(Edits[Order[J]]) == InsertBeforeRank &&
+             Edits[Order[J]].OrigOffset == Edits[Order[I]].OrigOffset)
+        ++J;
+    std::reverse(Order.begin() + I, Order.begin() + J);
+    I = J;
+  }
+}
+
+static bool findConflictInOrder(ArrayRef<RewriteBuffer::Edit> Edits,
+                                ArrayRef<unsigned> Order, unsigned &Index) {
+  unsigned ReplacedEnd = 0;
+  for (unsigned I : Order) {
+    const RewriteBuffer::Edit &E = Edits[I];
+    if (E.OrigOffset < ReplacedEnd) {
+      Index = I;
+      return true;
+    }
+    if (E.OrigLength)
+      ReplacedEnd = E.OrigOffset + E.OrigLength;
+  }
+  return false;
+}
+
+bool RewriteBuffer::findConflict(ArrayRef<Edit> Edits, unsigned &Index) {
+  SmallVector<unsigned, 64> Order;
+  sortEdits(Edits, Order);
+  return findConflictInOrder(Edits, Order, Index);
+}
+
+bool RewriteBuffer::ApplyEdits(ArrayRef<Edit> Edits) {
+  SmallVector<unsigned, 64> Order;
+  sortEdits(Edits, Order);
+  unsigned Index;
+  if (findConflictInOrder(Edits, Order, Index))
+    return true;
+
+  // Find where each edit goes in the current buffer before changing anything.
+  // Text changed earlier may still get in the way of a replacement.
+  SmallVector<unsigned, 64> Positions;
+  Positions.reserve(Order.size());
+  unsigned End = 0;
+  size_t NewSize = Buffer.size();
+  for (unsigned I : Order) {
+    const Edit &E = Edits[I];
+    unsigned Pos = getMappedOffset(E.OrigOffset,
+                                   getEditRank(E) != InsertBeforeRank);
+    if (Pos < End || Pos + E.OrigLength > Buffer.size())
+      return true;
+    Positions.push_back(Pos);
+    End = Pos + E.OrigLength;
+    NewSize += E.Text.size() - E.OrigLength;
+  }
+
+  std::string NewBuffer;
+  NewBuffer.reserve(NewSize);
+  RewriteBufferCursor Cursor(*this);
+  for (unsigned K = 0, N = Order.size(); K != N; ++K) {
+    const Edit &E = Edits[Order[K]];
+    Cursor.advance(Positions[K], &NewBuffer);
+    Cursor.advance(Positions[K] + E.OrigLength, nullptr);
+    NewBuffer += E.Text;
+  }
+  Cursor.advance(Buffer.size(), &NewBuffer);
+  Buffer.assign(NewBuffer.data(), NewBuffer.data() + NewBuffer.size());
+
+  // Record the deltas, so that later changes are offset correctly.
+  for (unsigned I : Order) {
+    const Edit &E = Edits[I];
+    if (!E.OrigLength) {
+      if (!E.Text.empty())
+        AddInsertDelta(E.OrigOffset, E.Text.size());
+    } else if (E.Text.size() != E.OrigLength) {
+      AddReplaceDelta(E.OrigOffset, E.Text.size() - E.OrigLength);
+    }
+  }
+  return false;
+}
 
 //===----------------------------------------------------------------------===//
 // Rewriter class
@@ -200,13 +342,13 @@ std::string Rewriter::getRewrittenText(SourceRange Range) const {
   // start of the last token.
   EndOff += Lexer::MeasureTokenLength(Range.getEnd(), *SourceMgr, *LangOpts);
 
-  // Advance the iterators to the right spot, yay for linear time algorithms.
-  RewriteBuffer::iterator Start = RB.begin();
-  std::advance(Start, StartOff);
-  RewriteBuffer::iterator End = Start;
-  std::advance(End, EndOff-StartOff);
-
-  return std::string(Start, End);
+  // Copy the text a piece at a time.
+  std::string Result;
+  Result.reserve(EndOff-StartOff);
+  RewriteBufferCursor Cursor(RB);
+  Cursor.advance(StartOff, nullptr);
+  Cursor.advance(EndOff, &Result);
+  return Result;
 }
 
 unsigned Rewriter::getLocationOffsetAndFileID(SourceLocation Loc,
@@ -392,6 +534,46 @@ bool Rewriter::IncreaseIndentation(CharSourceRange range,
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// RewriteBatch class
+//===----------------------------------------------------------------------===//
+
+bool RewriteBatch::addEdit(SourceLocation Loc, unsigned OrigLength,
+                           StringRef Str, bool InsertAfter) {
+  if (!Rewriter::isRewritable(Loc)) return true;
+  FileID FID;
+  unsigned Offset = Rewrite.getLocationOffsetAndFileID(Loc, FID);
+  Edits[FID].emplace_back(Offset, OrigLength, Strings.save(Str), InsertAfter);
+  return false;
+}
+
+bool RewriteBatch::commit(SourceLocation *ConflictLoc) {
+  // Check the whole batch before touching any file.
+  bool Failed = false;
+  for (const auto &FileEdits : Edits) {
+    unsigned Index;
+    if (RewriteBuffer::findConflict(FileEdits.second, Index)) {
+      if (ConflictLoc) {
+        SourceManager &SM = Rewrite.getSourceMgr();
+        unsigned Offset = FileEdits.second[Index].OrigOffset;
+        *ConflictLoc =
+            SM.getLocForStartOfFile(FileEdits.first).getLocWithOffset(Offset);
+      }
+      Failed = true;
+      break;
+    }
+  }
+
+  if (!Failed)
+    for (const auto &FileEdits : Edits)
+      if (Rewrite.getEditBuffer(FileEdits.first).ApplyEdits(FileEdits.second))
+        Failed = true;
+
+  Edits.clear();
+  Alloc.Reset();
+  return Failed;
+}
+
 namespace {
 // A wrapper for a file stream that atomically overwrites the target.
 //
@@ -725,6 +725,16 @@ static void CheckFallThroughForBody(Sema &S, const Decl *D, const Stmt *Body,
   if (CD.checkDiagnostics(Diags, ReturnsVoid, HasNoReturn))
       return;
   SourceLocation LBrace = Body->getLocStart(), RBrace = Body->getLocEnd();
+
+  // Control only reaches the closing brace by completing the last statement
+  // of the body, so a body ending in a return can't fall off its end. Unless
+  // we need to know whether the function returns at all, there is no need to
+  // build the CFG.
+  if (const auto *CS = dyn_cast<CompoundStmt>(Body))
+    if (!CS->body_empty() && isa<ReturnStmt>(CS->body_back()) &&
+        !(ReturnsVoid && !HasNoReturn && CD.diag_NeverFallThroughOrReturn &&
+          !Diags.isIgnored(CD.diag_NeverFallThroughOrReturn, LBrace)))
+      return;
   auto EmitDiag = [&](SourceLocation Loc, unsigned DiagID) {
     if (IsCoroutine)
       S.Diag(Loc, DiagID) << S.getCurFunction()->CoroutinePromise->getType();
@@ -2020,6 +2030,67 @@ public:
 } // namespace consumed
 } // namespace clang
 
+//===----------------------------------------------------------------------===//
+// Deciding which CFG-based checks can warn.
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// \brief What a quick walk over the body of a function found, to tell which
+/// CFG-based checks can warn about it at all. The walk is much cheaper than
+/// building the CFG, which most functions then don't need.
+struct CFGCheckPrescan {
+  /// \brief Whether the function calls itself, see checkRecursiveFunction.
+  bool CallsItself = false;
+  /// \brief Whether the function has a throw expression, see
+  /// checkThrowInNonThrowingFunc.
+  bool HasThrow = false;
+};
+} // anonymous namespace
+
+static CFGCheckPrescan prescanForCFGChecks(const Decl *D, const Stmt *Body) {
+  CFGCheckPrescan Result;
+  const Decl *Canonical = D->getCanonicalDecl();
+  SmallVector<const Stmt *, 32> Worklist;
+  Worklist.push_back(Body);
+
+  // The CFG of a constructor also has its member initializers.
+  if (const auto *CD = dyn_cast<CXXConstructorDecl>(D)) {
+    for (const CXXCtorInitializer *Init : CD->inits()) {
+      const Expr *E = Init->getInit();
+      if (const auto *Default = dyn_cast_or_null<CXXDefaultInitExpr>(E))
+        E = Default->getExpr();
+      Worklist.push_back(E);
+    }
+  }
+
+  while (!Worklist.empty()) {
+    const Stmt *S = Worklist.pop_back_val();
+    if (!S)
+      continue;
+    if (const auto *CE = dyn_cast<CallExpr>(S)) {
+      const Decl *Callee = CE->getCalleeDecl();
+      if (Callee && Callee->getCanonicalDecl() == Canonical)
+        Result.CallsItself = true;
+    } else if (isa<CXXThrowExpr>(S)) {
+      Result.HasThrow = true;
+    }
+    if (Result.CallsItself && Result.HasThrow)
+      break;
+    Worklist.append(S->child_begin(), S->child_end());
+  }
+  return Result;
+}
+
+/// \brief Returns true if the given context declares local variables, which
+/// the uninitialized values analysis could track.
+static bool hasLocalVariables(const DeclContext *DC) {
+  for (const Decl *D : DC->decls())
+    if (const auto *VD = dyn_cast<VarDecl>(D))
+      if (VD->isLocalVarDecl() && !VD->hasGlobalStorage())
+        return true;
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 // AnalysisBasedWarnings - Worker object used by Sema to execute analysis-based
 //  warnings on a function, method, or block.
@@ -2040,6 +2111,7 @@ clang::sema::AnalysisBasedWarnings::AnalysisBasedWarnings(Sema &s)
   : S(s),
     NumFunctionsAnalyzed(0),
     NumFunctionsWithBadCFGs(0),
+    NumFunctionsWithoutCFG(0),
     NumCFGBlocks(0),
     MaxCFGBlocksPerFunction(0),
     NumUninitAnalysisFunctions(0),
@@ -2234,9 +2306,10 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
     Analyzer.run(AC);
   }
 
-  if (!Diags.isIgnored(diag::warn_uninit_var, D->getLocStart()) ||
-      !Diags.isIgnored(diag::warn_sometimes_uninit_var, D->getLocStart()) ||
-      !Diags.isIgnored(diag::warn_maybe_uninit_var, D->getLocStart())) {
+  if ((!Diags.isIgnored(diag::warn_uninit_var, D->getLocStart()) ||
+       !Diags.isIgnored(diag::warn_sometimes_uninit_var, D->getLocStart()) ||
+       !Diags.isIgnored(diag::warn_maybe_uninit_var, D->getLocStart())) &&
+      hasLocalVariables(cast<DeclContext>(D))) {
     if (CFG *cfg = AC.getCFG()) {
       UninitValsDiagReporter reporter(S);
       UninitVariablesAnalysisStats stats;
@@ -2272,19 +2345,27 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
     diagnoseRepeatedUseOfWeak(S, fscope, D, AC.getParentMap());
 
 
-  // Check for infinite self-recursion in functions
-  if (!Diags.isIgnored(diag::warn_infinite_recursive_function,
-                       D->getLocStart())) {
-    if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+  // The remaining checks only look for calls and throw expressions, so find
+  // out whether there are any before building a CFG for them.
+  const FunctionDecl *FD = dyn_cast<FunctionDecl>(D);
+  bool CheckRecursion =
+      FD && !Diags.isIgnored(diag::warn_infinite_recursive_function,
+                             D->getLocStart());
+  bool CheckThrow =
+      FD && S.getLangOpts().CPlusPlus &&
+      !Diags.isIgnored(diag::warn_throw_in_noexcept_func, D->getLocStart()) &&
+      isNoexcept(FD);
+  if (CheckRecursion || CheckThrow) {
+    CFGCheckPrescan Prescan = prescanForCFGChecks(D, Body);
+
+    // Check for infinite self-recursion in functions
+    if (CheckRecursion && Prescan.CallsItself)
       checkRecursiveFunction(S, FD, Body, AC);
-    }
-  }
 
-  // Check for throw out of non-throwing function.
-  if (!Diags.isIgnored(diag::warn_throw_in_noexcept_func, D->getLocStart()))
-    if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D))
-      if (S.getLangOpts().CPlusPlus && isNoexcept(FD))
-        checkThrowInNonThrowingFunc(S, FD, AC);
+    // Check for throw out of non-throwing function.
+    if (CheckThrow && Prescan.HasThrow)
+      checkThrowInNonThrowingFunc(S, FD, AC);
+  }
 
   // If none of the previous checks caused a CFG build, trigger one here
   // for -Wtautological-overlap-compare
@@ -2294,6 +2375,8 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   }
 
   // Collect statistics about the CFG if it was built.
+  if (S.CollectStats && !AC.isCFGBuilt())
+    ++NumFunctionsWithoutCFG;
   if (S.CollectStats && AC.isCFGBuilt()) {
     ++NumFunctionsAnalyzed;
     if (CFG *cfg = AC.getCFG()) {
@@ -2320,7 +2403,9 @@ void clang::sema::AnalysisBasedWarnings::PrintStats() const {
                << "  " << AvgCFGBlocksPerFunction
                << " average CFG blocks per function.\n"
                << "  " << MaxCFGBlocksPerFunction
-               << " max CFG blocks per function.\n";
+               << " max CFG blocks per function.\n"
+               << NumFunctionsWithoutCFG
+               << " functions checked without building a CFG.\n";
 
   unsigned AvgUninitVariablesPerFunction = !NumUninitAnalysisFunctions ? 0
       : NumUninitAnalysisVariables/NumUninitAnalysisFunctions;
@@ -15,6 +15,7 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclTemplate.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Lex/Preprocessor.h"
@@ -429,6 +430,12 @@ CodeCompleteConsumer::OverloadCandidate::getFunctionType() const {
 
 CodeCompleteConsumer::~CodeCompleteConsumer() { }
 
+StringRef CodeCompleteConsumer::getTypedPrefix(Sema &S) const {
+  if (!CodeCompleteOpts.TypedPrefix.empty())
+    return CodeCompleteOpts.TypedPrefix;
+  return S.getPreprocessor().getCodeCompletionFilter();
+}
+
 bool PrintingCodeCompleteConsumer::isResultFilteredOut(StringRef Filter,
                                                 CodeCompletionResult Result) {
   switch (Result.Kind) {
@@ -456,7 +463,10 @@ PrintingCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &SemaRef,
                                                          unsigned NumResults) {
   std::stable_sort(Results, Results + NumResults);
   
-  StringRef Filter = SemaRef.getPreprocessor().getCodeCompletionFilter();
+  // Fuzzy-filtered results have already been matched against the prefix.
+  StringRef Filter;
+  if (!fuzzyFilterResults())
+    Filter = SemaRef.getPreprocessor().getCodeCompletionFilter();
 
   // Print the results.
   for (unsigned I = 0; I != NumResults; ++I) {
@@ -661,3 +671,115 @@ bool clang::operator<(const CodeCompletionResult &X,
   
   return false;
 }
+
+//===----------------------------------------------------------------------===//
+// Fuzzy matching and ranking of code-completion results
+//===----------------------------------------------------------------------===//
+
+/// \brief Priority penalties applied to results by the fuzzy matcher.
+enum {
+  /// \brief The typed text is a prefix of the name, modulo case.
+  CCFM_PrefixIgnoringCase = 1,
+  /// \brief Each typed character starts a word of the name, or continues the
+  /// previously matched character.
+  CCFM_WordBoundary = 3,
+  /// \brief The typed text is a scattered subsequence of the name.
+  CCFM_Subsequence = 6,
+  /// \brief The largest additional penalty for the number of gaps in a
+  /// subsequence match.
+  CCFM_MaxGapPenalty = 10
+};
+
+/// \brief Determine whether the character at \p I starts a word within the
+/// given identifier, e.g., the 'F' in "getFoo" or the 'f' in "get_foo".
+static bool isWordStart(StringRef Word, unsigned I) {
+  if (I == 0)
+    return true;
+  char Prev = Word[I - 1], C = Word[I];
+  if (Prev == '_' || Prev == '$')
+    return C != '_';
+  if (isUppercase(C))
+    return !isUppercase(Prev) ||
+           (I + 1 < Word.size() && isLowercase(Word[I + 1]));
+  if (isDigit(C))
+    return !isDigit(Prev);
+  return false;
+}
+
+CodeCompletionFuzzyMatcher::CodeCompletionFuzzyMatcher(StringRef Pattern)
+  : Pattern(Pattern), LowerPattern(Pattern.lower()) { }
+
+bool CodeCompletionFuzzyMatcher::match(StringRef Word,
+                                       unsigned &Penalty) const {
+  Penalty = 0;
+  if (Pattern.empty() || Word.startswith(Pattern))
+    return true;
+
+  if (Word.size() < Pattern.size())
+    return false;
+
+  if (Word.startswith_lower(Pattern)) {
+    Penalty = CCFM_PrefixIgnoringCase;
+    return true;
+  }
+
+  // Try to match every typed character either at the start of a word or
+  // directly after the previously matched character.
+  unsigned P = 0, LastMatch = 0;
+  for (unsigned I = 0, N = Word.size(); I != N && P != LowerPattern.size();
+       ++I) {
+    if (toLowercase(Word[I]) != LowerPattern[P])
+      continue;
+    if (isWordStart(Word, I) || (P != 0 && LastMatch + 1 == I)) {
+      LastMatch = I;
+      ++P;
+    }
+  }
+  if (P == LowerPattern.size()) {
+    Penalty = CCFM_WordBoundary;
+    return true;
+  }
+
+  // Fall back to a plain subsequence match, penalizing each gap.
+  unsigned Gaps = 0;
+  P = 0;
+  bool InRun = false;
+  for (unsigned I = 0, N = Word.size(); I != N && P != LowerPattern.size();
+       ++I) {
+    if (toLowercase(Word[I]) == LowerPattern[P]) {
+      if (!InRun && I != 0)
+        ++Gaps;
+      InRun = true;
+      ++P;
+    } else {
+      InRun = false;
+    }
+  }
+  if (P != LowerPattern.size())
+    return false;
+
+  Penalty = CCFM_Subsequence + std::min<unsigned>(Gaps, CCFM_MaxGapPenalty);
+  return true;
+}
+
+bool CodeCompletionFuzzyMatcher::matchResult(const CodeCompletionResult &R,
+                                             unsigned &Penalty) const {
+  std::string Saved;
+  return match(getOrderedName(R, Saved), Penalty);
+}
+
+unsigned clang::selectBestCodeCompletionResults(CodeCompletionResult *Results,
+                                                unsigned NumResults,
+                                                unsigned Limit) {
+  if (!Limit || NumResults <= Limit)
+    return NumResults;
+
+  std::partial_sort(Results, Results + Limit, Results + NumResults,
+                    [](const CodeCompletionResult &X,
+                       const CodeCompletionResult &Y) {
+                      if (X.Priority != Y.Priority)
+                        return X.Priority < Y.Priority;
+                      return X < Y;
+                    });
+  return Limit;
+}
@@ -635,7 +635,10 @@ static bool MethodsAndNestedClassesComplete(const CXXRecordDecl *RD,
                                   E = RD->decls_end();
        I != E && Complete; ++I) {
     if (const CXXMethodDecl *M = dyn_cast<CXXMethodDecl>(*I))
-      Complete = M->isDefined() || (M->isPure() && !isa<CXXDestructorDecl>(M));
+      // The body of a lazily parsed inline function that was not used has
+      // not been analyzed either.
+      Complete = (M->isDefined() && !M->isLateTemplateParsed()) ||
+                 (M->isPure() && !isa<CXXDestructorDecl>(M));
     else if (const FunctionTemplateDecl *F = dyn_cast<FunctionTemplateDecl>(*I))
       // If the template function is marked as late template parsed at this
       // point, it has not been instantiated and therefore we have not
@@ -763,6 +766,22 @@ void Sema::ActOnEndOfTranslationUnit() {
     }
     PerformPendingInstantiations();
 
+    // Parse the bodies of the lazily parsed inline functions that are used,
+    // or of all of them if they are checked. They can use more vtables,
+    // templates and lazily parsed functions.
+    if (getLangOpts().CheckLazyInlineFunctionBodies) {
+      for (auto &LPT : LateParsedTemplateMap) {
+        // The map also holds late parsed templates, whose D is the template.
+        auto *FD = const_cast<FunctionDecl *>(LPT.first);
+        if (UnusedLazyFunctionBodies.erase(FD))
+          PendingLazyFunctionBodies.push_back(FD);
+      }
+    }
+    while (ParsePendingLazyFunctionBodies()) {
+      DefineUsedVTables();
+      PerformPendingInstantiations();
+    }
+
     if (LateTemplateParserCleanup)
       LateTemplateParserCleanup(OpaqueParser);
 
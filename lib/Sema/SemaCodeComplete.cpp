@@ -163,8 +163,21 @@ namespace {
     /// object.
     ObjCImplementationDecl *ObjCImplementation;
 
+    /// \brief If the consumer asked for fuzzy filtering, the matcher for the
+    /// typed prefix. Results that don't match are dropped as they are added.
+    Optional<CodeCompletionFuzzyMatcher> Matcher;
+
     void AdjustResultPriorityForDecl(Result &R);
 
+    /// \brief Determine whether the given result matches the typed prefix.
+    ///
+    /// \param Penalty Set to the priority penalty for the quality of the
+    /// match, which is applied once the result is known to be added.
+    bool matchesTypedPrefix(const Result &R, unsigned &Penalty) const {
+      Penalty = 0;
+      return !Matcher || Matcher->matchResult(R, Penalty);
+    }
+
     void MaybeAddConstructorResults(Result R);
     
   public:
@@ -195,6 +208,13 @@ namespace {
       default:
         break;
       }
+
+      CodeCompleteConsumer *Consumer = SemaRef.CodeCompleter;
+      if (Consumer && Consumer->fuzzyFilterResults()) {
+        StringRef Prefix = Consumer->getTypedPrefix(SemaRef);
+        if (!Prefix.empty())
+          Matcher = CodeCompletionFuzzyMatcher(Prefix);
+      }
     }
 
     /// \brief Determine the priority for a reference to the given declaration.
@@ -829,9 +849,13 @@ void ResultBuilder::MaybeAddConstructorResults(Result R) {
 void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
   assert(!ShadowMaps.empty() && "Must enter into a results scope");
   
+  unsigned MatchPenalty;
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
-    Results.push_back(R);
+    if (matchesTypedPrefix(R, MatchPenalty)) {
+      R.Priority += MatchPenalty;
+      Results.push_back(R);
+    }
     return;
   }
 
@@ -856,6 +880,9 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
   if (isa<CXXConstructorDecl>(R.Declaration))
     return;
 
+  if (!matchesTypedPrefix(R, MatchPenalty))
+    return;
+
   ShadowMap &SMap = ShadowMaps.back();
   ShadowMapEntry::iterator I, IEnd;
   ShadowMap::iterator NamePos = SMap.find(R.Declaration->getDeclName());
@@ -935,6 +962,8 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
       R.QualifierIsInformative = false;
   }
     
+  R.Priority += MatchPenalty;
+
   // Insert this result into the set of results and into the current shadow
   // map.
   SMap[R.Declaration->getDeclName()].Add(R.Declaration, Results.size());
@@ -946,9 +975,13 @@ void ResultBuilder::MaybeAddResult(Result R, DeclContext *CurContext) {
 
 void ResultBuilder::AddResult(Result R, DeclContext *CurContext, 
                               NamedDecl *Hiding, bool InBaseClass = false) {
+  unsigned MatchPenalty;
   if (R.Kind != Result::RK_Declaration) {
     // For non-declaration results, just add the result.
-    Results.push_back(R);
+    if (matchesTypedPrefix(R, MatchPenalty)) {
+      R.Priority += MatchPenalty;
+      Results.push_back(R);
+    }
     return;
   }
 
@@ -969,6 +1002,9 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
   if (isa<CXXConstructorDecl>(R.Declaration))
     return;
 
+  if (!matchesTypedPrefix(R, MatchPenalty))
+    return;
+
   if (Hiding && CheckHiddenResult(R, CurContext, Hiding))
     return;
 
@@ -1021,6 +1057,8 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
         }
       }
   
+  R.Priority += MatchPenalty;
+
   // Insert this result into the set of results.
   Results.push_back(R);
   
@@ -1031,6 +1069,10 @@ void ResultBuilder::AddResult(Result R, DeclContext *CurContext,
 void ResultBuilder::AddResult(Result R) {
   assert(R.Kind != Result::RK_Declaration && 
           "Declaration results need more context");
+  unsigned MatchPenalty;
+  if (!matchesTypedPrefix(R, MatchPenalty))
+    return;
+  R.Priority += MatchPenalty;
   Results.push_back(R);
 }
 
@@ -3268,8 +3310,14 @@ static void HandleCodeCompleteResults(Sema *S,
                                       CodeCompletionContext Context,
                                       CodeCompletionResult *Results,
                                       unsigned NumResults) {
-  if (CodeCompleter)
-    CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
+  if (!CodeCompleter)
+    return;
+
+  // Only hand the best-ranked results to the consumer, which will typically
+  // build a code-completion string for each of them.
+  NumResults = selectBestCodeCompletionResults(
+      Results, NumResults, CodeCompleter->getResultLimit());
+  CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
 }
 
 static enum CodeCompletionContext::Kind mapCodeCompletionContext(Sema &S, 
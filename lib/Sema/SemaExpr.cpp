@@ -177,6 +177,37 @@ static void diagnoseUseOfInternalDeclInInlineFunction(Sema &S,
       << D;
 }
 
+/// \brief With -flazy-inline-function-bodies-check, diagnose a name in a
+/// lazily parsed body that refers to a declaration following the class of
+/// the function. The body is parsed at the end of the translation unit, so
+/// the declaration is found although it is not visible where the body is
+/// written, and it can be picked over the one that would be found otherwise.
+static void diagnoseUseOfLaterDeclInLazyFunctionBody(Sema &S,
+                                                     const NamedDecl *D,
+                                                     SourceLocation Loc) {
+  const FunctionDecl *Body = S.CheckedLazyFunctionBody;
+  if (!Body || S.getCurFunctionDecl() != Body)
+    return;
+
+  // The bodies of the members of a nested class are parsed at the end of
+  // the outermost class, where everything declared in it is visible.
+  const auto *Class = cast<CXXRecordDecl>(Body->getDeclContext());
+  while (const auto *Outer = dyn_cast<CXXRecordDecl>(Class->getDeclContext()))
+    Class = Outer;
+
+  const Decl *First = D->getCanonicalDecl();
+  SourceLocation ClassEnd = Class->getBraceRange().getEnd();
+  if (First->isImplicit() || First->getLocation().isInvalid() ||
+      ClassEnd.isInvalid() ||
+      !S.getSourceManager().isBeforeInTranslationUnit(ClassEnd,
+                                                      First->getLocation()))
+    return;
+
+  S.Diag(Loc, diag::warn_lazy_function_body_uses_later_decl)
+      << D << Class << Body;
+  S.Diag(First->getLocation(), diag::note_entity_declared_at) << D;
+}
+
 void Sema::MaybeSuggestAddingStaticToDecl(const FunctionDecl *Cur) {
   const FunctionDecl *First = Cur->getFirstDecl();
 
@@ -294,6 +325,8 @@ bool Sema::DiagnoseUseOfDecl(NamedDecl *D, SourceLocation Loc,
 
   diagnoseUseOfInternalDeclInInlineFunction(*this, D, Loc);
 
+  diagnoseUseOfLaterDeclInLazyFunctionBody(*this, D, Loc);
+
   return false;
 }
 
@@ -13536,6 +13569,12 @@ void Sema::MarkFunctionReferenced(SourceLocation Loc, FunctionDecl *Func,
       (!NeedDefinition || Func->getBody()))
     return;
 
+  // The body of a lazily parsed inline function is parsed at the end of the
+  // translation unit, once it is known to be needed.
+  if (NeedDefinition && Func->isLateTemplateParsed() &&
+      UnusedLazyFunctionBodies.erase(Func))
+    PendingLazyFunctionBodies.push_back(Func);
+
   // Note that this declaration has been used.
   if (CXXConstructorDecl *Constructor = dyn_cast<CXXConstructorDecl>(Func)) {
     Constructor = cast<CXXConstructorDecl>(Constructor->getFirstDecl());
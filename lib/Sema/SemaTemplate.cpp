@@ -32,6 +32,7 @@
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/SaveAndRestore.h"
 
 #include <iterator>
 using namespace clang;
@@ -9829,6 +9830,43 @@ void Sema::UnmarkAsLateParsedTemplate(FunctionDecl *FD) {
   FD->setLateTemplateParsed(false);
 }
 
+/// \brief Keep the tokens of the body of an inline member function until it
+/// is used, like those of a late parsed template.
+void Sema::MarkAsLazyFunctionBody(FunctionDecl *FD, CachedTokens &Toks) {
+  MarkAsLateParsedTemplate(FD, FD, Toks);
+  UnusedLazyFunctionBodies.insert(FD);
+}
+
+/// \brief Parse the bodies of the lazily parsed inline member functions that
+/// were used. This happens at the end of the translation unit, at file scope,
+/// so unqualified names in the bodies are looked up in the whole translation
+/// unit, as in delayed template parsing: a call can resolve to a function
+/// declared after the class. In check mode, such names are diagnosed.
+///
+/// \returns true if any body was parsed.
+bool Sema::ParsePendingLazyFunctionBodies() {
+  if (PendingLazyFunctionBodies.empty() || !LateTemplateParser)
+    return false;
+
+  // A body can use more lazily parsed functions, which are appended.
+  for (unsigned I = 0; I != PendingLazyFunctionBodies.size(); ++I) {
+    FunctionDecl *FD = PendingLazyFunctionBodies[I];
+    auto LPTIter = LateParsedTemplateMap.find(FD);
+    assert(LPTIter != LateParsedTemplateMap.end() &&
+           "missing lazily parsed function body");
+    {
+      llvm::SaveAndRestore<FunctionDecl *> SavedBody(
+          CheckedLazyFunctionBody,
+          getLangOpts().CheckLazyInlineFunctionBodies ? FD : nullptr);
+      LateTemplateParser(OpaqueParser, *LPTIter->second);
+    }
+    UnmarkAsLateParsedTemplate(FD);
+    ActOnFinishInlineFunctionDef(FD);
+  }
+  PendingLazyFunctionBodies.clear();
+  return true;
+}
+
 bool Sema::IsInsideALocalClassWithinATemplateFunction() {
   DeclContext *DC = CurContext;
 
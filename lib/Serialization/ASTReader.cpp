@@ -5719,6 +5719,10 @@ void ASTReader::ReadPragmaDiagnosticMappings(DiagnosticsEngine &Diag) {
     // Don't try to read these mappings again.
     Record.clear();
   }
+
+  // We added states and state transitions behind the back of the engine.
+  Diag.DiagStatesByLoc.invalidateLookupCache();
+  Diag.invalidateIgnoredEverywhere();
 }
 
 /// \brief Get the correct cursor and offset for loading a type.
@@ -14,8 +14,6 @@
 #include "clang/Tooling/Core/Replacement.h"
 
 #include "clang/Basic/Diagnostic.h"
-#include "clang/Basic/DiagnosticIDs.h"
-#include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/Lexer.h"
@@ -323,6 +321,100 @@ llvm::Error Replacements::add(const Replacement &R) {
   return llvm::Error::success();
 }
 
+llvm::Error Replacements::addAll(ArrayRef<Replacement> Rs) {
+  if (Rs.empty())
+    return llvm::Error::success();
+
+  // Check the file paths.
+  const Replacement &First = empty() ? Rs.front() : *Replaces.begin();
+  for (const Replacement &R : Rs)
+    if (R.getFilePath() != First.getFilePath())
+      return llvm::make_error<ReplacementError>(
+          replacement_error::wrong_file_path, R, First);
+
+  std::vector<unsigned> Order(Rs.size());
+  for (unsigned I = 0, E = Rs.size(); I != E; ++I)
+    Order[I] = I;
+  std::stable_sort(Order.begin(), Order.end(),
+                   [&](unsigned L, unsigned R) { return Rs[L] < Rs[R]; });
+
+  // Sweep over the existing and the new replacements in order, and find the
+  // new ones that touch another replacement: those that overlap one before
+  // them, or are insertions at the same offset as the one just before them.
+  // Overlapping replacements are found through the one that reaches the
+  // farthest; any other one overlaps it as well. New replacements that touch
+  // nothing commute with all the others, and can be added in any order.
+  std::vector<bool> Touches(Rs.size(), false);
+  auto Existing = Replaces.begin();
+  unsigned Next = 0;
+  unsigned MaxEnd = 0;
+  // The replacement that reaches the farthest, and the previous replacement;
+  // new ones by index into Rs, existing ones as -1.
+  int MaxEndIndex = -1;
+  int PrevIndex = -1;
+  const Replacement *Prev = nullptr;
+  while (Existing != Replaces.end() || Next != Order.size()) {
+    bool IsNew = Existing == Replaces.end() ||
+                 (Next != Order.size() && Rs[Order[Next]] < *Existing);
+    const Replacement &R = IsNew ? Rs[Order[Next]] : *Existing;
+    int Index = IsNew ? (int)Order[Next] : -1;
+    if (IsNew)
+      ++Next;
+    else
+      ++Existing;
+    // Header insertions never conflict.
+    if (R.getOffset() == UINT_MAX)
+      continue;
+
+    bool Touching = false;
+    if (MaxEnd > R.getOffset()) {
+      Touching = true;
+      if (MaxEndIndex >= 0)
+        Touches[MaxEndIndex] = true;
+    }
+    if (R.getLength() == 0 && Prev && Prev->getLength() == 0 &&
+        Prev->getOffset() == R.getOffset()) {
+      Touching = true;
+      if (PrevIndex >= 0)
+        Touches[PrevIndex] = true;
+    }
+    if (Touching && Index >= 0)
+      Touches[Index] = true;
+
+    unsigned End = R.getOffset() + R.getLength();
+    if (End > MaxEnd) {
+      MaxEnd = End;
+      MaxEndIndex = Index;
+    }
+    Prev = &R;
+    PrevIndex = Index;
+  }
+
+  // Build the new set from the existing replacements and the new ones that
+  // touch nothing, which are already in order.
+  std::vector<Replacement> Merged;
+  Merged.reserve(size() + Rs.size());
+  Existing = Replaces.begin();
+  for (unsigned I : Order) {
+    if (Touches[I])
+      continue;
+    while (Existing != Replaces.end() && *Existing < Rs[I])
+      Merged.push_back(*Existing++);
+    Merged.push_back(Rs[I]);
+  }
+  Merged.insert(Merged.end(), Existing, Replaces.end());
+  Replacements Result(ReplacementsImpl(Merged.begin(), Merged.end()));
+
+  // Add the rest one by one, in their original order.
+  for (unsigned I = 0, E = Rs.size(); I != E; ++I)
+    if (Touches[I])
+      if (llvm::Error Err = Result.add(Rs[I]))
+        return Err;
+
+  Replaces.swap(Result.Replaces);
+  return llvm::Error::success();
+}
+
 namespace {
 
 // Represents a merged replacement, i.e. a replacement consisting of multiple
@@ -350,9 +442,9 @@ public:
   MergedReplacement(const Replacement &R, bool MergeSecond, int D)
       : MergeSecond(MergeSecond), Delta(D), FilePath(R.getFilePath()),
         Offset(R.getOffset() + (MergeSecond ? 0 : Delta)), Length(R.getLength()),
-        Text(R.getReplacementText()) {
-    Delta += MergeSecond ? 0 : Text.size() - Length;
-    DeltaFirst = MergeSecond ? Text.size() - Length : 0;
+        Rest(R.getReplacementText()), RestStart(0) {
+    Delta += MergeSecond ? 0 : Rest.size() - Length;
+    DeltaFirst = MergeSecond ? Rest.size() - Length : 0;
   }
 
   // Merges the next element 'R' into this merged element. As we always merge
@@ -361,21 +453,30 @@ public:
   void merge(const Replacement &R) {
     if (MergeSecond) {
       unsigned REnd = R.getOffset() + Delta + R.getLength();
-      unsigned End = Offset + Text.size();
+      unsigned End = Offset + textSize();
       if (REnd > End) {
         Length += REnd - End;
         MergeSecond = false;
       }
-      StringRef TextRef = Text;
-      StringRef Head = TextRef.substr(0, R.getOffset() + Delta - Offset);
-      StringRef Tail = TextRef.substr(REnd - Offset);
-      Text = (Head + R.getReplacementText() + Tail).str();
+      // 'R' replaces part of the text, which is never in front of the text
+      // that earlier elements from 'Second' put in.
+      unsigned HeadSize = R.getOffset() + Delta - Offset;
+      if (HeadSize < Done.size()) {
+        Rest = getText();
+        RestStart = 0;
+        Done.clear();
+      }
+      StringRef RestRef = StringRef(Rest).substr(RestStart);
+      unsigned DoneSize = Done.size();
+      Done += RestRef.substr(0, HeadSize - DoneSize);
+      Done += R.getReplacementText();
+      RestStart += std::min<size_t>(REnd - Offset - DoneSize, RestRef.size());
       Delta += R.getReplacementText().size() - R.getLength();
     } else {
       unsigned End = Offset + Length;
       StringRef RText = R.getReplacementText();
       StringRef Tail = RText.substr(End - R.getOffset());
-      Text = (Text + Tail).str();
+      Rest += Tail;
       if (R.getOffset() + RText.size() > End) {
         Length = R.getOffset() + R.getLength() - Offset;
         MergeSecond = true;
@@ -390,14 +491,16 @@ public:
   // doesn't need to be merged.
   bool endsBefore(const Replacement &R) const {
     if (MergeSecond)
-      return Offset + Text.size() < R.getOffset() + Delta;
+      return Offset + textSize() < R.getOffset() + Delta;
     return Offset + Length < R.getOffset();
   }
 
   // Returns 'true' if an element from the second set should be merged next.
   bool mergeSecond() const { return MergeSecond; }
   int deltaFirst() const { return DeltaFirst; }
-  Replacement asReplacement() const { return {FilePath, Offset, Length, Text}; }
+  Replacement asReplacement() const {
+    return {FilePath, Offset, Length, getText()};
+  }
 
 private:
   bool MergeSecond;
@@ -416,7 +519,16 @@ private:
   const StringRef FilePath;
   const unsigned Offset;
   unsigned Length;
-  std::string Text;
+
+  // The text of the merged replacement is 'Done' followed by 'Rest' from
+  // 'RestStart' on. Merged elements only change the text after 'Done', so
+  // keeping it apart avoids copying all of the text for every element.
+  std::string Done;
+  std::string Rest;
+  size_t RestStart;
+
+  size_t textSize() const { return Done.size() + Rest.size() - RestStart; }
+  std::string getText() const { return Done + Rest.substr(RestStart); }
 };
 
 } // namespace
@@ -454,9 +566,10 @@ Replacements Replacements::merge(const Replacements &ReplacesToMerge) const {
       ++I;
     }
     Delta -= Merged.deltaFirst();
-    Result.insert(Merged.asReplacement());
+    // The merged elements come out in order.
+    Result.insert(Result.end(), Merged.asReplacement());
   }
-  return Replacements(Result.begin(), Result.end());
+  return Replacements(std::move(Result));
 }
 
 // Combines overlapping ranges in \p Ranges and sorts the combined ranges.
@@ -539,15 +652,25 @@ unsigned Replacements::getShiftedCodePosition(unsigned Position) const {
 }
 
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
+  // Apply the replacements in a single pass over the file rather than one at
+  // a time.
+  SourceManager &SM = Rewrite.getSourceMgr();
+  RewriteBatch Batch(Rewrite);
   bool Result = true;
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    if (I->isApplicable()) {
-      Result = I->apply(Rewrite) && Result;
-    } else {
+  for (const Replacement &R : Replaces) {
+    const FileEntry *Entry =
+        R.isApplicable() ? SM.getFileManager().getFile(R.getFilePath())
+                         : nullptr;
+    if (!Entry) {
       Result = false;
+      continue;
     }
+    FileID ID = SM.getOrCreateFileID(Entry, SrcMgr::C_User);
+    SourceLocation Start =
+        SM.getLocForStartOfFile(ID).getLocWithOffset(R.getOffset());
+    Batch.ReplaceText(Start, R.getLength(), R.getReplacementText());
   }
-  return Result;
+  return !Batch.commit() && Result;
 }
 
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
@@ -555,29 +678,24 @@ llvm::Expected<std::string> applyAllReplacements(StringRef Code,
   if (Replaces.empty())
     return Code.str();
 
-  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
-      new vfs::InMemoryFileSystem);
-  FileManager Files(FileSystemOptions(), InMemoryFileSystem);
-  DiagnosticsEngine Diagnostics(
-      IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs),
-      new DiagnosticOptions);
-  SourceManager SourceMgr(Diagnostics, Files);
-  Rewriter Rewrite(SourceMgr, LangOptions());
-  InMemoryFileSystem->addFile(
-      "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
-  FileID ID = SourceMgr.createFileID(Files.getFile("<stdin>"), SourceLocation(),
-                                     clang::SrcMgr::C_User);
-  for (auto I = Replaces.rbegin(), E = Replaces.rend(); I != E; ++I) {
-    Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
-                        I->getReplacementText());
-    if (!Replace.apply(Rewrite))
+  // The replacements are sorted and don't overlap, so the new code can be
+  // put together in a single pass.
+  size_t NewSize = Code.size();
+  for (const Replacement &R : Replaces)
+    NewSize += R.getReplacementText().size() - R.getLength();
+  std::string Result;
+  Result.reserve(NewSize);
+  unsigned Position = 0;
+  for (const Replacement &R : Replaces) {
+    if (R.getOffset() < Position || R.getOffset() > Code.size() ||
+        R.getLength() > Code.size() - R.getOffset())
       return llvm::make_error<ReplacementError>(
-          replacement_error::fail_to_apply, Replace);
+          replacement_error::fail_to_apply, R);
+    Result.append(Code.data() + Position, R.getOffset() - Position);
+    Result += R.getReplacementText();
+    Position = R.getOffset() + R.getLength();
   }
-  std::string Result;
-  llvm::raw_string_ostream OS(Result);
-  Rewrite.getEditBuffer(ID).write(OS);
-  OS.flush();
+  Result.append(Code.data() + Position, Code.size() - Position);
   return Result;
 }
 
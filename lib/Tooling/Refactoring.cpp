@@ -19,7 +19,9 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 
 namespace clang {
@@ -34,25 +36,139 @@ std::map<std::string, Replacements> &RefactoringTool::getReplacements() {
   return FileToReplaces;
 }
 
+namespace {
+/// \brief The outcome of applying the replacements for one file and writing
+/// it back.
+struct SavedFile {
+  const FileEntry *Entry = nullptr;
+  const Replacements *Replaces = nullptr;
+  /// \brief Whether some of the replacements could not be applied.
+  bool Skipped = false;
+  /// \brief The diagnostic to report if the file could not be written, with
+  /// its arguments.
+  unsigned DiagID = 0;
+  SmallString<128> TempFilename;
+  std::string Message;
+};
+} // end anonymous namespace
+
+/// \brief Apply the replacements for a single file and write it back,
+/// atomically replacing the file.
+///
+/// This only touches the file system, so it can run for many files at once.
+static void applyAndSave(vfs::FileSystem &FS, SavedFile &File) {
+  StringRef Filename = File.Entry->getName();
+  auto Buffer = FS.getBufferForFile(Filename);
+  if (!Buffer) {
+    File.Skipped = true;
+    return;
+  }
+  StringRef Code = (*Buffer)->getBuffer();
+
+  // Leave out the replacements that don't fit into the file, like the
+  // Rewriter would.
+  const Replacements *Replaces = File.Replaces;
+  Replacements Applicable;
+  if (!Replaces->empty() &&
+      std::prev(Replaces->end())->getOffset() +
+              std::prev(Replaces->end())->getLength() > Code.size()) {
+    std::vector<Replacement> Fitting;
+    for (const Replacement &R : *Replaces)
+      if (R.getOffset() <= Code.size() &&
+          R.getLength() <= Code.size() - R.getOffset())
+        Fitting.push_back(R);
+    File.Skipped = true;
+    llvm::consumeError(Applicable.addAll(Fitting));
+    Replaces = &Applicable;
+  }
+
+  auto NewCode = tooling::applyAllReplacements(Code, *Replaces);
+  if (!NewCode) {
+    llvm::consumeError(NewCode.takeError());
+    File.Skipped = true;
+    return;
+  }
+  if (*NewCode == Code)
+    return;
+
+  File.TempFilename = Filename;
+  File.TempFilename += "-%%%%%%%%";
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(File.TempFilename, FD,
+                                      File.TempFilename)) {
+    File.DiagID = diag::err_unable_to_make_temp;
+    return;
+  }
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << *NewCode;
+  }
+  if (std::error_code EC = llvm::sys::fs::rename(File.TempFilename,
+                                                 Filename)) {
+    File.DiagID = diag::err_unable_to_rename_temp;
+    File.Message = EC.message();
+    // If the remove fails, there's not a lot we can do - this is already an
+    // error.
+    llvm::sys::fs::remove(File.TempFilename);
+  }
+}
+
 int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   if (int Result = run(ActionFactory)) {
     return Result;
   }
 
-  LangOptions DefaultLangOptions;
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
   TextDiagnosticPrinter DiagnosticPrinter(llvm::errs(), &*DiagOpts);
   DiagnosticsEngine Diagnostics(
       IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs()),
       &*DiagOpts, &DiagnosticPrinter, false);
-  SourceManager Sources(Diagnostics, getFiles());
-  Rewriter Rewrite(Sources, DefaultLangOptions);
 
-  if (!applyAllReplacements(Rewrite)) {
+  // Look up the files up front, as the FileManager is not thread-safe, then
+  // rewrite the files in parallel.
+  std::map<std::string, Replacements> Grouped =
+      groupReplacementsByFile(getFiles(), FileToReplaces);
+  std::vector<SavedFile> Files;
+  bool Skipped = false;
+  for (const auto &FileAndReplaces : Grouped) {
+    const FileEntry *Entry = getFiles().getFile(FileAndReplaces.first);
+    if (!Entry) {
+      Skipped = true;
+      continue;
+    }
+    Files.emplace_back();
+    Files.back().Entry = Entry;
+    Files.back().Replaces = &FileAndReplaces.second;
+  }
+
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = getFiles().getVirtualFileSystem();
+  if (Files.size() > 1) {
+    llvm::ThreadPool Pool;
+    for (SavedFile &File : Files)
+      Pool.async([&FS, &File] { applyAndSave(*FS, File); });
+    Pool.wait();
+  } else {
+    for (SavedFile &File : Files)
+      applyAndSave(*FS, File);
+  }
+
+  // Report the errors in the order of the files.
+  bool AllWritten = true;
+  for (const SavedFile &File : Files) {
+    Skipped |= File.Skipped;
+    if (File.DiagID == diag::err_unable_to_make_temp)
+      Diagnostics.Report(File.DiagID) << File.TempFilename;
+    else if (File.DiagID == diag::err_unable_to_rename_temp)
+      Diagnostics.Report(File.DiagID)
+          << File.TempFilename << File.Entry->getName() << File.Message;
+    AllWritten &= File.DiagID == 0;
+  }
+
+  if (Skipped) {
     llvm::errs() << "Skipped some replacements.\n";
   }
 
-  return saveRewrittenFiles(Rewrite);
+  return AllWritten ? 0 : 1;
 }
 
 bool RefactoringTool::applyAllReplacements(Rewriter &Rewrite) {
@@ -0,0 +1,27 @@
+struct Widget {
+  int getFooList();
+  int getFooBar();
+  int getBaz();
+  int setFooList();
+  int fooListSize();
+};
+
+void test(Widget &W) {
+  W.gfl;
+  W.fl;
+}
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-fuzzy-filter -code-completion-at=%s:10:8 %s -o - | FileCheck -check-prefix=CHECK-CC1 %s
+// CHECK-CC1-NOT: getBaz
+// CHECK-CC1-NOT: getFooBar
+// CHECK-CC1: COMPLETION: getFooList : [#int#]getFooList()
+// CHECK-CC1-NOT: setFooList
+
+// Without fuzzy filtering, only prefix matches are reported.
+// RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:10:8 %s -o - | FileCheck -check-prefix=CHECK-CC2 %s
+// CHECK-CC2-NOT: COMPLETION:
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-fuzzy-filter -code-completion-limit=2 -code-completion-at=%s:11:7 %s -o - | FileCheck -check-prefix=CHECK-CC3 %s
+// CHECK-CC3: COMPLETION: fooListSize : [#int#]fooListSize()
+// CHECK-CC3-NEXT: COMPLETION: getFooList : [#int#]getFooList()
+// CHECK-CC3-NOT: COMPLETION:
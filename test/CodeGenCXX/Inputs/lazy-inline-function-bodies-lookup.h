@@ -0,0 +1,8 @@
+int g(long);
+
+struct T {
+  int call() { return g(1); }
+  struct Nested {
+    int call() { return g(2); }
+  };
+};
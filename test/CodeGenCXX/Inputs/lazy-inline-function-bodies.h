@@ -0,0 +1,8 @@
+struct S {
+  int used() { return helper(); }
+  int unused() { return undeclared; }
+  virtual int virt() { return 1; }
+  int helper() { return 2; }
+};
+
+template <typename T> T identity(T t) { return t; }
@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -I %S/Inputs -emit-llvm -o - %s | FileCheck -check-prefix=EAGER %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -flazy-inline-function-bodies -I %S/Inputs -emit-llvm -o - %s | FileCheck -check-prefix=LAZY %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -flazy-inline-function-bodies-check -I %S/Inputs -fsyntax-only %s 2>&1 | FileCheck -check-prefix=WARN %s
+
+// A lazily parsed body is parsed at the end of the translation unit, at file
+// scope, so its names also find the declarations that follow the class: here
+// g(int), declared after the header, is a better match than the g(long) the
+// header sees.
+
+#include "lazy-inline-function-bodies-lookup.h"
+
+int g(int);
+
+int use(T &t, T::Nested &n) { return t.call() + n.call(); }
+
+// EAGER-LABEL: define linkonce_odr i32 @_ZN1T4callEv(
+// EAGER: call i32 @_Z1gl(
+// EAGER-LABEL: define linkonce_odr i32 @_ZN1T6Nested4callEv(
+// EAGER: call i32 @_Z1gl(
+
+// LAZY-LABEL: define linkonce_odr i32 @_ZN1T4callEv(
+// LAZY: call i32 @_Z1gi(
+// LAZY-LABEL: define linkonce_odr i32 @_ZN1T6Nested4callEv(
+// LAZY: call i32 @_Z1gi(
+
+// WARN-DAG: lazy-inline-function-bodies-lookup.h:4:23: warning: 'g' is declared after 'T'; it is only found because the body of 'call' is parsed at the end of the translation unit
+// WARN-DAG: lazy-inline-function-bodies-lookup.h:6:25: warning: 'g' is declared after 'T'; it is only found because the body of 'call' is parsed at the end of the translation unit
+// WARN-DAG: lazy-inline-function-bodies-lookup.cpp:12:5: note: 'g' declared here
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -flazy-inline-function-bodies -I %S/Inputs -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -flazy-inline-function-bodies -I %S/Inputs -emit-llvm -o - %s | FileCheck -check-prefix=UNUSED %s
+// RUN: not %clang_cc1 -triple x86_64-linux-gnu -flazy-inline-function-bodies-check -I %S/Inputs -fsyntax-only %s 2>&1 | FileCheck -check-prefix=CHECK-BODIES %s
+// RUN: not %clang_cc1 -triple x86_64-linux-gnu -fdelayed-template-parsing -flazy-inline-function-bodies-check -I %S/Inputs -fsyntax-only %s 2>&1 | FileCheck -check-prefix=CHECK-BODIES %s
+
+// The bodies of the inline member functions of a header are only parsed if
+// the functions are used, directly, through another body or through a vtable.
+
+#include "lazy-inline-function-bodies.h"
+
+// CHECK-BODIES: lazy-inline-function-bodies.h:3:25: error: use of undeclared identifier 'undeclared'
+
+struct Local {
+  int f() { return 3; }
+};
+
+int use(S &s, Local &l) { return s.used() + l.f(); }
+
+void make() { S s; }
+
+// CHECK-DAG: define linkonce_odr i32 @_ZN1S4usedEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1S6helperEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN1S4virtEv(
+// CHECK-DAG: define linkonce_odr i32 @_ZN5Local1fEv(
+
+// UNUSED-NOT: _ZN1S6unusedEv
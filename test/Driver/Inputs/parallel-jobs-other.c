@@ -0,0 +1 @@
+int other(void) { return 1; }
@@ -0,0 +1,12 @@
+// RUN: %clang -### -c -ftime-trace %s 2>&1 | FileCheck %s
+// RUN: %clang -### -c -ftime-trace -ftime-trace-granularity=0 %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=GRANULARITY %s
+// RUN: %clang -### -c %s 2>&1 | FileCheck -check-prefix=NONE %s
+
+// CHECK: "-cc1"
+// CHECK-SAME: "-ftime-trace"
+// CHECK-NOT: -ftime-trace-granularity
+
+// GRANULARITY: "-ftime-trace" "-ftime-trace-granularity=0"
+
+// NONE-NOT: -ftime-trace
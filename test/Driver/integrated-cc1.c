@@ -0,0 +1,22 @@
+// In-process cc1 jobs free their memory, so they do not get -disable-free.
+// RUN: %clang -fintegrated-cc1 -### -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=IN-PROCESS %s
+// IN-PROCESS-NOT: argument unused during compilation
+// IN-PROCESS: "-cc1"
+// IN-PROCESS-NOT: "-disable-free"
+
+// RUN: %clang -### -c %s 2>&1 | FileCheck -check-prefix=OUT-OF-PROCESS %s
+// RUN: %clang -fintegrated-cc1 -fno-integrated-cc1 -### -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=OUT-OF-PROCESS %s
+// OUT-OF-PROCESS: "-cc1"
+// OUT-OF-PROCESS-SAME: "-disable-free"
+
+// Jobs that run at the same time always get a process of their own.
+// RUN: %clang -fintegrated-cc1 -parallel-jobs=2 -### -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=OUT-OF-PROCESS %s
+
+// -mllvm options would leak into the next in-process jobs.
+// RUN: %clang -fintegrated-cc1 -mllvm -debug-pass=Structure -### -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=OUT-OF-PROCESS %s
+
+int main(void) { return 0; }
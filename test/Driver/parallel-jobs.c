@@ -0,0 +1,36 @@
+// Independent jobs are still listed in the order of their inputs.
+// RUN: rm -rf %t && mkdir -p %t && cd %t
+// RUN: %clang -parallel-jobs=2 -### -c %s %S/Inputs/parallel-jobs-other.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=JOBS %s
+// RUN: ls %t | count 0
+// JOBS: "-cc1"{{.*}} "-o" "parallel-jobs.o"{{.*}} "{{[^"]*}}parallel-jobs.c"
+// JOBS: "-cc1"{{.*}} "-o" "parallel-jobs-other.o"{{.*}} "{{[^"]*}}parallel-jobs-other.c"
+
+// RUN: %clang -parallel-jobs=2 -### -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=CLAIMED %s
+// CLAIMED-NOT: argument unused during compilation
+
+// Run the jobs: both files are checked, and a failing one fails the
+// compilation.
+// RUN: echo %s > amd64_files.config
+// RUN: echo %S/Inputs/parallel-jobs-other.c >> amd64_files.config
+// RUN: echo -DPARALLEL_JOBS > amd64.config
+// RUN: %clang -parallel-jobs=2 -fsyntax-only %s \
+// RUN:   %S/Inputs/parallel-jobs-other.c
+// RUN: not %clang -parallel-jobs=2 -fsyntax-only -DBROKEN %s \
+// RUN:   %S/Inputs/parallel-jobs-other.c 2>&1 \
+// RUN:   | FileCheck -check-prefix=BROKEN %s
+// BROKEN: error: broken
+
+#ifndef PARALLEL_JOBS
+#error not compiled with the platform options
+#endif
+#ifdef BROKEN
+#error broken
+#endif
+
+// RUN: not %clang -parallel-jobs=0 -### -c %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=INVALID %s
+// INVALID: error: invalid integral value '0' in '-parallel-jobs=0'
+
+int main(void) { return 0; }
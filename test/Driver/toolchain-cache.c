@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp -R %S/Inputs/basic_linux_tree %t/tree
+//
+// The first run detects the installation and caches it, later runs reuse it.
+// RUN: %clang -v --target=i386-unknown-linux -### -c %s \
+// RUN:     --sysroot=%t/tree --gcc-toolchain="" --toolchain-cache=%t/cache \
+// RUN:     2>&1 | FileCheck -check-prefix=GCC46 %s
+// RUN: ls %t/cache | FileCheck -check-prefix=FILE %s
+// RUN: %clang -v --target=i386-unknown-linux -### -c %s \
+// RUN:     --sysroot=%t/tree --gcc-toolchain="" --toolchain-cache=%t/cache \
+// RUN:     2>&1 | FileCheck -check-prefix=GCC46 %s
+// FILE: gcc-installation-{{[0-9a-f]+$}}
+// GCC46-NOT: argument unused during compilation
+// GCC46: Found candidate GCC installation: {{.*}}i386-unknown-linux{{.}}4.6.0
+// GCC46: Selected GCC installation: {{.*}}i386-unknown-linux{{.}}4.6.0
+//
+// A newer installation makes the cached result stale.
+// RUN: mkdir %t/tree/usr/lib/gcc/i386-unknown-linux/4.9.0
+// RUN: touch %t/tree/usr/lib/gcc/i386-unknown-linux/4.9.0/crtbegin.o
+// RUN: %clang -v --target=i386-unknown-linux -### -c %s \
+// RUN:     --sysroot=%t/tree --gcc-toolchain="" --toolchain-cache=%t/cache \
+// RUN:     2>&1 | FileCheck -check-prefix=GCC49 %s
+// GCC49: Selected GCC installation: {{.*}}i386-unknown-linux{{.}}4.9.0
+//
+// Different target flags get an entry of their own.
+// RUN: %clang -v --target=x86_64-unknown-linux -m32 -### -c %s \
+// RUN:     --sysroot=%t/tree --gcc-toolchain="" --toolchain-cache=%t/cache \
+// RUN:     2>&1 | FileCheck -check-prefix=GCC49 %s
+// RUN: ls %t/cache | count 2
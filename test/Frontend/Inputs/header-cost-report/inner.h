@@ -0,0 +1,2 @@
+#pragma once
+template <class T> struct Box { T value; };
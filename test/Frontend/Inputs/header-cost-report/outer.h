@@ -0,0 +1,2 @@
+#include "inner.h"
+inline int outer() { return 1; }
@@ -0,0 +1,31 @@
+// REQUIRES: zlib
+
+// RUN: %clang_cc1 -E -fcompress-preprocessed-output %s -o %t.i
+// RUN: not grep answer %t.i
+// RUN: not %clang_cc1 -fsyntax-only -x cpp-output %t.i 2>&1 | FileCheck %s
+// RUN: cat %t.i | not %clang_cc1 -fsyntax-only -x cpp-output - 2>&1 \
+// RUN:   | FileCheck %s
+
+// Other inputs are not decompressed, and uncompressed preprocessed input is
+// still accepted.
+// RUN: not %clang_cc1 -fsyntax-only -x c %t.i 2>&1 \
+// RUN:   | FileCheck -check-prefix=NOT-PREPROCESSED %s
+// RUN: %clang_cc1 -E %s -o %t.plain.i
+// RUN: not %clang_cc1 -fsyntax-only -x cpp-output %t.plain.i 2>&1 \
+// RUN:   | FileCheck %s
+
+// RUN: printf '\177CLZPP1\n' > %t.bad.i
+// RUN: not %clang_cc1 -fsyntax-only -x cpp-output %t.bad.i 2>&1 \
+// RUN:   | FileCheck -check-prefix=BAD %s
+
+// RUN: %clang -### -E -fcompress-preprocessed-output %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=DRIVER %s
+
+#define ANSWER 42
+int answer = ANSWER;
+int question = undeclared;
+// CHECK: compressed-preprocessed-output.c:[[@LINE-1]]:16: error: use of undeclared identifier 'undeclared'
+
+// NOT-PREPROCESSED: error:
+// BAD: error decompressing '{{.*}}.bad.i': truncated compressed preprocessed input
+// DRIVER: "-cc1"{{.*}} "-fcompress-preprocessed-output"
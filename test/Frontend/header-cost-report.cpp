@@ -0,0 +1,29 @@
+// Compile for the x family, amd64 and i386, each of which writes its own
+// report.
+// RUN: rm -rf %t && mkdir %t && cd %t
+// RUN: echo %s > x_files.config
+// RUN: echo -DHEADER_COST_REPORT > amd64.config
+// RUN: echo -DHEADER_COST_REPORT > i386.config
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs/header-cost-report \
+// RUN:   -header-cost-report %t/costs.json %s
+// RUN: FileCheck %s < %t/costs.amd64.json
+// RUN: FileCheck %s < %t/costs.i386.json
+// RUN: not ls %t/costs.json
+
+#include "outer.h"
+#include "inner.h"
+
+Box<int> box;
+int main() { return outer() + box.value; }
+
+// Each file is charged with the tokens lexed and the declarations written in
+// it, and with the instantiations it triggers. The tokens of directives, such
+// as #include and #pragma once, are not counted. Its inclusive costs add those
+// of the files it includes.
+
+// CHECK: "version": 1,
+// CHECK-NEXT: "main-file": "{{.*}}header-cost-report.cpp",
+// CHECK-DAG: {"name": "{{.*}}header-cost-report.cpp", "inclusions": 1, "exclusive": {"tokens": {{[0-9]+}}, "microseconds": {{[0-9]+}}, "decls": 2, "instantiations": 1, "bytes": {{[0-9]+}}}, "inclusive": {"tokens": {{[0-9]+}}, "microseconds": {{[0-9]+}}, "decls": 5, "instantiations": 1, "bytes": {{[0-9]+}}}}
+// CHECK-DAG: {"name": "{{.*}}outer.h", "inclusions": 1, "exclusive": {"tokens": 10, "microseconds": {{[0-9]+}}, "decls": 1, "instantiations": 0, "bytes": {{[0-9]+}}}, "inclusive": {"tokens": 23, "microseconds": {{[0-9]+}}, "decls": 3, "instantiations": 0, "bytes": {{[0-9]+}}}}
+// CHECK-DAG: {"name": "{{.*}}inner.h", "inclusions": 1, "exclusive": {"tokens": 13, "microseconds": {{[0-9]+}}, "decls": 2, "instantiations": 0, "bytes": {{[0-9]+}}}, "inclusive": {"tokens": 13, "microseconds": {{[0-9]+}}, "decls": 2, "instantiations": 0, "bytes": {{[0-9]+}}}}
+// CHECK-DAG: {"name": "<built-in>", "inclusions": 1,
@@ -0,0 +1,7 @@
+#include "symbol-index.h"
+
+class Derived2 : public Base {
+  void foo() override;
+};
+
+void use2() { helper(); }
@@ -0,0 +1,6 @@
+class Base {
+public:
+  virtual void foo();
+};
+
+void helper();
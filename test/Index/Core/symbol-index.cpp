@@ -0,0 +1,40 @@
+// RUN: rm -rf %t.idx
+// RUN: c-index-test core -store-symbol-index -index-dir %t.idx -- %s -std=c++11 -I %S/Inputs
+// RUN: c-index-test core -store-symbol-index -index-dir %t.idx -- %S/Inputs/symbol-index-other.cpp -std=c++11 -I %S/Inputs
+// RUN: c-index-test core -query-symbol-index -index-dir %t.idx -usr c:@F@helper# | FileCheck -check-prefix=ALL %s
+// RUN: c-index-test core -query-symbol-index -index-dir %t.idx -usr c:@F@helper# -query=refs | FileCheck -check-prefix=REFS %s
+// RUN: c-index-test core -query-symbol-index -index-dir %t.idx -usr c:@S@Base@F@foo# -query=overrides | FileCheck -check-prefix=OVERRIDES %s
+
+// Re-indexing a translation unit replaces its shard.
+// RUN: c-index-test core -store-symbol-index -index-dir %t.idx -- %s -std=c++11 -I %S/Inputs
+// RUN: c-index-test core -query-symbol-index -index-dir %t.idx -usr c:@F@helper# -query=refs | FileCheck -check-prefix=REFS %s
+
+// RUN: not c-index-test core -query-symbol-index -index-dir %t.missing -usr c:@F@helper# 2>&1 | FileCheck -check-prefix=MISSING %s
+
+#include "symbol-index.h"
+
+class Derived1 : public Base {
+  void foo() override;
+};
+
+void use1() { helper(); }
+
+// Shards are visited in the order of their file names, and the declaration in
+// the shared header is reported once.
+// ALL: symbol-index.h:6:6 | function | Decl | rel: 0
+// ALL-NEXT: symbol-index-other.cpp:7:15 | function | Ref,Call,RelCall,RelCont | rel: 1
+// ALL-NEXT: RelCall,RelCont | c:@F@use2#
+// ALL-NEXT: symbol-index.cpp:20:15 | function | Ref,Call,RelCall,RelCont | rel: 1
+// ALL-NEXT: RelCall,RelCont | c:@F@use1#
+// ALL-NOT: symbol-index
+
+// REFS-NOT: Decl
+// REFS: symbol-index-other.cpp:7:15 | function | Ref,Call,RelCall,RelCont | rel: 1
+// REFS-NEXT: RelCall,RelCont | c:@F@use2#
+// REFS-NEXT: symbol-index.cpp:20:15 | function | Ref,Call,RelCall,RelCont | rel: 1
+// REFS-NEXT: RelCall,RelCont | c:@F@use1#
+
+// OVERRIDES-DAG: c:@S@Derived1@F@foo#
+// OVERRIDES-DAG: c:@S@Derived2@F@foo#
+
+// MISSING: error: symbol index directory '{{.*}}' does not exist
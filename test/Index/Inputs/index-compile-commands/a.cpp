@@ -0,0 +1,3 @@
+#include "shared.h"
+
+void a_func() { shared_func(); }
@@ -0,0 +1,3 @@
+#include "shared.h"
+
+void b_func() { shared_func(); }
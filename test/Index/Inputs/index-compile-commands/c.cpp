@@ -0,0 +1,3 @@
+#include "shared.h"
+
+void c_func() { shared_func(); }
@@ -0,0 +1,13 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#define SHARED_VALUE 42
+
+int shared_func();
+int shared_other();
+struct SharedRecord {
+  int field;
+};
+const int shared_value = SHARED_VALUE;
+
+#endif
@@ -0,0 +1,26 @@
+// Note: the run lines follow their respective tests, since line/column
+// matter in this test.
+
+namespace ns {
+  int createWidget();
+  int createWindow();
+  int destroyWidget();
+}
+using namespace ns;
+
+int countWidgets();
+
+static void foo() {
+  int cw;
+}
+
+// RUN: env CINDEXTEST_COMPLETION_FUZZY_FILTER=1 CINDEXTEST_COMPLETION_PREFIX=cw c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-CC1 %s
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_FUZZY_FILTER=1 CINDEXTEST_COMPLETION_PREFIX=cw c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-CC1 %s
+// CHECK-CC1: FunctionDecl:{ResultType int}{TypedText countWidgets}{LeftParen (}{RightParen )}
+// CHECK-CC1: FunctionDecl:{ResultType int}{TypedText createWidget}{LeftParen (}{RightParen )}
+// CHECK-CC1: FunctionDecl:{ResultType int}{TypedText createWindow}{LeftParen (}{RightParen )}
+// CHECK-CC1-NOT: destroyWidget
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_COMPLETION_CACHING=1 CINDEXTEST_COMPLETION_FUZZY_FILTER=1 CINDEXTEST_COMPLETION_PREFIX=cw CINDEXTEST_COMPLETION_LIMIT=1 c-index-test -code-completion-at=%s:14:3 %s | FileCheck -check-prefix=CHECK-CC2 %s
+// CHECK-CC2: FunctionDecl:{ResultType int}{TypedText countWidgets}{LeftParen (}{RightParen )}
+// CHECK-CC2-NOT: FunctionDecl:
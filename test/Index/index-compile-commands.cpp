@@ -0,0 +1,43 @@
+// RUN: env CINDEXTEST_SKIP_INDEXED_HEADERS=1 CINDEXTEST_INDEX_THREADS=1 \
+// RUN:   c-index-test -index-compile-db %S/Inputs/index-compile-commands/compile_commands.json \
+// RUN:   | FileCheck %s
+// RUN: env CINDEXTEST_INDEX_THREADS=1 \
+// RUN:   c-index-test -index-compile-db %S/Inputs/index-compile-commands/compile_commands.json \
+// RUN:   | FileCheck -check-prefix=NOSKIP %s
+// RUN: env CINDEXTEST_SKIP_INDEXED_HEADERS=1 CINDEXTEST_INDEX_THREADS=4 \
+// RUN:   c-index-test -index-compile-db %S/Inputs/index-compile-commands/compile_commands.json \
+// RUN:   > /dev/null
+
+// The header is reported by the first translation unit that includes it, and
+// again for a translation unit with different predefined macros. The header
+// has several declarations, so that some are reported while it is still
+// being parsed.
+
+// CHECK:      [startedTranslationUnit]
+// CHECK-NEXT: [enteredMainFile]: {{.*}}a.cpp
+// CHECK:      [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}shared.h:6:5
+// CHECK:      [indexDeclaration]: kind: function | name: shared_other | {{.*}} | loc: {{.*}}shared.h:7:5
+// CHECK:      [indexDeclaration]: kind: struct | name: SharedRecord | {{.*}} | loc: {{.*}}shared.h:8:8
+// CHECK:      [indexDeclaration]: kind: field | name: field | {{.*}} | loc: {{.*}}shared.h:9:7
+// CHECK:      [indexDeclaration]: kind: variable | name: shared_value | {{.*}} | loc: {{.*}}shared.h:11:11
+// CHECK:      [indexDeclaration]: kind: function | name: a_func |
+// CHECK-NEXT: [indexEntityReference]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}a.cpp:3:18
+
+// CHECK:      [startedTranslationUnit]
+// CHECK-NEXT: [enteredMainFile]: {{.*}}b.cpp
+// CHECK-NOT:  loc: {{.*}}shared.h
+// CHECK:      [indexDeclaration]: kind: function | name: b_func |
+// CHECK-NEXT: [indexEntityReference]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}b.cpp:3:18
+
+// CHECK:      [startedTranslationUnit]
+// CHECK-NEXT: [enteredMainFile]: {{.*}}c.cpp
+// CHECK:      [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}shared.h:6:5
+// CHECK:      [indexDeclaration]: kind: variable | name: shared_value | {{.*}} | loc: {{.*}}shared.h:11:11
+// CHECK:      [indexDeclaration]: kind: function | name: c_func |
+
+// NOSKIP:      [enteredMainFile]: {{.*}}a.cpp
+// NOSKIP:      [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}shared.h:6:5
+// NOSKIP:      [enteredMainFile]: {{.*}}b.cpp
+// NOSKIP:      [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}shared.h:6:5
+// NOSKIP:      [enteredMainFile]: {{.*}}c.cpp
+// NOSKIP:      [indexDeclaration]: kind: function | name: shared_func | {{.*}} | loc: {{.*}}shared.h:6:5
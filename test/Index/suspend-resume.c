@@ -0,0 +1,35 @@
+#include "suspend-resume.h"
+
+int sum(struct Point p) {
+  int unused;
+  return p.x + p.y;
+}
+
+// Resume from the serialized form kept by clang_suspendTranslationUnit.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_FOR_SERIALIZATION=1 \
+// RUN:     CINDEXTEST_RESUME=1 LIBCLANG_LOGGING=1 \
+// RUN:     c-index-test -test-load-source local %s \
+// RUN:     -I %S/Inputs -Wunused-variable 2> %t.err | FileCheck %s
+// RUN: FileCheck -check-prefixes=CHECK-RESUMED,CHECK-DIAG %s < %t.err
+
+// Without CXTranslationUnit_ForSerialization, resuming reparses.
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_RESUME=1 LIBCLANG_LOGGING=1 \
+// RUN:     c-index-test -test-load-source local %s \
+// RUN:     -I %S/Inputs -Wunused-variable 2> %t.err | FileCheck %s
+// RUN: FileCheck -check-prefixes=CHECK-REPARSED,CHECK-DIAG %s < %t.err
+
+// CHECK: suspend-resume.c:3:5: FunctionDecl=sum:3:5 (Definition) Extent=[3:1 - 6:2]
+// CHECK: suspend-resume.c:3:22: ParmDecl=p:3:22 (Definition) Extent=[3:9 - 3:23]
+// CHECK: suspend-resume.c:4:7: VarDecl=unused:4:7 (Definition) Extent=[4:3 - 4:13]
+// CHECK: suspend-resume.c:5:12: MemberRefExpr=x:2:7
+// CHECK: suspend-resume.c:5:18: MemberRefExpr=y:3:7
+
+// CHECK-RESUMED-NOT: reparsing
+// CHECK-RESUMED: clang_resumeTranslationUnit:{{.*}} restored from the serialized AST
+// CHECK-RESUMED-NOT: reparsing
+
+// CHECK-REPARSED-NOT: restored from the serialized AST
+// CHECK-REPARSED: clang_resumeTranslationUnit:{{.*}} reparsing
+// CHECK-REPARSED-NOT: restored from the serialized AST
+
+// CHECK-DIAG: suspend-resume.c:4:7: warning: unused variable 'unused'
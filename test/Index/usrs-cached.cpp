@@ -0,0 +1,38 @@
+namespace outer {
+namespace inner {
+struct S {
+  void method();
+  struct Nested { int field; };
+};
+}
+}
+
+void use(outer::inner::S a, outer::inner::S b) {
+  struct Local { int x; };
+}
+
+namespace outer {
+namespace inner {
+void S::method() {}
+}
+}
+
+// The USRs of enclosing contexts are cached and reused for their members;
+// members of contexts whose USR includes a location or type substitutions
+// must still get the same USRs as when generated from scratch.
+
+// RUN: c-index-test -test-load-source-usrs all %s | FileCheck %s
+// CHECK: usrs-cached.cpp c:@N@outer Extent=[1:1 - 8:2]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner Extent=[2:1 - 7:2]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner@S@S Extent=[3:1 - 6:2]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner@S@S@F@method# Extent=[4:3 - 4:16]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner@S@S@S@Nested Extent=[5:3 - 5:31]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner@S@S@S@Nested@FI@field Extent=[5:19 - 5:28]
+// CHECK: usrs-cached.cpp c:@F@use#$@N@outer@N@inner@S@S#S0_# Extent=[10:1 - 12:2]
+// CHECK: usrs-cached.cpp c:usrs-cached.cpp@{{[0-9]+}}@F@use#$@N@outer@N@inner@S@S#S0_#@a Extent=[10:10 - 10:27]
+// CHECK: usrs-cached.cpp c:usrs-cached.cpp@{{[0-9]+}}@F@use#$@N@outer@N@inner@S@S#S0_#@b Extent=[10:29 - 10:46]
+// CHECK: usrs-cached.cpp c:usrs-cached.cpp@{{[0-9]+}}@F@use#$@N@outer@N@inner@S@S#S0_#@S@Local Extent=[11:3 - 11:26]
+// CHECK: usrs-cached.cpp c:usrs-cached.cpp@{{[0-9]+}}@F@use#$@N@outer@N@inner@S@S#S0_#@S@Local@FI@x Extent=[11:18 - 11:23]
+// CHECK: usrs-cached.cpp c:@N@outer Extent=[14:1 - 18:2]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner Extent=[15:1 - 17:2]
+// CHECK: usrs-cached.cpp c:@N@outer@N@inner@S@S@F@method# Extent=[16:1 - 16:20]
@@ -0,0 +1,4 @@
+static inline int header_uninitialized(void) {
+  int x;
+  return x;
+}
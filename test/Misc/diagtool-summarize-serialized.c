@@ -0,0 +1,30 @@
+// RUN: rm -f %t.1.dia %t.2.dia
+// RUN: %clang_cc1 -fsyntax-only -Wuninitialized -Wunused-variable -I %S/Inputs %s -serialize-diagnostic-file %t.1.dia 2>/dev/null
+// RUN: not %clang_cc1 -fsyntax-only -Wuninitialized -Werror=unused-variable -DSECOND -I %S/Inputs %s -serialize-diagnostic-file %t.2.dia 2>/dev/null
+// RUN: diagtool summarize-serialized -j 2 %t.1.dia %t.2.dia | FileCheck %s
+// RUN: diagtool summarize-serialized -json %t.1.dia %t.2.dia | FileCheck -check-prefix=JSON %s
+// RUN: not diagtool summarize-serialized %t.1.dia %t.missing.dia 2>&1 | FileCheck -check-prefix=MISSING %s
+
+// The warning of the header is reported by both translation units, but is
+// counted once. The same unused variable is a warning in one translation unit
+// and an error in the other.
+
+#include "summarize-serialized.h"
+
+void f(void) {
+  int a;
+#ifdef SECOND
+  int b;
+#endif
+}
+
+// CHECK: 2 files, 5 diagnostics, 4 unique
+// CHECK-NEXT: occurrences   unique   errors      TUs    files  flag
+// CHECK-NEXT: {{^ +}}3        3        2        2        1  -Wunused-variable
+// CHECK-NEXT: {{^ +}}2        1        0        2        1  -Wuninitialized
+
+// JSON: {"flag":"unused-variable","occurrences":3,"unique":3,"errors":2,"translation-units":2,"source-files":1}
+// JSON-NEXT: {"flag":"uninitialized","occurrences":2,"unique":1,"errors":0,"translation-units":2,"source-files":1}
+
+// MISSING: error: {{.*}}missing.dia: {{.+}}
+// MISSING: 1 files, 2 diagnostics, 2 unique
@@ -0,0 +1,24 @@
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+// Whether a '(' starts a function declarator is decided while disambiguating
+// a statement, and again when the declaration is parsed. Check that both
+// agree, and that the ambiguity is still diagnosed.
+
+struct S {
+  S();
+  S(int);
+  S(S, S);
+  int get() const;
+};
+struct T {};
+int n;
+
+int f(int x) {
+  S (a)(S(x), S(n)); // expected-warning {{parentheses were disambiguated as a function declaration}} expected-note {{add a pair of parentheses to declare a variable}}
+  S (b)(S(n + 1), S(x));
+  S (*c)(S(x)) = nullptr;
+  S (d), e(T(y)); // expected-warning {{parentheses were disambiguated as a function declaration}} expected-note {{add a pair of parentheses to declare a variable}}
+  S (g)[2], h(S(n + 1), S(x));
+  for (S (i)(S(n + 1), S(x)); ; )
+    return b.get() + d.get() + g[1].get() + h.get() + i.get();
+}
@@ -0,0 +1,29 @@
+// RUN: %clang_cc1 -fsyntax-only -Wunused-macros -Wunused-function -verify %s
+
+// Unused macros and functions are only diagnosed at the end of the
+// translation unit, so the diagnostic state of each location below is looked
+// up after all the state transitions are known, and nearby locations share a
+// state range.
+
+#define UNUSED_1 1 // expected-warning {{macro is not used}}
+#define UNUSED_2 2 // expected-warning {{macro is not used}}
+static void unused_1(void) {} // expected-warning {{unused function 'unused_1'}}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-macros"
+#define UNUSED_3 3
+#define UNUSED_4 4
+static void unused_2(void) {} // expected-warning {{unused function 'unused_2'}}
+#pragma clang diagnostic ignored "-Wunused-function"
+static void unused_3(void) {}
+#pragma clang diagnostic pop
+
+#define UNUSED_5 5 // expected-warning {{macro is not used}}
+static void unused_4(void) {} // expected-warning {{unused function 'unused_4'}}
+
+#pragma clang diagnostic ignored "-Wunused-macros"
+#define UNUSED_6 6
+#pragma clang diagnostic warning "-Wunused-macros"
+#define UNUSED_7 7 // expected-warning {{macro is not used}}
+#pragma clang diagnostic ignored "-Wunused-macros"
+#define UNUSED_8 8
@@ -0,0 +1,16 @@
+// RUN: %clang_cc1 -E -trigraphs %s | FileCheck -strict-whitespace %s
+
+// -E prints punctuators without looking up their spelling, unless they are
+// written as a digraph or need cleaning.
+
+#define PASTE(a, b) a ## b
+
+// CHECK: a [ 1 ] <: 2 :> <% %> %: %:%: ... -> ->* ++ >>= ;
+a [ 1 ] <: 2 :> <% %> %: %:%: ... -> ->* ++ >>= ;
+
+// CHECK: x <<= y ++;
+x <\
+<= y PASTE(+, +);
+
+// CHECK: b [ c ];
+b ??( c ??);
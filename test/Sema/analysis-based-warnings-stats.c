@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -fsyntax-only -Wuninitialized -Winfinite-recursion -print-stats %s 2>&1 | FileCheck %s
+
+// None of the CFG-based warnings can apply to these functions, so no CFG is
+// built for them.
+int returns_param(int x) { return x; }
+void no_locals(int *p) { *p = 0; }
+int calls_other(int x) { return returns_param(x); }
+
+// These need a CFG.
+int maybe_uninit(int x) {
+  int y;
+  if (x)
+    y = 1;
+  return y;
+}
+void recurses(int x) {
+  recurses(x);
+}
+
+// CHECK: 2 functions analyzed (0 w/o CFGs).
+// CHECK: 3 functions checked without building a CFG.
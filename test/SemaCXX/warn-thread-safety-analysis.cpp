@@ -5204,3 +5204,54 @@ class acquired_before_empty_str {
   } // expected-warning {{mutex 'lock_' is still held at the end of function}}
   Mutex lock_ ACQUIRED_BEFORE("");
 };
+
+
+namespace InternedCapabilityTest {
+
+// Capabilities that are written differently but have the same value must be
+// treated as the same capability, and capabilities that differ only in a
+// base object must not.
+class Foo {
+public:
+  Mutex mu_;
+  int a GUARDED_BY(mu_);
+
+  Mutex *getMu() LOCK_RETURNED(mu_);
+  void lock()   EXCLUSIVE_LOCK_FUNCTION(mu_);
+  void unlock() UNLOCK_FUNCTION(mu_);
+};
+
+void lockFoo(Foo *f)   EXCLUSIVE_LOCK_FUNCTION(f->mu_);
+void unlockFoo(Foo *f) UNLOCK_FUNCTION(f->mu_);
+
+void test1(Foo *f1, Foo *f2) {
+  f1->lock();
+  f1->getMu()->Unlock();
+  lockFoo(f1);
+  f1->a = 0;
+  f1->mu_.Unlock();
+  f1->getMu()->Lock();
+  unlockFoo(f1);
+}
+
+void test2(Foo *f1, Foo *f2) {
+  f1->lock();
+  f2->a = 0; // \
+    // expected-warning {{writing variable 'a' requires holding mutex 'f2->mu_' exclusively}} \
+    // expected-note {{found near match 'f1->mu_'}}
+  f2->unlock();    // expected-warning {{releasing mutex 'f2->mu_' that was not held}}
+  lockFoo(f1);     // expected-warning {{acquiring mutex 'f1->mu_' that is already held}}
+  f1->unlock();
+}
+
+void test3(Foo *f1, Foo *f2) {
+  DoubleMutexLock lock(&f1->mu_, f2->getMu());
+  f1->a = 0;
+  f2->a = 0;
+  f2->getMu()->Unlock();
+  f2->a = 0; // \
+    // expected-warning {{writing variable 'a' requires holding mutex 'f2->mu_' exclusively}} \
+    // expected-note {{found near match 'f1->mu_'}}
+}
+
+} // end namespace InternedCapabilityTest
@@ -0,0 +1,24 @@
+// RUN: sed -e "s:INPUT_DIR:%S/Inputs:g" -e "s:OUT_DIR:%t:g" %S/Inputs/vfsoverlay.yaml > %t.yaml
+// RUN: clang-vfs-overlay %t.yaml -o %t.vfs
+// RUN: %clang_cc1 -Werror -I %t -ivfsoverlay %t.vfs -fsyntax-only %s
+// REQUIRES: shell
+
+// The names of the mapped files follow 'use-external-names'.
+// RUN: sed -e "s:INPUT_DIR:%S/Inputs:g" -e "s:OUT_DIR:%t:g" -e "s:EXTERNAL_NAMES:false:" %S/Inputs/use-external-names.yaml > %t.internal.yaml
+// RUN: clang-vfs-overlay %t.internal.yaml -o %t.internal.vfs
+// RUN: %clang_cc1 -I %t -ivfsoverlay %t.internal.vfs -E %s -DEXTERNAL_NAMES | FileCheck -check-prefix=CHECK-PP %s
+// CHECK-PP-NOT: Inputs
+
+// RUN: not clang-vfs-overlay %S/Inputs/missing-key.yaml -o %t.invalid.vfs 2>&1 | FileCheck -check-prefix=CHECK-INVALID %s
+// CHECK-INVALID: missing key 'type'
+// CHECK-INVALID: error: invalid virtual file system overlay
+
+#ifdef EXTERNAL_NAMES
+#include "external-names.h"
+#else
+#include "not_real.h"
+
+void foo() {
+  bar();
+}
+#endif
@@ -82,6 +82,8 @@ static unsigned getDefaultParsingOptions() {
     options |= CXTranslationUnit_CreatePreambleOnFirstParse;
   if (getenv("CINDEXTEST_KEEP_GOING"))
     options |= CXTranslationUnit_KeepGoing;
+  if (getenv("CINDEXTEST_FOR_SERIALIZATION"))
+    options |= CXTranslationUnit_ForSerialization;
 
   return options;
 }
@@ -1777,8 +1779,13 @@ int perform_test_load_source(int argc, const char **argv,
     if (Repeats > 1) {
       clang_suspendTranslationUnit(TU);
 
-      Err = clang_reparseTranslationUnit(TU, num_unsaved_files, unsaved_files,
-                                         clang_defaultReparseOptions(TU));
+      if (getenv("CINDEXTEST_RESUME"))
+        Err = clang_resumeTranslationUnit(TU, num_unsaved_files, unsaved_files,
+                                          clang_defaultReparseOptions(TU));
+      else
+        Err = clang_reparseTranslationUnit(TU, num_unsaved_files,
+                                           unsaved_files,
+                                           clang_defaultReparseOptions(TU));
       if (Err != CXError_Success) {
         describeLibclangFailure(Err);
         free_remapped_files(unsaved_files, num_unsaved_files);
@@ -2303,11 +2310,17 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   CXTranslationUnit TU;
   unsigned I, Repeats = 1;
   unsigned completionOptions = clang_defaultCodeCompleteOptions();
+  const char *typedPrefix = getenv("CINDEXTEST_COMPLETION_PREFIX");
+  unsigned maxResults = 0;
   
   if (getenv("CINDEXTEST_CODE_COMPLETE_PATTERNS"))
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
   if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
     completionOptions |= CXCodeComplete_IncludeBriefComments;
+  if (getenv("CINDEXTEST_COMPLETION_FUZZY_FILTER"))
+    completionOptions |= CXCodeComplete_FuzzyFilter;
+  if (getenv("CINDEXTEST_COMPLETION_LIMIT"))
+    maxResults = atoi(getenv("CINDEXTEST_COMPLETION_LIMIT"));
   
   if (timing_only)
     input += strlen("-code-completion-timing=");
@@ -2347,9 +2360,10 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
   }
 
   for (I = 0; I != Repeats; ++I) {
-    results = clang_codeCompleteAt(TU, filename, line, column,
-                                   unsaved_files, num_unsaved_files,
-                                   completionOptions);
+    results = clang_codeCompleteAtWithLimit(TU, filename, line, column,
+                                            unsaved_files, num_unsaved_files,
+                                            completionOptions, typedPrefix,
+                                            maxResults);
     if (!results) {
       fprintf(stderr, "Unable to perform code completion!\n");
       return 1;
@@ -3451,6 +3465,8 @@ static unsigned getIndexOptions(void) {
     index_opts |= CXIndexOpt_IndexFunctionLocalSymbols;
   if (!getenv("CINDEXTEST_DISABLE_SKIPPARSEDBODIES"))
     index_opts |= CXIndexOpt_SkipParsedBodiesInSession;
+  if (getenv("CINDEXTEST_SKIP_INDEXED_HEADERS"))
+    index_opts |= CXIndexOpt_SkipIndexedHeadersInSession;
 
   return index_opts;
 }
@@ -3601,6 +3617,35 @@ static int index_tu(int argc, const char **argv) {
   return result;
 }
 
+static int index_compile_commands(CXCompileCommands CCmds,
+                                  unsigned num_threads,
+                                  CXIndexAction idxAction,
+                                  const char *check_prefix) {
+  IndexData index_data;
+  int result;
+
+  index_data.check_prefix = check_prefix;
+  index_data.first_check_printed = 0;
+  index_data.fail_for_error = 0;
+  index_data.abort = 0;
+  index_data.main_filename = "";
+  index_data.importedASTs = 0;
+  index_data.strings = NULL;
+  index_data.TU = NULL;
+
+  result = clang_indexCompileCommands(idxAction, &index_data,
+                                      &IndexCB, sizeof(IndexCB),
+                                      getIndexOptions(), CCmds, num_threads);
+  if (result != CXError_Success)
+    describeLibclangFailure(result);
+
+  if (index_data.fail_for_error)
+    result = -1;
+
+  free_client_data(&index_data);
+  return result;
+}
+
 static int index_compile_db(int argc, const char **argv) {
   const char *check_prefix;
   CXIndex Idx;
@@ -3679,6 +3724,13 @@ static int index_compile_db(int argc, const char **argv) {
         goto cdb_end;
       }
 
+      if (getenv("CINDEXTEST_INDEX_THREADS")) {
+        errorCode = index_compile_commands(
+            CCmds, atoi(getenv("CINDEXTEST_INDEX_THREADS")), idxAction,
+            check_prefix);
+        goto cdb_end;
+      }
+
       for (i=0; i<numCmds && errorCode == 0; ++i) {
         CCmd = clang_CompileCommands_getCommand(CCmds, i);
 
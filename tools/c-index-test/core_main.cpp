@@ -14,10 +14,12 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Index/IndexingAction.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/SymbolIndex.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Index/CodegenNameGenerator.h"
 #include "clang/Serialization/ASTReader.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/PrettyStackTrace.h"
@@ -33,6 +35,8 @@ namespace {
 enum class ActionType {
   None,
   PrintSourceSymbols,
+  StoreSymbolIndex,
+  QuerySymbolIndex,
 };
 
 namespace options {
@@ -43,7 +47,13 @@ static cl::opt<ActionType>
 Action(cl::desc("Action:"), cl::init(ActionType::None),
        cl::values(
           clEnumValN(ActionType::PrintSourceSymbols,
-                     "print-source-symbols", "Print symbols from source")),
+                     "print-source-symbols", "Print symbols from source"),
+          clEnumValN(ActionType::StoreSymbolIndex,
+                     "store-symbol-index",
+                     "Index source into the symbol index directory"),
+          clEnumValN(ActionType::QuerySymbolIndex,
+                     "query-symbol-index",
+                     "Print occurrences of a symbol from the symbol index")),
        cl::cat(IndexTestCoreCategory));
 
 static cl::extrahelp MoreHelp(
@@ -65,6 +75,21 @@ static cl::opt<std::string>
   ModuleFormat("fmodule-format", cl::init("raw"),
         cl::desc("Container format for clang modules and PCH, 'raw' or 'obj'"));
 
+static cl::opt<std::string>
+IndexDir("index-dir", cl::desc("Path to the symbol index directory"));
+static cl::opt<std::string>
+QueryUSR("usr", cl::desc("USR of the symbol to query"));
+
+enum class QueryKind { All, References, Overrides };
+
+static cl::opt<QueryKind>
+Query("query", cl::desc("Symbol index query:"), cl::init(QueryKind::All),
+      cl::values(
+         clEnumValN(QueryKind::All, "all", "Print all occurrences"),
+         clEnumValN(QueryKind::References, "refs", "Print references"),
+         clEnumValN(QueryKind::Overrides, "overrides",
+                    "Print the USRs of overriding methods")));
+
 }
 } // anonymous namespace
 
@@ -235,6 +260,80 @@ static bool printSourceSymbolsFromModule(StringRef modulePath,
   return false;
 }
 
+//===----------------------------------------------------------------------===//
+// Symbol Index
+//===----------------------------------------------------------------------===//
+
+static bool storeSymbolIndex(ArrayRef<const char *> Args, StringRef IndexDir) {
+  SmallVector<const char *, 4> ArgsWithProgName;
+  ArgsWithProgName.push_back("clang");
+  ArgsWithProgName.append(Args.begin(), Args.end());
+  IntrusiveRefCntPtr<DiagnosticsEngine>
+    Diags(CompilerInstance::createDiagnostics(new DiagnosticOptions));
+  auto CInvok = createInvocationFromCommandLine(ArgsWithProgName, Diags);
+  if (!CInvok)
+    return true;
+
+  auto Recorder = std::make_shared<SymbolIndexRecorder>(IndexDir);
+  IndexingOptions IndexOpts;
+  std::unique_ptr<FrontendAction> IndexAction;
+  IndexAction = createIndexingAction(Recorder, IndexOpts,
+                                     /*WrappedAction=*/nullptr);
+
+  auto PCHContainerOps = std::make_shared<PCHContainerOperations>();
+  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCompilerInvocationAction(
+      std::move(CInvok), PCHContainerOps, Diags, IndexAction.get()));
+
+  if (!Unit)
+    return true;
+
+  if (!Recorder->getError().empty()) {
+    errs() << "error: " << Recorder->getError() << '\n';
+    return true;
+  }
+  return false;
+}
+
+static bool querySymbolIndex(StringRef IndexDir, StringRef USR,
+                             options::QueryKind Query) {
+  std::string Error;
+  std::unique_ptr<SymbolIndex> Index = SymbolIndex::open(IndexDir, Error);
+  if (!Index) {
+    errs() << "error: " << Error << '\n';
+    return true;
+  }
+
+  raw_ostream &OS = outs();
+  auto printOccurrence = [&](const StoredSymbolOccurrence &Occur) -> bool {
+    OS << sys::path::filename(Occur.FilePath) << ':' << Occur.Line << ':'
+       << Occur.Column << " | " << getSymbolKindString(Occur.Kind) << " | ";
+    printSymbolRoles(Occur.Roles, OS);
+    OS << " | rel: " << Occur.Relations.size() << '\n';
+    for (const StoredSymbolRelation &Rel : Occur.Relations) {
+      OS << '\t';
+      printSymbolRoles(Rel.Roles, OS);
+      OS << " | " << Rel.USR << '\n';
+    }
+    return true;
+  };
+
+  switch (Query) {
+  case options::QueryKind::All:
+    Index->forEachOccurrence(USR, /*Roles=*/0, printOccurrence);
+    break;
+  case options::QueryKind::References:
+    Index->forEachReference(USR, printOccurrence);
+    break;
+  case options::QueryKind::Overrides:
+    Index->forEachOverride(USR, [&](StringRef OverrideUSR) -> bool {
+      OS << OverrideUSR << '\n';
+      return true;
+    });
+    break;
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 // Helper Utils
 //===----------------------------------------------------------------------===//
@@ -305,5 +404,22 @@ int indextest_core_main(int argc, const char **argv) {
     return printSourceSymbols(CompArgs, options::DumpModuleImports, options::IncludeLocals);
   }
 
+  if (options::Action == ActionType::StoreSymbolIndex ||
+      options::Action == ActionType::QuerySymbolIndex) {
+    if (options::IndexDir.empty()) {
+      errs() << "error: missing symbol index directory; pass '-index-dir'\n";
+      return 1;
+    }
+    if (options::Action == ActionType::QuerySymbolIndex)
+      return querySymbolIndex(options::IndexDir, options::QueryUSR,
+                              options::Query);
+    if (CompArgs.empty()) {
+      errs() << "error: missing compiler args; "
+                "pass '-- <compiler arguments>'\n";
+      return 1;
+    }
+    return storeSymbolIndex(CompArgs, options::IndexDir);
+  }
+
   return 0;
 }
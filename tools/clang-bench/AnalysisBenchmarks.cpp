@@ -0,0 +1,121 @@
+//===-- clang-bench/AnalysisBenchmarks.cpp - Dataflow analysis benchmarks -===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The dataflow analyses behind -Wuninitialized and the dead-store and
+// unused-value checks, run on the CFG of a large function. The function is
+// parsed and its CFG built before the timing starts.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "FrontendFixture.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Analysis/Analyses/LiveVariables.h"
+#include "clang/Analysis/Analyses/UninitializedValues.h"
+#include "clang/Analysis/AnalysisContext.h"
+#include "clang/Analysis/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::bench;
+
+/// Generates a function \c f with the given number of variables, each
+/// assigned on some paths through a chain of conditionals and loops, and used
+/// later.
+static std::string generateLargeFunction(unsigned NumVars) {
+  std::string Code;
+  llvm::raw_string_ostream OS(Code);
+  OS << "int g(int);\nint f(int c) {\n";
+  for (unsigned I = 0; I < NumVars; ++I)
+    OS << "  int v" << I << ";\n";
+  for (unsigned I = 0; I < NumVars; ++I) {
+    OS << "  if (g(" << I << ")) v" << I << " = c;\n";
+    OS << "  while (g(c)) { c = c + v" << (I + NumVars / 2) % NumVars
+       << "; }\n";
+  }
+  OS << "  int sum = 0;\n";
+  for (unsigned I = 0; I < NumVars; ++I)
+    OS << "  sum += v" << I << ";\n";
+  OS << "  return sum;\n}\n";
+  return OS.str();
+}
+
+namespace {
+class CountingUninitHandler : public UninitVariablesHandler {
+public:
+  unsigned NumUses = 0;
+  void handleUseOfUninitVariable(const VarDecl *VD,
+                                 const UninitUse &Use) override {
+    ++NumUses;
+  }
+};
+} // end anonymous namespace
+
+/// Parses the large function and runs \p Run on its analysis context in each
+/// iteration.
+template <typename RunFn>
+static void benchmarkLargeFunction(BenchmarkState &State, RunFn Run) {
+  std::string Source = generateLargeFunction(1000 * State.getScale());
+  FrontendFixture Fixture(Source, /*CPlusPlus=*/false);
+  Fixture.parse();
+  if (Fixture.hasErrors())
+    return State.fail("the input has errors");
+
+  const FunctionDecl *Func = nullptr;
+  for (const Decl *D :
+       Fixture.getASTContext().getTranslationUnitDecl()->decls())
+    if (const auto *FD = dyn_cast<FunctionDecl>(D))
+      if (FD->getName() == "f" && FD->hasBody())
+        Func = FD;
+  if (!Func)
+    return State.fail("no function f in the input");
+
+  AnalysisDeclContextManager ADCM;
+  AnalysisDeclContext *AC = ADCM.getContext(Func);
+  const CFG *Cfg = AC->getCFG();
+  if (!Cfg)
+    return State.fail("no CFG for the function");
+
+  while (State.keepRunning())
+    Run(*Func, *Cfg, *AC);
+  State.setItemsPerIteration(Cfg->getNumBlockIDs(), "blocks");
+  State.recordArenaBytes(Fixture.getArenaBytes());
+}
+
+static RegisterBenchmark UninitializedValues(
+    "Analysis/UninitializedValues",
+    "Find uses of uninitialized variables in a function with many variables "
+    "and loops",
+    [](BenchmarkState &State) {
+      benchmarkLargeFunction(State, [&](const FunctionDecl &Func,
+                                        const CFG &Cfg,
+                                        AnalysisDeclContext &AC) {
+        CountingUninitHandler Handler;
+        UninitVariablesAnalysisStats Stats = {0, 0};
+        runUninitializedVariablesAnalysis(Func, Cfg, AC, Handler, Stats);
+        if (!Handler.NumUses)
+          State.fail("no uninitialized uses found");
+      });
+    });
+
+static RegisterBenchmark LiveVariablesAnalysis(
+    "Analysis/LiveVariables",
+    "Compute the live variables of a function with many variables and loops",
+    [](BenchmarkState &State) {
+      benchmarkLargeFunction(State, [&](const FunctionDecl &,
+                                        const CFG &,
+                                        AnalysisDeclContext &AC) {
+        std::unique_ptr<LiveVariables> LV(LiveVariables::create(AC));
+        State.pauseTiming();
+        if (!LV)
+          State.fail("the analysis did not run");
+        LV.reset();
+        State.resumeTiming();
+      });
+    });
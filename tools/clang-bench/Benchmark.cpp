@@ -0,0 +1,184 @@
+//===-- clang-bench/Benchmark.cpp - Benchmark harness ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the benchmark harness. Heap allocations are counted by
+// replacing the global operator new and delete for the whole tool: each block
+// is prefixed with its size, so that the memory in use can be tracked.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/Support/ErrorHandling.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace clang;
+using namespace clang::bench;
+
+//===----------------------------------------------------------------------===//
+// Allocation tracking
+//===----------------------------------------------------------------------===//
+
+namespace {
+std::atomic<bool> CountAllocations(false);
+std::atomic<uint64_t> AllocationCount(0);
+std::atomic<uint64_t> AllocationBytes(0);
+std::atomic<int64_t> LiveBytes(0);
+std::atomic<int64_t> PeakLiveBytes(0);
+
+/// The size of the header in front of each block, which keeps the blocks
+/// aligned as malloc aligns them.
+const size_t HeaderSize = alignof(std::max_align_t);
+static_assert(HeaderSize >= sizeof(size_t), "header cannot hold the size");
+} // end anonymous namespace
+
+static void *allocate(size_t Size) {
+  void *P = std::malloc(Size + HeaderSize);
+  if (!P)
+    llvm::report_fatal_error("out of memory", false);
+  std::memcpy(P, &Size, sizeof(Size));
+
+  // The peak is only updated by the thread that raises it, which is exact
+  // for the single-threaded benchmarks and close enough otherwise.
+  int64_t Live = LiveBytes += Size;
+  if (Live > PeakLiveBytes.load(std::memory_order_relaxed))
+    PeakLiveBytes.store(Live, std::memory_order_relaxed);
+  if (CountAllocations.load(std::memory_order_relaxed)) {
+    ++AllocationCount;
+    AllocationBytes += Size;
+  }
+  return static_cast<char *>(P) + HeaderSize;
+}
+
+static void deallocate(void *P) {
+  if (!P)
+    return;
+  char *Block = static_cast<char *>(P) - HeaderSize;
+  size_t Size;
+  std::memcpy(&Size, Block, sizeof(Size));
+  LiveBytes -= Size;
+  std::free(Block);
+}
+
+void *operator new(size_t Size) { return allocate(Size); }
+void *operator new[](size_t Size) { return allocate(Size); }
+void *operator new(size_t Size, const std::nothrow_t &) noexcept {
+  return allocate(Size);
+}
+void *operator new[](size_t Size, const std::nothrow_t &) noexcept {
+  return allocate(Size);
+}
+void operator delete(void *P) noexcept { deallocate(P); }
+void operator delete[](void *P) noexcept { deallocate(P); }
+void operator delete(void *P, const std::nothrow_t &) noexcept {
+  deallocate(P);
+}
+void operator delete[](void *P, const std::nothrow_t &) noexcept {
+  deallocate(P);
+}
+
+//===----------------------------------------------------------------------===//
+// BenchmarkState
+//===----------------------------------------------------------------------===//
+
+BenchmarkState::BenchmarkState(const RunOptions &Options) : Options(Options) {}
+
+bool BenchmarkState::keepRunning() {
+  if (Finished)
+    return false;
+
+  if (Iterations == 0) {
+    LiveBytesAtStart = LiveBytes;
+    PeakLiveBytes = LiveBytesAtStart;
+    resumeTiming();
+  } else if (Options.Iterations ? Iterations >= Options.Iterations
+                                : getElapsedWallTime() >= Options.MinTime) {
+    finish();
+    return false;
+  }
+  ++Iterations;
+  return true;
+}
+
+double BenchmarkState::getElapsedWallTime() const {
+  double Elapsed = Time.getWallTime();
+  if (Running)
+    Elapsed += llvm::TimeRecord::getCurrentTime(false).getWallTime() -
+               Start.getWallTime();
+  return Elapsed;
+}
+
+void BenchmarkState::pauseTiming() {
+  if (!Running)
+    return;
+  llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(false);
+  Elapsed -= Start;
+  Time += Elapsed;
+  Running = false;
+
+  CountAllocations = false;
+  NumAllocations += AllocationCount.exchange(0);
+  AllocatedBytes += AllocationBytes.exchange(0);
+}
+
+void BenchmarkState::resumeTiming() {
+  if (Running || Finished)
+    return;
+  Running = true;
+  AllocationCount = 0;
+  AllocationBytes = 0;
+  CountAllocations = true;
+  Start = llvm::TimeRecord::getCurrentTime(true);
+}
+
+void BenchmarkState::finish() {
+  pauseTiming();
+  Finished = true;
+}
+
+void BenchmarkState::fail(StringRef Message) {
+  ErrorMessage = Message;
+  finish();
+}
+
+void BenchmarkState::recordArenaBytes(size_t Bytes) {
+  ArenaBytes = std::max(ArenaBytes, Bytes);
+}
+
+uint64_t BenchmarkState::getPeakMemory() const {
+  return PeakLiveBytes - LiveBytesAtStart + ArenaBytes;
+}
+
+//===----------------------------------------------------------------------===//
+// Registry
+//===----------------------------------------------------------------------===//
+
+static std::vector<BenchmarkInfo> &getRegistry() {
+  static std::vector<BenchmarkInfo> Registry;
+  return Registry;
+}
+
+RegisterBenchmark::RegisterBenchmark(const char *Name,
+                                     const char *Description,
+                                     BenchmarkFunction Function) {
+  getRegistry().push_back({Name, Description, Function});
+}
+
+std::vector<BenchmarkInfo> bench::getBenchmarks() {
+  std::vector<BenchmarkInfo> Benchmarks = getRegistry();
+  std::sort(Benchmarks.begin(), Benchmarks.end(),
+            [](const BenchmarkInfo &A, const BenchmarkInfo &B) {
+              return StringRef(A.Name) < StringRef(B.Name);
+            });
+  return Benchmarks;
+}
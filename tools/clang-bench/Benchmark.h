@@ -0,0 +1,134 @@
+//===-- clang-bench/Benchmark.h - Benchmark harness -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief A small benchmark harness in the style of google-benchmark.
+///
+/// A benchmark is a function that runs its workload once per iteration of a
+/// \c keepRunning() loop. The harness decides how many iterations to run and
+/// measures wall and CPU time, the number and size of heap allocations, and
+/// the peak memory use of each benchmark.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_CLANG_BENCH_BENCHMARK_H
+#define LLVM_CLANG_TOOLS_CLANG_BENCH_BENCHMARK_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Timer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace bench {
+
+/// \brief How a benchmark is run.
+struct RunOptions {
+  /// \brief Run each benchmark until it has been measured for this many
+  /// seconds.
+  double MinTime = 1.0;
+  /// \brief If nonzero, run exactly this many iterations instead.
+  unsigned Iterations = 0;
+  /// \brief Multiplies the size of the generated inputs.
+  unsigned Scale = 1;
+};
+
+/// \brief The state of a running benchmark, and what was measured so far.
+///
+/// Work done while the timing is paused, such as setting up and tearing down
+/// the objects a benchmark needs, is neither timed nor counted as allocations,
+/// but still counts towards the peak memory use.
+class BenchmarkState {
+public:
+  explicit BenchmarkState(const RunOptions &Options);
+
+  /// \brief Returns true while more iterations should be run:
+  ///
+  /// \code
+  ///   while (State.keepRunning()) { ... }
+  /// \endcode
+  bool keepRunning();
+
+  void pauseTiming();
+  void resumeTiming();
+
+  /// \brief The scale of the inputs to generate, see RunOptions::Scale.
+  unsigned getScale() const { return Options.Scale; }
+
+  /// \brief Records the number of items, such as tokens or declarations,
+  /// that one iteration processes, to report a throughput.
+  void setItemsPerIteration(uint64_t Items, const char *Unit) {
+    ItemsPerIteration = Items;
+    ItemUnit = Unit;
+  }
+
+  /// \brief Stops the benchmark and reports it as failed, for instance
+  /// because its input did not compile.
+  void fail(StringRef Message);
+
+  /// \brief Records the memory held by allocators that do not get it from
+  /// operator new, such as the slabs of a BumpPtrAllocator, at a point where
+  /// it is at its largest.
+  void recordArenaBytes(size_t Bytes);
+
+  unsigned getIterations() const { return Iterations; }
+  const llvm::TimeRecord &getTime() const { return Time; }
+  uint64_t getNumAllocations() const { return NumAllocations; }
+  uint64_t getAllocatedBytes() const { return AllocatedBytes; }
+  uint64_t getItemsPerIteration() const { return ItemsPerIteration; }
+  const char *getItemUnit() const { return ItemUnit; }
+  bool hasFailed() const { return !ErrorMessage.empty(); }
+  StringRef getErrorMessage() const { return ErrorMessage; }
+  /// \brief The largest amount of heap memory that was in use at any point
+  /// in the benchmark, beyond what was in use when it started.
+  uint64_t getPeakMemory() const;
+
+private:
+  double getElapsedWallTime() const;
+  void finish();
+
+  const RunOptions &Options;
+  unsigned Iterations = 0;
+  bool Running = false;
+  bool Finished = false;
+  llvm::TimeRecord Start;
+  llvm::TimeRecord Time;
+  uint64_t NumAllocations = 0;
+  uint64_t AllocatedBytes = 0;
+  uint64_t ItemsPerIteration = 0;
+  const char *ItemUnit = "items";
+  std::string ErrorMessage;
+  size_t ArenaBytes = 0;
+  int64_t LiveBytesAtStart = 0;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState &State);
+
+struct BenchmarkInfo {
+  const char *Name;
+  const char *Description;
+  BenchmarkFunction Function;
+};
+
+/// \brief Registers a benchmark when constructed, typically as a static
+/// object next to the benchmark function.
+struct RegisterBenchmark {
+  RegisterBenchmark(const char *Name, const char *Description,
+                    BenchmarkFunction Function);
+};
+
+/// \brief Returns all registered benchmarks, sorted by name.
+std::vector<BenchmarkInfo> getBenchmarks();
+
+} // end namespace bench
+} // end namespace clang
+
+#endif
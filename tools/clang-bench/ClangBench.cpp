@@ -0,0 +1,171 @@
+//===-- clang-bench/ClangBench.cpp - Frontend microbenchmarks -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements clang-bench, which runs microbenchmarks of the
+/// lexer, preprocessor, header search, parser, Sema, dataflow analyses and
+/// source replacements on synthetic inputs, and reports the time, heap
+/// allocations and peak memory use of each.
+///
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace clang::bench;
+
+static cl::OptionCategory ClangBenchCategory("clang-bench options");
+
+static cl::opt<std::string>
+    Filter("filter", cl::init(".*"),
+           cl::desc("Only run the benchmarks whose name matches this regex"),
+           cl::cat(ClangBenchCategory));
+static cl::opt<bool> List("list",
+                          cl::desc("List the benchmarks instead of running "
+                                   "them"),
+                          cl::cat(ClangBenchCategory));
+static cl::opt<double>
+    MinTime("min-time", cl::init(1.0),
+            cl::desc("Run each benchmark for at least this many seconds"),
+            cl::cat(ClangBenchCategory));
+static cl::opt<unsigned>
+    Iterations("iterations", cl::init(0),
+               cl::desc("Run exactly this many iterations of each benchmark, "
+                        "overriding -min-time"),
+               cl::cat(ClangBenchCategory));
+static cl::opt<unsigned> Scale("scale", cl::init(1),
+                               cl::desc("Multiply the size of the inputs"),
+                               cl::cat(ClangBenchCategory));
+static cl::opt<bool> CSV("csv", cl::desc("Print the results as CSV"),
+                         cl::cat(ClangBenchCategory));
+
+/// Formats a byte count with a binary unit.
+static std::string formatBytes(double Bytes) {
+  static const char *const Units[] = {"B", "KiB", "MiB", "GiB"};
+  unsigned Unit = 0;
+  while (Bytes >= 1024 && Unit + 1 < array_lengthof(Units)) {
+    Bytes /= 1024;
+    ++Unit;
+  }
+  std::string Result;
+  raw_string_ostream OS(Result);
+  OS << format(Unit ? "%.1f %s" : "%.0f %s", Bytes, Units[Unit]);
+  return OS.str();
+}
+
+/// Formats a duration in seconds with a unit that keeps it readable.
+static std::string formatTime(double Seconds) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  if (Seconds >= 1)
+    OS << format("%.2f s", Seconds);
+  else if (Seconds >= 1e-3)
+    OS << format("%.2f ms", Seconds * 1e3);
+  else
+    OS << format("%.2f us", Seconds * 1e6);
+  return OS.str();
+}
+
+static void printHeader(raw_ostream &OS) {
+  if (CSV) {
+    OS << "name,iterations,wall_seconds,cpu_seconds,allocations,"
+          "allocated_bytes,peak_bytes,items,item_unit\n";
+    return;
+  }
+  OS << left_justify("Benchmark", 32) << ' ' << right_justify("Iterations", 10);
+  for (const char *Column : {"Wall/iter", "CPU/iter", "Allocs/iter",
+                             "Bytes/iter", "Peak memory"})
+    OS << ' ' << right_justify(Column, 12);
+  OS << "  Throughput\n";
+}
+
+static void printResult(raw_ostream &OS, const BenchmarkInfo &Info,
+                        const BenchmarkState &State) {
+  if (State.hasFailed()) {
+    if (CSV)
+      OS << Info.Name << ",FAILED\n";
+    else
+      OS << format("%-32s ", Info.Name) << "FAILED: "
+         << State.getErrorMessage() << "\n";
+    return;
+  }
+
+  double N = std::max(State.getIterations(), 1u);
+  double Wall = State.getTime().getWallTime() / N;
+  double CPU = State.getTime().getProcessTime() / N;
+  double Allocs = State.getNumAllocations() / N;
+  double Bytes = State.getAllocatedBytes() / N;
+
+  if (CSV) {
+    OS << Info.Name << ',' << State.getIterations() << ','
+       << format("%.9f,%.9f,%.1f,%.1f,", Wall, CPU, Allocs, Bytes)
+       << State.getPeakMemory() << ',' << State.getItemsPerIteration() << ','
+       << State.getItemUnit() << '\n';
+    return;
+  }
+
+  OS << format("%-32s %10u %12s %12s %12.0f %12s %12s", Info.Name,
+               State.getIterations(), formatTime(Wall).c_str(),
+               formatTime(CPU).c_str(), Allocs, formatBytes(Bytes).c_str(),
+               formatBytes(State.getPeakMemory()).c_str());
+  if (State.getItemsPerIteration() && Wall > 0)
+    OS << format("  %.3g %s/s", State.getItemsPerIteration() / Wall,
+                 State.getItemUnit());
+  OS << '\n';
+}
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  cl::HideUnrelatedOptions(ClangBenchCategory);
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "Microbenchmarks of the lexer, preprocessor, header search, parser, "
+      "Sema, dataflow analyses and source replacements.\n");
+
+  Regex FilterRegex(Filter);
+  std::string Error;
+  if (!FilterRegex.isValid(Error)) {
+    errs() << "error: invalid -filter '" << Filter << "': " << Error << "\n";
+    return 1;
+  }
+
+  std::vector<BenchmarkInfo> Benchmarks;
+  for (const BenchmarkInfo &Info : getBenchmarks())
+    if (FilterRegex.match(Info.Name))
+      Benchmarks.push_back(Info);
+
+  if (List) {
+    for (const BenchmarkInfo &Info : Benchmarks)
+      outs() << format("%-32s ", Info.Name) << Info.Description << "\n";
+    return 0;
+  }
+
+  RunOptions Options;
+  Options.MinTime = MinTime;
+  Options.Iterations = Iterations;
+  Options.Scale = std::max(1u, unsigned(Scale));
+
+  bool Failed = false;
+  printHeader(outs());
+  for (const BenchmarkInfo &Info : Benchmarks) {
+    BenchmarkState State(Options);
+    Info.Function(State);
+    printResult(outs(), Info, State);
+    outs().flush();
+    Failed |= State.hasFailed();
+  }
+  return Failed ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+//===-- clang-bench/FrontendFixture.cpp - Frontend setup ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "FrontendFixture.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Parse/ParseAST.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <iterator>
+
+using namespace clang;
+using namespace clang::bench;
+
+static const char *const MainFileName = "/main.c";
+
+FrontendFixture::FrontendFixture(StringRef MainSource, bool CPlusPlus)
+    : FS(new vfs::InMemoryFileSystem),
+      FileMgr(FileSystemOptions(), FS),
+      Diags(new DiagnosticIDs, new DiagnosticOptions,
+            new IgnoringDiagConsumer),
+      SourceMgr(Diags, FileMgr) {
+  auto TargetOpts = std::make_shared<TargetOptions>();
+  TargetOpts->Triple = "x86_64-unknown-linux-gnu";
+  Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+
+  PreprocessorOptions PPOpts;
+  CompilerInvocation::setLangDefaults(
+      LangOpts, CPlusPlus ? InputKind::CXX : InputKind::C, Target->getTriple(),
+      PPOpts, CPlusPlus ? LangStandard::lang_cxx14 : LangStandard::lang_c11);
+
+  HeaderInfo = llvm::make_unique<HeaderSearch>(
+      std::make_shared<HeaderSearchOptions>(), SourceMgr, Diags, LangOpts,
+      Target.get());
+
+  addFile(MainFileName, MainSource);
+  SourceMgr.setMainFileID(SourceMgr.createFileID(
+      FileMgr.getFile(MainFileName), SourceLocation(), SrcMgr::C_User));
+}
+
+FrontendFixture::~FrontendFixture() {}
+
+void FrontendFixture::addFile(StringRef Path, StringRef Contents) {
+  FS->addFile(Path, 0, llvm::MemoryBuffer::getMemBuffer(
+                           Contents, Path, /*RequiresNullTerminator=*/false));
+}
+
+void FrontendFixture::addSearchPath(StringRef Dir) {
+  const DirectoryEntry *DE = FileMgr.getDirectory(Dir);
+  assert(DE && "search path does not exist");
+  HeaderInfo->AddSearchPath(DirectoryLookup(DE, SrcMgr::C_User, false),
+                            /*isAngled=*/true);
+}
+
+Preprocessor &FrontendFixture::createPreprocessor() {
+  assert(!PP && "preprocessor already created");
+  PP = llvm::make_unique<Preprocessor>(
+      std::make_shared<PreprocessorOptions>(), Diags, LangOpts, SourceMgr,
+      PCMCache, *HeaderInfo, ModLoader, /*IILookup=*/nullptr,
+      /*OwnsHeaderSearch=*/false);
+  PP->Initialize(*Target);
+  return *PP;
+}
+
+uint64_t FrontendFixture::preprocess() {
+  Preprocessor &PP = createPreprocessor();
+  PP.EnterMainSourceFile();
+  uint64_t NumTokens = 0;
+  Token Tok;
+  do {
+    PP.Lex(Tok);
+    ++NumTokens;
+  } while (Tok.isNot(tok::eof));
+  return NumTokens;
+}
+
+namespace {
+class CountingConsumer : public ASTConsumer {
+public:
+  uint64_t NumDecls = 0;
+
+  bool HandleTopLevelDecl(DeclGroupRef D) override {
+    NumDecls += std::distance(D.begin(), D.end());
+    return true;
+  }
+};
+} // end anonymous namespace
+
+uint64_t FrontendFixture::parse() {
+  Preprocessor &PP = createPreprocessor();
+  Context = llvm::make_unique<ASTContext>(LangOpts, SourceMgr,
+                                          PP.getIdentifierTable(),
+                                          PP.getSelectorTable(),
+                                          PP.getBuiltinInfo());
+  Context->InitBuiltinTypes(*Target);
+  CountingConsumer Consumer;
+  ParseAST(PP, &Consumer, *Context);
+  return Consumer.NumDecls;
+}
+
+size_t FrontendFixture::getArenaBytes() const {
+  size_t Bytes = SourceMgr.getContentCacheSize();
+  if (PP)
+    Bytes += PP->getPreprocessorAllocator().getTotalMemory() +
+             PP->getIdentifierTable().getAllocator().getTotalMemory();
+  if (Context)
+    Bytes += Context->getASTAllocatedMemory();
+  return Bytes;
+}
@@ -0,0 +1,121 @@
+//===-- clang-bench/FrontendFixture.h - Frontend setup ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Sets up the objects that are needed to lex, preprocess or parse a
+/// file held in memory, without going through the driver or a frontend
+/// action, so that benchmarks measure only the subsystem they exercise.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_CLANG_BENCH_FRONTENDFIXTURE_H
+#define LLVM_CLANG_TOOLS_CLANG_BENCH_FRONTENDFIXTURE_H
+
+#include "Benchmark.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/MemoryBufferCache.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include <memory>
+
+namespace clang {
+
+class ASTContext;
+
+namespace bench {
+
+class FrontendFixture {
+public:
+  /// \param MainSource The contents of the main file, which must outlive the
+  /// fixture.
+  /// \param CPlusPlus Whether to use C++14 instead of C11.
+  FrontendFixture(StringRef MainSource, bool CPlusPlus);
+  ~FrontendFixture();
+
+  /// \brief Adds a file to the in-memory file system. The contents must
+  /// outlive the fixture.
+  void addFile(StringRef Path, StringRef Contents);
+
+  /// \brief Adds a directory to search for included files.
+  void addSearchPath(StringRef Dir);
+
+  SourceManager &getSourceManager() { return SourceMgr; }
+  const LangOptions &getLangOpts() const { return LangOpts; }
+
+  /// \brief Creates the preprocessor and enters the main file. Files and
+  /// search paths must have been added before.
+  Preprocessor &createPreprocessor();
+
+  /// \brief Preprocesses the main file, and returns the number of tokens.
+  uint64_t preprocess();
+
+  /// \brief Parses the main file and returns the number of top-level
+  /// declarations.
+  uint64_t parse();
+
+  /// \brief The AST built by parse().
+  ASTContext &getASTContext() {
+    assert(Context && "the main file was not parsed");
+    return *Context;
+  }
+
+  /// \brief Returns true if there was an error in the input.
+  bool hasErrors() const { return Diags.hasErrorOccurred(); }
+
+  /// \brief The memory held by the allocators of the preprocessor, the
+  /// identifier table, the source manager and the AST context.
+  size_t getArenaBytes() const;
+
+private:
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS;
+  FileManager FileMgr;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+  MemoryBufferCache PCMCache;
+  TrivialModuleLoader ModLoader;
+  std::unique_ptr<HeaderSearch> HeaderInfo;
+  std::unique_ptr<Preprocessor> PP;
+  std::unique_ptr<ASTContext> Context;
+};
+
+/// \brief Runs a benchmark on a new fixture for \p MainSource in each
+/// iteration. Only \p Run is measured: \p Setup, which can add files and
+/// search paths, and the destruction of the fixture are not.
+template <typename SetupFn, typename RunFn>
+void runWithFixture(BenchmarkState &State, StringRef MainSource,
+                    bool CPlusPlus, SetupFn Setup, RunFn Run) {
+  while (State.keepRunning()) {
+    State.pauseTiming();
+    {
+      FrontendFixture Fixture(MainSource, CPlusPlus);
+      Setup(Fixture);
+      State.resumeTiming();
+      Run(Fixture);
+      State.pauseTiming();
+      if (Fixture.hasErrors())
+        State.fail("the input has errors");
+      State.recordArenaBytes(Fixture.getArenaBytes());
+    }
+    State.resumeTiming();
+  }
+}
+
+} // end namespace bench
+} // end namespace clang
+
+#endif
@@ -0,0 +1,383 @@
+//===-- clang-bench/Inputs.cpp - Synthetic benchmark inputs ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Inputs.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::bench;
+
+std::string bench::generateRealWorldShapedSource(unsigned Scale) {
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  OS << "typedef unsigned long size_t;\n"
+        "int printf(const char *Format, ...);\n\n";
+  for (unsigned I = 0, E = 200 * Scale; I != E; ++I) {
+    OS << "/// \\brief A widget that counts things, number " << I << ".\n"
+       << "///\n"
+       << "/// It keeps a small buffer of values and reports them on request.\n"
+       << "namespace widgets" << I % 16 << " {\n"
+       << "class Widget" << I << " {\n"
+       << "  int Values[16];\n"
+       << "  size_t Count = 0;\n"
+       << "  const char *Name = \"widget-" << I << "\";\n\n"
+       << "public:\n"
+       << "  explicit Widget" << I << "(int Seed) {\n"
+       << "    for (int J = 0; J < 16; ++J)\n"
+       << "      Values[J] = (Seed * " << I + 3 << " + J) % 0x7fff;\n"
+       << "  }\n\n"
+       << "  // Adds a value, dropping the oldest one if the buffer is full.\n"
+       << "  void add(int Value) {\n"
+       << "    Values[Count++ % 16] = Value;\n"
+       << "  }\n\n"
+       << "  double average() const;\n"
+       << "  bool empty() const { return Count == 0; }\n"
+       << "};\n\n"
+       << "double Widget" << I << "::average() const {\n"
+       << "  if (empty())\n"
+       << "    return 0.0;\n"
+       << "  long Sum = 0;\n"
+       << "  size_t N = Count < 16 ? Count : 16;\n"
+       << "  for (size_t J = 0; J != N; ++J) {\n"
+       << "    /* Values are small, so the sum cannot overflow. */\n"
+       << "    Sum += Values[J] * 2 - (Values[J] >> 1) + 'x';\n"
+       << "  }\n"
+       << "  printf(\"%s: %ld values\\n\", Name, (long)N);\n"
+       << "  return Sum / static_cast<double>(N) * 1.5e-3;\n"
+       << "}\n"
+       << "} // end namespace widgets" << I % 16 << "\n\n";
+  }
+  return OS.str();
+}
+
+std::string bench::generateMacroStorm(unsigned Scale) {
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  // Each level doubles the size of the expansion.
+  OS << "#define ID(x) x\n"
+        "#define PLUS(a, b) ((a) + (b))\n"
+        "#define CAT(a, b) CAT_I(a, b)\n"
+        "#define CAT_I(a, b) a ## b\n"
+        "#define STR(x) STR_I(x)\n"
+        "#define STR_I(x) #x\n"
+        "#define FIRST(x, ...) x\n"
+        "#define REST(x, ...) __VA_ARGS__\n"
+        "#define CALL(f, ...) f(__VA_ARGS__)\n"
+        "#define M0(x) PLUS(ID(x), FIRST(x, 1, 2))\n";
+  for (unsigned Level = 1; Level != 6; ++Level)
+    OS << "#define M" << Level << "(x) PLUS(M" << Level - 1 << "(x), M"
+       << Level - 1 << "(ID(x)))\n";
+
+  // An X-macro list that is expanded with several definitions of X.
+  OS << "#define LIST(X) \\\n";
+  for (unsigned I = 0; I != 100; ++I)
+    OS << "  X(item" << I << ", " << I << ") \\\n";
+  OS << "\n";
+
+  for (unsigned I = 0, E = 50 * Scale; I != E; ++I) {
+    OS << "#define PREFIX p" << I << "_\n";
+    for (unsigned J = 0; J != 10; ++J)
+      OS << "int CAT(PREFIX, v" << J << ") = M5(" << J
+         << ") + REST(0, CAT(1, " << J << ")) + CALL(FIRST, " << J
+         << ", 0);\n";
+    OS << "#undef PREFIX\n";
+    if (I % 4)
+      continue;
+    switch (I / 4 % 3) {
+    case 0:
+      OS << "#define X(name, value) int CAT(name, _value" << I
+         << ") = value;\n";
+      break;
+    case 1:
+      OS << "#define X(name, value) const char *CAT(name, _name" << I
+         << ") = STR(name);\n";
+      break;
+    case 2:
+      OS << "#define X(name, value) int CAT(name, _get" << I
+         << ")(void) { return M2(value); }\n";
+      break;
+    }
+    OS << "LIST(X)\n"
+       << "#undef X\n";
+  }
+  return OS.str();
+}
+
+std::string bench::generateIfdefForest(unsigned Scale) {
+  static const char *const Platforms[] = {
+      "PLATFORM_WIN32", "PLATFORM_MACOS", "PLATFORM_IOS",   "PLATFORM_ANDROID",
+      "PLATFORM_FUCHSIA", "PLATFORM_FREEBSD", "PLATFORM_SOLARIS",
+      "PLATFORM_LINUX"};
+  const unsigned NumPlatforms = sizeof(Platforms) / sizeof(Platforms[0]);
+
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  OS << "#define PLATFORM_LINUX 1\n"
+        "#define PLATFORM_VERSION 40\n"
+        "#define HAS_FEATURE_X 1\n";
+  for (unsigned I = 0, E = 400 * Scale; I != E; ++I) {
+    // The active platform comes last, so that all the others are skipped.
+    for (unsigned P = 0; P != NumPlatforms; ++P) {
+      OS << (P == 0 ? "#if " : "#elif ") << "defined(" << Platforms[P] << ")";
+      if (P + 1 != NumPlatforms)
+        OS << " && PLATFORM_VERSION >= " << (I + P) % 50;
+      OS << "\n";
+      OS << "#  ifdef HAS_FEATURE_X\n"
+         << "#    if defined(USE_FAST_PATH_" << I % 7 << ") || "
+         << "(PLATFORM_VERSION > 20 && !defined(NO_THREADS))\n"
+         << "int feature" << I << "_" << P << "(int x) { return x * " << P
+         << "; }\n"
+         << "#    else\n"
+         << "/* Fall back to the slow path on " << Platforms[P] << ". */\n"
+         << "int feature" << I << "_" << P << "(int x) { return x; }\n"
+         << "#    endif\n"
+         << "#  else\n"
+         << "#    define feature" << I << "_" << P << "(x) (x)\n"
+         << "#  endif\n";
+    }
+    OS << "#else\n"
+       << "#  error \"unsupported platform\"\n"
+       << "#endif\n";
+  }
+  return OS.str();
+}
+
+IncludeGraph bench::generateIncludeGraph(unsigned Scale) {
+  const unsigned NumDirs = 64;
+  const unsigned NumCommon = 16;
+  const unsigned NumChains = 16 * Scale;
+  // Stays well below the limit on the nesting of includes.
+  const unsigned ChainLength = 100;
+
+  IncludeGraph Graph;
+  for (unsigned I = 0; I != NumDirs; ++I)
+    Graph.SearchDirs.push_back("/include/dir" + llvm::utostr(I));
+
+  // Common headers live in the last search directory, so that every lookup
+  // of one goes through all the others.
+  for (unsigned I = 0; I != NumCommon; ++I) {
+    std::string Contents;
+    llvm::raw_string_ostream OS(Contents);
+    if (I % 2) {
+      OS << "#pragma once\n";
+    } else {
+      OS << "#ifndef COMMON_" << I << "_H\n"
+         << "#define COMMON_" << I << "_H\n";
+    }
+    OS << "typedef int common_type_" << I << ";\n";
+    if (I % 2 == 0)
+      OS << "#endif\n";
+    Graph.Headers.emplace_back(Graph.SearchDirs.back() + "/common" +
+                                   llvm::utostr(I) + ".h",
+                               OS.str());
+  }
+
+  for (unsigned C = 0; C != NumChains; ++C) {
+    for (unsigned L = 0; L != ChainLength; ++L) {
+      std::string Contents;
+      llvm::raw_string_ostream OS(Contents);
+      OS << "#ifndef CHAIN_" << C << "_" << L << "_H\n"
+         << "#define CHAIN_" << C << "_" << L << "_H\n"
+         << "#include <common" << (C + L) % NumCommon << ".h>\n"
+         << "#include \"common" << (C * L) % NumCommon << ".h\"\n";
+      Graph.NumIncludes += 2;
+      if (L + 1 != ChainLength) {
+        OS << "#include <chain" << C << "/header" << L + 1 << ".h>\n";
+        ++Graph.NumIncludes;
+      }
+      OS << "extern int chain" << C << "_" << L << ";\n"
+         << "#endif\n";
+      Graph.Headers.emplace_back(Graph.SearchDirs[(C + L * 7) % NumDirs] +
+                                     "/chain" + llvm::utostr(C) + "/header" +
+                                     llvm::utostr(L) + ".h",
+                                 OS.str());
+    }
+  }
+
+  llvm::raw_string_ostream OS(Graph.MainSource);
+  for (unsigned C = 0; C != NumChains; ++C) {
+    // Including a header again is stopped by its include guard.
+    OS << "#include <chain" << C << "/header0.h>\n"
+       << "#include <chain" << C << "/header" << ChainLength / 2 << ".h>\n";
+    Graph.NumIncludes += 2;
+  }
+  OS.flush();
+  return Graph;
+}
+
+std::string bench::generateTemplateMetaprogram(unsigned Scale) {
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  OS << "template <int N> struct Int { static const int value = N; };\n"
+        "template <typename... Ts> struct TypeList {};\n"
+        "\n"
+        "template <int N> struct Fib {\n"
+        "  static const int value = (Fib<N - 1>::value + Fib<N - 2>::value)"
+        " % 1000;\n"
+        "};\n"
+        "template <> struct Fib<0> { static const int value = 0; };\n"
+        "template <> struct Fib<1> { static const int value = 1; };\n"
+        "\n"
+        "template <int N, typename... Ts>\n"
+        "struct MakeList : MakeList<N - 1, Int<N>, Ts...> {};\n"
+        "template <typename... Ts> struct MakeList<0, Ts...> {\n"
+        "  typedef TypeList<Ts...> type;\n"
+        "};\n"
+        "\n"
+        "template <typename L> struct Sum;\n"
+        "template <> struct Sum<TypeList<>> {\n"
+        "  static const int value = 0;\n"
+        "};\n"
+        "template <typename T, typename... Ts>\n"
+        "struct Sum<TypeList<T, Ts...>> {\n"
+        "  static const int value = (T::value + Sum<TypeList<Ts...>>::value)"
+        " % 1000;\n"
+        "};\n"
+        "\n"
+        "template <typename L, template <typename> class F> struct Map;\n"
+        "template <typename... Ts, template <typename> class F>\n"
+        "struct Map<TypeList<Ts...>, F> {\n"
+        "  typedef TypeList<typename F<Ts>::type...> type;\n"
+        "};\n"
+        "template <typename T> struct Twice {\n"
+        "  typedef Int<T::value * 2> type;\n"
+        "};\n"
+        "\n"
+        "constexpr int collatz(int N, int Steps = 0) {\n"
+        "  return N == 1 ? Steps\n"
+        "                : collatz(N % 2 ? 3 * N + 1 : N / 2, Steps + 1);\n"
+        "}\n\n";
+  for (unsigned I = 0, E = 10 * Scale; I != E; ++I) {
+    unsigned N = 50 + I * 20 % 200;
+    OS << "static_assert(Fib<" << 100 + I * 30 % 400
+       << ">::value >= 0, \"\");\n"
+       << "static_assert(Sum<MakeList<" << N << ">::type>::value >= 0, \"\");\n"
+       << "static_assert(Sum<Map<MakeList<" << N
+       << ", Int<" << I << ">>::type, Twice>::type>::value >= 0, \"\");\n"
+       << "static_assert(collatz(" << 27 + I << ") > 0, \"\");\n";
+  }
+  return OS.str();
+}
+
+std::string bench::generateAmbiguousStatements(unsigned Scale) {
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  OS << "struct Value {\n"
+        "  Value();\n"
+        "  Value(int);\n"
+        "  Value(const Value &, const Value &);\n"
+        "  int get() const;\n"
+        "};\n"
+        "struct Callable { Value operator()(Value) const; };\n"
+        "template <typename T> struct Box {\n"
+        "  Box();\n"
+        "  Box(T);\n"
+        "  T get() const;\n"
+        "};\n\n";
+  for (unsigned I = 0, E = 50 * Scale; I != E; ++I) {
+    std::string N = llvm::utostr(I);
+    OS << "int n" << N << " = " << N << ";\n"
+       << "int test" << N << "(int X) {\n"
+       // Declarations whose declarator is in parentheses.
+       << "  Value(a" << N << ");\n"
+       << "  Value(b" << N << ")(X);\n"
+       << "  Value (c" << N << ")(Value(n" << N << " + 1), Value(X));\n"
+       << "  Value (*d" << N << ")(Value, Value) = nullptr;\n"
+       // The most vexing parse: these declare functions.
+       << "  Value (e" << N << ")(Value(X), Value(n" << N << "));\n"
+       << "  Value (f" << N << ")(Value(Value(X)), Box<int>(Y));\n"
+       // Expressions that start like declarations.
+       << "  Value(X).get();\n"
+       << "  Callable()(Value(X));\n"
+       << "  Box<int>(X).get();\n"
+       << "  if (int(g" << N << ") = X)\n"
+       << "    ;\n"
+       << "  for (Value(h" << N << ")(X); h" << N << ".get();)\n"
+       << "    Value(h" << N << ").get();\n"
+       << "  return Value(a" << N << ").get() + b" << N << ".get() + c" << N
+       << ".get();\n"
+       << "}\n\n";
+  }
+  return OS.str();
+}
+
+std::string bench::generateOverloadSet(unsigned Scale) {
+  const unsigned NumOverloads = 200;
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  OS << "template <int N> struct Tag {};\n"
+        "struct Base {};\n"
+        "template <int N> struct Derived : Base {};\n"
+        "struct Convertible { Convertible(int); };\n\n";
+  for (unsigned I = 0; I != NumOverloads; ++I)
+    OS << "int f(Tag<" << I << ">);\n";
+  const char *const Types[] = {"char", "short", "int", "long", "long long",
+                               "float", "double", "const char *", "Base &",
+                               "Convertible"};
+  for (const char *Type : Types)
+    OS << "int g(" << Type << ");\n";
+  OS << "\n";
+
+  for (unsigned I = 0, E = 10 * Scale; I != E; ++I) {
+    OS << "int test" << I << "() {\n"
+       << "  int Result = 0;\n";
+    for (unsigned J = 0; J != NumOverloads; J += 4)
+      OS << "  Result += f(Tag<" << (I + J) % NumOverloads << ">());\n";
+    OS << "  Derived<" << I << "> D;\n"
+       << "  Result += g('a') + g(1) + g(2L) + g(3.0) + g(4.0f) + g(\"s\") +"
+          " g(D);\n"
+       << "  Result += g(static_cast<short>(Result)) + g(1LL);\n"
+       << "  return Result;\n"
+       << "}\n";
+  }
+  return OS.str();
+}
+
+std::string bench::generateNameLookup(unsigned Scale) {
+  const unsigned Depth = 8;
+  const unsigned NamesPerScope = 50;
+  std::string Source;
+  llvm::raw_string_ostream OS(Source);
+  for (unsigned U = 0; U != 4; ++U) {
+    OS << "namespace used" << U << " {\n";
+    for (unsigned I = 0; I != NamesPerScope; ++I)
+      OS << "int u" << U << "_" << I << ";\n";
+    OS << "}\n";
+  }
+  for (unsigned D = 0; D != Depth; ++D) {
+    OS << "namespace n" << D << " {\n";
+    if (D % 2 == 0)
+      OS << "using namespace used" << D / 2 << ";\n";
+    for (unsigned I = 0; I != NamesPerScope; ++I)
+      OS << "int v" << D << "_" << I << ";\n";
+  }
+
+  OS << "struct Outer {\n"
+        "  int m0, m1, m2, m3;\n"
+        "  struct Inner {\n"
+        "    int i0, i1;\n";
+  for (unsigned F = 0, E = 100 * Scale; F != E; ++F) {
+    OS << "    int f" << F << "(int Param) {\n"
+       << "      int Local = Param;\n";
+    for (unsigned J = 0; J != 10; ++J) {
+      unsigned D = (F + J) % Depth;
+      OS << "      Local += v" << D << "_" << (F * 7 + J) % NamesPerScope
+         << " + u" << (F + J) % 4 << "_" << J
+         << " + i" << J % 2 << ";\n";
+    }
+    OS << "      return Local;\n"
+       << "    }\n";
+  }
+  OS << "  };\n"
+        "};\n";
+  for (unsigned D = 0; D != Depth; ++D)
+    OS << "}\n";
+  return OS.str();
+}
@@ -0,0 +1,75 @@
+//===-- clang-bench/Inputs.h - Synthetic benchmark inputs -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Generators for the inputs of the benchmarks. The inputs only depend
+/// on the scale they are generated at, so that measurements are reproducible,
+/// and are shaped after code that is slow to compile in practice.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_TOOLS_CLANG_BENCH_INPUTS_H
+#define LLVM_CLANG_TOOLS_CLANG_BENCH_INPUTS_H
+
+#include "clang/Basic/LLVM.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clang {
+namespace bench {
+
+/// \brief C++ code in the style of an ordinary project: comments, classes,
+/// inline and out-of-line member functions, literals and expressions.
+std::string generateRealWorldShapedSource(unsigned Scale);
+
+/// \brief Nested function-like macros that expand to many tokens, X-macro
+/// lists, variadic macros, stringizing and token pasting.
+std::string generateMacroStorm(unsigned Scale);
+
+/// \brief Declarations guarded by nested conditionals over many platforms and
+/// versions, most of which are skipped.
+std::string generateIfdefForest(unsigned Scale);
+
+/// \brief A graph of headers with include guards, spread over many search
+/// directories: long include chains, and common headers that are included
+/// from everywhere.
+struct IncludeGraph {
+  /// \brief The search directories, in search order.
+  std::vector<std::string> SearchDirs;
+  /// \brief The paths and contents of the headers.
+  std::vector<std::pair<std::string, std::string>> Headers;
+  /// \brief The main file, which includes the roots of the graph.
+  std::string MainSource;
+  /// \brief The number of inclusion directives that are processed.
+  unsigned NumIncludes = 0;
+};
+IncludeGraph generateIncludeGraph(unsigned Scale);
+
+/// \brief Recursive class templates, variadic type lists and constexpr
+/// functions that need deep and wide instantiation.
+std::string generateTemplateMetaprogram(unsigned Scale);
+
+/// \brief Statements that are ambiguous between declarations and
+/// expressions, such as function-style casts and declarators in parentheses,
+/// which the parser has to disambiguate by parsing them tentatively.
+std::string generateAmbiguousStatements(unsigned Scale);
+
+/// \brief Calls to functions with large overload sets, which are resolved by
+/// the types of their arguments.
+std::string generateOverloadSet(unsigned Scale);
+
+/// \brief Unqualified names that are found in enclosing namespaces, classes
+/// and namespaces nominated by using-directives.
+std::string generateNameLookup(unsigned Scale);
+
+} // end namespace bench
+} // end namespace clang
+
+#endif
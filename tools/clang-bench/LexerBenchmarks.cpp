@@ -0,0 +1,51 @@
+//===-- clang-bench/LexerBenchmarks.cpp - Lexer benchmarks ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "FrontendFixture.h"
+#include "Inputs.h"
+#include "clang/Lex/Lexer.h"
+
+using namespace clang;
+using namespace clang::bench;
+
+/// Lexes the main file of the fixture in raw mode, which bypasses the
+/// preprocessor and the identifier table.
+static uint64_t lexRaw(FrontendFixture &Fixture, bool KeepComments) {
+  SourceManager &SM = Fixture.getSourceManager();
+  FileID FID = SM.getMainFileID();
+  Lexer L(FID, SM.getBuffer(FID), SM, Fixture.getLangOpts());
+  L.SetCommentRetentionState(KeepComments);
+  uint64_t NumTokens = 0;
+  Token Tok;
+  do {
+    L.LexFromRawLexer(Tok);
+    ++NumTokens;
+  } while (Tok.isNot(tok::eof));
+  return NumTokens;
+}
+
+static void benchmarkRawLexer(BenchmarkState &State, bool KeepComments) {
+  std::string Source = generateRealWorldShapedSource(State.getScale());
+  FrontendFixture Fixture(Source, /*CPlusPlus=*/true);
+  uint64_t NumTokens = 0;
+  while (State.keepRunning())
+    NumTokens = lexRaw(Fixture, KeepComments);
+  State.setItemsPerIteration(NumTokens, "tokens");
+  State.recordArenaBytes(Fixture.getArenaBytes());
+}
+
+static RegisterBenchmark RawTokens(
+    "Lexer/RawTokens", "Lex real-world-shaped C++ in raw mode",
+    [](BenchmarkState &State) { benchmarkRawLexer(State, false); });
+
+static RegisterBenchmark RawTokensWithComments(
+    "Lexer/RawTokensWithComments",
+    "Lex real-world-shaped C++ in raw mode, returning comments as tokens",
+    [](BenchmarkState &State) { benchmarkRawLexer(State, true); });
@@ -0,0 +1,118 @@
+//===-- clang-bench/PreprocessorBenchmarks.cpp - Preprocessor benchmarks --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "FrontendFixture.h"
+#include "Inputs.h"
+#include "clang/Frontend/PreprocessorOutputOptions.h"
+#include "clang/Frontend/Utils.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace clang::bench;
+
+static void benchmarkPreprocessor(BenchmarkState &State, StringRef Source,
+                                  bool CPlusPlus) {
+  uint64_t NumTokens = 0;
+  runWithFixture(State, Source, CPlusPlus, [](FrontendFixture &) {},
+                 [&](FrontendFixture &Fixture) {
+                   NumTokens = Fixture.preprocess();
+                 });
+  State.setItemsPerIteration(NumTokens, "tokens");
+}
+
+static RegisterBenchmark PlainSource(
+    "Preprocessor/PlainSource",
+    "Preprocess real-world-shaped C++ without directives, which mostly "
+    "measures lexing and identifier lookup",
+    [](BenchmarkState &State) {
+      benchmarkPreprocessor(
+          State, generateRealWorldShapedSource(State.getScale()), true);
+    });
+
+static RegisterBenchmark MacroStorm(
+    "Preprocessor/MacroStorm",
+    "Expand nested function-like macros, X-macros and variadic macros",
+    [](BenchmarkState &State) {
+      benchmarkPreprocessor(State, generateMacroStorm(State.getScale()),
+                            false);
+    });
+
+static RegisterBenchmark IfdefForest(
+    "Preprocessor/IfdefForest",
+    "Evaluate and skip nested conditionals over many platforms",
+    [](BenchmarkState &State) {
+      benchmarkPreprocessor(State, generateIfdefForest(State.getScale()),
+                            false);
+    });
+
+namespace {
+/// A buffered stream that discards its output but counts it.
+class CountingOStream : public llvm::raw_ostream {
+  uint64_t Pos = 0;
+
+  void write_impl(const char *Ptr, size_t Size) override { Pos += Size; }
+  uint64_t current_pos() const override { return Pos; }
+
+public:
+  ~CountingOStream() override { flush(); }
+};
+} // end anonymous namespace
+
+/// Measures -E: preprocessing, and printing the tokens with line markers to a
+/// stream that discards them.
+static void benchmarkPrintPreprocessed(BenchmarkState &State,
+                                       StringRef Source, bool CPlusPlus) {
+  uint64_t NumBytes = 0;
+  runWithFixture(State, Source, CPlusPlus, [](FrontendFixture &) {},
+                 [&](FrontendFixture &Fixture) {
+                   PreprocessorOutputOptions Opts;
+                   Opts.ShowCPP = 1;
+                   CountingOStream OS;
+                   DoPrintPreprocessedInput(Fixture.createPreprocessor(), &OS,
+                                            Opts);
+                   NumBytes = OS.tell();
+                 });
+  State.setItemsPerIteration(NumBytes, "bytes");
+}
+
+static RegisterBenchmark PrintPlainSource(
+    "Preprocessor/PrintPlainSource",
+    "Print the preprocessed output of real-world-shaped C++, as -E does",
+    [](BenchmarkState &State) {
+      benchmarkPrintPreprocessed(
+          State, generateRealWorldShapedSource(State.getScale()), true);
+    });
+
+static RegisterBenchmark PrintMacroStorm(
+    "Preprocessor/PrintMacroStorm",
+    "Print the preprocessed output of nested macro expansions, as -E does",
+    [](BenchmarkState &State) {
+      benchmarkPrintPreprocessed(State, generateMacroStorm(State.getScale()),
+                                 false);
+    });
+
+static void benchmarkIncludeGraph(BenchmarkState &State) {
+  IncludeGraph Graph = generateIncludeGraph(State.getScale());
+  runWithFixture(State, Graph.MainSource, /*CPlusPlus=*/false,
+                 [&](FrontendFixture &Fixture) {
+                   for (const auto &Header : Graph.Headers)
+                     Fixture.addFile(Header.first, Header.second);
+                   for (const std::string &Dir : Graph.SearchDirs)
+                     Fixture.addSearchPath(Dir);
+                 },
+                 [](FrontendFixture &Fixture) { Fixture.preprocess(); });
+  State.setItemsPerIteration(Graph.NumIncludes, "includes");
+}
+
+static RegisterBenchmark DeepIncludes(
+    "HeaderSearch/IncludeGraph",
+    "Look up and enter long chains of guarded headers spread over many "
+    "search directories",
+    benchmarkIncludeGraph);
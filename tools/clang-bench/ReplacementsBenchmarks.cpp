@@ -0,0 +1,151 @@
+//===-- clang-bench/ReplacementsBenchmarks.cpp - Replacements benchmarks --===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Adding, merging and applying large sets of replacements, as produced by
+// codebase-wide migrations. The replacements are built before the timing
+// starts, and the sets built in each iteration are destroyed after it stops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "clang/Tooling/Core/Replacement.h"
+#include <utility>
+
+using namespace clang;
+using namespace clang::bench;
+using namespace clang::tooling;
+
+static const unsigned Stride = 16;
+
+static unsigned getNumReplacements(const BenchmarkState &State) {
+  return 100000 * State.getScale();
+}
+
+/// Generates replacements at every \c Stride bytes of a file: every third one
+/// is an insertion, the others replace a few bytes. With \p Overlapping, every
+/// other replacement is a deletion that overlaps the next one, so that they
+/// need to be merged.
+static std::vector<Replacement> generateReplacements(unsigned N,
+                                                     bool Overlapping) {
+  std::vector<Replacement> Result;
+  Result.reserve(N);
+  unsigned Seed = 1;
+  for (unsigned I = 0; I < N; ++I) {
+    Seed = Seed * 1103515245 + 12345;
+    unsigned Offset = I * Stride + (Seed >> 16) % (Stride / 2);
+    if (Overlapping && I % 2)
+      Result.emplace_back("input.cc", Offset, Stride, "");
+    else if (I % 3 == 0)
+      Result.emplace_back("input.cc", Offset, 0, "x");
+    else
+      Result.emplace_back("input.cc", Offset, 2, "yy");
+  }
+  // Shuffle, as tools don't produce replacements in order.
+  for (unsigned I = Result.size() - 1; I > 0; --I) {
+    Seed = Seed * 1103515245 + 12345;
+    std::swap(Result[I], Result[(Seed >> 8) % (I + 1)]);
+  }
+  return Result;
+}
+
+static llvm::Error addReplacements(Replacements &Replaces,
+                                   ArrayRef<Replacement> Rs, bool AddAll) {
+  if (AddAll)
+    return Replaces.addAll(Rs);
+  for (const Replacement &R : Rs)
+    if (llvm::Error Err = Replaces.add(R))
+      return Err;
+  return llvm::Error::success();
+}
+
+static void benchmarkAdd(BenchmarkState &State, bool AddAll,
+                         bool Overlapping) {
+  std::vector<Replacement> Rs =
+      generateReplacements(getNumReplacements(State), Overlapping);
+  while (State.keepRunning()) {
+    State.pauseTiming();
+    {
+      Replacements Replaces;
+      State.resumeTiming();
+      llvm::Error Err = addReplacements(Replaces, Rs, AddAll);
+      State.pauseTiming();
+      // Overlapping deletions can conflict with the insertions they cover.
+      if (Err && !Overlapping)
+        State.fail(llvm::toString(std::move(Err)));
+      else
+        llvm::consumeError(std::move(Err));
+    }
+    State.resumeTiming();
+  }
+  State.setItemsPerIteration(Rs.size(), "replacements");
+}
+
+static RegisterBenchmark AddAll(
+    "Replacements/AddAll", "Add a large unsorted set of replacements at once",
+    [](BenchmarkState &State) { benchmarkAdd(State, true, false); });
+
+static RegisterBenchmark AddOneByOne(
+    "Replacements/AddOneByOne",
+    "Add a large unsorted set of replacements one at a time",
+    [](BenchmarkState &State) { benchmarkAdd(State, false, false); });
+
+static RegisterBenchmark AddAllOverlapping(
+    "Replacements/AddAllOverlapping",
+    "Add a large set of replacements that overlap and have to be merged",
+    [](BenchmarkState &State) { benchmarkAdd(State, true, true); });
+
+static RegisterBenchmark Merge(
+    "Replacements/Merge",
+    "Merge two large sets of replacements, the second one referring to the "
+    "code the first one produces",
+    [](BenchmarkState &State) {
+      Replacements First, Second;
+      llvm::consumeError(First.addAll(
+          generateReplacements(getNumReplacements(State), false)));
+      std::vector<Replacement> Rs;
+      int Shift = 0;
+      for (const Replacement &R : First) {
+        Rs.emplace_back("input.cc", R.getOffset() + Shift,
+                        R.getReplacementText().size(), "zz");
+        Shift += R.getReplacementText().size() - R.getLength();
+      }
+      llvm::consumeError(Second.addAll(Rs));
+
+      while (State.keepRunning()) {
+        Replacements Merged = First.merge(Second);
+        State.pauseTiming();
+        if (Merged.size() != First.size())
+          State.fail("merged replacements were lost");
+        Merged = Replacements();
+        State.resumeTiming();
+      }
+      State.setItemsPerIteration(First.size() + Second.size(),
+                                 "replacements");
+    });
+
+static RegisterBenchmark Apply(
+    "Replacements/Apply", "Apply a large set of replacements to a buffer",
+    [](BenchmarkState &State) {
+      unsigned N = getNumReplacements(State);
+      std::string Code(N * Stride + Stride, 'a');
+      Replacements Replaces;
+      llvm::consumeError(Replaces.addAll(generateReplacements(N, false)));
+
+      while (State.keepRunning()) {
+        llvm::Expected<std::string> Result =
+            applyAllReplacements(Code, Replaces);
+        State.pauseTiming();
+        if (!Result)
+          State.fail(llvm::toString(Result.takeError()));
+        else
+          *Result = std::string();
+        State.resumeTiming();
+      }
+      State.setItemsPerIteration(Replaces.size(), "replacements");
+    });
@@ -0,0 +1,67 @@
+//===-- clang-bench/SemaBenchmarks.cpp - Parser and Sema benchmarks -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The parser and Sema cannot run separately, so these benchmarks parse inputs
+// whose cost is dominated by one of them. None of the inputs use macros, so
+// preprocessing is only a small part of the time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Benchmark.h"
+#include "FrontendFixture.h"
+#include "Inputs.h"
+
+using namespace clang;
+using namespace clang::bench;
+
+static void benchmarkParse(BenchmarkState &State, StringRef Source) {
+  uint64_t NumDecls = 0;
+  runWithFixture(State, Source, /*CPlusPlus=*/true, [](FrontendFixture &) {},
+                 [&](FrontendFixture &Fixture) {
+                   NumDecls = Fixture.parse();
+                 });
+  State.setItemsPerIteration(NumDecls, "decls");
+}
+
+static RegisterBenchmark RealWorldShaped(
+    "Parser/RealWorldShaped",
+    "Parse real-world-shaped C++: classes, member functions and statements",
+    [](BenchmarkState &State) {
+      benchmarkParse(State, generateRealWorldShapedSource(State.getScale()));
+    });
+
+static RegisterBenchmark TemplateMetaprogram(
+    "Sema/TemplateMetaprogram",
+    "Instantiate recursive class templates, variadic type lists and "
+    "constexpr functions",
+    [](BenchmarkState &State) {
+      benchmarkParse(State, generateTemplateMetaprogram(State.getScale()));
+    });
+
+static RegisterBenchmark OverloadSet(
+    "Sema/OverloadSet",
+    "Resolve calls to functions with large overload sets",
+    [](BenchmarkState &State) {
+      benchmarkParse(State, generateOverloadSet(State.getScale()));
+    });
+
+static RegisterBenchmark NameLookup(
+    "Sema/NameLookup",
+    "Look up unqualified names through nested namespaces, classes and "
+    "using-directives",
+    [](BenchmarkState &State) {
+      benchmarkParse(State, generateNameLookup(State.getScale()));
+    });
+
+static RegisterBenchmark AmbiguousStatements(
+    "Parser/AmbiguousStatements",
+    "Disambiguate statements that could be declarations or expressions",
+    [](BenchmarkState &State) {
+      benchmarkParse(State, generateAmbiguousStatements(State.getScale()));
+    });
@@ -0,0 +1,74 @@
+//===-- clang-vfs-overlay/ClangVFSOverlay.cpp -----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file implements clang-vfs-overlay, which compiles a virtual
+/// file system overlay described in YAML to the binary format. -ivfsoverlay
+/// accepts either, but reads a binary overlay in place instead of parsing it,
+/// which matters for overlays that map many files.
+///
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+static cl::OptionCategory ClangVFSOverlayCategory("clang-vfs-overlay options");
+
+static cl::opt<std::string> InputFilename(cl::Positional, cl::Required,
+                                          cl::desc("<input YAML overlay>"),
+                                          cl::cat(ClangVFSOverlayCategory));
+static cl::opt<std::string> OutputFilename("o", cl::Required,
+                                           cl::desc("Output binary overlay"),
+                                           cl::value_desc("filename"),
+                                           cl::cat(ClangVFSOverlayCategory));
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+
+  cl::HideUnrelatedOptions(ClangVFSOverlayCategory);
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "A tool to compile a virtual file system overlay in YAML format to the\n"
+      "binary format, for use with -ivfsoverlay.\n");
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+      MemoryBuffer::getFile(InputFilename);
+  if (!Buffer) {
+    errs() << "error: cannot read '" << InputFilename
+           << "': " << Buffer.getError().message() << "\n";
+    return 1;
+  }
+
+  std::error_code EC;
+  tool_output_file Out(OutputFilename, EC, sys::fs::F_None);
+  if (EC) {
+    errs() << "error: cannot open '" << OutputFilename
+           << "': " << EC.message() << "\n";
+    return 1;
+  }
+
+  // Errors in the YAML are reported by the default diagnostic handler.
+  if (!clang::vfs::writeBinaryVFSOverlay(std::move(*Buffer),
+                                         /*DiagHandler=*/nullptr,
+                                         InputFilename, Out.os())) {
+    errs() << "error: invalid virtual file system overlay '" << InputFilename
+           << "'\n";
+    return 1;
+  }
+
+  Out.keep();
+  return 0;
+}
@@ -0,0 +1,110 @@
+//===- SummarizeSerializedDiagnostics.cpp - diagtool tool -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file provides a diagtool tool that merges the serialized diagnostics
+// files of many translation units and prints statistics per warning flag.
+//
+//===----------------------------------------------------------------------===//
+
+#include "DiagTool.h"
+#include "clang/Frontend/SerializedDiagnosticAggregator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Threading.h"
+
+DEF_DIAGTOOL("summarize-serialized",
+             "Merge serialized diagnostics files and summarize them per flag",
+             SummarizeSerializedDiagnostics)
+
+using namespace clang;
+using namespace clang::serialized_diags;
+using namespace diagtool;
+
+/// Writes \p Str as a JSON string literal. Flag names only contain
+/// letters, digits, '-', '=' and '#'.
+static void printJSONString(llvm::raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\';
+    OS << C;
+  }
+  OS << '"';
+}
+
+int SummarizeSerializedDiagnostics::run(unsigned int argc, char **argv,
+                                        llvm::raw_ostream &OS) {
+  static llvm::cl::OptionCategory SummarizeOptions(
+      "diagtool summarize-serialized options");
+
+  static llvm::cl::list<std::string> Files(
+      llvm::cl::Positional, llvm::cl::desc("<file.dia>..."),
+      llvm::cl::OneOrMore, llvm::cl::cat(SummarizeOptions));
+
+  static llvm::cl::opt<unsigned> NumThreads(
+      "j", llvm::cl::desc("Number of files to read in parallel"),
+      llvm::cl::init(0), llvm::cl::cat(SummarizeOptions));
+
+  static llvm::cl::opt<bool> JSON(
+      "json", llvm::cl::desc("Print one JSON object per flag"),
+      llvm::cl::cat(SummarizeOptions));
+
+  std::vector<const char *> Args;
+  Args.push_back("summarize-serialized");
+  for (const char *A : llvm::makeArrayRef(argv, argc))
+    Args.push_back(A);
+
+  llvm::cl::HideUnrelatedOptions(SummarizeOptions);
+  llvm::cl::ParseCommandLineOptions(
+      (int)Args.size(), Args.data(),
+      "Serialized diagnostics summary\n\n"
+      "  Files can also be listed in a response file, as @<file>.\n");
+
+  unsigned Threads = NumThreads;
+  if (!Threads)
+    Threads = llvm::heavyweight_hardware_concurrency();
+
+  bool Failed = false;
+  DiagnosticAggregator Aggregator;
+  Aggregator.addFiles(
+      Files, Threads, [&](StringRef File, std::error_code EC) {
+        llvm::errs() << "error: " << File << ": " << EC.message() << "\n";
+        Failed = true;
+      });
+
+  std::vector<DiagnosticFlagSummary> Summaries = Aggregator.summarize();
+
+  if (JSON) {
+    for (const DiagnosticFlagSummary &Summary : Summaries) {
+      OS << "{\"flag\":";
+      printJSONString(OS, Summary.Flag);
+      OS << ",\"occurrences\":" << Summary.Occurrences
+         << ",\"unique\":" << Summary.Unique
+         << ",\"errors\":" << Summary.Errors
+         << ",\"translation-units\":" << Summary.TranslationUnits
+         << ",\"source-files\":" << Summary.SourceFiles << "}\n";
+    }
+    return Failed;
+  }
+
+  OS << Aggregator.getNumFiles() << " files, "
+     << Aggregator.getNumDiagnostics() << " diagnostics, "
+     << Aggregator.getNumUniqueDiagnostics() << " unique\n";
+  OS << "occurrences   unique   errors      TUs    files  flag\n";
+  for (const DiagnosticFlagSummary &Summary : Summaries) {
+    OS << llvm::format("%11u %8u %8u %8u %8u  ", Summary.Occurrences,
+                       Summary.Unique, Summary.Errors,
+                       Summary.TranslationUnits, Summary.SourceFiles);
+    if (Summary.Flag.empty())
+      OS << "(no flag)\n";
+    else
+      OS << "-W" << Summary.Flag << "\n";
+  }
+  return Failed;
+}
@@ -21,6 +21,7 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Basic/BruteClangDiagnostic.h" //access the functionality of BruteClangDiagnostic classes
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/TextDiagnosticBuffer.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
@@ -31,8 +32,10 @@
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
@@ -65,6 +68,11 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // particular that we remove files registered with RemoveFileOnSignal.
   llvm::sys::RunInterruptHandlers();
 
+  // When running in the driver's process (-fintegrated-cc1), hand the failure
+  // back to the driver instead of exiting from under it.
+  if (auto *CRC = llvm::CrashRecoveryContext::GetCurrent())
+    CRC->HandleCrash();
+
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
@@ -195,6 +203,41 @@ bool isInFileList(std::string configFile, std::string &fileName){
   }
 }
 
+/// Writes the -ftime-trace timeline of a compilation next to its output file,
+/// or next to its input if it writes to stdout. Each platform gets its own
+/// timeline, since they share the output file.
+static void writeTimeTrace(CompilerInstance &Clang, StringRef Platform) {
+  const FrontendOptions &Opts = Clang.getFrontendOpts();
+  SmallString<128> Path(Opts.OutputFile);
+  if (Path.empty() || Path == "-") {
+    if (Opts.Inputs.empty())
+      return;
+    Path = llvm::sys::path::filename(Opts.Inputs[0].getFile());
+  }
+  llvm::sys::path::replace_extension(Path, Platform + ".json");
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    Clang.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << Path << EC.message();
+    return;
+  }
+  timeTraceProfilerWrite(OS);
+}
+
+/// Gives each platform its own -header-cost-report file, since they share the
+/// command line: costs.json -> costs.<platform>.json.
+static void setHeaderCostReportPlatform(FrontendOptions &Opts,
+                                        StringRef Platform) {
+  if (Opts.HeaderCostReportFile.empty())
+    return;
+  SmallString<128> Path(Opts.HeaderCostReportFile);
+  std::string Extension = llvm::sys::path::extension(Path);
+  llvm::sys::path::replace_extension(Path, Platform + Extension);
+  Opts.HeaderCostReportFile = Path.str();
+}
+
 void ExecuteCI(std::string platform, frontend::IncludeDirGroup Group, CustomDiagContainer &DiagContainer, ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr){
   std::string current_CI;
   current_CI = platform;
@@ -263,8 +306,22 @@ void ExecuteCI(std::string platform, frontend::IncludeDirGroup Group, CustomDiag
   //setting error limit to unlimited (0)
   Clang->getDiagnostics().setErrorLimit(0);
 
+  setHeaderCostReportPlatform(Clang->getFrontendOpts(), platform);
+
+  bool TimeTrace = Clang->getFrontendOpts().TimeTrace;
+  if (TimeTrace)
+    timeTraceProfilerInitialize(Clang->getFrontendOpts().TimeTraceGranularity);
+
   // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  {
+    TimeTraceScope TimeScope("ExecuteCompiler");
+    Success = ExecuteCompilerInvocation(Clang.get());
+  }
+
+  if (TimeTrace) {
+    writeTimeTrace(*Clang, platform);
+    timeTraceProfilerCleanup();
+  }
 
   // Our error handler depends on the Diagnostics object, which we're
   // potentially about to delete. Uninstall the handler now so that any
@@ -312,6 +312,14 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
   return 1;
 }
 
+/// Run a -cc1 job of the compilation in the driver's process.
+static int ExecuteCC1InProcess(ArrayRef<const char *> argv) {
+  // The LLVM command line options are global; forget what the driver or the
+  // previous jobs passed with -mllvm.
+  llvm::cl::ResetAllOptionOccurrences();
+  return ExecuteCC1Tool(argv, "");
+}
+
 int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal(argv_[0]);
   llvm::PrettyStackTraceProgram X(argc_, argv_);
@@ -459,6 +467,7 @@ int main(int argc_, const char **argv_) {
                           SavedStrings);
 
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
+  TheDriver.CC1Main = ExecuteCC1InProcess;
 
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
   int Res = 1;
@@ -33,6 +33,7 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Index/CodegenNameGenerator.h"
 #include "clang/Index/CommentToXML.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/PreprocessingRecord.h"
@@ -81,6 +82,7 @@ CXTranslationUnit cxtu::MakeCXTranslationUnit(CIndexer *CIdx,
   D->Diagnostics = nullptr;
   D->OverridenCursorsPool = createOverridenCXCursorsPool();
   D->CommentToXML = nullptr;
+  D->USRs = nullptr;
   return D;
 }
 
@@ -3934,6 +3936,7 @@ void clang_disposeTranslationUnit(CXTranslationUnit CTUnit) {
     delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
     disposeOverridenCXCursorsPool(CTUnit->OverridenCursorsPool);
     delete CTUnit->CommentToXML;
+    delete CTUnit->USRs;
     delete CTUnit;
   }
 }
@@ -3945,13 +3948,54 @@ unsigned clang_suspendTranslationUnit(CXTranslationUnit CTUnit) {
     if (Unit && Unit->isUnsafeToFree())
       return false;
 
-    Unit->ResetForParse();
+    // The diagnostics and the cached USRs refer to the AST we are dropping.
+    delete static_cast<CXDiagnosticSetImpl *>(CTUnit->Diagnostics);
+    CTUnit->Diagnostics = nullptr;
+    delete CTUnit->USRs;
+    CTUnit->USRs = nullptr;
+
+    Unit->suspend();
     return true;
   }
 
   return false;
 }
 
+int clang_resumeTranslationUnit(CXTranslationUnit TU,
+                                unsigned num_unsaved_files,
+                                struct CXUnsavedFile *unsaved_files,
+                                unsigned options) {
+  LOG_FUNC_SECTION {
+    *Log << TU;
+  }
+
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return CXError_InvalidArguments;
+  }
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  if (CXXUnit->isUnsafeToFree())
+    return CXError_Failure;
+
+  {
+    ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+    if (!CXXUnit->resume(TU->CIdx->getPCHContainerOperations())) {
+      LOG_FUNC_SECTION {
+        *Log << "restored from the serialized AST";
+      }
+      return CXError_Success;
+    }
+  }
+
+  // The serialized form is missing or out of date; parse the sources again.
+  LOG_FUNC_SECTION {
+    *Log << "reparsing";
+  }
+  return clang_reparseTranslationUnit(TU, num_unsaved_files, unsaved_files,
+                                      options);
+}
+
 unsigned clang_defaultReparseOptions(CXTranslationUnit TU) {
   return CXReparse_None;
 }
@@ -3977,6 +4021,10 @@ clang_reparseTranslationUnit_Impl(CXTranslationUnit TU,
   ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
   ASTUnit::ConcurrencyCheck Check(*CXXUnit);
 
+  // Reparsing replaces the AST, which the cached USRs refer to.
+  delete TU->USRs;
+  TU->USRs = nullptr;
+
   std::unique_ptr<std::vector<ASTUnit::RemappedFile>> RemappedFiles(
       new std::vector<ASTUnit::RemappedFile>());
 
@@ -640,8 +640,10 @@ static CXCodeCompleteResults *
 clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                           unsigned complete_line, unsigned complete_column,
                           ArrayRef<CXUnsavedFile> unsaved_files,
-                          unsigned options) {
+                          unsigned options, StringRef typed_prefix,
+                          unsigned max_results) {
   bool IncludeBriefComments = options & CXCodeComplete_IncludeBriefComments;
+  bool FuzzyFilter = options & CXCodeComplete_FuzzyFilter;
 
 #ifdef UDP_CODE_COMPLETION_LOGGER
 #ifdef UDP_CODE_COMPLETION_LOGGER_PORT
@@ -697,7 +699,8 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                     IncludeBriefComments, Capture,
                     CXXIdx->getPCHContainerOperations(), *Results->Diag,
                     Results->LangOpts, *Results->SourceMgr, *Results->FileMgr,
-                    Results->Diagnostics, Results->TemporaryBuffers);
+                    Results->Diagnostics, Results->TemporaryBuffers,
+                    FuzzyFilter, typed_prefix, max_results);
 
   Results->DiagnosticsWrappers.resize(Results->Diagnostics.size());
 
@@ -791,19 +794,37 @@ CXCodeCompleteResults *clang_codeCompleteAt(CXTranslationUnit TU,
                                             struct CXUnsavedFile *unsaved_files,
                                             unsigned num_unsaved_files,
                                             unsigned options) {
+  return clang_codeCompleteAtWithLimit(TU, complete_filename, complete_line,
+                                       complete_column, unsaved_files,
+                                       num_unsaved_files, options, nullptr, 0);
+}
+
+CXCodeCompleteResults *
+clang_codeCompleteAtWithLimit(CXTranslationUnit TU,
+                              const char *complete_filename,
+                              unsigned complete_line, unsigned complete_column,
+                              struct CXUnsavedFile *unsaved_files,
+                              unsigned num_unsaved_files, unsigned options,
+                              const char *typed_prefix, unsigned max_results) {
   LOG_FUNC_SECTION {
     *Log << TU << ' '
          << complete_filename << ':' << complete_line << ':' << complete_column;
+    if (typed_prefix)
+      *Log << " prefix=" << typed_prefix;
+    if (max_results)
+      *Log << " limit=" << max_results;
   }
 
   if (num_unsaved_files && !unsaved_files)
     return nullptr;
 
+  StringRef Prefix = typed_prefix ? StringRef(typed_prefix) : StringRef();
   CXCodeCompleteResults *result;
   auto CodeCompleteAtImpl = [=, &result]() {
     result = clang_codeCompleteAt_Impl(
         TU, complete_filename, complete_line, complete_column,
-        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options);
+        llvm::makeArrayRef(unsaved_files, num_unsaved_files), options, Prefix,
+        max_results);
   };
 
   if (getenv("LIBCLANG_NOTHREADS")) {
@@ -32,8 +32,13 @@ static inline StringRef extractUSRSuffix(StringRef s) {
   return s.startswith("c:") ? s.substr(2) : "";
 }
 
-bool cxcursor::getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf) {
-  return generateUSRForDecl(D, Buf);
+bool cxcursor::getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf,
+                                CXTranslationUnit TU) {
+  if (!TU)
+    return generateUSRForDecl(D, Buf);
+  if (!TU->USRs)
+    TU->USRs = new USRCache();
+  return generateUSRForDecl(D, Buf, TU->USRs);
 }
 
 CXString clang_getCursorUSR(CXCursor C) {
@@ -52,7 +57,7 @@ CXString clang_getCursorUSR(CXCursor C) {
     if (!buf)
       return cxstring::createEmpty();
 
-    bool Ignore = cxcursor::getDeclCursorUSR(D, buf->Data);
+    bool Ignore = cxcursor::getDeclCursorUSR(D, buf->Data, TU);
     if (Ignore) {
       buf->dispose();
       return cxstring::createEmpty();
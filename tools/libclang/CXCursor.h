@@ -279,10 +279,12 @@ static inline CXCursor getTypeRefedCallExprCursor(CXCursor cursor) {
 
 CXCursor getTypeRefCursor(CXCursor cursor);
 
-/// \brief Generate a USR for \arg D and put it in \arg Buf.
+/// \brief Generate a USR for \arg D and put it in \arg Buf, using the USR
+/// cache of \arg TU.
 /// \returns true if no USR was computed or the result should be ignored,
 /// false otherwise.
-bool getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf);
+bool getDeclCursorUSR(const Decl *D, SmallVectorImpl<char> &Buf,
+                      CXTranslationUnit TU);
 
 bool operator==(CXCursor X, CXCursor Y);
   
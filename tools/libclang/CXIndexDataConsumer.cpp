@@ -1190,7 +1190,7 @@ void CXIndexDataConsumer::getEntityInfo(const NamedDecl *D,
 
   {
     SmallString<512> StrBuf;
-    bool Ignore = getDeclCursorUSR(D, StrBuf);
+    bool Ignore = getDeclCursorUSR(D, StrBuf, CXTU);
     if (Ignore) {
       EntityInfo.USR = nullptr;
     } else {
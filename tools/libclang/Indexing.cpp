@@ -16,6 +16,7 @@
 #include "CXString.h"
 #include "CXTranslationUnit.h"
 #include "clang/AST/ASTConsumer.h"
+#include "clang/Basic/VirtualFileSystem.h"
 #include "clang/Frontend/ASTUnit.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/CompilerInvocation.h"
@@ -29,8 +30,11 @@
 #include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/ThreadPool.h"
 #include <cstdio>
 #include <utility>
 
@@ -218,6 +222,280 @@ private:
   }
 };
 
+//===----------------------------------------------------------------------===//
+// Skip Indexed Headers
+//===----------------------------------------------------------------------===//
+
+/// \brief A header file as seen in a particular macro context.
+///
+/// The macro context is approximated by the predefines of the translation
+/// unit, which capture the -D/-U options and the language mode. Only headers
+/// with include guards or '#pragma once' are tracked, since their symbols
+/// generally don't depend on the point of inclusion.
+class IndexedHeader {
+  llvm::sys::fs::UniqueID UniqueID;
+  time_t ModTime;
+  unsigned MacroContext;
+
+public:
+  IndexedHeader() : UniqueID(0, 0), ModTime(), MacroContext() {}
+  IndexedHeader(llvm::sys::fs::UniqueID UniqueID, time_t modTime,
+                unsigned macroContext)
+    : UniqueID(UniqueID), ModTime(modTime), MacroContext(macroContext) {}
+
+  const llvm::sys::fs::UniqueID &getUniqueID() const { return UniqueID; }
+  time_t getModTime() const { return ModTime; }
+  unsigned getMacroContext() const { return MacroContext; }
+
+  friend bool operator==(const IndexedHeader &lhs, const IndexedHeader &rhs) {
+    return lhs.UniqueID == rhs.UniqueID && lhs.ModTime == rhs.ModTime &&
+           lhs.MacroContext == rhs.MacroContext;
+  }
+};
+
+} // end anonymous namespace
+
+namespace llvm {
+  template <> struct isPodLike<IndexedHeader> {
+    static const bool value = true;
+  };
+
+  template <>
+  struct DenseMapInfo<IndexedHeader> {
+    static inline IndexedHeader getEmptyKey() {
+      return IndexedHeader(llvm::sys::fs::UniqueID(0, 0), 0, unsigned(-1));
+    }
+    static inline IndexedHeader getTombstoneKey() {
+      return IndexedHeader(llvm::sys::fs::UniqueID(0, 0), 0, unsigned(-2));
+    }
+
+    static unsigned getHashValue(const IndexedHeader &S) {
+      llvm::FoldingSetNodeID ID;
+      const llvm::sys::fs::UniqueID &UniqueID = S.getUniqueID();
+      ID.AddInteger(UniqueID.getFile());
+      ID.AddInteger(UniqueID.getDevice());
+      ID.AddInteger(S.getModTime());
+      ID.AddInteger(S.getMacroContext());
+      return ID.ComputeHash();
+    }
+
+    static bool isEqual(const IndexedHeader &LHS, const IndexedHeader &RHS) {
+      return LHS == RHS;
+    }
+  };
+}
+
+namespace {
+
+/// \brief The headers whose symbols were already reported during an indexing
+/// session. Shared by the translation units indexed in the session, possibly
+/// concurrently.
+class SessionIndexedHeaders {
+  llvm::sys::Mutex Mux;
+  llvm::DenseSet<IndexedHeader> Headers;
+
+public:
+  SessionIndexedHeaders() : Mux(/*recursive=*/false) {}
+
+  /// \brief Claim the given header for the calling translation unit.
+  ///
+  /// \returns true if no other translation unit claimed it before.
+  bool claim(const IndexedHeader &Header) {
+    llvm::MutexGuard MG(Mux);
+    return Headers.insert(Header).second;
+  }
+};
+
+/// \brief Decides which headers of a translation unit another translation unit
+/// of the session already reported.
+///
+/// A header can only be skipped if it is guarded against multiple inclusion,
+/// which the preprocessor knows once it reaches the end of the header. The
+/// header is therefore claimed when it is exited.
+class TUSkipHeaderControl {
+  SessionIndexedHeaders &SessionData;
+  Preprocessor *PP;
+  unsigned MacroContext;
+
+  /// \brief Whether the symbols in each exited file are reported by another
+  /// translation unit.
+  llvm::DenseMap<FileID, bool> SkippedFiles;
+
+public:
+  explicit TUSkipHeaderControl(SessionIndexedHeaders &sessionData)
+    : SessionData(sessionData), PP(nullptr), MacroContext(0) {}
+
+  void setPreprocessor(Preprocessor &pp) {
+    PP = &pp;
+    MacroContext = llvm::HashString(pp.getPredefines());
+  }
+
+  /// \brief Claims the file that the preprocessor just left, if it is a
+  /// header guarded against multiple inclusion.
+  void fileExited(FileID FID) {
+    if (!PP || SkippedFiles.count(FID))
+      return;
+
+    bool Skipped = false;
+    const SourceManager &SM = PP->getSourceManager();
+    if (FID != SM.getMainFileID()) {
+      const FileEntry *FE = SM.getFileEntryForID(FID);
+      if (FE && PP->getHeaderSearchInfo().isFileMultipleIncludeGuarded(FE))
+        Skipped = !SessionData.claim(IndexedHeader(FE->getUniqueID(),
+                                                   FE->getModificationTime(),
+                                                   MacroContext));
+    }
+    SkippedFiles[FID] = Skipped;
+  }
+
+  /// \brief Returns whether the symbols in the given file are reported by
+  /// another translation unit, or None if this is not known until the
+  /// preprocessor leaves the file.
+  Optional<bool> isIndexedElsewhere(FileID FID) const {
+    if (!PP)
+      return false;
+
+    auto Known = SkippedFiles.find(FID);
+    if (Known != SkippedFiles.end())
+      return Known->second;
+
+    const SourceManager &SM = PP->getSourceManager();
+    if (FID == SM.getMainFileID() || !SM.getFileEntryForID(FID))
+      return false;
+    return None;
+  }
+};
+
+/// \brief Tells a TUSkipHeaderControl when the preprocessor leaves a file.
+class SkipHeaderPPCallbacks : public PPCallbacks {
+  TUSkipHeaderControl &SHCtrl;
+
+public:
+  explicit SkipHeaderPPCallbacks(TUSkipHeaderControl &shCtrl)
+    : SHCtrl(shCtrl) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                 SrcMgr::CharacteristicKind FileType, FileID PrevFID) override {
+    if (Reason == PPCallbacks::ExitFile && PrevFID.isValid())
+      SHCtrl.fileExited(PrevFID);
+  }
+};
+
+/// \brief Filters out the occurrences in headers whose symbols were already
+/// reported by another translation unit of the session.
+///
+/// The occurrences in a header that is still being parsed are held back until
+/// the header is claimed, and are then reported before the next occurrence.
+class SkipIndexedHeadersDataConsumer : public IndexDataConsumer {
+  /// \brief A declaration or macro occurrence that was held back.
+  struct PendingOccurrence {
+    const Decl *D;
+    const IdentifierInfo *MacroName;
+    const MacroInfo *MI;
+    SymbolRoleSet Roles;
+    SmallVector<SymbolRelation, 2> Relations;
+    unsigned Offset;
+    ASTNodeInfo ASTNode;
+  };
+
+  std::shared_ptr<CXIndexDataConsumer> DataConsumer;
+  TUSkipHeaderControl SHCtrl;
+  llvm::MapVector<FileID, std::vector<PendingOccurrence>> Pending;
+
+  IndexDataConsumer &getDataConsumer() { return *DataConsumer; }
+
+  bool report(const PendingOccurrence &Occ, FileID FID) {
+    if (Occ.D)
+      return getDataConsumer().handleDeclOccurence(
+          Occ.D, Occ.Roles, Occ.Relations, FID, Occ.Offset, Occ.ASTNode);
+    return getDataConsumer().handleMacroOccurence(Occ.MacroName, Occ.MI,
+                                                  Occ.Roles, FID, Occ.Offset);
+  }
+
+  /// \brief Reports or drops the occurrences held back for the headers that
+  /// were claimed since, or for all of them if \p All is true.
+  ///
+  /// \returns false if indexing should stop.
+  bool flushPending(bool All = false) {
+    bool Continue = true;
+    Pending.remove_if(
+        [&](const std::pair<FileID, std::vector<PendingOccurrence>> &Entry) {
+          Optional<bool> Skipped = SHCtrl.isIndexedElsewhere(Entry.first);
+          if (!Skipped && !All)
+            return false;
+          if (!Skipped || !*Skipped)
+            for (const PendingOccurrence &Occ : Entry.second)
+              if (Continue)
+                Continue = report(Occ, Entry.first);
+          return true;
+        });
+    return Continue;
+  }
+
+public:
+  SkipIndexedHeadersDataConsumer(
+      std::shared_ptr<CXIndexDataConsumer> dataConsumer,
+      SessionIndexedHeaders &sessionData)
+    : DataConsumer(std::move(dataConsumer)), SHCtrl(sessionData) {}
+
+  TUSkipHeaderControl &getSkipHeaderControl() { return SHCtrl; }
+
+  void initialize(ASTContext &Ctx) override {
+    getDataConsumer().initialize(Ctx);
+  }
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           FileID FID, unsigned Offset,
+                           ASTNodeInfo ASTNode) override {
+    if (!Pending.empty() && !flushPending())
+      return false;
+
+    Optional<bool> Skipped = SHCtrl.isIndexedElsewhere(FID);
+    if (!Skipped) {
+      Pending[FID].push_back({D, nullptr, nullptr, Roles,
+                              SmallVector<SymbolRelation, 2>(
+                                  Relations.begin(), Relations.end()),
+                              Offset, ASTNode});
+      return true;
+    }
+    if (*Skipped)
+      return true;
+    return getDataConsumer().handleDeclOccurence(D, Roles, Relations, FID,
+                                                 Offset, ASTNode);
+  }
+
+  bool handleMacroOccurence(const IdentifierInfo *Name, const MacroInfo *MI,
+                            SymbolRoleSet Roles, FileID FID,
+                            unsigned Offset) override {
+    if (!Pending.empty() && !flushPending())
+      return false;
+
+    Optional<bool> Skipped = SHCtrl.isIndexedElsewhere(FID);
+    if (!Skipped) {
+      Pending[FID].push_back({nullptr, Name, MI, Roles, {}, Offset, {}});
+      return true;
+    }
+    if (*Skipped)
+      return true;
+    return getDataConsumer().handleMacroOccurence(Name, MI, Roles, FID,
+                                                  Offset);
+  }
+
+  bool handleModuleOccurence(const ImportDecl *ImportD, SymbolRoleSet Roles,
+                             FileID FID, unsigned Offset) override {
+    if (!Pending.empty() && !flushPending())
+      return false;
+    return getDataConsumer().handleModuleOccurence(ImportD, Roles, FID,
+                                                   Offset);
+  }
+
+  void finish() override {
+    flushPending(/*All=*/true);
+    getDataConsumer().finish();
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // IndexPPCallbacks
 //===----------------------------------------------------------------------===//
@@ -355,10 +633,14 @@ class IndexingFrontendAction : public ASTFrontendAction {
   SessionSkipBodyData *SKData;
   std::unique_ptr<TUSkipBodyControl> SKCtrl;
 
+  TUSkipHeaderControl *SHCtrl;
+
 public:
   IndexingFrontendAction(std::shared_ptr<CXIndexDataConsumer> dataConsumer,
-                         SessionSkipBodyData *skData)
-      : DataConsumer(std::move(dataConsumer)), SKData(skData) {}
+                         SessionSkipBodyData *skData,
+                         TUSkipHeaderControl *shCtrl)
+      : DataConsumer(std::move(dataConsumer)), SKData(skData),
+        SHCtrl(shCtrl) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override {
@@ -380,6 +662,11 @@ public:
       SKCtrl = llvm::make_unique<TUSkipBodyControl>(*SKData, *PPRec, PP);
     }
 
+    if (SHCtrl) {
+      SHCtrl->setPreprocessor(PP);
+      PP.addPPCallbacks(llvm::make_unique<SkipHeaderPPCallbacks>(*SHCtrl));
+    }
+
     return llvm::make_unique<IndexingConsumer>(*DataConsumer, SKCtrl.get());
   }
 
@@ -406,9 +693,11 @@ static IndexingOptions getIndexingOptionsFromCXOptions(unsigned index_options) {
 struct IndexSessionData {
   CXIndex CIdx;
   std::unique_ptr<SessionSkipBodyData> SkipBodyData;
+  std::unique_ptr<SessionIndexedHeaders> IndexedHeaders;
 
   explicit IndexSessionData(CXIndex cIdx)
-    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
+    : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData),
+      IndexedHeaders(new SessionIndexedHeaders) {}
 };
 
 } // anonymous namespace
@@ -419,7 +708,7 @@ static CXErrorCode clang_indexSourceFile_Impl(
     unsigned index_options, const char *source_filename,
     const char *const *command_line_args, int num_command_line_args,
     ArrayRef<CXUnsavedFile> unsaved_files, CXTranslationUnit *out_TU,
-    unsigned TU_options) {
+    unsigned TU_options, IntrusiveRefCntPtr<vfs::FileSystem> BaseFS = nullptr) {
   if (out_TU)
     *out_TU = nullptr;
   bool requestedToGetTU = (out_TU != nullptr);
@@ -521,8 +810,11 @@ static CXErrorCode clang_indexSourceFile_Impl(
   CInvok->getHeaderSearchOpts().ModuleFormat =
     CXXIdx->getPCHContainerOperations()->getRawReader().getFormat();
 
+  // A base file system is shared by a batch of translation units, whose files
+  // do not change while it runs; volatile reads would bypass its cache.
+  bool UserFilesAreVolatile = !BaseFS;
   auto Unit = ASTUnit::create(CInvok, Diags, CaptureDiagnostics,
-                              /*UserFilesAreVolatile=*/true);
+                              UserFilesAreVolatile, BaseFS);
   if (!Unit)
     return CXError_InvalidArguments;
 
@@ -544,10 +836,23 @@ static CXErrorCode clang_indexSourceFile_Impl(
   auto DataConsumer =
     std::make_shared<CXIndexDataConsumer>(client_data, CB, index_options,
                                           CXTU->getTU());
+
+  // Report the symbols of each header once per session, by filtering out the
+  // occurrences in headers that another translation unit already claimed.
+  std::shared_ptr<IndexDataConsumer> IndexConsumer = DataConsumer;
+  TUSkipHeaderControl *SHCtrl = nullptr;
+  if (index_options & CXIndexOpt_SkipIndexedHeadersInSession) {
+    auto SkipConsumer = std::make_shared<SkipIndexedHeadersDataConsumer>(
+        DataConsumer, *IdxSession->IndexedHeaders);
+    SHCtrl = &SkipConsumer->getSkipHeaderControl();
+    IndexConsumer = std::move(SkipConsumer);
+  }
+
   auto InterAction = llvm::make_unique<IndexingFrontendAction>(DataConsumer,
-                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr);
+                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr,
+                         SHCtrl);
   std::unique_ptr<FrontendAction> IndexAction;
-  IndexAction = createIndexingAction(DataConsumer,
+  IndexAction = createIndexingAction(IndexConsumer,
                                 getIndexingOptionsFromCXOptions(index_options),
                                      std::move(InterAction));
 
@@ -949,6 +1254,117 @@ int clang_indexTranslationUnit(CXIndexAction idxAction,
   return result;
 }
 
+int clang_indexCompileCommands(CXIndexAction idxAction,
+                               CXClientData client_data,
+                               IndexerCallbacks *index_callbacks,
+                               unsigned index_callbacks_size,
+                               unsigned index_options,
+                               CXCompileCommands commands,
+                               unsigned num_threads) {
+  if (!commands)
+    return CXError_InvalidArguments;
+
+  // Copy the command lines up front; the jobs only see plain strings.
+  unsigned NumCommands = clang_CompileCommands_getSize(commands);
+  std::vector<std::vector<std::string>> CommandLines(NumCommands);
+  for (unsigned I = 0; I != NumCommands; ++I) {
+    CXCompileCommand Cmd = clang_CompileCommands_getCommand(commands, I);
+    std::vector<std::string> &CommandLine = CommandLines[I];
+    for (unsigned A = 0, N = clang_CompileCommand_getNumArgs(Cmd); A != N;
+         ++A) {
+      CXString Arg = clang_CompileCommand_getArg(Cmd, A);
+      CommandLine.push_back(clang_getCString(Arg));
+      clang_disposeString(Arg);
+
+      // Resolve relative paths against the directory of the command, without
+      // changing the working directory of the process.
+      if (A == 0) {
+        CXString Dir = clang_CompileCommand_getDirectory(Cmd);
+        if (*clang_getCString(Dir)) {
+          CommandLine.push_back("-working-directory");
+          CommandLine.push_back(clang_getCString(Dir));
+        }
+        clang_disposeString(Dir);
+      }
+    }
+  }
+
+  LOG_FUNC_SECTION {
+    *Log << NumCommands << " commands, " << num_threads << " threads";
+  }
+
+  // The translation units share most of their headers; stat and read each
+  // file once for all of them.
+  IntrusiveRefCntPtr<vfs::CachingFileSystem> FS(
+      new vfs::CachingFileSystem(vfs::getRealFileSystem()));
+
+  std::vector<CXErrorCode> Results(NumCommands, CXError_Failure);
+  auto IndexCommand = [&](unsigned I) {
+    const std::vector<std::string> &CommandLine = CommandLines[I];
+    if (CommandLine.empty()) {
+      Results[I] = CXError_InvalidArguments;
+      return;
+    }
+
+    SmallVector<const char *, 32> Args;
+    for (const std::string &Arg : CommandLine)
+      Args.push_back(Arg.c_str());
+
+    auto IndexSourceFileImpl = [&]() {
+      Results[I] = clang_indexSourceFile_Impl(
+          idxAction, client_data, index_callbacks, index_callbacks_size,
+          index_options, /*source_filename=*/nullptr, Args.data(),
+          Args.size(), None, /*out_TU=*/nullptr,
+          CXTranslationUnit_None, FS);
+    };
+
+    if (getenv("LIBCLANG_NOTHREADS")) {
+      IndexSourceFileImpl();
+      return;
+    }
+
+    llvm::CrashRecoveryContext CRC;
+    if (!RunSafely(CRC, IndexSourceFileImpl)) {
+      fprintf(stderr, "libclang: crash detected during indexing source file: "
+                      "{\n");
+      fprintf(stderr, "  'command_line_args' : [");
+      for (unsigned A = 0, N = Args.size(); A != N; ++A) {
+        if (A)
+          fprintf(stderr, ", ");
+        fprintf(stderr, "'%s'", Args[A]);
+      }
+      fprintf(stderr, "],\n");
+      fprintf(stderr, "}\n");
+      Results[I] = CXError_Crashed;
+    }
+  };
+
+  if (num_threads == 1 || NumCommands <= 1 || getenv("LIBCLANG_NOTHREADS")) {
+    for (unsigned I = 0; I != NumCommands; ++I)
+      IndexCommand(I);
+  } else {
+    std::unique_ptr<llvm::ThreadPool> Pool(
+        num_threads ? new llvm::ThreadPool(num_threads) : new llvm::ThreadPool);
+    for (unsigned I = 0; I != NumCommands; ++I)
+      Pool->async(IndexCommand, I);
+    Pool->wait();
+  }
+
+  LOG_FUNC_SECTION {
+    vfs::CachingFileSystem::Statistics Stats = FS->getStatistics();
+    *Log << "file cache: " << (unsigned long)Stats.StatusHits
+         << " status hits, " << (unsigned long)Stats.StatusMisses
+         << " misses; " << (unsigned long)Stats.ContentsHits
+         << " contents hits, " << (unsigned long)Stats.ContentsMisses
+         << " misses";
+  }
+
+  for (CXErrorCode Result : Results)
+    if (Result != CXError_Success)
+      return Result;
+  return CXError_Success;
+}
+
 void clang_indexLoc_getFileLocation(CXIdxLoc location,
                                     CXIdxClientFile *indexFile,
                                     CXFile *file,
@@ -0,0 +1,139 @@
+//===- unittests/Analysis/BitVectorDataflowTest.cpp -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/Analyses/BitVectorDataflow.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Analysis/Analyses/LiveVariables.h"
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "clang/Analysis/AnalysisContext.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+#include <string>
+
+namespace clang {
+namespace analysis {
+namespace {
+
+using namespace ast_matchers;
+
+class BitVectorDataflowTest : public ::testing::Test {
+protected:
+  std::unique_ptr<ASTUnit> AST;
+  AnalysisDeclContextManager ADCM;
+  const FunctionDecl *Func = nullptr;
+  AnalysisDeclContext *AC = nullptr;
+
+  void buildCFG(StringRef Code) {
+    AST = tooling::buildASTFromCode(Code);
+    ASSERT_TRUE(AST);
+    Func = selectFirst<FunctionDecl>(
+        "f", match(functionDecl(hasName("f"), isDefinition()).bind("f"),
+                   AST->getASTContext()));
+    ASSERT_TRUE(Func);
+    AC = ADCM.getContext(Func);
+    ASSERT_TRUE(AC->getCFG());
+  }
+
+  /// Find the block that contains the given kind of statement.
+  const CFGBlock *findBlock(Stmt::StmtClass Class) {
+    for (const CFGBlock *B : *AC->getCFG())
+      for (const CFGElement &E : *B)
+        if (Optional<CFGStmt> S = E.getAs<CFGStmt>())
+          if (S->getStmt()->getStmtClass() == Class)
+            return B;
+    return nullptr;
+  }
+};
+
+// A fact generated in a loop reaches the exit along some path, but not along
+// all paths.
+TEST_F(BitVectorDataflowTest, ForwardLoop) {
+  buildCFG("void f(int n) { while (n) { n--; } }");
+  const CFG &Cfg = *AC->getCFG();
+  const CFGBlock *Body = findBlock(Stmt::UnaryOperatorClass);
+  ASSERT_TRUE(Body);
+
+  BitVectorDataflow MayReach(Cfg, *AC->getAnalysis<PostOrderCFGView>(),
+                             DataflowWorklist::Forward,
+                             BitVectorDataflow::Union);
+  MayReach.setNumBits(2);
+  MayReach.getGen(Body).set(0);
+  MayReach.getGen(&Cfg.getEntry()).set(1);
+  MayReach.getKill(Body).set(1);
+  MayReach.solve(llvm::BitVector(2));
+  EXPECT_TRUE(MayReach.getIn(&Cfg.getExit()).test(0));
+  EXPECT_TRUE(MayReach.getIn(&Cfg.getExit()).test(1));
+  // The fact reaches the start of the loop body along the back edge.
+  EXPECT_TRUE(MayReach.getIn(Body).test(0));
+  EXPECT_FALSE(MayReach.getOut(Body).test(1));
+
+  BitVectorDataflow MustReach(Cfg, *AC->getAnalysis<PostOrderCFGView>(),
+                              DataflowWorklist::Forward,
+                              BitVectorDataflow::Intersection);
+  MustReach.setNumBits(2);
+  MustReach.getGen(Body).set(0);
+  MustReach.getGen(&Cfg.getEntry()).set(1);
+  MustReach.getKill(Body).set(1);
+  MustReach.solve(llvm::BitVector(2));
+  EXPECT_FALSE(MustReach.getIn(&Cfg.getExit()).test(0));
+  EXPECT_FALSE(MustReach.getIn(&Cfg.getExit()).test(1));
+  EXPECT_TRUE(MustReach.getOut(Body).test(0));
+}
+
+TEST_F(BitVectorDataflowTest, BackwardLoop) {
+  buildCFG("void f(int n) { while (n) { n--; } }");
+  const CFG &Cfg = *AC->getCFG();
+  const CFGBlock *Body = findBlock(Stmt::UnaryOperatorClass);
+  ASSERT_TRUE(Body);
+
+  BitVectorDataflow Live(Cfg, *AC->getAnalysis<PostOrderCFGView>(),
+                         DataflowWorklist::Backward, BitVectorDataflow::Union);
+  Live.setNumBits(1);
+  Live.getGen(Body).set(0);
+  Live.solve(llvm::BitVector(1));
+  EXPECT_TRUE(Live.getOut(&Cfg.getEntry()).test(0));
+  // The loop body flows back into itself.
+  EXPECT_TRUE(Live.getIn(Body).test(0));
+  EXPECT_FALSE(Live.getIn(&Cfg.getExit()).test(0));
+}
+
+TEST_F(BitVectorDataflowTest, LiveVariablesAcrossLoop) {
+  buildCFG("int g(int);\n"
+           "int f(int n) {\n"
+           "  int a = 0, b = 1;\n"
+           "  while (n--)\n"
+           "    a = g(a);\n"
+           "  return b;\n"
+           "}\n");
+  const CFGBlock *Body = findBlock(Stmt::CallExprClass);
+  ASSERT_TRUE(Body);
+  auto *LV = AC->getAnalysis<LiveVariables>();
+  ASSERT_TRUE(LV);
+
+  const VarDecl *A = nullptr, *B = nullptr;
+  for (const Decl *D : Func->decls()) {
+    if (const auto *VD = dyn_cast<VarDecl>(D)) {
+      if (VD->getName() == "a")
+        A = VD;
+      else if (VD->getName() == "b")
+        B = VD;
+    }
+  }
+  ASSERT_TRUE(A && B);
+  // 'a' is used in the next iteration, and 'b' after the loop.
+  EXPECT_TRUE(LV->isLive(Body, A));
+  EXPECT_TRUE(LV->isLive(Body, B));
+}
+
+} // end anonymous namespace
+} // end namespace analysis
+} // end namespace clang
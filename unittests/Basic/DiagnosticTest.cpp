@@ -72,4 +72,43 @@ TEST(DiagnosticTest, suppressAfterFatalError) {
   }
 }
 
+// Check that isIgnored follows the changes to mappings and flags that decide
+// whether a diagnostic is ignored everywhere.
+TEST(DiagnosticTest, isIgnoredAfterMappingChanges) {
+  DiagnosticsEngine Diags(new DiagnosticIDs(),
+                          new DiagnosticOptions,
+                          new IgnoringDiagConsumer());
+  const unsigned Off = diag::warn_method_param_declaration;
+  const unsigned On = diag::warn_method_param_redefinition;
+  const unsigned Ext = diag::ext_c99_longlong;
+
+  EXPECT_TRUE(Diags.isIgnored(Off, SourceLocation()));
+  EXPECT_FALSE(Diags.isIgnored(On, SourceLocation()));
+  EXPECT_TRUE(Diags.isIgnored(Ext, SourceLocation()));
+
+  Diags.setSeverity(Off, diag::Severity::Warning, SourceLocation());
+  EXPECT_FALSE(Diags.isIgnored(Off, SourceLocation()));
+
+  Diags.setIgnoreAllWarnings(true);
+  EXPECT_TRUE(Diags.isIgnored(Off, SourceLocation()));
+  EXPECT_TRUE(Diags.isIgnored(On, SourceLocation()));
+  Diags.setIgnoreAllWarnings(false);
+  EXPECT_FALSE(Diags.isIgnored(On, SourceLocation()));
+
+  // -Weverything does not override an explicit mapping.
+  Diags.setSeverity(Off, diag::Severity::Ignored, SourceLocation());
+  Diags.setEnableAllWarnings(true);
+  EXPECT_TRUE(Diags.isIgnored(Off, SourceLocation()));
+  EXPECT_FALSE(Diags.isIgnored(diag::warn_cxx98_compat_variadic_templates,
+                               SourceLocation()));
+  Diags.setEnableAllWarnings(false);
+
+  Diags.setExtensionHandlingBehavior(diag::Severity::Warning);
+  EXPECT_FALSE(Diags.isIgnored(Ext, SourceLocation()));
+
+  Diags.Reset();
+  EXPECT_TRUE(Diags.isIgnored(Ext, SourceLocation()));
+  EXPECT_TRUE(Diags.isIgnored(Off, SourceLocation()));
+}
+
 }
@@ -0,0 +1,63 @@
+//===- unittests/Basic/TimeTraceTest.cpp - Time trace tests ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+std::string writeTrace() {
+  std::string Trace;
+  llvm::raw_string_ostream OS(Trace);
+  timeTraceProfilerWrite(OS);
+  return OS.str();
+}
+
+TEST(TimeTraceTest, disabledByDefault) {
+  EXPECT_FALSE(timeTraceProfilerEnabled());
+  // Scopes do nothing when no profiler is running.
+  TimeTraceScope Scope("Unrecorded");
+}
+
+TEST(TimeTraceTest, writesNestedEvents) {
+  timeTraceProfilerInitialize(/*GranularityInMicroseconds=*/0);
+  ASSERT_TRUE(timeTraceProfilerEnabled());
+  {
+    TimeTraceScope Outer("Outer", StringRef("a \"quoted\"\tdetail"));
+    TimeTraceScope Inner("Inner", [] { return std::string("computed"); });
+  }
+  std::string Trace = writeTrace();
+  timeTraceProfilerCleanup();
+  EXPECT_FALSE(timeTraceProfilerEnabled());
+
+  EXPECT_EQ(0u, Trace.find("{\"traceEvents\":["));
+  // Events are written in the order in which they end.
+  size_t Inner = Trace.find("\"name\":\"Inner\",\"args\":{\"detail\":"
+                            "\"computed\"}");
+  size_t Outer = Trace.find("\"name\":\"Outer\",\"args\":{\"detail\":"
+                            "\"a \\\"quoted\\\"\\tdetail\"}");
+  ASSERT_NE(std::string::npos, Inner);
+  ASSERT_NE(std::string::npos, Outer);
+  EXPECT_LT(Inner, Outer);
+  EXPECT_NE(std::string::npos, Trace.find("\"ph\":\"X\""));
+}
+
+TEST(TimeTraceTest, dropsShortEvents) {
+  // No event in this test takes anywhere near an hour.
+  timeTraceProfilerInitialize(/*GranularityInMicroseconds=*/3600000000u);
+  { TimeTraceScope Scope("Short"); }
+  std::string Trace = writeTrace();
+  timeTraceProfilerCleanup();
+  EXPECT_EQ(std::string::npos, Trace.find("Short"));
+}
+
+} // end anonymous namespace
@@ -9,12 +9,15 @@
 
 #include "clang/Basic/VirtualFileSystem.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "gtest/gtest.h"
+#include <atomic>
 #include <map>
+#include <thread>
 
 using namespace clang;
 using namespace llvm;
@@ -760,6 +763,156 @@ TEST_F(InMemoryFileSystemTest, WorkingDirectory) {
                       NormalizedFS.getCurrentWorkingDirectory().get()));
 }
 
+/// Counts the lookups that reach the file system it wraps.
+class CountingFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> FS;
+
+public:
+  std::atomic<unsigned> NumStats{0};
+  std::atomic<unsigned> NumOpens{0};
+
+  explicit CountingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : FS(FS) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    ++NumStats;
+    return FS->status(Path);
+  }
+  ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    ++NumOpens;
+    return FS->openFileForRead(Path);
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return FS->dir_begin(Dir, EC);
+  }
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return FS->getCurrentWorkingDirectory();
+  }
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    return FS->setCurrentWorkingDirectory(Path);
+  }
+};
+
+class CachingFileSystemTest : public ::testing::Test {
+protected:
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Mem;
+  IntrusiveRefCntPtr<CountingFileSystem> Counting;
+  IntrusiveRefCntPtr<vfs::CachingFileSystem> FS;
+
+  CachingFileSystemTest() : Mem(new vfs::InMemoryFileSystem) {
+    Mem->setCurrentWorkingDirectory("/");
+    Counting = new CountingFileSystem(Mem);
+    FS = new vfs::CachingFileSystem(Counting);
+  }
+
+  std::string read(const Twine &Path, bool IsVolatile = false) {
+    auto F = FS->openFileForRead(Path);
+    if (!F)
+      return "<error>";
+    auto Buffer = (*F)->getBuffer(Path, -1, true, IsVolatile);
+    if (!Buffer)
+      return "<error>";
+    return (*Buffer)->getBuffer();
+  }
+};
+
+TEST_F(CachingFileSystemTest, Status) {
+  Mem->addFile("/a/b.h", 0, MemoryBuffer::getMemBuffer("b"));
+
+  auto Stat = FS->status("/a/b.h");
+  ASSERT_FALSE(Stat.getError());
+  EXPECT_TRUE(Stat->isRegularFile());
+  EXPECT_EQ(1u, Counting->NumStats);
+
+  // Relative and unnormalized paths share the entry, but keep their names.
+  Stat = FS->status("a/./b.h");
+  ASSERT_FALSE(Stat.getError());
+  EXPECT_EQ("a/./b.h", Stat->getName());
+  EXPECT_EQ(1u, Counting->NumStats);
+
+  // Failed lookups are cached too.
+  EXPECT_EQ(llvm::errc::no_such_file_or_directory,
+            FS->status("/a/c.h").getError());
+  EXPECT_EQ(llvm::errc::no_such_file_or_directory,
+            FS->openFileForRead("/a/c.h").getError());
+  EXPECT_EQ(2u, Counting->NumStats);
+  EXPECT_EQ(0u, Counting->NumOpens);
+
+  vfs::CachingFileSystem::Statistics Stats = FS->getStatistics();
+  EXPECT_EQ(2u, Stats.StatusHits);
+  EXPECT_EQ(2u, Stats.StatusMisses);
+}
+
+TEST_F(CachingFileSystemTest, Contents) {
+  Mem->addFile("/a.h", 0, MemoryBuffer::getMemBuffer("contents"));
+
+  EXPECT_EQ("contents", read("/a.h"));
+  EXPECT_EQ(1u, Counting->NumOpens);
+
+  // Once the contents are cached, the file isn't opened again.
+  auto F = FS->openFileForRead("a.h");
+  ASSERT_FALSE(F.getError());
+  EXPECT_EQ(1u, Counting->NumOpens);
+  auto Stat = (*F)->status();
+  ASSERT_FALSE(Stat.getError());
+  EXPECT_EQ("a.h", Stat->getName());
+  auto Buffer = (*F)->getBuffer("a.h");
+  ASSERT_FALSE(Buffer.getError());
+  EXPECT_EQ("contents", (*Buffer)->getBuffer());
+  EXPECT_EQ("a.h", (*Buffer)->getBufferIdentifier());
+
+  vfs::CachingFileSystem::Statistics Stats = FS->getStatistics();
+  EXPECT_EQ(1u, Stats.ContentsHits);
+  EXPECT_EQ(1u, Stats.ContentsMisses);
+
+  // The buffers handed out outlive the cache.
+  F = std::error_code();
+  FS = nullptr;
+  EXPECT_EQ("contents", (*Buffer)->getBuffer());
+}
+
+TEST_F(CachingFileSystemTest, VolatileReads) {
+  Mem->addFile("/a.h", 0, MemoryBuffer::getMemBuffer("contents"));
+
+  EXPECT_EQ("contents", read("/a.h", /*IsVolatile=*/true));
+  EXPECT_EQ("contents", read("/a.h", /*IsVolatile=*/true));
+  EXPECT_EQ(2u, Counting->NumOpens);
+
+  vfs::CachingFileSystem::Statistics Stats = FS->getStatistics();
+  EXPECT_EQ(0u, Stats.ContentsHits + Stats.ContentsMisses);
+}
+
+#if LLVM_ENABLE_THREADS
+TEST_F(CachingFileSystemTest, ConcurrentLookups) {
+  const unsigned NumFiles = 16, NumThreads = 8;
+  for (unsigned I = 0; I != NumFiles; ++I)
+    Mem->addFile("/" + Twine(I) + ".h", 0,
+                 MemoryBuffer::getMemBuffer(Twine(I).str()));
+
+  std::atomic<unsigned> NumMismatches{0};
+  std::vector<std::thread> Threads;
+  for (unsigned T = 0; T != NumThreads; ++T)
+    Threads.emplace_back([&] {
+      for (unsigned Round = 0; Round != 4; ++Round)
+        for (unsigned I = 0; I != NumFiles; ++I) {
+          std::string Path = "/" + std::to_string(I) + ".h";
+          if (!FS->status(Path) || read(Path) != std::to_string(I))
+            ++NumMismatches;
+        }
+    });
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  EXPECT_EQ(0u, NumMismatches);
+  vfs::CachingFileSystem::Statistics Stats = FS->getStatistics();
+  EXPECT_EQ(NumThreads * 4 * NumFiles * 2,
+            Stats.StatusHits + Stats.StatusMisses);
+  EXPECT_LE(Counting->NumStats + Counting->NumOpens, NumThreads * NumFiles * 2);
+}
+#endif
+
 // NOTE: in the tests below, we use '//root/' as our root directory, since it is
 // a legal *absolute* path on Windows as well as *nix.
 class VFSFromYAMLTest : public ::testing::Test {
@@ -1270,3 +1423,183 @@ TEST_F(VFSFromYAMLTest, RecursiveDirectoryIterationLevel) {
   }
   EXPECT_EQ(I, E);
 }
+
+class VFSFromBinaryOverlayTest : public VFSFromYAMLTest {
+public:
+  /// Compile the YAML to a binary overlay and read that.
+  IntrusiveRefCntPtr<vfs::FileSystem> getFromBinaryString(
+      StringRef Content,
+      IntrusiveRefCntPtr<vfs::FileSystem> ExternalFS = new DummyFileSystem()) {
+    std::string YAML("{\n  'version':0,\n");
+    YAML += Content.slice(Content.find('{') + 1, StringRef::npos);
+    std::string Binary;
+    raw_string_ostream OS(Binary);
+    if (!vfs::writeBinaryVFSOverlay(MemoryBuffer::getMemBuffer(YAML),
+                                    CountingDiagHandler, "", OS, this))
+      return nullptr;
+    std::unique_ptr<MemoryBuffer> Buffer =
+        MemoryBuffer::getMemBufferCopy(OS.str());
+    EXPECT_TRUE(vfs::isBinaryVFSOverlay(*Buffer));
+    return vfs::getVFSFromBinaryOverlay(std::move(Buffer), "", ExternalFS);
+  }
+};
+
+TEST_F(VFSFromBinaryOverlayTest, InvalidOverlay) {
+  EXPECT_EQ(nullptr, getFromBinaryString("[]").get());
+  EXPECT_EQ(1, NumDiagnostics);
+
+  EXPECT_FALSE(vfs::isBinaryVFSOverlay(*MemoryBuffer::getMemBuffer("{}")));
+  EXPECT_EQ(nullptr, vfs::getVFSFromBinaryOverlay(
+                         MemoryBuffer::getMemBuffer("VFSB"), "").get());
+}
+
+TEST_F(VFSFromBinaryOverlayTest, MappedFiles) {
+  IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
+  Lower->addRegularFile("//root/foo/bar/a");
+  IntrusiveRefCntPtr<vfs::FileSystem> FS =
+      getFromBinaryString("{ 'roots': [\n"
+                          "{\n"
+                          "  'type': 'directory',\n"
+                          "  'name': '//root/',\n"
+                          "  'contents': [ {\n"
+                          "                  'type': 'file',\n"
+                          "                  'name': 'file1',\n"
+                          "                  'external-contents': '//root/foo/bar/a'\n"
+                          "                },\n"
+                          "                {\n"
+                          "                  'type': 'file',\n"
+                          "                  'name': 'file2',\n"
+                          "                  'external-contents': '//root/foo/b'\n"
+                          "                },\n"
+                          "                {\n"
+                          "                  'type': 'file',\n"
+                          "                  'name': 'dir/file3',\n"
+                          "                  'use-external-name': false,\n"
+                          "                  'external-contents': '//root/foo/bar/a'\n"
+                          "                }\n"
+                          "              ]\n"
+                          "}\n"
+                          "]\n"
+                          "}",
+                          Lower);
+  ASSERT_TRUE(FS.get() != nullptr);
+
+  IntrusiveRefCntPtr<vfs::OverlayFileSystem> O(
+      new vfs::OverlayFileSystem(Lower));
+  O->pushOverlay(FS);
+
+  // file
+  ErrorOr<vfs::Status> S = O->status("//root/file1");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("//root/foo/bar/a", S->getName());
+  EXPECT_TRUE(S->IsVFSMapped);
+
+  // file after opening
+  auto OpenedF = O->openFileForRead("//root/file1");
+  ASSERT_FALSE(OpenedF.getError());
+  auto OpenedS = (*OpenedF)->status();
+  ASSERT_FALSE(OpenedS.getError());
+  EXPECT_EQ("//root/foo/bar/a", OpenedS->getName());
+  EXPECT_TRUE(OpenedS->IsVFSMapped);
+
+  // file in an implicit directory, with its virtual name
+  S = O->status("//root/dir/file3");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("//root/dir/file3", S->getName());
+  EXPECT_EQ(FS->status("//root/dir/../dir/./file3")->getName(),
+            "//root/dir/../dir/./file3");
+
+  // directory
+  S = O->status("//root/dir");
+  ASSERT_FALSE(S.getError());
+  EXPECT_TRUE(S->isDirectory());
+  EXPECT_TRUE(S->equivalent(*O->status("//root/dir"))); // non-volatile UniqueID
+  EXPECT_FALSE(S->equivalent(*O->status("//root/")));
+
+  // broken mapping, missing file, file used as a directory
+  EXPECT_EQ(O->status("//root/file2").getError(),
+            llvm::errc::no_such_file_or_directory);
+  EXPECT_EQ(FS->status("//root/file4").getError(),
+            llvm::errc::no_such_file_or_directory);
+  EXPECT_EQ(FS->status("//root/file1/x").getError(),
+            llvm::errc::not_a_directory);
+  EXPECT_EQ(0, NumDiagnostics);
+}
+
+TEST_F(VFSFromBinaryOverlayTest, CaseInsensitive) {
+  IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
+  Lower->addRegularFile("//root/foo/bar/a");
+  IntrusiveRefCntPtr<vfs::FileSystem> FS =
+      getFromBinaryString("{ 'case-sensitive': 'false',\n"
+                          "  'roots': [\n"
+                          "{\n"
+                          "  'type': 'directory',\n"
+                          "  'name': '//root/',\n"
+                          "  'contents': [ {\n"
+                          "                  'type': 'file',\n"
+                          "                  'name': 'XX',\n"
+                          "                  'external-contents': '//root/foo/bar/a'\n"
+                          "                }\n"
+                          "              ]\n"
+                          "}]}",
+                          Lower);
+  ASSERT_TRUE(FS.get() != nullptr);
+
+  ErrorOr<vfs::Status> S = FS->status("//root/XX");
+  ASSERT_FALSE(S.getError());
+  ErrorOr<vfs::Status> SS = FS->status("//root/xx");
+  ASSERT_FALSE(SS.getError());
+  EXPECT_TRUE(S->equivalent(*SS));
+  SS = FS->status("//ROOT/xX");
+  ASSERT_FALSE(SS.getError());
+  EXPECT_TRUE(S->equivalent(*SS));
+  EXPECT_EQ(0, NumDiagnostics);
+}
+
+TEST_F(VFSFromBinaryOverlayTest, DirectoryIteration) {
+  IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
+  Lower->addDirectory("//root/");
+  Lower->addDirectory("//root/foo");
+  Lower->addDirectory("//root/foo/bar");
+  Lower->addRegularFile("//root/foo/bar/a");
+  Lower->addRegularFile("//root/foo/bar/b");
+  Lower->addRegularFile("//root/file3");
+  IntrusiveRefCntPtr<vfs::FileSystem> FS =
+  getFromBinaryString("{ 'use-external-names': false,\n"
+                      "  'roots': [\n"
+                      "{\n"
+                      "  'type': 'directory',\n"
+                      "  'name': '//root/',\n"
+                      "  'contents': [ {\n"
+                      "                  'type': 'file',\n"
+                      "                  'name': 'file1',\n"
+                      "                  'external-contents': '//root/foo/bar/a'\n"
+                      "                },\n"
+                      "                {\n"
+                      "                  'type': 'file',\n"
+                      "                  'name': 'missing',\n"
+                      "                  'external-contents': '//root/foo/bar/c'\n"
+                      "                },\n"
+                      "                {\n"
+                      "                  'type': 'file',\n"
+                      "                  'name': 'file2',\n"
+                      "                  'external-contents': '//root/foo/bar/b'\n"
+                      "                }\n"
+                      "              ]\n"
+                      "}\n"
+                      "]\n"
+                      "}",
+                      Lower);
+  ASSERT_TRUE(FS.get() != nullptr);
+
+  IntrusiveRefCntPtr<vfs::OverlayFileSystem> O(
+      new vfs::OverlayFileSystem(Lower));
+  O->pushOverlay(FS);
+
+  std::error_code EC;
+  checkContents(O->dir_begin("//root/", EC),
+                {"//root/file1", "//root/file2", "//root/file3", "//root/foo"});
+
+  checkContents(O->dir_begin("//root/foo/bar", EC),
+                {"//root/foo/bar/a", "//root/foo/bar/b"});
+}
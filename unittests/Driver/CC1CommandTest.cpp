@@ -0,0 +1,140 @@
+//===- unittests/Driver/CC1CommandTest.cpp --- In-process -cc1 jobs -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Unit tests for the -cc1 jobs that -fintegrated-cc1 runs in the driver's
+// process, with stubs in place of the -cc1 tool.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/Job.h"
+#include "clang/Basic/DiagnosticIDs.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Driver/Compilation.h"
+#include "clang/Driver/Driver.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+using namespace clang;
+using namespace clang::driver;
+
+namespace {
+
+std::vector<std::string> StubArgv;
+size_t BufferedOutputAtStart;
+
+int returnThree(ArrayRef<const char *> Argv) {
+  StubArgv.assign(Argv.begin(), Argv.end());
+  BufferedOutputAtStart = llvm::outs().GetNumBytesInBuffer();
+  llvm::outs() << "output of the in-process job\n";
+  return 3;
+}
+
+int crash(ArrayRef<const char *> Argv) {
+  StubArgv.assign(Argv.begin(), Argv.end());
+  LLVM_BUILTIN_TRAP;
+}
+
+void handleFatalError(void *UserData, const std::string &Message,
+                      bool GenCrashDiag) {
+  // Like the handler of cc1_main, hand the failure back to the driver.
+  if (auto *CRC = llvm::CrashRecoveryContext::GetCurrent())
+    CRC->HandleCrash();
+  ADD_FAILURE() << "not running in a crash recovery context";
+  abort();
+}
+
+int reportFatalError(ArrayRef<const char *> Argv) {
+  StubArgv.assign(Argv.begin(), Argv.end());
+  llvm::install_fatal_error_handler(handleFatalError);
+  llvm::report_fatal_error("broken backend");
+}
+
+class CC1CommandTest : public ::testing::Test {
+protected:
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags;
+  std::unique_ptr<Driver> TheDriver;
+  std::unique_ptr<Compilation> C;
+
+  /// Builds a -fsyntax-only compilation whose -cc1 job runs \p CC1Main.
+  void buildCompilation(Driver::CC1ToolFunc CC1Main) {
+    StubArgv.clear();
+    C.reset();
+    Diags = new DiagnosticsEngine(new DiagnosticIDs, new DiagnosticOptions,
+                                  new IgnoringDiagConsumer);
+    TheDriver.reset(new Driver("/bin/clang", "x86_64-unknown-linux-gnu",
+                               *Diags, new vfs::InMemoryFileSystem));
+    TheDriver->setCheckInputsExist(false);
+    TheDriver->CC1Main = CC1Main;
+    C.reset(TheDriver->BuildCompilation(
+        {"clang", "-fintegrated-cc1", "-fsyntax-only", "foo.c"}));
+    ASSERT_TRUE(C);
+    ASSERT_EQ(1u, C->getJobs().size());
+  }
+
+  int execute(const Command *&FailingCommand) {
+    FailingCommand = nullptr;
+    return C->ExecuteCommand(*C->getJobs().begin(), FailingCommand);
+  }
+};
+
+TEST_F(CC1CommandTest, ReturnsStatus) {
+  buildCompilation(returnThree);
+  llvm::outs() << "output of the driver\n";
+  const Command *FailingCommand;
+  EXPECT_EQ(3, execute(FailingCommand));
+  EXPECT_EQ(&*C->getJobs().begin(), FailingCommand);
+
+  ASSERT_LE(2u, StubArgv.size());
+  EXPECT_EQ("/bin/clang", StubArgv[0]);
+  EXPECT_EQ("-cc1", StubArgv[1]);
+  EXPECT_EQ("foo.c", StubArgv.back());
+
+  // The output of the driver and of the job are written in order.
+  EXPECT_EQ(0u, BufferedOutputAtStart);
+  EXPECT_EQ(0u, llvm::outs().GetNumBytesInBuffer());
+}
+
+TEST_F(CC1CommandTest, CrashIsReportedAsSignal) {
+  buildCompilation(crash);
+  const Command *FailingCommand;
+  EXPECT_EQ(-2, execute(FailingCommand));
+  EXPECT_EQ(&*C->getJobs().begin(), FailingCommand);
+  EXPECT_FALSE(StubArgv.empty());
+}
+
+TEST_F(CC1CommandTest, FatalErrorIsReportedAsSignal) {
+  buildCompilation(reportFatalError);
+  const Command *FailingCommand;
+  EXPECT_EQ(-2, execute(FailingCommand));
+  EXPECT_EQ(&*C->getJobs().begin(), FailingCommand);
+  EXPECT_FALSE(StubArgv.empty());
+
+  // The job's fatal error handler is gone; installing another one would
+  // assert otherwise.
+  llvm::install_fatal_error_handler(handleFatalError);
+  llvm::remove_fatal_error_handler();
+}
+
+TEST_F(CC1CommandTest, RunsAgainAfterCrash) {
+  buildCompilation(crash);
+  const Command *FailingCommand;
+  EXPECT_EQ(-2, execute(FailingCommand));
+
+  buildCompilation(returnThree);
+  EXPECT_EQ(3, execute(FailingCommand));
+  EXPECT_FALSE(StubArgv.empty());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,227 @@
+//===- unittests/Driver/CompilationTest.cpp --- Parallel job tests --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Unit tests for the scheduling of the jobs of a compilation with
+// -parallel-jobs, with stubs in place of the commands.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Driver/Compilation.h"
+#include "clang/Basic/DiagnosticIDs.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "clang/Driver/Driver.h"
+#include "clang/Driver/Job.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace clang;
+using namespace clang::driver;
+
+namespace {
+
+/// The order in which the stub commands start and end.
+class JobLog {
+  std::mutex Mutex;
+  std::condition_variable CV;
+  std::vector<std::string> Events;
+
+public:
+  void record(std::string Event) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Events.push_back(std::move(Event));
+    CV.notify_all();
+  }
+
+  /// Waits until \p Event was recorded, or a few seconds passed.
+  bool waitFor(const std::string &Event) {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    return CV.wait_for(Lock, std::chrono::seconds(10), [&] {
+      return llvm::is_contained(Events, Event);
+    });
+  }
+
+  /// Returns the position of \p Event, or -1 if it was not recorded.
+  int indexOf(const std::string &Event) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = std::find(Events.begin(), Events.end(), Event);
+    return It == Events.end() ? -1 : It - Events.begin();
+  }
+};
+
+/// A command that only logs that it ran, and returns a given status.
+class StubCommand : public Command {
+public:
+  std::string Name;
+  int Result = 0;
+  /// Events to wait for before returning.
+  std::vector<std::string> WaitFor;
+  /// Time to wait for after them.
+  std::chrono::milliseconds Delay{0};
+  JobLog &Log;
+
+  StubCommand(const Command &Job, std::string Name, JobLog &Log)
+      : Command(Job), Name(std::move(Name)), Log(Log) {}
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override {
+    Log.record("start " + Name);
+    for (const std::string &Event : WaitFor)
+      EXPECT_TRUE(Log.waitFor(Event)) << Name << " waits for " << Event;
+    std::this_thread::sleep_for(Delay);
+    Log.record("end " + Name);
+    if (ExecutionFailed)
+      *ExecutionFailed = false;
+    return Result;
+  }
+};
+
+class CompilationTest : public ::testing::Test {
+protected:
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags;
+  std::unique_ptr<Driver> TheDriver;
+  std::unique_ptr<Compilation> C;
+  JobLog Log;
+  /// The stubs that replaced the jobs of the compilation, in job order.
+  std::vector<StubCommand *> Stubs;
+
+  void SetUp() override {
+    Diags = new DiagnosticsEngine(new DiagnosticIDs, new DiagnosticOptions,
+                                  new IgnoringDiagConsumer);
+    TheDriver.reset(new Driver("/bin/clang", "x86_64-unknown-linux-gnu",
+                               *Diags, new vfs::InMemoryFileSystem));
+    TheDriver->setCheckInputsExist(false);
+  }
+
+  /// Builds the compilation for \p Args, then replaces each of its jobs
+  /// with a stub named after its position.
+  void buildCompilation(ArrayRef<const char *> Args, unsigned NumJobs) {
+    C.reset(TheDriver->BuildCompilation(Args));
+    ASSERT_TRUE(C);
+    ASSERT_EQ(NumJobs, C->getJobs().size());
+
+    std::vector<std::unique_ptr<StubCommand>> NewJobs;
+    for (const Command &Job : C->getJobs())
+      NewJobs.push_back(llvm::make_unique<StubCommand>(
+          Job, std::to_string(NewJobs.size()), Log));
+    C->getJobs().clear();
+    for (auto &Job : NewJobs) {
+      Stubs.push_back(Job.get());
+      C->getJobs().addJob(std::move(Job));
+    }
+  }
+
+  SmallVector<std::pair<int, const Command *>, 4> executeJobs() {
+    SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
+    C->ExecuteJobs(C->getJobs(), FailingCommands);
+    return FailingCommands;
+  }
+};
+
+TEST_F(CompilationTest, RunsIndependentJobsTogether) {
+  if (!llvm::llvm_is_multithreaded())
+    return;
+
+  // Compile a.c and b.c, then link.
+  buildCompilation({"clang", "-parallel-jobs=2", "a.c", "b.c"}, 3);
+  Stubs[0]->WaitFor = {"start 1"};
+  Stubs[1]->WaitFor = {"start 0"};
+  Stubs[1]->Delay = std::chrono::milliseconds(20);
+
+  EXPECT_TRUE(executeJobs().empty());
+  // The link job waits for both compile jobs.
+  EXPECT_LT(Log.indexOf("end 0"), Log.indexOf("start 2"));
+  EXPECT_LT(Log.indexOf("end 1"), Log.indexOf("start 2"));
+}
+
+TEST_F(CompilationTest, NoJobStartsAfterFailure) {
+  if (!llvm::llvm_is_multithreaded())
+    return;
+
+  // Compile and assemble a.c (jobs 0 and 1), then b.c (jobs 2 and 3).
+  // Compiling a.c fails while b.c is being compiled; assembling b.c must not
+  // start after that.
+  buildCompilation({"clang", "-parallel-jobs=2", "-no-integrated-as", "-c",
+                    "a.c", "b.c"},
+                   4);
+  Stubs[0]->WaitFor = {"start 2"};
+  Stubs[0]->Result = 1;
+  Stubs[2]->WaitFor = {"end 0"};
+  Stubs[2]->Delay = std::chrono::milliseconds(100);
+
+  auto FailingCommands = executeJobs();
+  ASSERT_EQ(1u, FailingCommands.size());
+  EXPECT_EQ(1, FailingCommands[0].first);
+  EXPECT_EQ(Stubs[0], FailingCommands[0].second);
+  EXPECT_NE(-1, Log.indexOf("end 2"));
+  EXPECT_EQ(-1, Log.indexOf("start 1"));
+  EXPECT_EQ(-1, Log.indexOf("start 3"));
+}
+
+TEST_F(CompilationTest, ReportsFailuresInJobOrder) {
+  if (!llvm::llvm_is_multithreaded())
+    return;
+
+  // Job 1 fails first, but job 0 is reported first.
+  buildCompilation({"clang", "-parallel-jobs=2", "-c", "a.c", "b.c"}, 2);
+  Stubs[0]->WaitFor = {"end 1"};
+  Stubs[0]->Result = 1;
+  Stubs[1]->Result = 2;
+
+  auto FailingCommands = executeJobs();
+  ASSERT_EQ(2u, FailingCommands.size());
+  EXPECT_EQ(1, FailingCommands[0].first);
+  EXPECT_EQ(Stubs[0], FailingCommands[0].second);
+  EXPECT_EQ(2, FailingCommands[1].first);
+  EXPECT_EQ(Stubs[1], FailingCommands[1].second);
+}
+
+TEST_F(CompilationTest, RemovesResultFileOfFailedJob) {
+  if (!llvm::llvm_is_multithreaded())
+    return;
+
+  SmallString<128> Dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("parallel-jobs", Dir));
+  SmallString<128> Output(Dir);
+  llvm::sys::path::append(Output, "a.out");
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Output, EC, llvm::sys::fs::F_None);
+    ASSERT_FALSE(EC);
+    OS << "stale output\n";
+  }
+
+  // The link job fails after both compile jobs succeeded.
+  buildCompilation({"clang", "-parallel-jobs=2", "a.c", "b.c", "-o",
+                    Output.c_str()},
+                   3);
+  Stubs[2]->Result = 1;
+
+  SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
+  EXPECT_NE(0, TheDriver->ExecuteCompilation(*C, FailingCommands));
+  ASSERT_EQ(1u, FailingCommands.size());
+  EXPECT_EQ(Stubs[2], FailingCommands[0].second);
+  EXPECT_FALSE(llvm::sys::fs::exists(Output));
+
+  llvm::sys::fs::remove(Dir);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,160 @@
+//===- unittests/Lex/CompactTokenBufferTest.cpp - CompactTokenBuffer tests ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/CompactTokenBuffer.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/MemoryBufferCache.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+class CompactTokenBufferTest : public ::testing::Test {
+protected:
+  CompactTokenBufferTest()
+    : FileMgr(FileMgrOpts),
+      DiagID(new DiagnosticIDs()),
+      Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+      SourceMgr(Diags, FileMgr),
+      TargetOpts(new TargetOptions)
+  {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+    LangOpts.CPlusPlus = true;
+    LangOpts.CPlusPlus11 = true;
+  }
+
+  // The preprocessor is kept alive, since it owns the identifiers.
+  std::vector<Token> Lex(StringRef Source) {
+    SourceMgr.setMainFileID(
+        SourceMgr.createFileID(llvm::MemoryBuffer::getMemBuffer(Source)));
+    HeaderInfo = llvm::make_unique<HeaderSearch>(
+        std::make_shared<HeaderSearchOptions>(), SourceMgr, Diags, LangOpts,
+        Target.get());
+    PP = llvm::make_unique<Preprocessor>(
+        std::make_shared<PreprocessorOptions>(), Diags, LangOpts, SourceMgr,
+        PCMCache, *HeaderInfo, ModLoader,
+        /*IILookup =*/nullptr,
+        /*OwnsHeaderSearch =*/false);
+    PP->Initialize(*Target);
+    PP->EnterMainSourceFile();
+
+    std::vector<Token> Toks;
+    while (1) {
+      Token Tok;
+      PP->Lex(Tok);
+      if (Tok.is(tok::eof))
+        break;
+      Toks.push_back(Tok);
+    }
+    return Toks;
+  }
+
+  void ExpectSameTokens(ArrayRef<Token> Expected, ArrayRef<Token> Actual) {
+    ASSERT_EQ(Expected.size(), Actual.size());
+    for (unsigned I = 0, E = Expected.size(); I != E; ++I) {
+      const Token &A = Expected[I], &B = Actual[I];
+      EXPECT_EQ(A.getKind(), B.getKind()) << "token " << I;
+      EXPECT_EQ(A.getFlags(), B.getFlags()) << "token " << I;
+      EXPECT_EQ(A.getLocation(), B.getLocation()) << "token " << I;
+      if (A.isAnnotation()) {
+        EXPECT_EQ(A.getAnnotationEndLoc(), B.getAnnotationEndLoc());
+        EXPECT_EQ(A.getAnnotationValue(), B.getAnnotationValue());
+        continue;
+      }
+      EXPECT_EQ(A.getLength(), B.getLength()) << "token " << I;
+      if (A.isLiteral())
+        EXPECT_EQ(A.getLiteralData(), B.getLiteralData()) << "token " << I;
+      else if (A.is(tok::eof))
+        EXPECT_EQ(A.getEofData(), B.getEofData()) << "token " << I;
+      else
+        EXPECT_EQ(A.getIdentifierInfo(), B.getIdentifierInfo())
+            << "token " << I;
+    }
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+  MemoryBufferCache PCMCache;
+  TrivialModuleLoader ModLoader;
+  std::unique_ptr<HeaderSearch> HeaderInfo;
+  std::unique_ptr<Preprocessor> PP;
+};
+
+TEST_F(CompactTokenBufferTest, RoundTrip) {
+  std::vector<Token> Toks = Lex(
+      "#define STR(x) #x\n"
+      "#define CAT(a, b) a ## b\n"
+      "int f(int x) {\n"
+      "  const char *s = STR(hello) \"world\" u8\"!\";\n"
+      "  int CAT(y, z) = 0x2a + 'c' + 1.5e3;\n"
+      "  return x ? yz : f(x - 1) >>= 2;\n"
+      "}\n");
+  ASSERT_FALSE(Toks.empty());
+
+  CompactTokenBuffer Buffer;
+  Buffer.encode(Toks, SourceMgr);
+  EXPECT_EQ(Toks.size(), Buffer.size());
+  EXPECT_LT(Buffer.getMemorySize(), Toks.size() * sizeof(Token) / 2);
+
+  SmallVector<Token, 16> Decoded;
+  Buffer.decode(Decoded, SourceMgr);
+  ExpectSameTokens(Toks, Decoded);
+
+  Buffer.clear();
+  EXPECT_TRUE(Buffer.empty());
+  EXPECT_EQ(0u, Buffer.getMemorySize());
+}
+
+TEST_F(CompactTokenBufferTest, TokensWithData) {
+  std::vector<Token> Toks = Lex("a + b");
+  ASSERT_EQ(3u, Toks.size());
+  int Data;
+
+  Token Annot;
+  Annot.startToken();
+  Annot.setKind(tok::annot_typename);
+  Annot.setAnnotationRange(
+      SourceRange(Toks[0].getLocation(), Toks[2].getLocation()));
+  Annot.setAnnotationValue(&Data);
+  Toks.insert(Toks.begin() + 1, Annot);
+
+  Token Eof;
+  Eof.startToken();
+  Eof.setKind(tok::eof);
+  Eof.setLocation(Toks.back().getEndLoc());
+  Eof.setEofData(&Data);
+  Toks.push_back(Eof);
+
+  CompactTokenBuffer Buffer;
+  Buffer.encode(Toks, SourceMgr);
+  SmallVector<Token, 8> Decoded;
+  Buffer.decode(Decoded, SourceMgr);
+  ExpectSameTokens(Toks, Decoded);
+}
+
+} // anonymous namespace
@@ -48,4 +48,74 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+static std::string getContents(const RewriteBuffer &Buf) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  return OS.str();
+}
+
+TEST(RewriteBuffer, ApplyEdits) {
+  StringRef Input = "hello world";
+  typedef RewriteBuffer::Edit Edit;
+  // The edits of TagRanges, as a batch in a different order.
+  Edit Edits[] = {
+    Edit(6, 5, ""),
+    Edit(5, 0, "</outer>", /*InsertAfter=*/false),
+    Edit(0, 0, "<outer>"),
+    Edit(5, 0, "</inner>", /*InsertAfter=*/false),
+    Edit(0, 0, "<inner>"),
+  };
+
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+  EXPECT_FALSE(Buf.ApplyEdits(Edits));
+  EXPECT_EQ("<outer><inner>hello</inner></outer> ", getContents(Buf));
+
+  // Later edits are still made relative to the original buffer.
+  Buf.ReplaceText(0, 5, "HELLO");
+  Buf.InsertTextAfter(11, "!");
+  EXPECT_EQ("<outer><inner>HELLO</inner></outer> !", getContents(Buf));
+}
+
+TEST(RewriteBuffer, ApplyEditsAfterEdits) {
+  RewriteBuffer Buf;
+  Buf.Initialize("int x = 0;");
+  Buf.InsertTextAfter(0, "static ");
+  Buf.ReplaceText(8, 1, "42");
+
+  typedef RewriteBuffer::Edit Edit;
+  Edit Edits[] = {
+    Edit(0, 0, "/*a*/ ", /*InsertAfter=*/false),
+    Edit(0, 0, "const "),
+    Edit(4, 1, "y"),
+    Edit(10, 0, " // b"),
+  };
+  EXPECT_FALSE(Buf.ApplyEdits(Edits));
+  EXPECT_EQ("/*a*/ static const int y = 42; // b", getContents(Buf));
+}
+
+TEST(RewriteBuffer, ApplyEditsConflict) {
+  typedef RewriteBuffer::Edit Edit;
+  Edit Overlapping[] = { Edit(0, 3, "a"), Edit(4, 1, "b"), Edit(2, 2, "c") };
+  unsigned Index;
+  EXPECT_TRUE(RewriteBuffer::findConflict(Overlapping, Index));
+  EXPECT_EQ(2u, Index);
+
+  // Insertions may not land inside replaced text, but may border it.
+  Edit Inside[] = { Edit(0, 3, "a"), Edit(1, 0, "b") };
+  EXPECT_TRUE(RewriteBuffer::findConflict(Inside, Index));
+  Edit Bordering[] = { Edit(0, 3, "a"), Edit(0, 0, "b"), Edit(3, 0, "c") };
+  EXPECT_FALSE(RewriteBuffer::findConflict(Bordering, Index));
+
+  RewriteBuffer Buf;
+  Buf.Initialize("abcdef");
+  EXPECT_TRUE(Buf.ApplyEdits(Overlapping));
+  EXPECT_EQ("abcdef", getContents(Buf));
+
+  Edit PastEnd[] = { Edit(4, 3, "x") };
+  EXPECT_TRUE(Buf.ApplyEdits(PastEnd));
+  EXPECT_EQ("abcdef", getContents(Buf));
+}
+
 } // anonymous namespace
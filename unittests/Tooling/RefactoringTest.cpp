@@ -502,6 +502,82 @@ TEST_F(ReplacementTest, FailOrderDependentReplacements) {
   EXPECT_EQ("line1\nother\nline3\nline4", Context.getRewrittenText(ID));
 }
 
+TEST_F(ReplacementTest, AddAllReplacements) {
+  Replacements Replaces =
+      toReplacements({Replacement("x.cc", 0, 2, ""),
+                      Replacement("x.cc", 10, 0, "b")});
+  auto Err = Replaces.addAll({Replacement("x.cc", 20, 3, "c"),
+                              Replacement("x.cc", 1, 3, ""),
+                              Replacement("x.cc", 15, 0, "d"),
+                              Replacement("x.cc", 5, 1, "e")});
+  EXPECT_TRUE(!Err);
+  llvm::consumeError(std::move(Err));
+  EXPECT_EQ(toReplacements({Replacement("x.cc", 0, 4, ""),
+                            Replacement("x.cc", 5, 1, "e"),
+                            Replacement("x.cc", 10, 0, "b"),
+                            Replacement("x.cc", 15, 0, "d"),
+                            Replacement("x.cc", 20, 3, "c")}),
+            Replaces);
+}
+
+TEST_F(ReplacementTest, AddAllMatchesAdd) {
+  // Add many small, often overlapping replacements one by one and all at
+  // once, and check that both end up with the same result.
+  unsigned Seed = 1;
+  auto Next = [&](unsigned Range) {
+    Seed = Seed * 1103515245 + 12345;
+    return (Seed >> 16) % Range;
+  };
+  for (unsigned Round = 0; Round < 50; ++Round) {
+    std::vector<Replacement> Existing, New;
+    for (unsigned I = 0; I < 20; ++I) {
+      auto &Rs = Next(2) ? New : Existing;
+      unsigned Length = Next(3) ? 0 : Next(4);
+      Rs.push_back(Replacement("x.cc", Next(100), Length,
+                               Next(2) ? "" : std::string(1, 'a' + Next(2))));
+    }
+
+    Replacements OneByOne, AllAtOnce;
+    for (const Replacement &R : Existing) {
+      llvm::consumeError(OneByOne.add(R));
+      llvm::consumeError(AllAtOnce.add(R));
+    }
+    Replacements Before = AllAtOnce;
+    bool Failed = false;
+    for (const Replacement &R : New) {
+      if (auto Err = OneByOne.add(R)) {
+        llvm::consumeError(std::move(Err));
+        Failed = true;
+        break;
+      }
+    }
+    auto Err = AllAtOnce.addAll(New);
+    EXPECT_EQ(Failed, (bool)Err);
+    llvm::consumeError(std::move(Err));
+    if (Failed)
+      EXPECT_EQ(Before, AllAtOnce);
+    else
+      EXPECT_EQ(OneByOne, AllAtOnce);
+  }
+}
+
+TEST_F(ReplacementTest, FailAddAllReplacements) {
+  Replacements Replaces = toReplacements({Replacement("x.cc", 0, 5, "a")});
+  Replacement Conflict("x.cc", 2, 1, "b");
+  auto Err = Replaces.addAll({Replacement("x.cc", 10, 0, "c"), Conflict});
+  EXPECT_TRUE(checkReplacementError(std::move(Err),
+                                    replacement_error::overlap_conflict,
+                                    *Replaces.begin(), Conflict));
+  EXPECT_EQ(toReplacements({Replacement("x.cc", 0, 5, "a")}), Replaces);
+
+  Replacement OtherFile("y.cc", 10, 0, "c");
+  Err = Replaces.addAll({Replacement("x.cc", 10, 0, "c"), OtherFile});
+  EXPECT_TRUE(checkReplacementError(std::move(Err),
+                                    replacement_error::wrong_file_path,
+                                    *Replaces.begin(), OtherFile));
+  EXPECT_EQ(1u, Replaces.size());
+}
+
 TEST_F(ReplacementTest, InvalidSourceLocationFailsApplyAll) {
   Replacements Replaces =
       toReplacements({Replacement(Context.Sources, SourceLocation(), 5, "2")});
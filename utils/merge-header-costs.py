@@ -0,0 +1,114 @@
+#!/usr/bin/env python
+
+"""Merge the -header-cost-report files of a project.
+
+Each translation unit compiled with
+
+  clang -Xclang -header-cost-report -Xclang <file>.hcost.json ...
+
+reports the cost of every file it includes, once per platform it is compiled
+for, in <file>.hcost.<platform>.json. This script sums the reports per file, so
+that the headers which cost the most across the whole build come first:
+
+  merge-header-costs.py --sort inclusive.microseconds build/**/*.hcost.*.json
+
+Each report counts as a translation unit, so a file compiled for several
+platforms counts several times; --platform keeps the reports of one platform.
+
+The exclusive costs of a file are those incurred in the file itself; its
+inclusive costs also cover everything it includes.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import sys
+
+METRICS = ['tokens', 'microseconds', 'decls', 'instantiations', 'bytes']
+
+
+def report_platform(path):
+    """Returns the platform in the name of a report, <file>.<platform>.json."""
+    stem = os.path.splitext(os.path.basename(path))[0]
+    return os.path.splitext(stem)[1][1:]
+
+
+def merge(paths):
+    files = {}
+    for path in paths:
+        with open(path) as f:
+            report = json.load(f)
+        if report.get('version') != 1:
+            sys.exit('error: %s: unsupported report version %r' %
+                     (path, report.get('version')))
+        for entry in report['files']:
+            merged = files.setdefault(entry['name'], {
+                'name': entry['name'],
+                'translation-units': 0,
+                'inclusions': 0,
+                'exclusive': dict((m, 0) for m in METRICS),
+                'inclusive': dict((m, 0) for m in METRICS),
+            })
+            merged['translation-units'] += 1
+            merged['inclusions'] += entry['inclusions']
+            for kind in ('exclusive', 'inclusive'):
+                for m in METRICS:
+                    merged[kind][m] += entry[kind][m]
+    return list(files.values())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('reports', nargs='+', metavar='report',
+                        help='a file written by -header-cost-report')
+    parser.add_argument('--sort', default='inclusive.microseconds',
+                        help='the metric to sort by, as exclusive.<metric> or '
+                             'inclusive.<metric>, where <metric> is one of ' +
+                             ', '.join(METRICS))
+    parser.add_argument('--platform',
+                        help='only merge the reports of this platform, such '
+                             'as amd64')
+    parser.add_argument('--limit', type=int, default=50,
+                        help='the number of files to print (0 for all)')
+    parser.add_argument('--json', action='store_true',
+                        help='print the merged report as JSON')
+    args = parser.parse_args()
+
+    kind, _, metric = args.sort.partition('.')
+    if kind not in ('exclusive', 'inclusive') or metric not in METRICS:
+        parser.error('invalid sort key %r' % args.sort)
+
+    reports = args.reports
+    if args.platform:
+        reports = [r for r in reports if report_platform(r) == args.platform]
+        if not reports:
+            parser.error('no report for platform %r' % args.platform)
+
+    files = merge(reports)
+    files.sort(key=lambda f: (-f[kind][metric], f['name']))
+    if args.limit:
+        files = files[:args.limit]
+
+    if args.json:
+        json.dump({'version': 1, 'translation-units': len(reports),
+                   'files': files}, sys.stdout, indent=2, sort_keys=True)
+        print()
+        return
+
+    print('%10s %10s %12s %12s %10s %10s %12s  %s' % (
+        'TUs', 'incl', 'incl-ms', 'excl-ms', 'tokens', 'decls', 'insts',
+        'file'))
+    for f in files:
+        print('%10d %10d %12.1f %12.1f %10d %10d %12d  %s' % (
+            f['translation-units'], f['inclusions'],
+            f['inclusive']['microseconds'] / 1000.0,
+            f['exclusive']['microseconds'] / 1000.0,
+            f['inclusive']['tokens'], f['inclusive']['decls'],
+            f['inclusive']['instantiations'], f['name']))
+
+
+if __name__ == '__main__':
+    main()